@@ -0,0 +1,211 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "RuntimeMeshAmbientOcclusion.h"
+#include "RuntimeMeshBVH.h"
+#include "RuntimeMeshBuilder.h"
+#include "Async/ParallelFor.h"
+
+// Vertices handed to a worker at a time
+static const int32 AO_VERTICES_PER_TASK = 64;
+
+namespace
+{
+	FORCEINLINE int32 CountRays(uint32 Mask)
+	{
+		static const int32 BitCounts[16] = { 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4 };
+		return BitCounts[Mask & 0xF];
+	}
+
+	struct FAOSection
+	{
+		URuntimeMeshComponent* Component;
+		int32 SectionIndex;
+		int32 FirstVertex;
+		int32 NumVertices;
+	};
+}
+
+FRuntimeMeshAOBakeStats FRuntimeMeshAOBaker::Bake(const TArray<URuntimeMeshComponent*>& Components, const FRuntimeMeshAOBakeSettings& Settings)
+{
+	FRuntimeMeshAOBakeStats Stats;
+	TArray<FAOSection> Sections;
+	TArray<FVector> Positions;
+	TArray<FVector> Normals;
+	FRuntimeMeshBVH BVH;
+
+	double StartTime = FPlatformTime::Seconds();
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_AOBake_BuildBVH);
+
+		TArray<FVector> SectionPositions;
+		TArray<FVector4> SectionNormals;
+		TArray<int32> SectionIndices;
+		for (URuntimeMeshComponent* Component : Components)
+		{
+			if (Component == nullptr)
+			{
+				continue;
+			}
+
+			// Normals go through the inverse transpose so they stay perpendicular under non uniform scale
+			const FMatrix PositionMatrix = Component->GetComponentTransform().ToMatrixWithScale();
+			const FMatrix NormalMatrix = PositionMatrix.InverseFast().GetTransposed();
+			const int32 LastSectionIdx = Component->GetLastSectionIndex();
+			for (int32 SectionIdx = 0; SectionIdx <= LastSectionIdx; SectionIdx++)
+			{
+				if (!Component->DoesSectionExist(SectionIdx))
+				{
+					continue;
+				}
+
+				const IRuntimeMeshVerticesBuilder* Vertices = nullptr;
+				const FRuntimeMeshIndicesBuilder* Indices = nullptr;
+				Component->MakeSectionResident(SectionIdx);
+				Component->GetSectionMesh(SectionIdx, Vertices, Indices);
+				if (Vertices == nullptr || Indices == nullptr)
+				{
+					delete Vertices;
+					delete Indices;
+					continue;
+				}
+
+				const int32 NumVertices = Vertices->Length();
+				Vertices->CopyPositions(SectionPositions);
+				Vertices->CopyNormals(SectionNormals);
+				for (int32 VertexIdx = 0; VertexIdx < NumVertices; VertexIdx++)
+				{
+					SectionPositions[VertexIdx] = PositionMatrix.TransformPosition(SectionPositions[VertexIdx]);
+					Normals.Add(NormalMatrix.TransformVector(FVector(SectionNormals[VertexIdx])).GetSafeNormal());
+				}
+
+				SectionIndices.SetNumUninitialized(Indices->Length());
+				Indices->Seek(0);
+				for (int32 Index = 0; Index < SectionIndices.Num(); Index++)
+				{
+					SectionIndices[Index] = Indices->ReadOne();
+				}
+				BVH.AddTriangles(SectionPositions, SectionIndices);
+
+				FAOSection& Section = Sections[Sections.AddUninitialized()];
+				Section.Component = Component;
+				Section.SectionIndex = SectionIdx;
+				Section.FirstVertex = Positions.Num();
+				Section.NumVertices = NumVertices;
+				Positions.Append(SectionPositions);
+
+				delete Vertices;
+				delete Indices;
+			}
+		}
+
+		BVH.Build();
+	}
+	Stats.BuildSeconds = FPlatformTime::Seconds() - StartTime;
+	Stats.NumVertices = Positions.Num();
+	Stats.NumTriangles = BVH.GetNumTriangles();
+	if (BVH.IsEmpty())
+	{
+		return Stats;
+	}
+
+	const int32 NumPackets = FMath::Max(FMath::DivideAndRoundUp(Settings.NumRays, 4), 1);
+	const int32 NumRays = NumPackets * 4;
+	const float SkyDistance = BVH.GetBounds().GetSize().Size();
+	TArray<FColor> Colors;
+	Colors.SetNumUninitialized(Positions.Num());
+	int64 TotalRays = 0;
+
+	StartTime = FPlatformTime::Seconds();
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_AOBake_Trace);
+
+		const int32 NumTasks = FMath::DivideAndRoundUp(Positions.Num(), AO_VERTICES_PER_TASK);
+		ParallelFor(NumTasks, [&](int32 TaskIdx)
+		{
+			int64 TaskRays = 0;
+			const int32 EndVertex = FMath::Min((TaskIdx + 1) * AO_VERTICES_PER_TASK, Positions.Num());
+			for (int32 VertexIdx = TaskIdx * AO_VERTICES_PER_TASK; VertexIdx < EndVertex; VertexIdx++)
+			{
+				const FVector& Normal = Normals[VertexIdx];
+				if (Normal.IsZero())
+				{
+					Colors[VertexIdx] = FColor::White;
+					continue;
+				}
+
+				FVector TangentX, TangentY;
+				Normal.FindBestAxisVectors(TangentX, TangentY);
+				const FVector Origin = Positions[VertexIdx] + Normal * Settings.Bias;
+
+				// Seeded per vertex so a bake gives the same result no matter how the work was split
+				FRandomStream Random(VertexIdx);
+				int32 NumOccluded = 0;
+				int32 NumEscaped = 0;
+				for (int32 PacketIdx = 0; PacketIdx < NumPackets; PacketIdx++)
+				{
+					// Cosine weighted, stratified over the packets so few rays still cover the hemisphere
+					FVector Directions[4];
+					for (int32 Lane = 0; Lane < 4; Lane++)
+					{
+						const float U1 = (PacketIdx + Random.GetFraction()) / NumPackets;
+						const float U2 = (Lane + Random.GetFraction()) * 0.25f;
+						const float Radius = FMath::Sqrt(U1);
+						float SinPhi, CosPhi;
+						FMath::SinCos(&SinPhi, &CosPhi, 2.0f * PI * U2);
+						Directions[Lane] = TangentX * (Radius * CosPhi) + TangentY * (Radius * SinPhi) + Normal * FMath::Sqrt(FMath::Max(0.0f, 1.0f - U1));
+					}
+
+					const uint32 Occluded = BVH.IsOccluded4(Origin, Directions, 0xF, 0.0f, Settings.MaxDistance);
+					NumOccluded += CountRays(Occluded);
+					TaskRays += 4;
+
+					if (Settings.bSkyVisibility && Occluded != 0xF)
+					{
+						const uint32 Blocked = BVH.IsOccluded4(Origin, Directions, ~Occluded & 0xF, Settings.MaxDistance, SkyDistance);
+						NumEscaped += CountRays(~(Occluded | Blocked) & 0xF);
+						TaskRays += CountRays(~Occluded & 0xF);
+					}
+				}
+
+				const uint8 Occlusion = (uint8)FMath::RoundToInt(255.0f * (NumRays - NumOccluded) / NumRays);
+				const uint8 Sky = Settings.bSkyVisibility ? (uint8)FMath::RoundToInt(255.0f * NumEscaped / NumRays) : 255;
+				Colors[VertexIdx] = FColor(Occlusion, Occlusion, Occlusion, Sky);
+			}
+			FPlatformAtomics::InterlockedAdd(&TotalRays, TaskRays);
+		});
+	}
+	Stats.TraceSeconds = FPlatformTime::Seconds() - StartTime;
+	Stats.NumRays = TotalRays;
+
+	// Every section is written in one pass once all the tracing is done
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_AOBake_WriteColors);
+
+		for (const FAOSection& Section : Sections)
+		{
+			IRuntimeMeshVerticesBuilder* Vertices = nullptr;
+			FRuntimeMeshIndicesBuilder* Indices = nullptr;
+			Section.Component->BeginMeshSectionUpdate(Section.SectionIndex, Vertices, Indices);
+			if (Vertices != nullptr && Vertices->HasColorComponent())
+			{
+				for (int32 VertexIdx = 0; VertexIdx < Section.NumVertices; VertexIdx++)
+				{
+					Vertices->SetColor(VertexIdx, Colors[Section.FirstVertex + VertexIdx]);
+				}
+				Section.Component->EndMeshSectionUpdate(Section.SectionIndex, ERuntimeMeshBuffer::Vertices);
+			}
+			else if (Vertices != nullptr)
+			{
+				UE_LOG(RuntimeMeshLog, Warning, TEXT("%s section %d has no vertex colors, ambient occlusion not stored"), *Section.Component->GetName(), Section.SectionIndex);
+			}
+
+			delete Vertices;
+			delete Indices;
+		}
+	}
+
+	UE_LOG(RuntimeMeshLog, Log, TEXT("Baked ambient occlusion for %d vertices against %d triangles: BVH %.2fs, %lld rays in %.2fs, %.2f Mrays/s"),
+		Stats.NumVertices, Stats.NumTriangles, Stats.BuildSeconds, Stats.NumRays, Stats.TraceSeconds, Stats.GetRaysPerSecond() / 1000000.0);
+	return Stats;
+}
@@ -0,0 +1,36 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "RuntimeMeshAsync.h"
+
+FCriticalSection FRuntimeMeshAsync::OrderLock;
+TMap<TWeakObjectPtr<URuntimeMeshComponent>, FGraphEventRef> FRuntimeMeshAsync::LastComponentTasks;
+
+void FRuntimeMeshAsync::AddLastComponentTask(const TWeakObjectPtr<URuntimeMeshComponent>& InRuntimeMeshComponent, FGraphEventArray& Prerequisites)
+{
+	const FGraphEventRef* LastTask = LastComponentTasks.Find(InRuntimeMeshComponent);
+	if (LastTask && !(*LastTask)->IsComplete())
+	{
+		Prerequisites.Add(*LastTask);
+	}
+}
+
+void FRuntimeMeshAsync::SetLastComponentTask(const TWeakObjectPtr<URuntimeMeshComponent>& InRuntimeMeshComponent, const FGraphEventRef& Event)
+{
+	if (FGraphEventRef* LastTask = LastComponentTasks.Find(InRuntimeMeshComponent))
+	{
+		*LastTask = Event;
+		return;
+	}
+
+	// Forget the components whose tasks have all run before adding another one
+	for (auto It = LastComponentTasks.CreateIterator(); It; ++It)
+	{
+		if (It.Value()->IsComplete())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	LastComponentTasks.Add(InRuntimeMeshComponent, Event);
+}
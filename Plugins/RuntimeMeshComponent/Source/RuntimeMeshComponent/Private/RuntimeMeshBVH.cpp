@@ -0,0 +1,726 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "RuntimeMeshBVH.h"
+
+// Centroid bins per axis the split candidates are taken from
+static const int32 SAH_BIN_COUNT = 12;
+// Nodes with no cheaper split than this many triangles stay leaves
+static const int32 SAH_MAX_LEAF_TRIANGLES = 16;
+// Determinants below this are treated as rays parallel to the triangle
+static const float TRIANGLE_EPSILON = 1.e-8f;
+// Traversal stack entries kept inline, deeper trees spill to the heap instead of losing subtrees
+static const int32 TraversalStackSize = 64;
+
+static float GetHalfSurfaceArea(const FBox& Box)
+{
+	FVector Extent = Box.Max - Box.Min;
+	return Extent.X * Extent.Y + Extent.Y * Extent.Z + Extent.Z * Extent.X;
+}
+
+/** Slab test, OutNear is where the ray enters the box or 0 when it starts inside */
+static FORCEINLINE bool IntersectRayBox(const FVector& Min, const FVector& Max, const FVector& Origin, const FVector& InvDirection, float MaxDistance, float& OutNear)
+{
+	const FVector T1 = (Min - Origin) * InvDirection;
+	const FVector T2 = (Max - Origin) * InvDirection;
+	const float TNear = FMath::Max3(FMath::Min(T1.X, T2.X), FMath::Min(T1.Y, T2.Y), FMath::Min(T1.Z, T2.Z));
+	const float TFar = FMath::Min3(FMath::Max(T1.X, T2.X), FMath::Max(T1.Y, T2.Y), FMath::Max(T1.Z, T2.Z));
+	OutNear = FMath::Max(TNear, 0.0f);
+	return TNear <= TFar && TFar >= 0.0f && TNear <= MaxDistance;
+}
+
+/** Earliest distance at which a sphere moving from Origin along Direction touches the triangle ABC, and the point it touches */
+static bool SweepSphereTriangle(const FVector& Origin, const FVector& Direction, float Radius, const FVector& A, const FVector& B, const FVector& C, float& OutDistance, FVector& OutContact)
+{
+	// Already touching at the start
+	const FVector Closest = FMath::ClosestPointOnTriangleToPoint(Origin, A, B, C);
+	if (FVector::DistSquared(Closest, Origin) <= Radius * Radius)
+	{
+		OutDistance = 0.0f;
+		OutContact = Closest;
+		return true;
+	}
+
+	const FVector Normal = ((B - A) ^ (C - A)).GetSafeNormal();
+	if (Normal.IsZero())
+	{
+		return false;
+	}
+
+	// The sphere reaches the plane on the side it starts on first, when that point is inside the triangle nothing can come earlier
+	const float Side = (Origin - A) | Normal;
+	const float Approach = Direction | Normal;
+	const float Sign = Side >= 0.0f ? 1.0f : -1.0f;
+	if (Approach * Sign < 0.0f)
+	{
+		const float Distance = (Sign * Radius - Side) / Approach;
+		const FVector Contact = Origin + Direction * Distance - Normal * (Sign * Radius);
+		const FVector Weights = FMath::ComputeBaryCentric2D(Contact, A, B, C);
+		if (Distance >= 0.0f && Weights.X >= 0.0f && Weights.Y >= 0.0f && Weights.Z >= 0.0f)
+		{
+			OutDistance = Distance;
+			OutContact = Contact;
+			return true;
+		}
+	}
+
+	// Otherwise the first contact is on an edge or a corner
+	bool bHit = false;
+	OutDistance = MAX_flt;
+	const FVector Corners[3] = { A, B, C };
+	for (int32 Corner = 0; Corner < 3; Corner++)
+	{
+		const FVector& P = Corners[Corner];
+		const FVector ToOrigin = Origin - P;
+
+		const float CornerB = ToOrigin | Direction;
+		const float CornerDisc = CornerB * CornerB - (ToOrigin.SizeSquared() - Radius * Radius);
+		if (CornerDisc >= 0.0f)
+		{
+			const float Distance = -CornerB - FMath::Sqrt(CornerDisc);
+			if (Distance >= 0.0f && Distance < OutDistance)
+			{
+				OutDistance = Distance;
+				OutContact = P;
+				bHit = true;
+			}
+		}
+
+		// Infinite cylinder around the edge, clipped to the segment afterwards
+		const FVector Edge = Corners[(Corner + 1) % 3] - P;
+		const float EdgeLengthSq = Edge.SizeSquared();
+		if (EdgeLengthSq <= SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		const FVector D = Direction - Edge * ((Direction | Edge) / EdgeLengthSq);
+		const FVector M = ToOrigin - Edge * ((ToOrigin | Edge) / EdgeLengthSq);
+		const float EdgeA = D | D;
+		if (EdgeA <= SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		const float EdgeB = M | D;
+		const float EdgeDisc = EdgeB * EdgeB - EdgeA * ((M | M) - Radius * Radius);
+		if (EdgeDisc >= 0.0f)
+		{
+			const float Distance = (-EdgeB - FMath::Sqrt(EdgeDisc)) / EdgeA;
+			const float Along = ((ToOrigin + Direction * Distance) | Edge) / EdgeLengthSq;
+			if (Distance >= 0.0f && Distance < OutDistance && Along >= 0.0f && Along <= 1.0f)
+			{
+				OutDistance = Distance;
+				OutContact = P + Edge * Along;
+				bHit = true;
+			}
+		}
+	}
+
+	return bHit;
+}
+
+void FRuntimeMeshBVH::AddTriangles(const TArray<FVector>& Positions, const TArray<int32>& Indices)
+{
+	const int32 NumTriangles = Indices.Num() / 3;
+	const int32 FirstIndex = NumInputTriangles;
+	NumInputTriangles += NumTriangles;
+	Triangles.Reserve(Triangles.Num() + NumTriangles);
+	TriangleIndices.Reserve(TriangleIndices.Num() + NumTriangles);
+	for (int32 TriIdx = 0; TriIdx < NumTriangles; TriIdx++)
+	{
+		const int32 I0 = Indices[TriIdx * 3 + 0];
+		const int32 I1 = Indices[TriIdx * 3 + 1];
+		const int32 I2 = Indices[TriIdx * 3 + 2];
+		if (!Positions.IsValidIndex(I0) || !Positions.IsValidIndex(I1) || !Positions.IsValidIndex(I2))
+		{
+			continue;
+		}
+
+		FTriangle& Triangle = Triangles[Triangles.AddUninitialized()];
+		Triangle.V0 = Positions[I0];
+		Triangle.E1 = Positions[I1] - Positions[I0];
+		Triangle.E2 = Positions[I2] - Positions[I0];
+		TriangleIndices.Add(FirstIndex + TriIdx);
+	}
+}
+
+void FRuntimeMeshBVH::Reset()
+{
+	Nodes.Reset();
+	Triangles.Reset();
+	TriangleIndices.Reset();
+	NumInputTriangles = 0;
+}
+
+FBox FRuntimeMeshBVH::GetBounds() const
+{
+	return Nodes.Num() > 0 ? FBox(Nodes[0].Min, Nodes[0].Max) : FBox(ForceInit);
+}
+
+void FRuntimeMeshBVH::Build()
+{
+	Nodes.Reset();
+	const int32 NumTriangles = Triangles.Num();
+	if (NumTriangles == 0)
+	{
+		return;
+	}
+
+	TArray<FBox> TriangleBounds;
+	TArray<FVector> Centroids;
+	TriangleBounds.SetNumUninitialized(NumTriangles);
+	Centroids.SetNumUninitialized(NumTriangles);
+	for (int32 TriIdx = 0; TriIdx < NumTriangles; TriIdx++)
+	{
+		const FTriangle& Triangle = Triangles[TriIdx];
+		FBox& Bounds = TriangleBounds[TriIdx];
+		Bounds = FBox(Triangle.V0, Triangle.V0);
+		Bounds += Triangle.V0 + Triangle.E1;
+		Bounds += Triangle.V0 + Triangle.E2;
+		Centroids[TriIdx] = Bounds.GetCenter();
+	}
+
+	// A binary tree over N leaves never has more than 2N - 1 nodes, reserving keeps indices into it stable
+	Nodes.Reserve(NumTriangles * 2);
+	Nodes.AddUninitialized(1);
+	Subdivide(0, 0, NumTriangles, TriangleBounds, Centroids);
+	Nodes.Shrink();
+}
+
+void FRuntimeMeshBVH::Refit(TFunctionRef<void(int32 TriangleIndex, FVector& OutV0, FVector& OutV1, FVector& OutV2)> GetTriangle)
+{
+	for (int32 TriIdx = 0; TriIdx < Triangles.Num(); TriIdx++)
+	{
+		FVector V0, V1, V2;
+		GetTriangle(TriangleIndices[TriIdx], V0, V1, V2);
+
+		FTriangle& Triangle = Triangles[TriIdx];
+		Triangle.V0 = V0;
+		Triangle.E1 = V1 - V0;
+		Triangle.E2 = V2 - V0;
+	}
+
+	// Children are always added after their parent, walking backwards finishes both children before the parent
+	for (int32 NodeIdx = Nodes.Num() - 1; NodeIdx >= 0; NodeIdx--)
+	{
+		FNode& Node = Nodes[NodeIdx];
+		FBox Bounds(ForceInit);
+		if (Node.Count == 0)
+		{
+			Bounds += FBox(Nodes[Node.Start].Min, Nodes[Node.Start].Max);
+			Bounds += FBox(Nodes[Node.Start + 1].Min, Nodes[Node.Start + 1].Max);
+		}
+		else
+		{
+			for (int32 TriIdx = Node.Start; TriIdx < Node.Start + Node.Count; TriIdx++)
+			{
+				const FTriangle& Triangle = Triangles[TriIdx];
+				Bounds += Triangle.V0;
+				Bounds += Triangle.V0 + Triangle.E1;
+				Bounds += Triangle.V0 + Triangle.E2;
+			}
+		}
+		Node.Min = Bounds.Min;
+		Node.Max = Bounds.Max;
+	}
+}
+
+void FRuntimeMeshBVH::Subdivide(int32 NodeIndex, int32 Start, int32 Count, TArray<FBox>& TriangleBounds, TArray<FVector>& Centroids)
+{
+	FBox Bounds(ForceInit);
+	FBox CentroidBounds(ForceInit);
+	for (int32 TriIdx = Start; TriIdx < Start + Count; TriIdx++)
+	{
+		Bounds += TriangleBounds[TriIdx];
+		CentroidBounds += Centroids[TriIdx];
+	}
+
+	Nodes[NodeIndex].Min = Bounds.Min;
+	Nodes[NodeIndex].Max = Bounds.Max;
+	Nodes[NodeIndex].Start = Start;
+	Nodes[NodeIndex].Count = Count;
+	if (Count <= MaxLeafTriangles)
+	{
+		return;
+	}
+
+	// Pick the cheapest bin boundary over all three axes
+	int32 BestAxis = INDEX_NONE;
+	int32 BestSplit = INDEX_NONE;
+	float BestCost = Count * GetHalfSurfaceArea(Bounds);
+	const FVector CentroidExtent = CentroidBounds.Max - CentroidBounds.Min;
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		if (CentroidExtent[Axis] <= KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		FBox BinBounds[SAH_BIN_COUNT];
+		int32 BinCounts[SAH_BIN_COUNT] = { 0 };
+		for (int32 Bin = 0; Bin < SAH_BIN_COUNT; Bin++)
+		{
+			BinBounds[Bin] = FBox(ForceInit);
+		}
+
+		const float BinScale = SAH_BIN_COUNT / CentroidExtent[Axis];
+		for (int32 TriIdx = Start; TriIdx < Start + Count; TriIdx++)
+		{
+			int32 Bin = FMath::Min((int32)((Centroids[TriIdx][Axis] - CentroidBounds.Min[Axis]) * BinScale), SAH_BIN_COUNT - 1);
+			BinBounds[Bin] += TriangleBounds[TriIdx];
+			BinCounts[Bin]++;
+		}
+
+		// Sweep from the right to get the cost of every right side, then from the left to combine
+		float RightCosts[SAH_BIN_COUNT];
+		FBox RightBounds(ForceInit);
+		int32 RightCount = 0;
+		for (int32 Bin = SAH_BIN_COUNT - 1; Bin > 0; Bin--)
+		{
+			RightBounds += BinBounds[Bin];
+			RightCount += BinCounts[Bin];
+			RightCosts[Bin] = RightCount > 0 ? RightCount * GetHalfSurfaceArea(RightBounds) : 0.0f;
+		}
+
+		FBox LeftBounds(ForceInit);
+		int32 LeftCount = 0;
+		for (int32 Bin = 0; Bin < SAH_BIN_COUNT - 1; Bin++)
+		{
+			LeftBounds += BinBounds[Bin];
+			LeftCount += BinCounts[Bin];
+			if (LeftCount == 0 || LeftCount == Count)
+			{
+				continue;
+			}
+
+			float Cost = LeftCount * GetHalfSurfaceArea(LeftBounds) + RightCosts[Bin + 1];
+			if (Cost < BestCost)
+			{
+				BestCost = Cost;
+				BestAxis = Axis;
+				BestSplit = Bin + 1;
+			}
+		}
+	}
+
+	int32 Middle = Start;
+	if (BestAxis != INDEX_NONE)
+	{
+		const float BinScale = SAH_BIN_COUNT / CentroidExtent[BestAxis];
+		int32 Right = Start + Count - 1;
+		while (Middle <= Right)
+		{
+			int32 Bin = FMath::Min((int32)((Centroids[Middle][BestAxis] - CentroidBounds.Min[BestAxis]) * BinScale), SAH_BIN_COUNT - 1);
+			if (Bin < BestSplit)
+			{
+				Middle++;
+			}
+			else
+			{
+				Swap(Triangles[Middle], Triangles[Right]);
+				Swap(TriangleIndices[Middle], TriangleIndices[Right]);
+				Swap(TriangleBounds[Middle], TriangleBounds[Right]);
+				Swap(Centroids[Middle], Centroids[Right]);
+				Right--;
+			}
+		}
+	}
+	else if (Count > SAH_MAX_LEAF_TRIANGLES)
+	{
+		// Splitting doesn't pay off, but the leaf would be too large to test. Halve it so the depth stays bounded
+		Middle = Start + Count / 2;
+	}
+
+	if (Middle == Start || Middle == Start + Count)
+	{
+		return;
+	}
+
+	const int32 ChildIndex = Nodes.AddUninitialized(2);
+	Nodes[NodeIndex].Start = ChildIndex;
+	Nodes[NodeIndex].Count = 0;
+	Subdivide(ChildIndex, Start, Middle - Start, TriangleBounds, Centroids);
+	Subdivide(ChildIndex + 1, Middle, Start + Count - Middle, TriangleBounds, Centroids);
+}
+
+bool FRuntimeMeshBVH::IsOccluded(const FVector& Origin, const FVector& Direction, float MinDistance, float MaxDistance) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return false;
+	}
+
+	const FVector InvDirection(1.0f / (Direction.X != 0.0f ? Direction.X : TRIANGLE_EPSILON),
+		1.0f / (Direction.Y != 0.0f ? Direction.Y : TRIANGLE_EPSILON),
+		1.0f / (Direction.Z != 0.0f ? Direction.Z : TRIANGLE_EPSILON));
+
+	TArray<int32, TInlineAllocator<TraversalStackSize>> Stack;
+	Stack.Push(0);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+		const FVector T1 = (Node.Min - Origin) * InvDirection;
+		const FVector T2 = (Node.Max - Origin) * InvDirection;
+		const float TNear = FMath::Max3(FMath::Min(T1.X, T2.X), FMath::Min(T1.Y, T2.Y), FMath::Min(T1.Z, T2.Z));
+		const float TFar = FMath::Min3(FMath::Max(T1.X, T2.X), FMath::Max(T1.Y, T2.Y), FMath::Max(T1.Z, T2.Z));
+		if (TNear > TFar || TFar < MinDistance || TNear > MaxDistance)
+		{
+			continue;
+		}
+
+		if (Node.Count == 0)
+		{
+			Stack.Push(Node.Start + 1);
+			Stack.Push(Node.Start);
+			continue;
+		}
+
+		for (int32 TriIdx = Node.Start; TriIdx < Node.Start + Node.Count; TriIdx++)
+		{
+			// Moller-Trumbore, both sides count as blocking
+			const FTriangle& Triangle = Triangles[TriIdx];
+			const FVector P = Direction ^ Triangle.E2;
+			const float Det = Triangle.E1 | P;
+			if (FMath::Abs(Det) < TRIANGLE_EPSILON)
+			{
+				continue;
+			}
+
+			const float InvDet = 1.0f / Det;
+			const FVector T = Origin - Triangle.V0;
+			const float U = (T | P) * InvDet;
+			if (U < 0.0f || U > 1.0f)
+			{
+				continue;
+			}
+
+			const FVector Q = T ^ Triangle.E1;
+			const float V = (Direction | Q) * InvDet;
+			if (V < 0.0f || U + V > 1.0f)
+			{
+				continue;
+			}
+
+			const float Distance = (Triangle.E2 | Q) * InvDet;
+			if (Distance >= MinDistance && Distance <= MaxDistance)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+uint32 FRuntimeMeshBVH::IsOccluded4(const FVector& Origin, const FVector Directions[4], uint32 ActiveMask, float MinDistance, float MaxDistance) const
+{
+	if (Nodes.Num() == 0 || ActiveMask == 0)
+	{
+		return 0;
+	}
+
+	// Rays in structure of arrays layout, one lane per ray
+	const VectorRegister Epsilon = VectorSetFloat1(TRIANGLE_EPSILON);
+	VectorRegister Dir[3];
+	VectorRegister InvDir[3];
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		Dir[Axis] = MakeVectorRegister(Directions[0][Axis], Directions[1][Axis], Directions[2][Axis], Directions[3][Axis]);
+		// Keep zero components from turning the slab test into 0 * inf
+		VectorRegister Safe = VectorSelect(VectorCompareGT(Epsilon, VectorAbs(Dir[Axis])), Epsilon, Dir[Axis]);
+		InvDir[Axis] = VectorReciprocalAccurate(Safe);
+	}
+
+	const VectorRegister Zero = VectorZero();
+	const VectorRegister One = VectorOne();
+	const VectorRegister MinT = VectorSetFloat1(MinDistance);
+	const VectorRegister MaxT = VectorSetFloat1(MaxDistance);
+
+	uint32 OccludedMask = 0;
+	TArray<int32, TInlineAllocator<TraversalStackSize>> Stack;
+	Stack.Push(0);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+		const uint32 Pending = ActiveMask & ~OccludedMask;
+
+		// The origin is shared, so the distances to the slabs are scalars scaled per ray
+		VectorRegister TNear = MinT;
+		VectorRegister TFar = MaxT;
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			VectorRegister T1 = VectorMultiply(VectorSetFloat1(Node.Min[Axis] - Origin[Axis]), InvDir[Axis]);
+			VectorRegister T2 = VectorMultiply(VectorSetFloat1(Node.Max[Axis] - Origin[Axis]), InvDir[Axis]);
+			TNear = VectorMax(TNear, VectorMin(T1, T2));
+			TFar = VectorMin(TFar, VectorMax(T1, T2));
+		}
+		if ((VectorMaskBits(VectorCompareGE(TFar, TNear)) & Pending) == 0)
+		{
+			continue;
+		}
+
+		if (Node.Count == 0)
+		{
+			Stack.Push(Node.Start + 1);
+			Stack.Push(Node.Start);
+			continue;
+		}
+
+		for (int32 TriIdx = Node.Start; TriIdx < Node.Start + Node.Count; TriIdx++)
+		{
+			const FTriangle& Triangle = Triangles[TriIdx];
+			const VectorRegister E1X = VectorSetFloat1(Triangle.E1.X);
+			const VectorRegister E1Y = VectorSetFloat1(Triangle.E1.Y);
+			const VectorRegister E1Z = VectorSetFloat1(Triangle.E1.Z);
+			const VectorRegister E2X = VectorSetFloat1(Triangle.E2.X);
+			const VectorRegister E2Y = VectorSetFloat1(Triangle.E2.Y);
+			const VectorRegister E2Z = VectorSetFloat1(Triangle.E2.Z);
+
+			// P = D x E2
+			const VectorRegister PX = VectorSubtract(VectorMultiply(Dir[1], E2Z), VectorMultiply(Dir[2], E2Y));
+			const VectorRegister PY = VectorSubtract(VectorMultiply(Dir[2], E2X), VectorMultiply(Dir[0], E2Z));
+			const VectorRegister PZ = VectorSubtract(VectorMultiply(Dir[0], E2Y), VectorMultiply(Dir[1], E2X));
+			const VectorRegister Det = VectorMultiplyAdd(E1X, PX, VectorMultiplyAdd(E1Y, PY, VectorMultiply(E1Z, PZ)));
+			const VectorRegister InvDet = VectorReciprocalAccurate(Det);
+
+			// T and Q = T x E1 don't depend on the direction, they stay scalar
+			const FVector T = Origin - Triangle.V0;
+			const FVector Q = T ^ Triangle.E1;
+
+			const VectorRegister U = VectorMultiply(VectorMultiplyAdd(VectorSetFloat1(T.X), PX, VectorMultiplyAdd(VectorSetFloat1(T.Y), PY, VectorMultiply(VectorSetFloat1(T.Z), PZ))), InvDet);
+			const VectorRegister V = VectorMultiply(VectorMultiplyAdd(Dir[0], VectorSetFloat1(Q.X), VectorMultiplyAdd(Dir[1], VectorSetFloat1(Q.Y), VectorMultiply(Dir[2], VectorSetFloat1(Q.Z)))), InvDet);
+			const VectorRegister Distance = VectorMultiply(VectorSetFloat1(Triangle.E2 | Q), InvDet);
+
+			VectorRegister Hit = VectorCompareGT(VectorAbs(Det), Epsilon);
+			Hit = VectorBitwiseAnd(Hit, VectorCompareGE(U, Zero));
+			Hit = VectorBitwiseAnd(Hit, VectorCompareGE(V, Zero));
+			Hit = VectorBitwiseAnd(Hit, VectorCompareGE(One, VectorAdd(U, V)));
+			Hit = VectorBitwiseAnd(Hit, VectorCompareGE(Distance, MinT));
+			Hit = VectorBitwiseAnd(Hit, VectorCompareGE(MaxT, Distance));
+
+			OccludedMask |= VectorMaskBits(Hit) & ActiveMask;
+			if (OccludedMask == ActiveMask)
+			{
+				return OccludedMask;
+			}
+		}
+	}
+
+	return OccludedMask;
+}
+
+template<typename TriangleTestType>
+bool FRuntimeMeshBVH::TraceClosest(const FVector& Origin, const FVector& Direction, float Padding, float MaxDistance, FHit& OutHit, TriangleTestType TriangleTest) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return false;
+	}
+
+	const FVector InvDirection(1.0f / (Direction.X != 0.0f ? Direction.X : TRIANGLE_EPSILON),
+		1.0f / (Direction.Y != 0.0f ? Direction.Y : TRIANGLE_EPSILON),
+		1.0f / (Direction.Z != 0.0f ? Direction.Z : TRIANGLE_EPSILON));
+	const FVector Grow(Padding);
+
+	struct FStackEntry
+	{
+		int32 Node;
+		float Near;
+	};
+
+	float BestDistance = MaxDistance;
+	bool bHit = false;
+	TArray<FStackEntry, TInlineAllocator<TraversalStackSize>> Stack;
+	float RootNear;
+	if (!IntersectRayBox(Nodes[0].Min - Grow, Nodes[0].Max + Grow, Origin, InvDirection, BestDistance, RootNear))
+	{
+		return false;
+	}
+	Stack.Push({ 0, RootNear });
+
+	while (Stack.Num() > 0)
+	{
+		const FStackEntry Entry = Stack.Pop(false);
+		if (Entry.Near > BestDistance)
+		{
+			// A closer hit turned up since this node was pushed
+			continue;
+		}
+
+		const FNode& Node = Nodes[Entry.Node];
+		if (Node.Count == 0)
+		{
+			float Near[2];
+			bool bChildHit[2];
+			for (int32 Child = 0; Child < 2; Child++)
+			{
+				const FNode& ChildNode = Nodes[Node.Start + Child];
+				bChildHit[Child] = IntersectRayBox(ChildNode.Min - Grow, ChildNode.Max + Grow, Origin, InvDirection, BestDistance, Near[Child]);
+			}
+
+			// The nearer child goes on top, so it is searched first and tightens the distance for the other one
+			const int32 First = Near[1] < Near[0] ? 1 : 0;
+			const int32 Order[2] = { 1 - First, First };
+			for (int32 Child : Order)
+			{
+				if (bChildHit[Child])
+				{
+					Stack.Push({ Node.Start + Child, Near[Child] });
+				}
+			}
+			continue;
+		}
+
+		for (int32 TriIdx = Node.Start; TriIdx < Node.Start + Node.Count; TriIdx++)
+		{
+			float Distance, U, V;
+			if (TriangleTest(Triangles[TriIdx], Distance, U, V) && Distance <= BestDistance)
+			{
+				BestDistance = Distance;
+				OutHit.TriangleIndex = TriangleIndices[TriIdx];
+				OutHit.Distance = Distance;
+				OutHit.U = U;
+				OutHit.V = V;
+				bHit = true;
+			}
+		}
+	}
+
+	return bHit;
+}
+
+bool FRuntimeMeshBVH::Raycast(const FVector& Origin, const FVector& Direction, float MaxDistance, FHit& OutHit) const
+{
+	return TraceClosest(Origin, Direction, 0.0f, MaxDistance, OutHit, [&](const FTriangle& Triangle, float& OutDistance, float& OutU, float& OutV)
+	{
+		const FVector P = Direction ^ Triangle.E2;
+		const float Det = Triangle.E1 | P;
+		if (FMath::Abs(Det) < TRIANGLE_EPSILON)
+		{
+			return false;
+		}
+
+		const float InvDet = 1.0f / Det;
+		const FVector T = Origin - Triangle.V0;
+		OutU = (T | P) * InvDet;
+		if (OutU < 0.0f || OutU > 1.0f)
+		{
+			return false;
+		}
+
+		const FVector Q = T ^ Triangle.E1;
+		OutV = (Direction | Q) * InvDet;
+		if (OutV < 0.0f || OutU + OutV > 1.0f)
+		{
+			return false;
+		}
+
+		OutDistance = (Triangle.E2 | Q) * InvDet;
+		return OutDistance >= 0.0f;
+	});
+}
+
+bool FRuntimeMeshBVH::SweepSphere(const FVector& Origin, const FVector& Direction, float Radius, float MaxDistance, FHit& OutHit) const
+{
+	return TraceClosest(Origin, Direction, Radius, MaxDistance, OutHit, [&](const FTriangle& Triangle, float& OutDistance, float& OutU, float& OutV)
+	{
+		const FVector A = Triangle.V0;
+		const FVector B = Triangle.V0 + Triangle.E1;
+		const FVector C = Triangle.V0 + Triangle.E2;
+		FVector Contact;
+		if (!SweepSphereTriangle(Origin, Direction, Radius, A, B, C, OutDistance, Contact))
+		{
+			return false;
+		}
+
+		const FVector Weights = FMath::ComputeBaryCentric2D(Contact, A, B, C);
+		OutU = Weights.Y;
+		OutV = Weights.Z;
+		return true;
+	});
+}
+
+void FRuntimeMeshBVH::OverlapBox(const FBox& Box, TArray<int32>& OutTriangles) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	const FVector Center = Box.GetCenter();
+	const FVector Extent = Box.GetExtent();
+	TArray<int32, TInlineAllocator<TraversalStackSize>> Stack;
+	Stack.Push(0);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+		if (Node.Min.X > Box.Max.X || Node.Min.Y > Box.Max.Y || Node.Min.Z > Box.Max.Z ||
+			Node.Max.X < Box.Min.X || Node.Max.Y < Box.Min.Y || Node.Max.Z < Box.Min.Z)
+		{
+			continue;
+		}
+
+		if (Node.Count == 0)
+		{
+			Stack.Push(Node.Start + 1);
+			Stack.Push(Node.Start);
+			continue;
+		}
+
+		for (int32 TriIdx = Node.Start; TriIdx < Node.Start + Node.Count; TriIdx++)
+		{
+			const FTriangle& Triangle = Triangles[TriIdx];
+			if (TriangleIntersectsBox(Triangle.V0, Triangle.V0 + Triangle.E1, Triangle.V0 + Triangle.E2, Center, Extent))
+			{
+				OutTriangles.Add(TriangleIndices[TriIdx]);
+			}
+		}
+	}
+}
+
+bool FRuntimeMeshBVH::TriangleIntersectsBox(const FVector& V0, const FVector& V1, const FVector& V2, const FVector& Center, const FVector& Extent)
+{
+	const FVector A = V0 - Center;
+	const FVector B = V1 - Center;
+	const FVector C = V2 - Center;
+
+	// Box faces
+	for (int32 Axis = 0; Axis < 3; Axis++)
+	{
+		if (FMath::Min3(A[Axis], B[Axis], C[Axis]) > Extent[Axis] || FMath::Max3(A[Axis], B[Axis], C[Axis]) < -Extent[Axis])
+		{
+			return false;
+		}
+	}
+
+	// Triangle plane
+	const FVector Normal = (B - A) ^ (C - A);
+	const float PlaneRadius = Extent.X * FMath::Abs(Normal.X) + Extent.Y * FMath::Abs(Normal.Y) + Extent.Z * FMath::Abs(Normal.Z);
+	if (FMath::Abs(Normal | A) > PlaneRadius)
+	{
+		return false;
+	}
+
+	// Cross products of the triangle edges with the box axes
+	const FVector Edges[3] = { B - A, C - B, A - C };
+	for (const FVector& Edge : Edges)
+	{
+		for (int32 Axis = 0; Axis < 3; Axis++)
+		{
+			FVector BoxAxis(0.0f, 0.0f, 0.0f);
+			BoxAxis[Axis] = 1.0f;
+			const FVector SeparatingAxis = BoxAxis ^ Edge;
+			const float PA = A | SeparatingAxis;
+			const float PB = B | SeparatingAxis;
+			const float PC = C | SeparatingAxis;
+			const float Radius = Extent.X * FMath::Abs(SeparatingAxis.X) + Extent.Y * FMath::Abs(SeparatingAxis.Y) + Extent.Z * FMath::Abs(SeparatingAxis.Z);
+			if (FMath::Min3(PA, PB, PC) > Radius || FMath::Max3(PA, PB, PC) < -Radius)
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
@@ -0,0 +1,937 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "RuntimeMeshComponent.h"
+#include "RuntimeMeshLibrary.h"
+#include "RuntimeMeshQuery.h"
+#include "RuntimeMeshOcclusion.h"
+#include "EssImporter.h"
+#include "EssNativeReader.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+/*
+*	Repeatable benchmark of the RMC hot paths.
+*
+*	Usage: RMC.Benchmark [Iterations] [OutputFile] [EssScene]
+*
+*	Runs headless, for example:
+*		UE4Editor-Cmd.exe Project.uproject -game -nullrhi -unattended -ExecCmds="RMC.Benchmark 20, quit"
+*
+*	Components are never registered so no render thread work is measured, only the game thread cost of each call.
+*	Results are written as JSON with per case percentiles so CI can diff two runs.
+*	EssScene is an exported scene with real materials, the synthetic scenes have none, and adds material resolution throughput.
+*	Ess files are also read by FEssNativeScene alone, its throughput is logged in MB/s.
+*/
+namespace RuntimeMeshBenchmark
+{
+	static const int32 GridSides[] = { 32, 128, 512 };
+
+	struct FBenchmarkResult
+	{
+		FString Name;
+		int32 Size;
+		TArray<double> Samples;
+	};
+
+	/* Nearest rank percentile of sorted samples */
+	static double Percentile(const TArray<double>& SortedSamples, double Percent)
+	{
+		if (SortedSamples.Num() == 0)
+		{
+			return 0.0;
+		}
+		int32 Rank = FMath::Clamp(FMath::CeilToInt(Percent / 100.0 * SortedSamples.Num()) - 1, 0, SortedSamples.Num() - 1);
+		return SortedSamples[Rank];
+	}
+
+	/* Runs the body Iterations times. The body returns the seconds spent in the measured region so setup isn't counted. */
+	static void Measure(TArray<FBenchmarkResult>& Results, const FString& Name, int32 Size, int32 Iterations, TFunctionRef<double()> Body)
+	{
+		FBenchmarkResult& Result = Results[Results.AddDefaulted()];
+		Result.Name = Name;
+		Result.Size = Size;
+		Result.Samples.Reserve(Iterations);
+
+		// One warm up run to get allocations and caches settled
+		Body();
+
+		for (int32 Iteration = 0; Iteration < Iterations; Iteration++)
+		{
+			Result.Samples.Add(Body());
+		}
+
+		UE_LOG(RuntimeMeshLog, Log, TEXT("RMC.Benchmark: %s (%d) done"), *Name, Size);
+	}
+
+	template<typename VertexType>
+	static typename TEnableIf<FRuntimeMeshVertexTraits<VertexType>::HasPosition>::Type SetPosition(VertexType& Vertex, const FVector& Position)
+	{
+		Vertex.Position = Position;
+	}
+
+	template<typename VertexType>
+	static typename TEnableIf<!FRuntimeMeshVertexTraits<VertexType>::HasPosition>::Type SetPosition(VertexType& Vertex, const FVector& Position)
+	{
+	}
+
+	/* Builds a wavy grid so tangent and tessellation work isn't degenerate */
+	template<typename VertexType>
+	static void BuildGrid(int32 Side, TArray<FVector>& Positions, TArray<VertexType>& Vertices, TArray<int32>& Triangles)
+	{
+		Positions.SetNumUninitialized(Side * Side);
+		Vertices.SetNum(Side * Side);
+		for (int32 Y = 0; Y < Side; Y++)
+		{
+			for (int32 X = 0; X < Side; X++)
+			{
+				const int32 Index = Y * Side + X;
+				Positions[Index] = FVector(X * 10.0f, Y * 10.0f, FMath::Sin(X * 0.1f) * FMath::Cos(Y * 0.1f) * 50.0f);
+				SetPosition(Vertices[Index], Positions[Index]);
+				Vertices[Index].UV0 = FVector2D(X / (float)Side, Y / (float)Side);
+			}
+		}
+
+		Triangles.Reset();
+		URuntimeMeshLibrary::CreateGridMeshTriangles(Side, Side, true, Triangles);
+	}
+
+	static URuntimeMeshComponent* NewTransientComponent()
+	{
+		return NewObject<URuntimeMeshComponent>(GetTransientPackage(), NAME_None, RF_Transient);
+	}
+
+	/* Create/update of a single buffer section */
+	template<typename VertexType>
+	static void BenchmarkVertexType(TArray<FBenchmarkResult>& Results, const TCHAR* TypeName, int32 Iterations)
+	{
+		for (int32 Side : GridSides)
+		{
+			TArray<FVector> Positions;
+			TArray<VertexType> SourceVertices;
+			TArray<int32> SourceTriangles;
+			BuildGrid(Side, Positions, SourceVertices, SourceTriangles);
+
+			URuntimeMeshComponent* RuntimeMesh = NewTransientComponent();
+
+			Measure(Results, FString::Printf(TEXT("CreateMeshSection<%s>"), TypeName), SourceVertices.Num(), Iterations, [&]()
+			{
+				TArray<VertexType> Vertices = SourceVertices;
+				TArray<int32> Triangles = SourceTriangles;
+				double Start = FPlatformTime::Seconds();
+				RuntimeMesh->CreateMeshSection(0, Vertices, Triangles, false, EUpdateFrequency::Average, ESectionUpdateFlags::MoveArrays);
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			Measure(Results, FString::Printf(TEXT("UpdateMeshSection<%s>"), TypeName), SourceVertices.Num(), Iterations, [&]()
+			{
+				TArray<VertexType> Vertices = SourceVertices;
+				double Start = FPlatformTime::Seconds();
+				RuntimeMesh->UpdateMeshSection(0, Vertices, ESectionUpdateFlags::MoveArrays);
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			Measure(Results, FString::Printf(TEXT("UpdateMeshSection<%s> (CalculateNormalTangent)"), TypeName), SourceVertices.Num(), Iterations, [&]()
+			{
+				TArray<VertexType> Vertices = SourceVertices;
+				double Start = FPlatformTime::Seconds();
+				RuntimeMesh->UpdateMeshSection(0, Vertices, ESectionUpdateFlags::MoveArrays | ESectionUpdateFlags::CalculateNormalTangent);
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			RuntimeMesh->DestroyComponent();
+		}
+	}
+
+	/* Create/update of a dual buffer section */
+	template<typename VertexType>
+	static void BenchmarkDualBufferVertexType(TArray<FBenchmarkResult>& Results, const TCHAR* TypeName, int32 Iterations)
+	{
+		for (int32 Side : GridSides)
+		{
+			TArray<FVector> SourcePositions;
+			TArray<VertexType> SourceVertices;
+			TArray<int32> SourceTriangles;
+			BuildGrid(Side, SourcePositions, SourceVertices, SourceTriangles);
+
+			URuntimeMeshComponent* RuntimeMesh = NewTransientComponent();
+
+			Measure(Results, FString::Printf(TEXT("CreateMeshSectionDualBuffer<%s>"), TypeName), SourceVertices.Num(), Iterations, [&]()
+			{
+				TArray<FVector> Positions = SourcePositions;
+				TArray<VertexType> Vertices = SourceVertices;
+				TArray<int32> Triangles = SourceTriangles;
+				double Start = FPlatformTime::Seconds();
+				RuntimeMesh->CreateMeshSectionDualBuffer(0, Positions, Vertices, Triangles, false, EUpdateFrequency::Frequent, ESectionUpdateFlags::MoveArrays);
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			Measure(Results, FString::Printf(TEXT("UpdateMeshSectionPositionsImmediate<%s>"), TypeName), SourceVertices.Num(), Iterations, [&]()
+			{
+				TArray<FVector> Positions = SourcePositions;
+				double Start = FPlatformTime::Seconds();
+				RuntimeMesh->UpdateMeshSectionPositionsImmediate(0, Positions, ESectionUpdateFlags::MoveArrays);
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			RuntimeMesh->DestroyComponent();
+		}
+	}
+
+	static void BenchmarkLibrary(TArray<FBenchmarkResult>& Results, int32 Iterations)
+	{
+		for (int32 Side : GridSides)
+		{
+			TArray<FVector> Positions;
+			TArray<FRuntimeMeshVertexSimple> SourceVertices;
+			TArray<int32> Triangles;
+			BuildGrid(Side, Positions, SourceVertices, Triangles);
+
+			Measure(Results, TEXT("CalculateTangentsForMesh"), SourceVertices.Num(), Iterations, [&]()
+			{
+				TArray<FRuntimeMeshVertexSimple> Vertices = SourceVertices;
+				double Start = FPlatformTime::Seconds();
+				URuntimeMeshLibrary::CalculateTangentsForMesh(Vertices, Triangles);
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			Measure(Results, TEXT("CalculateTessellationIndices"), SourceVertices.Num(), Iterations, [&]()
+			{
+				TArray<int32> TessellationTriangles;
+				double Start = FPlatformTime::Seconds();
+				URuntimeMeshLibrary::GenerateTessellationIndexBuffer(SourceVertices, Triangles, TessellationTriangles);
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			// The cursor accessors against the range accessors the library algorithms use
+			TArray<FVector> ReadPositions;
+			TArray<FVector4> ReadNormals;
+			TArray<FVector2D> ReadUVs;
+			ReadPositions.SetNumUninitialized(SourceVertices.Num());
+			ReadNormals.SetNumUninitialized(SourceVertices.Num());
+			ReadUVs.SetNumUninitialized(SourceVertices.Num());
+
+			Measure(Results, TEXT("VerticesBuilder Read/Write (Per Vertex)"), SourceVertices.Num(), Iterations, [&]()
+			{
+				FRuntimeMeshPackedVerticesBuilder<FRuntimeMeshVertexSimple> Builder(&SourceVertices);
+				const IRuntimeMeshVerticesBuilder& Vertices = Builder;
+				double Start = FPlatformTime::Seconds();
+				Vertices.Seek(-1);
+				for (int32 VertexIdx = 0; Vertices.MoveNext() < Vertices.Length(); VertexIdx++)
+				{
+					ReadPositions[VertexIdx] = Vertices.GetPosition();
+					ReadNormals[VertexIdx] = Vertices.GetNormal();
+					ReadUVs[VertexIdx] = Vertices.GetUV(0);
+				}
+				for (int32 VertexIdx = 0; VertexIdx < ReadNormals.Num(); VertexIdx++)
+				{
+					Builder.SetNormal(VertexIdx, ReadNormals[VertexIdx]);
+				}
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			Measure(Results, TEXT("VerticesBuilder Read/Write (Range)"), SourceVertices.Num(), Iterations, [&]()
+			{
+				FRuntimeMeshPackedVerticesBuilder<FRuntimeMeshVertexSimple> Builder(&SourceVertices);
+				const IRuntimeMeshVerticesBuilder& Vertices = Builder;
+				double Start = FPlatformTime::Seconds();
+				Vertices.GetPositionRange(0, Vertices.Length(), ReadPositions.GetData());
+				Vertices.GetNormalRange(0, Vertices.Length(), ReadNormals.GetData());
+				Vertices.GetUVRange(0, 0, Vertices.Length(), ReadUVs.GetData());
+				Builder.SetNormalRange(0, ReadNormals.Num(), ReadNormals.GetData());
+				return FPlatformTime::Seconds() - Start;
+			});
+		}
+	}
+
+	static void BenchmarkSerialization(TArray<FBenchmarkResult>& Results, int32 Iterations)
+	{
+		const int32 NumSections = 8;
+
+		for (int32 Side : GridSides)
+		{
+			TArray<FVector> Positions;
+			TArray<FRuntimeMeshVertexSimple> SourceVertices;
+			TArray<int32> SourceTriangles;
+			BuildGrid(Side, Positions, SourceVertices, SourceTriangles);
+
+			URuntimeMeshComponent* Source = NewTransientComponent();
+			for (int32 SectionIndex = 0; SectionIndex < NumSections; SectionIndex++)
+			{
+				TArray<FRuntimeMeshVertexSimple> Vertices = SourceVertices;
+				TArray<int32> Triangles = SourceTriangles;
+				Source->CreateMeshSection(SectionIndex, Vertices, Triangles, false, EUpdateFrequency::Infrequent, ESectionUpdateFlags::MoveArrays);
+			}
+
+			URuntimeMeshComponent* Target = NewTransientComponent();
+
+			Measure(Results, TEXT("SerializeRMC (Round Trip)"), SourceVertices.Num() * NumSections, Iterations, [&]()
+			{
+				TArray<uint8> Bytes;
+				double Start = FPlatformTime::Seconds();
+
+				FMemoryWriter Writer(Bytes, true);
+				Source->SerializeRMC(Writer);
+
+				FMemoryReader Reader(Bytes, true);
+				Target->SerializeRMC(Reader);
+
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			Source->DestroyComponent();
+			Target->DestroyComponent();
+		}
+	}
+
+	static void BenchmarkBatchUpdates(TArray<FBenchmarkResult>& Results, int32 Iterations)
+	{
+		const int32 NumSections = 32;
+		const int32 Side = 64;
+
+		TArray<FVector> Positions;
+		TArray<FRuntimeMeshVertexSimple> SourceVertices;
+		TArray<int32> SourceTriangles;
+		BuildGrid(Side, Positions, SourceVertices, SourceTriangles);
+
+		URuntimeMeshComponent* RuntimeMesh = NewTransientComponent();
+		for (int32 SectionIndex = 0; SectionIndex < NumSections; SectionIndex++)
+		{
+			TArray<FRuntimeMeshVertexSimple> Vertices = SourceVertices;
+			TArray<int32> Triangles = SourceTriangles;
+			RuntimeMesh->CreateMeshSection(SectionIndex, Vertices, Triangles, false, EUpdateFrequency::Frequent, ESectionUpdateFlags::MoveArrays);
+		}
+
+		Measure(Results, TEXT("BatchUpdate (Sections x Vertices)"), NumSections * SourceVertices.Num(), Iterations, [&]()
+		{
+			TArray<TArray<FRuntimeMeshVertexSimple>> SectionVertices;
+			SectionVertices.Init(SourceVertices, NumSections);
+
+			double Start = FPlatformTime::Seconds();
+			RuntimeMesh->BeginBatchUpdates();
+			for (int32 SectionIndex = 0; SectionIndex < NumSections; SectionIndex++)
+			{
+				RuntimeMesh->UpdateMeshSection(SectionIndex, SectionVertices[SectionIndex], ESectionUpdateFlags::MoveArrays);
+			}
+			RuntimeMesh->EndBatchUpdates();
+			return FPlatformTime::Seconds() - Start;
+		});
+
+		RuntimeMesh->DestroyComponent();
+	}
+
+	/* CPU BVH build, refit and query throughput. Query cases are sized by their ray or box count so size_per_second is queries per second */
+	static void BenchmarkQueries(TArray<FBenchmarkResult>& Results, int32 Iterations)
+	{
+		const int32 NumRays = 10000;
+		const int32 NumBoxes = 1000;
+
+		for (int32 Side : GridSides)
+		{
+			TArray<FVector> Positions;
+			TArray<FRuntimeMeshVertexSimple> SourceVertices;
+			TArray<int32> SourceTriangles;
+			BuildGrid(Side, Positions, SourceVertices, SourceTriangles);
+			const int32 NumTriangles = SourceTriangles.Num() / 3;
+
+			URuntimeMeshComponent* RuntimeMesh = NewTransientComponent();
+			{
+				TArray<FRuntimeMeshVertexSimple> Vertices = SourceVertices;
+				TArray<int32> Triangles = SourceTriangles;
+				RuntimeMesh->CreateMeshSection(0, Vertices, Triangles, false, EUpdateFrequency::Frequent, ESectionUpdateFlags::MoveArrays);
+			}
+
+			Measure(Results, TEXT("FRuntimeMeshComponentBVH Build"), NumTriangles, Iterations, [&]()
+			{
+				FRuntimeMeshComponentBVH BVH;
+				double Start = FPlatformTime::Seconds();
+				BVH.Gather(RuntimeMesh);
+				BVH.Build();
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			FRuntimeMeshComponentBVH BVH;
+			BVH.Gather(RuntimeMesh);
+			BVH.Build();
+
+			Measure(Results, TEXT("FRuntimeMeshComponentBVH Refit"), NumTriangles, Iterations, [&]()
+			{
+				double Start = FPlatformTime::Seconds();
+				BVH.GatherVertices(RuntimeMesh);
+				BVH.Refit();
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			// Straight down onto random points of the grid, every ray hits
+			const FBox Bounds = BVH.GetBounds();
+			const float TraceLength = Bounds.GetSize().Z + 200.0f;
+			FRandomStream Random(Side);
+			TArray<FVector> Origins;
+			Origins.SetNumUninitialized(NumRays);
+			for (FVector& Origin : Origins)
+			{
+				Origin = FVector(Random.FRandRange(Bounds.Min.X, Bounds.Max.X), Random.FRandRange(Bounds.Min.Y, Bounds.Max.Y), Bounds.Max.Z + 100.0f);
+			}
+
+			Measure(Results, FString::Printf(TEXT("FRuntimeMeshComponentBVH Raycast (%d Triangles)"), NumTriangles), NumRays, Iterations, [&]()
+			{
+				FRuntimeMeshQueryHit Hit;
+				double Start = FPlatformTime::Seconds();
+				for (const FVector& Origin : Origins)
+				{
+					BVH.Raycast(Origin, FVector(0.0f, 0.0f, -1.0f), TraceLength, Hit);
+				}
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			Measure(Results, FString::Printf(TEXT("FRuntimeMeshComponentBVH SweepSphere (%d Triangles)"), NumTriangles), NumRays, Iterations, [&]()
+			{
+				FRuntimeMeshQueryHit Hit;
+				double Start = FPlatformTime::Seconds();
+				for (const FVector& Origin : Origins)
+				{
+					BVH.SweepSphere(Origin, FVector(0.0f, 0.0f, -1.0f), 15.0f, TraceLength, Hit);
+				}
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			Measure(Results, FString::Printf(TEXT("FRuntimeMeshComponentBVH OverlapBox (%d Triangles)"), NumTriangles), NumBoxes, Iterations, [&]()
+			{
+				TArray<FRuntimeMeshQueryHit> Hits;
+				double Start = FPlatformTime::Seconds();
+				for (int32 BoxIdx = 0; BoxIdx < NumBoxes; BoxIdx++)
+				{
+					Hits.Reset();
+					BVH.OverlapBox(FTranslationMatrix(FVector(Origins[BoxIdx].X, Origins[BoxIdx].Y, Bounds.GetCenter().Z)), FVector(25.0f, 25.0f, Bounds.GetExtent().Z), Hits);
+				}
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			RuntimeMesh->DestroyComponent();
+		}
+
+		// Many small components under one scene tree, their BVHs build on the thread pool together
+		const int32 SceneSide = 8;
+		const int32 Side = 64;
+		TArray<FVector> Positions;
+		TArray<FRuntimeMeshVertexSimple> SourceVertices;
+		TArray<int32> SourceTriangles;
+		BuildGrid(Side, Positions, SourceVertices, SourceTriangles);
+
+		TArray<URuntimeMeshComponent*> Components;
+		for (int32 ComponentIdx = 0; ComponentIdx < SceneSide * SceneSide; ComponentIdx++)
+		{
+			URuntimeMeshComponent* RuntimeMesh = NewTransientComponent();
+			RuntimeMesh->SetWorldLocation(FVector((ComponentIdx % SceneSide) * Side * 10.0f, (ComponentIdx / SceneSide) * Side * 10.0f, 0.0f));
+			Components.Add(RuntimeMesh);
+		}
+
+		const int32 SceneTriangles = Components.Num() * SourceTriangles.Num() / 3;
+		FRuntimeMeshSceneBVH Scene;
+		Measure(Results, TEXT("FRuntimeMeshSceneBVH Build"), SceneTriangles, Iterations, [&]()
+		{
+			// New sections make every component BVH stale
+			for (URuntimeMeshComponent* RuntimeMesh : Components)
+			{
+				TArray<FRuntimeMeshVertexSimple> Vertices = SourceVertices;
+				TArray<int32> Triangles = SourceTriangles;
+				RuntimeMesh->CreateMeshSection(0, Vertices, Triangles, false, EUpdateFrequency::Frequent, ESectionUpdateFlags::MoveArrays);
+			}
+
+			double Start = FPlatformTime::Seconds();
+			Scene.Build(Components);
+			return FPlatformTime::Seconds() - Start;
+		});
+
+		const float SceneExtent = SceneSide * Side * 10.0f;
+		FRandomStream Random(SceneSide);
+		TArray<FVector> Starts;
+		TArray<FVector> Ends;
+		for (int32 RayIdx = 0; RayIdx < NumRays; RayIdx++)
+		{
+			// Shallow rays across the scene so they pass over several components before hitting
+			const FVector Start(Random.FRandRange(0.0f, SceneExtent), Random.FRandRange(0.0f, SceneExtent), 200.0f);
+			Starts.Add(Start);
+			Ends.Add(Start + FVector(Random.FRandRange(-1.0f, 1.0f), Random.FRandRange(-1.0f, 1.0f), -0.2f).GetSafeNormal() * SceneExtent);
+		}
+
+		Measure(Results, FString::Printf(TEXT("FRuntimeMeshSceneBVH LineTrace (%d Components)"), Components.Num()), NumRays, Iterations, [&]()
+		{
+			FRuntimeMeshQueryHit Hit;
+			double Start = FPlatformTime::Seconds();
+			for (int32 RayIdx = 0; RayIdx < NumRays; RayIdx++)
+			{
+				Scene.LineTrace(Starts[RayIdx], Ends[RayIdx], Hit);
+			}
+			return FPlatformTime::Seconds() - Start;
+		});
+
+		for (URuntimeMeshComponent* RuntimeMesh : Components)
+		{
+			RuntimeMesh->DestroyComponent();
+		}
+	}
+
+	/* Software occlusion of a city block layout seen from street level. Visibility cases are sized by their depth buffer width */
+	static void BenchmarkOcclusion(TArray<FBenchmarkResult>& Results, int32 Iterations)
+	{
+		const int32 BlockSide = 16;
+		const float BlockSpacing = 3000.0f;
+		const FVector BlockExtent(1000.0f, 1000.0f, 1500.0f);
+		const int32 NumProps = 20000;
+
+		// Blocks are occluders and items both, like the large components of an imported scene
+		TArray<FVector> BoxPositions;
+		TArray<int32> BoxTriangles;
+		TArray<FVector> BoxNormals;
+		TArray<FVector2D> BoxUVs;
+		TArray<FRuntimeMeshTangent> BoxTangents;
+		URuntimeMeshLibrary::CreateBoxMesh(BlockExtent, BoxPositions, BoxTriangles, BoxNormals, BoxUVs, BoxTangents);
+
+		TArray<FBox> SourceItemBounds;
+		TArray<FVector> BlockPositions;
+		BlockPositions.SetNumUninitialized(BoxPositions.Num());
+		for (int32 BlockIdx = 0; BlockIdx < BlockSide * BlockSide; BlockIdx++)
+		{
+			const FVector Center((BlockIdx % BlockSide) * BlockSpacing, (BlockIdx / BlockSide) * BlockSpacing, BlockExtent.Z);
+			SourceItemBounds.Add(FBox(Center - BlockExtent, Center + BlockExtent));
+		}
+
+		const float SceneExtent = (BlockSide - 1) * BlockSpacing;
+		FRandomStream Random(NumProps);
+		for (int32 PropIdx = 0; PropIdx < NumProps; PropIdx++)
+		{
+			const FVector Center(Random.FRandRange(0.0f, SceneExtent), Random.FRandRange(0.0f, SceneExtent), 50.0f);
+			SourceItemBounds.Add(FBox(Center - FVector(50.0f), Center + FVector(50.0f)));
+		}
+
+		auto AddBlocks = [&](FRuntimeMeshOcclusionData& Data)
+		{
+			for (int32 BlockIdx = 0; BlockIdx < BlockSide * BlockSide; BlockIdx++)
+			{
+				const FVector Center = SourceItemBounds[BlockIdx].GetCenter();
+				for (int32 VertexIdx = 0; VertexIdx < BoxPositions.Num(); VertexIdx++)
+				{
+					BlockPositions[VertexIdx] = BoxPositions[VertexIdx] + Center;
+				}
+				Data.AddOccluder(BlockPositions, BoxTriangles);
+			}
+		};
+
+		Measure(Results, TEXT("FRuntimeMeshOcclusionData Build"), SourceItemBounds.Num(), Iterations, [&]()
+		{
+			FRuntimeMeshOcclusionData Data;
+			double Start = FPlatformTime::Seconds();
+			AddBlocks(Data);
+			Data.BuildClusters(SourceItemBounds, 8);
+			return FPlatformTime::Seconds() - Start;
+		});
+
+		FRuntimeMeshOcclusionData Data;
+		AddBlocks(Data);
+		Data.BuildClusters(SourceItemBounds, 8);
+
+		// Eye height in the street between the first two columns of blocks, looking down it
+		const FVector ViewLocation(BlockSpacing * 0.5f, -2000.0f, 170.0f);
+		const FRotator ViewRotation(0.0f, 90.0f, 0.0f);
+		const FMatrix ViewMatrix = FTranslationMatrix(-ViewLocation) * FInverseRotationMatrix(ViewRotation) *
+			FMatrix(FPlane(0, 0, 1, 0), FPlane(1, 0, 0, 0), FPlane(0, 1, 0, 0), FPlane(0, 0, 0, 1));
+		const FMatrix WorldToClip = ViewMatrix * FReversedZPerspectiveMatrix(PI / 4.0f, 1920.0f, 1080.0f, 10.0f);
+
+		static const int32 Widths[] = { 128, 256, 512 };
+		for (int32 Width : Widths)
+		{
+			FRuntimeMeshDepthBuffer DepthBuffer;
+			DepthBuffer.Init(Width, Width * 9 / 16);
+			TBitArray<> VisibleClusters;
+			FRuntimeMeshOcclusionStats Stats;
+
+			Measure(Results, FString::Printf(TEXT("FRuntimeMeshOcclusionData ComputeVisibility (%d Clusters)"), Data.GetNumClusters()), Width, Iterations, [&]()
+			{
+				double Start = FPlatformTime::Seconds();
+				Data.ComputeVisibility(WorldToClip, 64.0f, DepthBuffer, VisibleClusters, Stats);
+				return FPlatformTime::Seconds() - Start;
+			});
+
+			UE_LOG(RuntimeMeshLog, Log, TEXT("RMC.Benchmark: Occlusion at %dx%d drew %d occluders (%d triangles) and culled %d of %d clusters (%d occluded, %d outside the view)"),
+				DepthBuffer.GetWidth(), DepthBuffer.GetHeight(), Stats.NumOccluders, Stats.NumOccluderTriangles,
+				Stats.GetNumClustersCulled(), Stats.NumClusters, Stats.NumClustersOccluded, Stats.NumClustersOutsideView);
+
+			// A prop behind the first block and one out in the street, the benchmark is meaningless if these come out wrong
+			const FBox HiddenBox(FVector(-550.0f, 1450.0f, 0.0f), FVector(-450.0f, 1550.0f, 100.0f));
+			const FBox StreetBox(FVector(1450.0f, -50.0f, 0.0f), FVector(1550.0f, 50.0f, 100.0f));
+			if (DepthBuffer.TestBox(WorldToClip, HiddenBox) != FRuntimeMeshDepthBuffer::EBoxVisibility::Occluded || !DepthBuffer.IsBoxVisible(WorldToClip, StreetBox))
+			{
+				UE_LOG(RuntimeMeshLog, Error, TEXT("RMC.Benchmark: Occlusion at %dx%d got the reference boxes wrong"), DepthBuffer.GetWidth(), DepthBuffer.GetHeight());
+			}
+		}
+	}
+
+#if WITH_ERSDK
+	/* Writes a synthetic scene of NumMeshes grids, each instanced InstancesPerMesh times, in the layout the 3ds Max exporter produces. */
+	static bool WriteSyntheticEss(const FString& FileName, int32 NumMeshes, int32 InstancesPerMesh, int32 Side)
+	{
+		ei_context();
+
+		for (int32 MeshIndex = 0; MeshIndex < NumMeshes; MeshIndex++)
+		{
+			FTCHARToUTF8 MeshName(*FString::Printf(TEXT("bench_mesh_%d"), MeshIndex));
+			ei_node("poly", MeshName.Get());
+
+			ei_param_array("pos_list", ei_tab(EI_TYPE_POINT, 1024));
+			for (int32 Y = 0; Y < Side; Y++)
+			{
+				for (int32 X = 0; X < Side; X++)
+				{
+					ei_tab_add_point(X * 10.0f, Y * 10.0f, FMath::Sin(X * 0.1f + MeshIndex) * 50.0f);
+				}
+			}
+			ei_end_tab();
+
+			// Face varying attributes share the corner indexing of triangle_list
+			TArray<int32> Triangles;
+			URuntimeMeshLibrary::CreateGridMeshTriangles(Side, Side, true, Triangles);
+
+			ei_param_array("triangle_list", ei_tab(EI_TYPE_INDEX, 1024));
+			for (int32 Index : Triangles)
+			{
+				ei_tab_add_index(Index);
+			}
+			ei_end_tab();
+
+			ei_declare_vector_array("N", EI_FACEVARYING, EI_NULL_TAG);
+			ei_param_array("N", ei_tab(EI_TYPE_VECTOR, 1));
+			ei_tab_add_vector(0.0f, 0.0f, 1.0f);
+			ei_end_tab();
+
+			ei_declare_index_array("N_idx", EI_FACEVARYING, EI_NULL_TAG);
+			ei_param_array("N_idx", ei_tab(EI_TYPE_INDEX, 1024));
+			for (int32 Corner = 0; Corner < Triangles.Num(); Corner++)
+			{
+				ei_tab_add_index(0);
+			}
+			ei_end_tab();
+
+			ei_declare_vector_array("uv1", EI_FACEVARYING, EI_NULL_TAG);
+			ei_param_array("uv1", ei_tab(EI_TYPE_VECTOR, 1024));
+			for (int32 Y = 0; Y < Side; Y++)
+			{
+				for (int32 X = 0; X < Side; X++)
+				{
+					ei_tab_add_vector(X / (float)Side, Y / (float)Side, 0.0f);
+				}
+			}
+			ei_end_tab();
+
+			ei_declare_index_array("uv1_idx", EI_FACEVARYING, EI_NULL_TAG);
+			ei_param_array("uv1_idx", ei_tab(EI_TYPE_INDEX, 1024));
+			for (int32 Index : Triangles)
+			{
+				ei_tab_add_index(Index);
+			}
+			ei_end_tab();
+
+			ei_end_node();
+		}
+
+		TArray<FString> InstanceNames;
+		for (int32 MeshIndex = 0; MeshIndex < NumMeshes; MeshIndex++)
+		{
+			FTCHARToUTF8 MeshName(*FString::Printf(TEXT("bench_mesh_%d"), MeshIndex));
+			for (int32 InstanceIndex = 0; InstanceIndex < InstancesPerMesh; InstanceIndex++)
+			{
+				FString InstanceName = FString::Printf(TEXT("bench_inst_%d_%d"), MeshIndex, InstanceIndex);
+				InstanceNames.Add(InstanceName);
+
+				ei_node("instance", TCHAR_TO_UTF8(*InstanceName));
+				ei_param_node("element", MeshName.Get());
+				ei_param_matrix("transform",
+					1.0f, 0.0f, 0.0f, 0.0f,
+					0.0f, 1.0f, 0.0f, 0.0f,
+					0.0f, 0.0f, 1.0f, 0.0f,
+					MeshIndex * Side * 10.0f, InstanceIndex * Side * 10.0f, 0.0f, 1.0f);
+				ei_end_node();
+			}
+		}
+
+		ei_node("instgroup", "mtoer_instgroup_00");
+		ei_param_array("instance_list", ei_tab(EI_TYPE_TAG_NODE, 16));
+		for (const FString& InstanceName : InstanceNames)
+		{
+			ei_tab_add_node(TCHAR_TO_UTF8(*InstanceName));
+		}
+		ei_end_tab();
+		ei_end_node();
+
+		// The exporter wants a camera and options even though the importer ignores them
+		ei_node("options", "bench_options");
+		ei_end_node();
+		ei_node("camera", "bench_camera");
+		ei_end_node();
+		ei_node("instance", "bench_camera_inst");
+		ei_param_node("element", "bench_camera");
+		ei_end_node();
+
+		bool bResult = ei_export_file(TCHAR_TO_UTF8(*FileName), "mtoer_instgroup_00", "bench_camera_inst", "bench_options") == EI_TRUE;
+
+		ei_end_context();
+
+		return bResult;
+	}
+#else
+	/* The same scene as the SDK export above, written directly in the syntax FEssNativeScene reads */
+	static bool WriteSyntheticEss(const FString& FileName, int32 NumMeshes, int32 InstancesPerMesh, int32 Side)
+	{
+		TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*FileName));
+		if (!Writer.IsValid())
+		{
+			return false;
+		}
+
+		auto Write = [&](const FString& Text)
+		{
+			FTCHARToUTF8 Converted(*Text);
+			Writer->Serialize((void*)Converted.Get(), Converted.Length());
+		};
+
+		for (int32 MeshIndex = 0; MeshIndex < NumMeshes; MeshIndex++)
+		{
+			Write(FString::Printf(TEXT("node \"poly\" \"bench_mesh_%d\"\n"), MeshIndex));
+
+			FString Line = FString::Printf(TEXT("\tarray \"pos_list\" \"point\" %d"), Side * Side);
+			for (int32 Y = 0; Y < Side; Y++)
+			{
+				for (int32 X = 0; X < Side; X++)
+				{
+					Line += FString::Printf(TEXT(" %g %g %g"), X * 10.0f, Y * 10.0f, FMath::Sin(X * 0.1f + MeshIndex) * 50.0f);
+				}
+			}
+			Write(Line + TEXT("\n"));
+
+			// Face varying attributes share the corner indexing of triangle_list
+			TArray<int32> Triangles;
+			URuntimeMeshLibrary::CreateGridMeshTriangles(Side, Side, true, Triangles);
+
+			FString Corners;
+			FString Zeros;
+			for (int32 Index : Triangles)
+			{
+				Corners += FString::Printf(TEXT(" %d"), Index);
+				Zeros += TEXT(" 0");
+			}
+			Write(FString::Printf(TEXT("\tarray \"triangle_list\" \"index\" %d%s\n"), Triangles.Num(), *Corners));
+			Write(TEXT("\tarray \"N\" \"vector\" 1 0 0 1\n"));
+			Write(FString::Printf(TEXT("\tarray \"N_idx\" \"index\" %d%s\n"), Triangles.Num(), *Zeros));
+
+			Line = FString::Printf(TEXT("\tarray \"uv1\" \"vector\" %d"), Side * Side);
+			for (int32 Y = 0; Y < Side; Y++)
+			{
+				for (int32 X = 0; X < Side; X++)
+				{
+					Line += FString::Printf(TEXT(" %g %g 0"), X / (float)Side, Y / (float)Side);
+				}
+			}
+			Write(Line + TEXT("\n"));
+			Write(FString::Printf(TEXT("\tarray \"uv1_idx\" \"index\" %d%s\n"), Triangles.Num(), *Corners));
+			Write(TEXT("end\n"));
+		}
+
+		FString InstanceList;
+		for (int32 MeshIndex = 0; MeshIndex < NumMeshes; MeshIndex++)
+		{
+			for (int32 InstanceIndex = 0; InstanceIndex < InstancesPerMesh; InstanceIndex++)
+			{
+				FString InstanceName = FString::Printf(TEXT("bench_inst_%d_%d"), MeshIndex, InstanceIndex);
+				InstanceList += FString::Printf(TEXT(" \"%s\""), *InstanceName);
+
+				Write(FString::Printf(TEXT("node \"instance\" \"%s\"\n\tnode \"element\" \"bench_mesh_%d\"\n"), *InstanceName, MeshIndex));
+				Write(FString::Printf(TEXT("\tmatrix \"transform\" 1 0 0 0 0 1 0 0 0 0 1 0 %g %g 0 1\nend\n"), MeshIndex * Side * 10.0f, InstanceIndex * Side * 10.0f));
+			}
+		}
+
+		Write(FString::Printf(TEXT("node \"instgroup\" \"mtoer_instgroup_00\"\n\tarray \"instance_list\" \"node\" %d%s\nend\n"), NumMeshes * InstancesPerMesh, *InstanceList));
+		return Writer->Close();
+	}
+#endif
+
+	/* Median throughput of a benchmark that read Bytes per sample */
+	static void LogThroughput(const FBenchmarkResult& Result, int64 Bytes, const FString& FileName)
+	{
+		TArray<double> Sorted = Result.Samples;
+		Sorted.Sort();
+		double Median = Percentile(Sorted, 50.0);
+		UE_LOG(RuntimeMeshLog, Log, TEXT("RMC.Benchmark: %s read %s (%.1f MB) at %.1f MB/s"), *Result.Name, *FPaths::GetCleanFilename(FileName),
+			Bytes / (1024.0 * 1024.0), Median > 0.0 ? Bytes / (1024.0 * 1024.0) / Median : 0.0);
+	}
+
+	/* Only the reader, without building meshes or materials */
+	static void BenchmarkEssRead(TArray<FBenchmarkResult>& Results, int32 Iterations, const FString& FileName, int32 Size)
+	{
+		Measure(Results, TEXT("FEssNativeScene Load"), Size, Iterations, [&]()
+		{
+			double Start = FPlatformTime::Seconds();
+			{
+				FEssNativeScene Scene;
+				Scene.Load(FileName);
+			}
+			return FPlatformTime::Seconds() - Start;
+		});
+		LogThroughput(Results.Last(), IFileManager::Get().FileSize(*FileName), FileName);
+	}
+
+	static void BenchmarkEssImport(TArray<FBenchmarkResult>& Results, int32 Iterations, const FString& WorkingDirectory)
+	{
+		struct FSceneConfig { int32 NumMeshes; int32 InstancesPerMesh; int32 Side; };
+		const FSceneConfig Scenes[] = { { 16, 4, 32 }, { 64, 8, 64 }, { 128, 4, 128 } };
+
+		for (const FSceneConfig& Scene : Scenes)
+		{
+			FString FileName = FPaths::Combine(*WorkingDirectory, *FString::Printf(TEXT("Synthetic_%d_%d_%d.ess"), Scene.NumMeshes, Scene.InstancesPerMesh, Scene.Side));
+			if (!WriteSyntheticEss(FileName, Scene.NumMeshes, Scene.InstancesPerMesh, Scene.Side))
+			{
+				UE_LOG(RuntimeMeshLog, Warning, TEXT("RMC.Benchmark: Failed to write synthetic scene %s, skipping."), *FileName);
+				continue;
+			}
+
+			const int32 Size = Scene.NumMeshes * Scene.Side * Scene.Side;
+			const int64 FileBytes = IFileManager::Get().FileSize(*FileName);
+			Measure(Results, TEXT("FEssImporter Parse"), Size, Iterations, [&]()
+			{
+				double Start = FPlatformTime::Seconds();
+				{
+					FEssImporter Importer;
+					Importer.ParseBlocking(FileName);
+				}
+				return FPlatformTime::Seconds() - Start;
+			});
+			LogThroughput(Results.Last(), FileBytes, FileName);
+
+#if WITH_ERSDK
+			Measure(Results, TEXT("FEssImporter Parse Native"), Size, Iterations, [&]()
+			{
+				double Start = FPlatformTime::Seconds();
+				{
+					FEssImporter Importer;
+					Importer.SetNativeReader(true);
+					Importer.ParseBlocking(FileName);
+				}
+				return FPlatformTime::Seconds() - Start;
+			});
+			LogThroughput(Results.Last(), FileBytes, FileName);
+#endif
+
+			BenchmarkEssRead(Results, Iterations, FileName, Size);
+		}
+	}
+
+	static void BenchmarkEssMaterials(TArray<FBenchmarkResult>& Results, int32 Iterations, const FString& SceneFile)
+	{
+		FEssImporter Importer;
+		if (!Importer.ParseBlocking(SceneFile))
+		{
+			UE_LOG(RuntimeMeshLog, Warning, TEXT("RMC.Benchmark: Failed to parse %s, skipping material resolution."), *SceneFile);
+			return;
+		}
+
+		TArray<FString> MaterialNames;
+		Importer.GetMaterialNames(MaterialNames);
+		Measure(Results, TEXT("FEssImporter ResolveMaterial"), MaterialNames.Num(), Iterations, [&]()
+		{
+			double Start = FPlatformTime::Seconds();
+			for (const FString& MaterialName : MaterialNames)
+			{
+				FEssMaterialParameters Params;
+				Importer.ResolveMaterial(MaterialName, Params);
+			}
+			return FPlatformTime::Seconds() - Start;
+		});
+
+		TArray<double> Sorted = Results.Last().Samples;
+		Sorted.Sort();
+		double Median = Percentile(Sorted, 50.0);
+		UE_LOG(RuntimeMeshLog, Log, TEXT("RMC.Benchmark: %d materials of %s resolved at %.0f materials/s"), MaterialNames.Num(), *FPaths::GetCleanFilename(SceneFile),
+			Median > 0.0 ? MaterialNames.Num() / Median : 0.0);
+	}
+
+	static FString ToJson(const TArray<FBenchmarkResult>& Results, int32 Iterations)
+	{
+		FString Json;
+		Json += TEXT("{\n");
+		Json += FString::Printf(TEXT("\t\"engine\": \"%d.%d.%d\",\n"), ENGINE_MAJOR_VERSION, ENGINE_MINOR_VERSION, ENGINE_PATCH_VERSION);
+		Json += FString::Printf(TEXT("\t\"platform\": \"%s\",\n"), ANSI_TO_TCHAR(FPlatformProperties::IniPlatformName()));
+		Json += FString::Printf(TEXT("\t\"cpu\": \"%s\",\n"), *FPlatformMisc::GetCPUBrand().TrimTrailing());
+		Json += FString::Printf(TEXT("\t\"cores\": %d,\n"), FPlatformMisc::NumberOfCoresIncludingHyperthreads());
+		Json += FString::Printf(TEXT("\t\"timestamp\": \"%s\",\n"), *FDateTime::UtcNow().ToIso8601());
+		Json += FString::Printf(TEXT("\t\"iterations\": %d,\n"), Iterations);
+		Json += TEXT("\t\"results\": [\n");
+
+		for (int32 Index = 0; Index < Results.Num(); Index++)
+		{
+			const FBenchmarkResult& Result = Results[Index];
+
+			TArray<double> Sorted = Result.Samples;
+			Sorted.Sort();
+
+			double Total = 0.0;
+			for (double Sample : Sorted)
+			{
+				Total += Sample;
+			}
+			double Mean = Sorted.Num() > 0 ? Total / Sorted.Num() : 0.0;
+
+			Json += TEXT("\t\t{ ");
+			Json += FString::Printf(TEXT("\"name\": \"%s\", \"size\": %d, \"size_per_second\": %.1f, "), *Result.Name, Result.Size, Mean > 0.0 ? Result.Size / Mean : 0.0);
+			Json += FString::Printf(TEXT("\"min_ms\": %.4f, \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f"),
+				Sorted.Num() > 0 ? Sorted[0] * 1000.0 : 0.0, Mean * 1000.0,
+				Percentile(Sorted, 50.0) * 1000.0, Percentile(Sorted, 90.0) * 1000.0, Percentile(Sorted, 99.0) * 1000.0,
+				Sorted.Num() > 0 ? Sorted.Last() * 1000.0 : 0.0);
+			Json += Index + 1 < Results.Num() ? TEXT(" },\n") : TEXT(" }\n");
+		}
+
+		Json += TEXT("\t]\n");
+		Json += TEXT("}\n");
+		return Json;
+	}
+
+	static void Run(const TArray<FString>& Args)
+	{
+		int32 Iterations = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10;
+
+		FString WorkingDirectory = FPaths::Combine(*FPaths::GameSavedDir(), TEXT("Profiling"), TEXT("RuntimeMesh"));
+		IFileManager::Get().MakeDirectory(*WorkingDirectory, true);
+
+		FString OutputFile = Args.Num() > 1 ? Args[1] : FPaths::Combine(*WorkingDirectory, *FString::Printf(TEXT("Benchmark-%s.json"), *FDateTime::Now().ToString()));
+
+		TArray<FBenchmarkResult> Results;
+
+		BenchmarkVertexType<FRuntimeMeshVertexSimple>(Results, TEXT("FRuntimeMeshVertexSimple"), Iterations);
+		BenchmarkVertexType<FRuntimeMeshVertexDualUV>(Results, TEXT("FRuntimeMeshVertexDualUV"), Iterations);
+		BenchmarkVertexType<FRuntimeMeshVertexHiPrecisionNormals>(Results, TEXT("FRuntimeMeshVertexHiPrecisionNormals"), Iterations);
+		BenchmarkDualBufferVertexType<FRuntimeMeshVertexNoPosition>(Results, TEXT("FRuntimeMeshVertexNoPosition"), Iterations);
+		BenchmarkLibrary(Results, Iterations);
+		BenchmarkSerialization(Results, Iterations);
+		BenchmarkBatchUpdates(Results, Iterations);
+		BenchmarkQueries(Results, Iterations);
+		BenchmarkOcclusion(Results, Iterations);
+		BenchmarkEssImport(Results, Iterations, WorkingDirectory);
+		if (Args.Num() > 2)
+		{
+			BenchmarkEssRead(Results, Iterations, Args[2], 0);
+			BenchmarkEssMaterials(Results, Iterations, Args[2]);
+		}
+
+		if (FFileHelper::SaveStringToFile(ToJson(Results, Iterations), *OutputFile))
+		{
+			UE_LOG(RuntimeMeshLog, Log, TEXT("RMC.Benchmark: Wrote %d results to %s"), Results.Num(), *OutputFile);
+		}
+		else
+		{
+			UE_LOG(RuntimeMeshLog, Error, TEXT("RMC.Benchmark: Failed to write %s"), *OutputFile);
+		}
+	}
+}
+
+static FAutoConsoleCommand GRuntimeMeshBenchmarkCommand(
+	TEXT("RMC.Benchmark"),
+	TEXT("Runs the RuntimeMeshComponent benchmark suite and writes JSON results. Usage: RMC.Benchmark [Iterations] [OutputFile] [EssScene]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RuntimeMeshBenchmark::Run));
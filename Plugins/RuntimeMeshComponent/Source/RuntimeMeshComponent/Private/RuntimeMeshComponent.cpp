@@ -5,6 +5,9 @@
 #include "RuntimeMeshCore.h"
 #include "RuntimeMeshGenericVertex.h"
 #include "RuntimeMeshVersion.h"
+#include "RuntimeMeshQuery.h"
+#include "RuntimeMeshOcclusion.h"
+#include "Async/Async.h"
 #include "PhysicsEngine/PhysicsSettings.h"
 #include "Physics/IPhysXCookingModule.h"
 
@@ -22,8 +25,13 @@ public:
 	FRuntimeMeshSceneProxy(URuntimeMeshComponent* Component)
 		: FPrimitiveSceneProxy(Component)
 		, BodySetup(Component->GetBodySetup())
+		, OcclusionScene(Component->OcclusionScene)
+		, OcclusionSlot(Component->OcclusionSlot)
+		// Components culled in software can do without a query each, the engine decides this when the proxy is added
+		, bHardwareOcclusion(!Component->OcclusionScene.IsValid() || FRuntimeMeshOcclusionScene::UseHardwareQueries())
 	{
-		bStaticElementsAlwaysUseProxyPrimitiveUniformBuffer = true;
+		// Quantized sections draw with a uniform buffer of their own, which static draw lists only respect when this is off
+		bStaticElementsAlwaysUseProxyPrimitiveUniformBuffer = !Component->bQuantizeStaticSections;
 
 
 		// Get the proxy for all mesh sections
@@ -43,8 +51,10 @@ public:
 				}
 
 
-				// Get the section creation data
-				auto* SectionData = SourceSection->GetSectionCreationData(&GetScene(), Material);
+				// Get the section creation data, evicted sections stay evicted
+				auto* SectionData = SourceSection->IsEvicted() ?
+					SourceSection->GetEvictedSectionCreationData(&GetScene(), Material, Component->GetQuantizationFrame()) :
+					SourceSection->GetSectionCreationData(&GetScene(), Material, Component->GetQuantizationFrame());
 				SectionData->SetTargetSection(SectionIdx);
 				SectionCreationData.Add(SectionData);
 
@@ -103,6 +113,7 @@ public:
 		// Get the proxy and finish the creation here on the render thread.
 		FRuntimeMeshSectionProxyInterface* Section = SectionData->NewProxy;
 		Section->FinishCreate_RenderThread(SectionData);		
+		UpdateSectionUniformBuffer(Section);
 
 		// Save ref to new section
 		Sections[SectionIndex] = Section;
@@ -113,6 +124,48 @@ public:
 		UpdateMaterialRelevance();
 	}
 
+	/** Sets the primitive uniform buffer of a section with its own transform, its vertices are mapped to world space through both transforms */
+	void UpdateSectionUniformBuffer(FRuntimeMeshSectionProxyInterface* Section)
+	{
+		if (!Section->HasSectionTransform())
+		{
+			return;
+		}
+
+		const FMatrix SectionTransform = Section->GetSectionTransform();
+		Section->SetPrimitiveUniformShaderParameters(GetPrimitiveUniformShaderParameters(
+			SectionTransform * GetLocalToWorld(),
+			GetActorPosition(),
+			GetBounds(),
+			GetLocalBounds().TransformBy(SectionTransform.Inverse()),
+			ReceivesDecals(),
+			HasDistanceFieldRepresentation(),
+			HasDynamicIndirectShadowCasterRepresentation(),
+			UseSingleSampleShadowFromStationaryLights(),
+			UseEditorDepthTest(),
+			GetLightingChannelMask(),
+			GetLpvBiasMultiplier()));
+	}
+
+	void SetOcclusionScene_RenderThread(const FRuntimeMeshOcclusionScenePtr& InOcclusionScene, int32 InOcclusionSlot)
+	{
+		check(IsInRenderingThread());
+
+		OcclusionScene = InOcclusionScene;
+		OcclusionSlot = InOcclusionSlot;
+	}
+
+	virtual void OnTransformChanged() override
+	{
+		for (FRuntimeMeshSectionProxyInterface* Section : Sections)
+		{
+			if (Section)
+			{
+				UpdateSectionUniformBuffer(Section);
+			}
+		}
+	}
+
 	/** Called on render thread to assign new dynamic data */
   	void UpdateSection_RenderThread(FRuntimeMeshRenderThreadCommandInterface* SectionData)
   	{
@@ -241,7 +294,8 @@ public:
 #endif
 	{
 		FPrimitiveViewRelevance Result;
-		Result.bDrawRelevance = IsShown(View);
+		// Clusters hidden behind the occluders of an imported scene are dropped before any section is submitted, shadows still go out
+		Result.bDrawRelevance = IsShown(View) && (!OcclusionScene.IsValid() || OcclusionScene->IsVisible(OcclusionSlot, *View, GetBounds().GetBox()));
 		Result.bShadowRelevance = IsShadowCast(View);
 
 		bool bForceDynamicPath = IsRichView(*View->Family) || View->Family->EngineShowFlags.Wireframe || IsSelected() || !IsStaticPathAvailable();
@@ -265,7 +319,8 @@ public:
 		MeshBatch.bCanApplyViewModeOverrides = true;
 		
 		FMeshBatchElement& BatchElement = MeshBatch.Elements[0];
-		BatchElement.PrimitiveUniformBufferResource = &GetUniformBuffer();
+		const TUniformBuffer<FPrimitiveUniformShaderParameters>* SectionUniformBuffer = Section->GetPrimitiveUniformBuffer();
+		BatchElement.PrimitiveUniformBufferResource = SectionUniformBuffer ? SectionUniformBuffer : &GetUniformBuffer();
 	}
 	
 	virtual void DrawStaticElements(FStaticPrimitiveDrawInterface* PDI) override
@@ -350,7 +405,7 @@ public:
 
 	virtual bool CanBeOccluded() const override
 	{
-		return !MaterialRelevance.bDisableDepthTest;
+		return !MaterialRelevance.bDisableDepthTest && bHardwareOcclusion;
 	}
 
 	virtual uint32 GetMemoryFootprint(void) const
@@ -360,7 +415,16 @@ public:
 
 	uint32 GetAllocatedSize(void) const
 	{
-		return(FPrimitiveSceneProxy::GetAllocatedSize());
+		// Sections count their GPU buffers too so stat memory shows what the mesh really costs
+		SIZE_T SectionsSize = Sections.GetAllocatedSize();
+		for (FRuntimeMeshSectionProxyInterface* Section : Sections)
+		{
+			if (Section)
+			{
+				SectionsSize += Section->GetAllocatedSize();
+			}
+		}
+		return(FPrimitiveSceneProxy::GetAllocatedSize() + SectionsSize);
 	}
 
 	void UpdateMaterialRelevance()
@@ -381,6 +445,10 @@ private:
 	TArray<FRuntimeMeshSectionProxyInterface*> Sections;
 	UBodySetup* BodySetup;
 	FMaterialRelevance MaterialRelevance;
+	/** Software occlusion scene the component was in and its slot there */
+	FRuntimeMeshOcclusionScenePtr OcclusionScene;
+	int32 OcclusionSlot;
+	bool bHardwareOcclusion;
 };
 
 
@@ -428,8 +496,13 @@ URuntimeMeshComponent::URuntimeMeshComponent(const FObjectInitializer& ObjectIni
 	, bUseComplexAsSimpleCollision(true)
 	, bUseAsyncCooking(false)
 	, bShouldSerializeMeshData(true)
+	, bAllowMemoryEviction(true)
 	, bCollisionDirty(true)
 	, CollisionMode(ERuntimeMeshCollisionCookingMode::CookingPerformance)
+	, bQueryBVHDirty(true)
+	, bQueryBVHNeedsRefit(false)
+	, OcclusionSlot(INDEX_NONE)
+	, bQuantizeStaticSections(false)
 {
 	// Setup the collision update ticker
 	PrePhysicsTick.TickGroup = TG_PrePhysics;
@@ -460,11 +533,19 @@ TSharedPtr<FRuntimeMeshSectionInterface> URuntimeMeshComponent::CreateOrResetSec
 }
 
 
-void URuntimeMeshComponent::CreateSectionInternal(int32 SectionIndex, ESectionUpdateFlags UpdateFlags)
+void URuntimeMeshComponent::CreateSectionInternal(int32 SectionIndex, ESectionUpdateFlags UpdateFlags, bool bHasPreparedData)
 {
 	RuntimeMeshSectionPtr Section = MeshSections[SectionIndex];
 	check(Section.IsValid());
 
+	MarkQueryBVHDirty(false);
+
+	// Reorder for the GPU first so the derived data is built in the final order
+	if (!!(UpdateFlags & ESectionUpdateFlags::OptimizeMesh))
+	{
+		Section->OptimizeMesh();
+	}
+
 	// Update normal/tangents if requested...
 	if (!!(UpdateFlags & ESectionUpdateFlags::CalculateNormalTangent))
 	{
@@ -477,6 +558,12 @@ void URuntimeMeshComponent::CreateSectionInternal(int32 SectionIndex, ESectionUp
 		Section->GenerateTessellationIndices();
 	}
 
+	// A section prepared on a worker already knows its index format
+	if (!bHasPreparedData)
+	{
+		Section->InvalidatePreparedData(true);
+	}
+
 	// Use the batch update if one is running
 	if (BatchState.IsBatchPending())
 	{
@@ -500,7 +587,7 @@ void URuntimeMeshComponent::CreateSectionInternal(int32 SectionIndex, ESectionUp
 	if (SceneProxy && Section->UpdateFrequency != EUpdateFrequency::Infrequent)
 	{
 		// Gather all needed update info
-		auto* SectionData = Section->GetSectionCreationData(GetScene(), GetSectionMaterial(SectionIndex));
+		auto* SectionData = Section->GetSectionCreationData(GetScene(), GetSectionMaterial(SectionIndex), GetQuantizationFrame());
 		SectionData->SetTargetSection(SectionIndex);
 
 		// Enqueue update on RT
@@ -530,13 +617,23 @@ void URuntimeMeshComponent::CreateSectionInternal(int32 SectionIndex, ESectionUp
 
 }
 
-void URuntimeMeshComponent::UpdateSectionInternal(int32 SectionIndex, bool bHadVertexPositionsUpdate, bool bHadVertexUpdates, bool bHadIndexUpdates, bool bNeedsBoundsUpdate, ESectionUpdateFlags UpdateFlags)
+void URuntimeMeshComponent::UpdateSectionInternal(int32 SectionIndex, bool bHadVertexPositionsUpdate, bool bHadVertexUpdates, bool bHadIndexUpdates, bool bNeedsBoundsUpdate, ESectionUpdateFlags UpdateFlags, bool bHasPreparedData)
 {
 	// Ensure that something was updated
 	check(bHadVertexPositionsUpdate || bHadVertexUpdates || bHadIndexUpdates || bNeedsBoundsUpdate);
 
 	check(SectionIndex < MeshSections.Num() && MeshSections[SectionIndex].IsValid());	
 	RuntimeMeshSectionPtr Section = MeshSections[SectionIndex];
+
+	MarkQueryBVHDirty(!bHadIndexUpdates);
+
+	// Reordering only makes sense along with new indices, it renumbers the vertices so they have to go to the GPU again
+	if (!!(UpdateFlags & ESectionUpdateFlags::OptimizeMesh) && bHadIndexUpdates)
+	{
+		Section->OptimizeMesh();
+		bHadVertexPositionsUpdate = true;
+		bHadVertexUpdates = true;
+	}
 	
 	// Update normal/tangents if requested...
 	if (!!(UpdateFlags & ESectionUpdateFlags::CalculateNormalTangent))
@@ -550,6 +647,12 @@ void URuntimeMeshComponent::UpdateSectionInternal(int32 SectionIndex, bool bHadV
 		Section->GenerateTessellationIndices();
 	}
 
+	// Anything prepared on a worker no longer matches the section
+	if (!bHasPreparedData)
+	{
+		Section->InvalidatePreparedData(bHadIndexUpdates);
+	}
+
 	/* Make sure this is only flagged if the section is dual buffer */
 	bHadVertexPositionsUpdate = Section->IsDualBufferSection() && bHadVertexPositionsUpdate;
 	bool bNeedsCollisionUpdate = Section->CollisionEnabled && (bHadVertexPositionsUpdate || (!Section->IsDualBufferSection() && bHadVertexUpdates));
@@ -624,11 +727,17 @@ void URuntimeMeshComponent::UpdateSectionInternal(int32 SectionIndex, bool bHadV
 	}
 }
 
-void URuntimeMeshComponent::UpdateSectionVertexPositionsInternal(int32 SectionIndex, bool bNeedsBoundsUpdate)
+void URuntimeMeshComponent::UpdateSectionVertexPositionsInternal(int32 SectionIndex, bool bNeedsBoundsUpdate, bool bHasPreparedData)
 {
 	check(SectionIndex < MeshSections.Num() && MeshSections[SectionIndex].IsValid());
 	RuntimeMeshSectionPtr Section = MeshSections[SectionIndex];
 
+	if (!bHasPreparedData)
+	{
+		Section->InvalidatePreparedData(false);
+	}
+	MarkQueryBVHDirty(true);
+
 	if (SceneProxy)
 	{
 		auto SectionData = Section->GetSectionPositionUpdateData();
@@ -704,6 +813,99 @@ void URuntimeMeshComponent::UpdateSectionPropertiesInternal(int32 SectionIndex,
 	}
 }
 
+void URuntimeMeshComponent::CommitPreparedSection(int32 SectionIndex, const RuntimeMeshSectionPtr& PreparedSection, ESectionUpdateFlags UpdateFlags)
+{
+	check(IsInGameThread());
+	check(PreparedSection.IsValid());
+
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_CommitPreparedSection);
+
+	RMC_CHECKINGAME_LOGINEDITOR((SectionIndex >= 0), "SectionIndex cannot be negative.", /*VoidReturn*/);
+	RMC_CHECKINGAME_LOGINEDITOR((PreparedSection->IndexBuffer.Num() > 0), "Triangles length must not be 0", /*VoidReturn*/);
+
+	// Ensure sections array is long enough
+	if (SectionIndex >= MeshSections.Num())
+	{
+		MeshSections.SetNum(SectionIndex + 1, false);
+	}
+
+	MeshSections[SectionIndex] = PreparedSection;
+
+	// Derived data was already built on the worker so don't let the finalize step redo it.
+	CreateSectionInternal(SectionIndex, UpdateFlags & ~(ESectionUpdateFlags::CalculateNormalTangent | ESectionUpdateFlags::CalculateTessellationIndices | ESectionUpdateFlags::OptimizeMesh), true);
+}
+
+bool URuntimeMeshComponent::MatchPreparedSectionLayout(int32 SectionIndex, const RuntimeMeshSectionPtr& PreparedSection, ERuntimeMeshSectionBatchUpdateType UpdateType, RuntimeMeshSectionPtr& OutLayoutSource)
+{
+	check(IsInGameThread());
+
+	RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, false);
+
+	const RuntimeMeshSectionPtr& Section = MeshSections[SectionIndex];
+	RMC_CHECKINGAME_LOGINEDITOR((!PreparedSection.IsValid() || Section->GetVertexType()->Equals(PreparedSection->GetVertexType())), "Prepared update vertex type doesn't match the section.", false);
+	RMC_CHECKINGAME_LOGINEDITOR((!(UpdateType & ERuntimeMeshSectionBatchUpdateType::PositionsUpdate) || Section->IsDualBufferSection()), "Vertex positions can only be updated on a dual buffer section.", false);
+
+	// The worker reads the buffers the update doesn't bring from here. Holding the section also keeps EvictSectionData() off it until the commit.
+	MakeSectionResident(SectionIndex);
+	OutLayoutSource = Section;
+	return true;
+}
+
+void URuntimeMeshComponent::CommitPreparedSectionUpdate(int32 SectionIndex, const RuntimeMeshSectionPtr& PreparedSection, const RuntimeMeshSectionPtr& LayoutSource,
+	ERuntimeMeshSectionBatchUpdateType UpdateType, ESectionUpdateFlags UpdateFlags)
+{
+	check(IsInGameThread());
+	check(PreparedSection.IsValid());
+
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_CommitPreparedSection);
+
+	RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+
+	RuntimeMeshSectionPtr& Section = MeshSections[SectionIndex];
+
+	// The worker built the update from the section it matched, which may have been recreated since
+	RMC_CHECKINGAME_LOGINEDITOR((Section == LayoutSource), "Section was replaced while the update was prepared.", /*VoidReturn*/);
+
+	// Carry the section properties over to the prepared buffers and swap them in
+	PreparedSection->CollisionEnabled = Section->CollisionEnabled;
+	PreparedSection->bIsVisible = Section->bIsVisible;
+	PreparedSection->bCastsShadow = Section->bCastsShadow;
+	PreparedSection->bShouldUseAdjacencyIndexBuffer = Section->bShouldUseAdjacencyIndexBuffer;
+	PreparedSection->UpdateFrequency = Section->UpdateFrequency;
+	PreparedSection->bIsLegacySectionType = Section->bIsLegacySectionType;
+
+	// Collision may have been turned off since the worker started
+	if (!PreparedSection->CollisionEnabled)
+	{
+		PreparedSection->CollisionPositionCache.Empty();
+	}
+
+	Section = PreparedSection;
+
+	bool bHadPositions = !!(UpdateType & ERuntimeMeshSectionBatchUpdateType::PositionsUpdate);
+	bool bHadVertices = !!(UpdateType & ERuntimeMeshSectionBatchUpdateType::VerticesUpdate);
+	const bool bHadIndices = !!(UpdateType & ERuntimeMeshSectionBatchUpdateType::IndicesUpdate);
+
+	// Reordering renumbered all the vertices so they have to go to the GPU again
+	if (!!(UpdateFlags & ESectionUpdateFlags::OptimizeMesh) && bHadIndices)
+	{
+		bHadPositions = true;
+		bHadVertices = true;
+	}
+
+	// A dual buffer section keeps its bounds while only its vertices change
+	const bool bNeedsBoundsUpdate = bHadPositions || (bHadVertices && !Section->IsDualBufferSection());
+
+	if (!bHadVertices && !bHadIndices)
+	{
+		UpdateSectionVertexPositionsInternal(SectionIndex, bNeedsBoundsUpdate, true);
+	}
+	else
+	{
+		const ESectionUpdateFlags CommitFlags = UpdateFlags & ~(ESectionUpdateFlags::CalculateNormalTangent | ESectionUpdateFlags::CalculateTessellationIndices | ESectionUpdateFlags::OptimizeMesh);
+		UpdateSectionInternal(SectionIndex, bHadPositions, bHadVertices, bHadIndices, bNeedsBoundsUpdate, CommitFlags, true);
+	}
+}
 
 void URuntimeMeshComponent::UpdateMeshSectionPositionsImmediate(int32 SectionIndex, TArray<FVector>& VertexPositions, ESectionUpdateFlags UpdateFlags)
 {
@@ -711,6 +913,7 @@ void URuntimeMeshComponent::UpdateMeshSectionPositionsImmediate(int32 SectionInd
 
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS_DUALBUFFER(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 
 	// Get section
 	RuntimeMeshSectionPtr& Section = MeshSections[SectionIndex];
@@ -750,6 +953,7 @@ void URuntimeMeshComponent::UpdateMeshSectionPositionsImmediate(int32 SectionInd
 
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS_DUALBUFFER(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 
 	// Get section
 	RuntimeMeshSectionPtr& Section = MeshSections[SectionIndex];
@@ -788,6 +992,7 @@ TArray<FVector>* URuntimeMeshComponent::BeginMeshSectionPositionUpdate(int32 Sec
 {
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS_DUALBUFFER(SectionIndex, nullptr);
+	MakeSectionResident(SectionIndex);
 
 	// Get section
 	RuntimeMeshSectionPtr& Section = MeshSections[SectionIndex];
@@ -799,6 +1004,7 @@ void URuntimeMeshComponent::EndMeshSectionPositionUpdate(int32 SectionIndex)
 {
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS_DUALBUFFER(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 	
 	// TODO: Validate that the position buffer is still the same length
 
@@ -809,6 +1015,7 @@ void URuntimeMeshComponent::EndMeshSectionPositionUpdate(int32 SectionIndex, con
 {
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS_DUALBUFFER(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 
 	RuntimeMeshSectionPtr& Section = MeshSections[SectionIndex];
 	
@@ -836,6 +1043,7 @@ void URuntimeMeshComponent::EndMeshSectionUpdate(int32 SectionIndex, ERuntimeMes
 
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 
 	// Get section and update bounding box
 	RuntimeMeshSectionPtr& Section = MeshSections[SectionIndex];
@@ -859,6 +1067,7 @@ void URuntimeMeshComponent::EndMeshSectionUpdate(int32 SectionIndex, ERuntimeMes
 
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 
 	// Get section and update bounding box
 	RuntimeMeshSectionPtr& Section = MeshSections[SectionIndex];
@@ -946,6 +1155,7 @@ void URuntimeMeshComponent::UpdateMeshSection(int32 SectionIndex, const TArray<F
 
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS_INTERNALSECTION(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 
 	// Validate section type
 	MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<FRuntimeMeshVertexSimple>();
@@ -974,6 +1184,7 @@ void URuntimeMeshComponent::UpdateMeshSection(int32 SectionIndex, const TArray<F
 
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS_INTERNALSECTION(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 
 	// Validate section type
 	MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<FRuntimeMeshVertexDualUV>();
@@ -1064,6 +1275,7 @@ void URuntimeMeshComponent::UpdateMeshSection(int32 SectionIndex, IRuntimeMeshVe
 {	
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS_INTERNALSECTION(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 
 	// Get section
 	RuntimeMeshSectionPtr& Section = MeshSections[SectionIndex];
@@ -1089,6 +1301,7 @@ void URuntimeMeshComponent::ClearMeshSection(int32 SectionIndex)
 
 		// Clear the section
 		MeshSections[SectionIndex].Reset();
+		MarkQueryBVHDirty(false);
 		
 		// Use the batch update if one is running
 		if (BatchState.IsBatchPending())
@@ -1141,6 +1354,7 @@ void URuntimeMeshComponent::ClearMeshSection(int32 SectionIndex)
 void URuntimeMeshComponent::ClearAllMeshSections()
 {
  	MeshSections.Empty();
+	MarkQueryBVHDirty(false);
 
 	// Use the batch update if one is running
 	if (BatchState.IsBatchPending())
@@ -1167,6 +1381,7 @@ void URuntimeMeshComponent::SetSectionTessellationTriangles(int32 SectionIndex,
 {
 	// Validate all update parameters
 	RMC_VALIDATE_UPDATEPARAMETERS_INTERNALSECTION(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 	
 	// Get section
 	RuntimeMeshSectionPtr& Section = MeshSections[SectionIndex];
@@ -1468,6 +1683,21 @@ FPrimitiveSceneProxy* URuntimeMeshComponent::CreateSceneProxy()
 {
 	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_CreateSceneProxy);
 
+	// Movable proxies draw velocities, which would miss the dequantization
+	bQuantizeStaticSections = FRuntimeMeshQuantizer::IsEnabled() && Mobility != EComponentMobility::Movable;
+	if (bQuantizeStaticSections)
+	{
+		FBox QuantizationBox(EForceInit::ForceInit);
+		for (const RuntimeMeshSectionPtr& Section : MeshSections)
+		{
+			if (Section.IsValid())
+			{
+				QuantizationBox += Section->LocalBoundingBox;
+			}
+		}
+		QuantizationFrame = FRuntimeMeshQuantizationFrame::FromBounds(QuantizationBox);
+	}
+
 	return new FRuntimeMeshSceneProxy(this);
 }
 
@@ -1481,6 +1711,28 @@ FBoxSphereBounds URuntimeMeshComponent::CalcBounds(const FTransform& LocalToWorl
 	return LocalBounds.TransformBy(LocalToWorld);
 }
 
+void URuntimeMeshComponent::OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	// Moving a parent only reaches the components below it, the counter shows how many that were this frame
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_UpdateTransform);
+	INC_DWORD_STAT(STAT_RuntimeMesh_TransformUpdates);
+
+	// The clusters and occluders were built where the component was, movable members test where they are
+	if (OcclusionScene.IsValid())
+	{
+		OcclusionScene->InvalidateMember(OcclusionSlot);
+	}
+
+	Super::OnUpdateTransform(UpdateTransformFlags, Teleport);
+}
+
+void URuntimeMeshComponent::SendRenderTransform_Concurrent()
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_SendRenderTransform);
+
+	Super::SendRenderTransform_Concurrent();
+}
+
 
 
 
@@ -1524,7 +1776,7 @@ void URuntimeMeshComponent::EndBatchUpdates()
 				}
 
 				// Get the section create data and add it to the list
-				auto SectionCreateData = MeshSections[Index]->GetSectionCreationData(GetScene(), Material);
+				auto SectionCreateData = MeshSections[Index]->GetSectionCreationData(GetScene(), Material, GetQuantizationFrame());
 				SectionCreateData->SetTargetSection(Index);
 
 				BatchUpdateData->CreateSections.Add(SectionCreateData);
@@ -1606,7 +1858,11 @@ void URuntimeMeshComponent::EndBatchUpdates()
 
 void URuntimeMeshComponent::GetSectionMesh(int32 SectionIndex, const IRuntimeMeshVerticesBuilder*& Vertices, const FRuntimeMeshIndicesBuilder*& Indices)
 {
+	Vertices = nullptr;
+	Indices = nullptr;
+
 	RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+	RMC_CHECKINGAME_LOGINEDITOR((!MeshSections[SectionIndex]->IsEvicted()), "GetSectionMesh() - Section is evicted, call MakeSectionResident() first.", /*VoidReturn*/);
 
 	IRuntimeMeshVerticesBuilder* TempVertices;
 	FRuntimeMeshIndicesBuilder* TempIndices;
@@ -1620,6 +1876,7 @@ void URuntimeMeshComponent::GetSectionMesh(int32 SectionIndex, const IRuntimeMes
 void URuntimeMeshComponent::BeginMeshSectionUpdate(int32 SectionIndex, IRuntimeMeshVerticesBuilder*& Vertices, FRuntimeMeshIndicesBuilder*& Indices)
 {
 	RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+	MakeSectionResident(SectionIndex);
 
 	// Get mesh
 	MeshSections[SectionIndex]->GetSectionMesh(Vertices, Indices);
@@ -1648,12 +1905,30 @@ bool URuntimeMeshComponent::GetPhysicsTriMeshData(struct FTriMeshCollisionData*
 
 		if (Section.IsValid() && Section->CollisionEnabled)
 		{
-			// Copy vertex data
+			MakeSectionResident(SectionIdx);
+
+			// Copy vertex data, using the positions extracted on a worker if we have them
 #if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 13
-			Section->GetCollisionInformation(CollisionData->Vertices, CollisionData->UVs, bCopyUVs);
+			if (Section->CollisionPositionCache.Num() > 0 && !bCopyUVs)
+			{
+				CollisionData->Vertices.Append(Section->CollisionPositionCache);
+			}
+			else
+			{
+				Section->GetCollisionInformation(CollisionData->Vertices, CollisionData->UVs, bCopyUVs);
+			}
 #else
-			Section->GetCollisionInformation(CollisionData->Vertices);
+			if (Section->CollisionPositionCache.Num() > 0)
+			{
+				CollisionData->Vertices.Append(Section->CollisionPositionCache);
+			}
+			else
+			{
+				Section->GetCollisionInformation(CollisionData->Vertices);
+			}
 #endif
+			// The cache only spares the first cook a walk over the vertices, later ones gather them again
+			Section->CollisionPositionCache.Empty();
 
 			// Copy indices
 			const int32 NumTriangles = Section->IndexBuffer.Num() / 3;
@@ -1717,7 +1992,7 @@ bool URuntimeMeshComponent::GetPhysicsTriMeshData(struct FTriMeshCollisionData*
  {
  	for (const RuntimeMeshSectionPtr& Section : MeshSections)
  	{
- 		if (Section.IsValid() && Section->IndexBuffer.Num() >= 3 && Section->CollisionEnabled)
+ 		if (Section.IsValid() && Section->GetNumIndices() >= 3 && Section->CollisionEnabled)
  		{
  			return true;
  		}
@@ -1853,6 +2128,286 @@ UBodySetup* URuntimeMeshComponent::GetBodySetup()
 	return BodySetup;
 }
 
+void URuntimeMeshComponent::UpdateQueryBVH(bool bAsync)
+{
+	if (PendingQueryBVH.IsValid())
+	{
+		QueryBVH = PendingQueryBVH.Get();
+		PendingQueryBVH = TFuture<TSharedPtr<FRuntimeMeshComponentBVH, ESPMode::ThreadSafe>>();
+	}
+
+	if (QueryBVH.IsValid() && !bQueryBVHDirty)
+	{
+		if (!bQueryBVHNeedsRefit)
+		{
+			return;
+		}
+
+		SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Query_RefitBVH);
+
+		bQueryBVHNeedsRefit = false;
+		if (QueryBVH->GatherVertices(this))
+		{
+			QueryBVH->Refit();
+			return;
+		}
+	}
+
+	// The mesh is copied here so the build doesn't touch the sections while the game thread may change them
+	TSharedPtr<FRuntimeMeshComponentBVH, ESPMode::ThreadSafe> NewBVH = MakeShareable(new FRuntimeMeshComponentBVH());
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Query_GatherBVH);
+		NewBVH->Gather(this);
+	}
+	bQueryBVHDirty = false;
+	bQueryBVHNeedsRefit = false;
+
+	if (bAsync)
+	{
+		PendingQueryBVH = Async<TSharedPtr<FRuntimeMeshComponentBVH, ESPMode::ThreadSafe>>(EAsyncExecution::ThreadPool, [NewBVH]()
+		{
+			NewBVH->Build();
+			return NewBVH;
+		});
+	}
+	else
+	{
+		NewBVH->Build();
+		QueryBVH = NewBVH;
+	}
+}
+
+const FRuntimeMeshComponentBVH* URuntimeMeshComponent::GetQueryBVH()
+{
+	check(IsInGameThread());
+	UpdateQueryBVH(false);
+	return QueryBVH.Get();
+}
+
+void URuntimeMeshComponent::RestoreEvictedSection(int32 SectionIndex)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Memory_RestoreSection);
+
+	MeshSections[SectionIndex]->Restore();
+}
+
+void URuntimeMeshComponent::GetMemoryUsage(FRuntimeMeshComponentMemory& OutMemory, TArray<FRuntimeMeshSectionMemory>* OutSections) const
+{
+	OutMemory = FRuntimeMeshComponentMemory();
+
+	for (int32 SectionIndex = 0; SectionIndex < MeshSections.Num(); SectionIndex++)
+	{
+		if (MeshSections[SectionIndex].IsValid())
+		{
+			FRuntimeMeshSectionMemory SectionMemory;
+			SectionMemory.SectionIndex = SectionIndex;
+			MeshSections[SectionIndex]->GetMemoryUsage(SectionMemory);
+			OutMemory.AddSection(SectionMemory);
+
+			if (OutSections)
+			{
+				OutSections->Add(SectionMemory);
+			}
+		}
+	}
+
+	if (BodySetup)
+	{
+		OutMemory.CollisionBytes += BodySetup->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+	}
+	for (UBodySetup* AsyncBodySetup : AsyncBodySetupQueue)
+	{
+		if (AsyncBodySetup)
+		{
+			OutMemory.CollisionBytes += AsyncBodySetup->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		}
+	}
+	for (const FRuntimeMeshCollisionSection& Section : MeshCollisionSections)
+	{
+		OutMemory.CollisionBytes += Section.VertexBuffer.GetAllocatedSize() + Section.IndexBuffer.GetAllocatedSize();
+	}
+	for (const FRuntimeConvexCollisionSection& Section : ConvexCollisionSections)
+	{
+		OutMemory.CollisionBytes += Section.VertexBuffer.GetAllocatedSize();
+	}
+
+	if (QueryBVH.IsValid())
+	{
+		OutMemory.QueryBytes = QueryBVH->GetAllocatedSize();
+	}
+}
+
+int64 URuntimeMeshComponent::TrimDerivedData()
+{
+	int64 FreedBytes = 0;
+
+	// A pending cook still wants the positions extracted on the worker
+	if (!bCollisionDirty && !BatchState.IsBatchPending())
+	{
+		for (const RuntimeMeshSectionPtr& Section : MeshSections)
+		{
+			if (Section.IsValid())
+			{
+				FreedBytes += Section->CollisionPositionCache.GetAllocatedSize();
+				Section->CollisionPositionCache.Empty();
+			}
+		}
+	}
+
+	// The next query rebuilds the tree
+	if (QueryBVH.IsValid() && !PendingQueryBVH.IsValid())
+	{
+		FreedBytes += QueryBVH->GetAllocatedSize();
+		QueryBVH.Reset();
+		bQueryBVHDirty = true;
+	}
+
+	return FreedBytes;
+}
+
+/** A restored section is kept at least this long, so one that is still being read isn't compressed again on the next budget pass */
+static const double GMinResidentSecondsAfterRestore = 30.0;
+
+int64 URuntimeMeshComponent::EvictSectionData()
+{
+	// The collision rebuild brings the sections back and a new proxy uncompresses them once more, so only evict once both are done
+	if (SceneProxy == nullptr || IsRenderStateDirty() || BatchState.IsBatchPending() || bCollisionDirty)
+	{
+		return 0;
+	}
+
+	int64 FreedBytes = 0;
+	for (const RuntimeMeshSectionPtr& Section : MeshSections)
+	{
+		// A section that isn't unique is being read by a prepared async update
+		if (Section.IsValid() && Section.IsUnique() && !Section->IsEvicted() && Section->UpdateFrequency != EUpdateFrequency::Frequent &&
+			Section->GetTimeSinceRestore() >= GMinResidentSecondsAfterRestore)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Memory_EvictSection);
+
+			FreedBytes += Section->Evict();
+		}
+	}
+	return FreedBytes;
+}
+
+void URuntimeMeshComponent::MarkQueryBVHDirty(bool bPositionsOnly)
+{
+	if (bPositionsOnly)
+	{
+		bQueryBVHNeedsRefit = true;
+	}
+	else
+	{
+		bQueryBVHDirty = true;
+	}
+
+	// Every section change comes through here, the occluders are copies of the sections as well
+	if (OcclusionScene.IsValid())
+	{
+		OcclusionScene->InvalidateMember(OcclusionSlot);
+	}
+}
+
+void URuntimeMeshComponent::SetOcclusionScene(const TSharedPtr<FRuntimeMeshOcclusionScene, ESPMode::ThreadSafe>& InOcclusionScene, int32 InOcclusionSlot)
+{
+	OcclusionScene = InOcclusionScene;
+	OcclusionSlot = InOcclusionSlot;
+
+	if (SceneProxy)
+	{
+		ENQUEUE_UNIQUE_RENDER_COMMAND_THREEPARAMETER(
+			FRuntimeMeshSetOcclusionScene,
+			FRuntimeMeshSceneProxy*, RuntimeMeshSceneProxy, (FRuntimeMeshSceneProxy*)SceneProxy,
+			FRuntimeMeshOcclusionScenePtr, NewOcclusionScene, InOcclusionScene,
+			int32, NewOcclusionSlot, InOcclusionSlot,
+			{
+				RuntimeMeshSceneProxy->SetOcclusionScene_RenderThread(NewOcclusionScene, NewOcclusionSlot);
+			}
+		);
+	}
+}
+
+static void TransformQueryHit(const FTransform& Transform, FRuntimeMeshQueryHit& Hit)
+{
+	Hit.Location = Transform.TransformPosition(Hit.Location);
+	// Normals go through the inverse transpose so they stay perpendicular under non uniform scale
+	Hit.Normal = Transform.ToMatrixWithScale().InverseFast().GetTransposed().TransformVector(Hit.Normal).GetSafeNormal();
+}
+
+bool URuntimeMeshComponent::TraceQueryBVH(const FVector& Start, const FVector& End, float Radius, FRuntimeMeshQueryHit& OutHit)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Query_Trace);
+
+	const FRuntimeMeshComponentBVH* BVH = GetQueryBVH();
+	if (BVH->IsEmpty())
+	{
+		return false;
+	}
+
+	// Traced in component space, the local length maps distances back to world space
+	const FTransform& Transform = GetComponentTransform();
+	const FVector LocalStart = Transform.InverseTransformPosition(Start);
+	FVector LocalDirection;
+	float LocalLength;
+	(Transform.InverseTransformPosition(End) - LocalStart).ToDirectionAndLength(LocalDirection, LocalLength);
+	if (LocalLength <= SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	bool bHit;
+	if (Radius > 0.0f)
+	{
+		// Dividing by the smallest scale makes the local sphere cover the world sphere on every axis
+		const float MinScale = Transform.GetMinimumAxisScale();
+		if (MinScale <= SMALL_NUMBER)
+		{
+			return false;
+		}
+		bHit = BVH->SweepSphere(LocalStart, LocalDirection, Radius / MinScale, LocalLength, OutHit);
+	}
+	else
+	{
+		bHit = BVH->Raycast(LocalStart, LocalDirection, LocalLength, OutHit);
+	}
+
+	if (!bHit)
+	{
+		return false;
+	}
+
+	OutHit.Component = this;
+	OutHit.Distance = OutHit.Distance / LocalLength * FVector::Dist(Start, End);
+	TransformQueryHit(Transform, OutHit);
+	return true;
+}
+
+bool URuntimeMeshComponent::LineTraceMesh(const FVector& Start, const FVector& End, FRuntimeMeshQueryHit& OutHit)
+{
+	return TraceQueryBVH(Start, End, 0.0f, OutHit);
+}
+
+bool URuntimeMeshComponent::SweepSphereMesh(const FVector& Start, const FVector& End, float Radius, FRuntimeMeshQueryHit& OutHit)
+{
+	return TraceQueryBVH(Start, End, FMath::Max(Radius, 0.0f), OutHit);
+}
+
+void URuntimeMeshComponent::OverlapBoxMesh(const FVector& Center, const FVector& Extent, const FRotator& Rotation, TArray<FRuntimeMeshQueryHit>& OutHits)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Query_Overlap);
+
+	OutHits.Reset();
+	const FRuntimeMeshComponentBVH* BVH = GetQueryBVH();
+	const FTransform& Transform = GetComponentTransform();
+	BVH->OverlapBox(FRotationTranslationMatrix(Rotation, Center) * Transform.ToMatrixWithScale().InverseFast(), Extent, OutHits);
+	for (FRuntimeMeshQueryHit& Hit : OutHits)
+	{
+		Hit.Component = this;
+		TransformQueryHit(Transform, Hit);
+	}
+}
+
 UMaterialInterface* URuntimeMeshComponent::GetMaterialFromCollisionFaceIndex(int32 FaceIndex, int32& SectionIndex) const
 {
 	UMaterialInterface* Result = nullptr;
@@ -1867,7 +2422,7 @@ UMaterialInterface* URuntimeMeshComponent::GetMaterialFromCollisionFaceIndex(int
 
 		if (Section.IsValid() && Section->CollisionEnabled)
 		{
-			int32 NumFaces = Section->IndexBuffer.Num() / 3;
+			int32 NumFaces = Section->GetNumIndices() / 3;
 			TotalFaceCount += NumFaces;
 
 			if (FaceIndex < TotalFaceCount)
@@ -2055,6 +2610,11 @@ void URuntimeMeshComponent::SerializeInternal(FArchive& Ar, bool bForceSaveAll)
 
 	Ar.UsingCustomVersion(FRuntimeMeshVersion::GUID);
 
+	if (Ar.IsLoading())
+	{
+		MarkQueryBVHDirty(false);
+	}
+
 	// Handle old serialization
 	if (Ar.CustomVer(FRuntimeMeshVersion::GUID) < FRuntimeMeshVersion::SerializationV2)
 	{
@@ -2169,6 +2729,8 @@ void URuntimeMeshComponent::SerializeRMCSection(FArchive& Ar, int32 SectionIndex
 
 	if (Ar.IsSaving())
 	{
+		MakeSectionResident(SectionIndex);
+
 		FMemoryWriter SectionAr(SectionData, true);
 		SectionAr.UsingCustomVersion(FRuntimeMeshVersion::GUID);
 
@@ -3,6 +3,9 @@
 #include "RuntimeMeshComponentPluginPrivatePCH.h"
 #include "RuntimeMeshVersion.h"
 #include "RuntimeMeshComponentPlugin.h"
+#include "RuntimeMeshMemory.h"
+#include "EssMaterialPermutations.h"
+#include "EssLiveSync.h"
 
 
 // Register the custom version with core
@@ -24,13 +27,16 @@ IMPLEMENT_MODULE(FRuntimeMeshComponentPlugin, RuntimeMeshComponent)
 
 void FRuntimeMeshComponentPlugin::StartupModule()
 {
-
+	FRuntimeMeshMemoryTracker::Startup();
+	FEssMaterialPermutations::Startup();
 }
 
 
 void FRuntimeMeshComponentPlugin::ShutdownModule()
 {
-
+	FEssLiveSync::Shutdown();
+	FEssMaterialPermutations::Shutdown();
+	FRuntimeMeshMemoryTracker::Shutdown();
 }
 
 
@@ -9,6 +9,11 @@
 #include "RuntimeMeshBuilder.h"
 #include "RuntimeMeshComponent.h"
 #include "EssImporter.h"
+#include "EssMaterialPermutations.h"
+#include "RuntimeMeshAmbientOcclusion.h"
+#include "RuntimeMeshQuery.h"
+#include "RuntimeMeshOcclusion.h"
+#include "EngineUtils.h"
 #if WITH_EDITOR
 #include "Editor/EditorEngine.h"
 #include "Public/LevelEditorViewport.h"
@@ -22,7 +27,13 @@ URuntimeMeshLibrary::URuntimeMeshLibrary(const FObjectInitializer& ObjectInitial
 	 mpEssImporter(NULL),
 	 mCurrentActor(NULL),
 	 mLastNodeIndex(INDEX_NONE),
-	 mbInEditor(false)
+	 mPlaceholderCursor(0),
+	 mGeometryCursor(0),
+	 mFirstPixelSeconds(0),
+	 mFirstGeometrySeconds(0),
+	 mbParseDone(false),
+	 mbInEditor(false),
+	 mbReimport(false)
 {
 
 }
@@ -164,6 +175,40 @@ void URuntimeMeshLibrary::ImportEss(const FString& filename, bool inEditor)
 	pInst->DoImportEss(filename, inEditor);
 }
 
+void URuntimeMeshLibrary::ReimportEss(const FString& filename, bool inEditor)
+{
+	URuntimeMeshLibrary* pInst = NewObject<URuntimeMeshLibrary>();
+	pInst->mbReimport = true;
+	pInst->DoImportEss(filename, inEditor);
+}
+
+void URuntimeMeshLibrary::ReimportTemporaryEss(const FString& filename, bool inEditor, const FSimpleDelegate& OnFinished)
+{
+	URuntimeMeshLibrary* pInst = NewObject<URuntimeMeshLibrary>();
+	pInst->mbReimport = true;
+	pInst->mTemporaryFile = filename;
+	pInst->mOnTemporaryImportFinished = OnFinished;
+	pInst->DoImportEss(filename, inEditor);
+	// Without a parse thread the import never starts, the caller still has to hear about it
+	if (NULL == pInst->mpEssImporter)
+	{
+		pInst->DeleteTemporaryFile();
+	}
+}
+
+void URuntimeMeshLibrary::DeleteTemporaryFile()
+{
+	if (!mTemporaryFile.IsEmpty())
+	{
+		IFileManager::Get().Delete(*mTemporaryFile);
+		mTemporaryFile.Empty();
+	}
+	// Reset first, the callback may start the next import
+	FSimpleDelegate onFinished = mOnTemporaryImportFinished;
+	mOnTemporaryImportFinished.Unbind();
+	onFinished.ExecuteIfBound();
+}
+
 void URuntimeMeshLibrary::DoImportEss(const FString& filename, bool inEditor)
 {
 	if (!mpEssImporter && FPlatformProcess::SupportsMultithreading())
@@ -173,12 +218,24 @@ void URuntimeMeshLibrary::DoImportEss(const FString& filename, bool inEditor)
 			OnComplete.BindUObject(this, &URuntimeMeshLibrary::OnEssParseFinished);
 		}
 		mpEssImporter = new FEssImporter();
+		mOcclusionScene = MakeShareable(new FRuntimeMeshOcclusionScene());
+		// Re-imports match nodes to the components already there, there is nothing to show early
+		if (mbReimport)
+		{
+			mpEssImporter->SetProgressive(false);
+		}
+		else
+		{
+			// A new scene shares no graphs with the last one, a re-import keeps reusing its permutations
+			FEssMaterialPermutations::Get().Reset();
+		}
 		if (!mpEssImporter->Initialize(filename, OnComplete, inEditor))
 		{
 			FString errorMsg = FString::Printf(TEXT("Can't find file : %s."), *filename);
 			GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, *errorMsg);
 			delete mpEssImporter;
 			mpEssImporter = NULL;
+			DeleteTemporaryFile();
 		}
 		mbInEditor = inEditor;
 	}
@@ -186,6 +243,441 @@ void URuntimeMeshLibrary::DoImportEss(const FString& filename, bool inEditor)
 
 extern UMaterial* GetDefaultMaterial();
 
+// Imported components are tagged with the mesh they were created from so nodes sharing a mesh can be found again
+static const TCHAR* ESS_MESH_TAG_PREFIX = TEXT("EssMesh:");
+// Content hashes of the sections and materials a component was built with, re-imports skip the parts whose hash didn't change
+static const TCHAR* ESS_GEOMETRY_TAG_PREFIX = TEXT("EssGeometry:");
+static const TCHAR* ESS_MATERIALS_TAG_PREFIX = TEXT("EssMaterials:");
+// Scene components standing in for nested instance groups
+static const TCHAR* ESS_GROUP_TAG_PREFIX = TEXT("EssGroup:");
+// Scoped name of the node a component was created for, what re-imports match components by
+static const TCHAR* ESS_NODE_TAG_PREFIX = TEXT("EssNode:");
+static const TCHAR* ESS_ROOT_ACTOR_NAME = TEXT("3dsMaxRoot");
+
+static FString FindEssTag(const UActorComponent* Component, const TCHAR* prefix)
+{
+	if (NULL != Component)
+	{
+		for (const FName& tag : Component->ComponentTags)
+		{
+			FString tagString = tag.ToString();
+			if (tagString.StartsWith(prefix))
+			{
+				return tagString.Mid(FCString::Strlen(prefix));
+			}
+		}
+	}
+	return FString();
+}
+
+static void SetEssTag(UActorComponent* Component, const TCHAR* prefix, const FString& value)
+{
+	Component->ComponentTags.RemoveAll([prefix](const FName& tag) { return tag.ToString().StartsWith(prefix); });
+	Component->ComponentTags.Add(FName(*(FString(prefix) + value)));
+}
+
+static FString FormatEssHash(uint32 hash)
+{
+	return FString::Printf(TEXT("%08x"), hash);
+}
+
+FString URuntimeMeshLibrary::GetEssMeshName(const UActorComponent* Component)
+{
+	return FindEssTag(Component, ESS_MESH_TAG_PREFIX);
+}
+
+USceneComponent* URuntimeMeshLibrary::FindEssGroup(AActor* SceneActor, const FString& GroupName)
+{
+	if (NULL == SceneActor)
+	{
+		return NULL;
+	}
+
+	TInlineComponentArray<USceneComponent*> components;
+	SceneActor->GetComponents(components);
+	for (USceneComponent* pComponent : components)
+	{
+		if (FindEssTag(pComponent, ESS_GROUP_TAG_PREFIX) == GroupName)
+		{
+			return pComponent;
+		}
+	}
+	return NULL;
+}
+
+bool URuntimeMeshLibrary::SetEssGroupTransform(AActor* SceneActor, const FString& GroupName, const FTransform& WorldTransform)
+{
+	USceneComponent* pGroup = FindEssGroup(SceneActor, GroupName);
+	if (NULL == pGroup)
+	{
+		return false;
+	}
+
+	// Static components can only be moved in the editor, making the group movable makes the nodes in it movable too
+	UWorld* world = pGroup->GetWorld();
+	if (NULL != world && world->IsGameWorld() && pGroup->Mobility == EComponentMobility::Static)
+	{
+		pGroup->SetMobility(EComponentMobility::Movable);
+	}
+	pGroup->SetWorldTransform(WorldTransform);
+	return true;
+}
+
+static void AddOcclusionComponents(AActor* SceneActor, FRuntimeMeshOcclusionScene& scene)
+{
+	TInlineComponentArray<URuntimeMeshComponent*> components;
+	SceneActor->GetComponents(components);
+	for (URuntimeMeshComponent* pComponent : components)
+	{
+		scene.AddComponent(pComponent);
+	}
+}
+
+void URuntimeMeshLibrary::BuildEssOcclusion(AActor* SceneActor)
+{
+	if (NULL == SceneActor)
+	{
+		return;
+	}
+
+	// The components move over from the scene they were in, it goes away with the last of them
+	TSharedRef<FRuntimeMeshOcclusionScene, ESPMode::ThreadSafe> scene = MakeShareable(new FRuntimeMeshOcclusionScene());
+	AddOcclusionComponents(SceneActor, scene.Get());
+	scene->Build();
+}
+
+bool URuntimeMeshLibrary::GetImportViewLocation(FVector& outLocation) const
+{
+#if WITH_EDITOR
+	if (mbInEditor)
+	{
+		outLocation = GEditor->LevelViewportClients[0]->GetViewLocation();
+		return true;
+	}
+#endif
+	UWorld* world = GetImportWorld();
+	APlayerController* pController = NULL != world ? world->GetFirstPlayerController() : NULL;
+	if (NULL != pController && NULL != pController->PlayerCameraManager)
+	{
+		outLocation = pController->PlayerCameraManager->GetCameraLocation();
+		return true;
+	}
+	return false;
+}
+
+UWorld* URuntimeMeshLibrary::GetImportWorld() const
+{
+#if WITH_EDITOR
+	return mbInEditor ? GEditor->LevelViewportClients[0]->GetWorld() : GEngine->GameViewport->GetWorld();
+#else
+	return GEngine->GameViewport->GetWorld();
+#endif
+}
+
+void URuntimeMeshLibrary::BuildNodeSections(URuntimeMeshComponent* runtimeMesh, int nodeIndex, bool bGeometry, bool bMaterials)
+{
+	const FMaxNodeInfo* pNodeInfo = mpEssImporter->GetNodeInfo(nodeIndex);
+	const FEssImporter::TMeshArray* pMeshArray = mpEssImporter->GetMeshInfo(pNodeInfo->meshName);
+
+	FEssImportScope scope(mpEssImporter->GetProfiler(), EEssImportStage::CreateComponents, &pNodeInfo->name);
+	// Sections of a component that is already on screen go out in one render update
+	const bool bBatch = bGeometry && runtimeMesh->IsRegistered();
+	if (bBatch)
+	{
+		runtimeMesh->BeginBatchUpdates();
+	}
+
+	int32 vertexCount = 0;
+	int32 triangleCount = 0;
+	for (int j = 0; j < pMeshArray->Num(); ++j)
+	{
+		const FMeshInfo& meshInfo = (*pMeshArray)[j];
+		if (bGeometry)
+		{
+			vertexCount += meshInfo.Vertices.Num();
+			triangleCount += meshInfo.Triangles.Num() / 3;
+			const TArray<int32>& triangles = meshInfo.Triangles;
+			const TArray<FVector2D>& uv2s = meshInfo.Uv2s.Num() > 0 ? meshInfo.Uv2s : meshInfo.Uv1s;
+			if (runtimeMesh->DoesSectionExist(j))
+			{
+				runtimeMesh->UpdateMeshSection(j, meshInfo.Vertices, triangles, meshInfo.Normals, meshInfo.Uv1s, uv2s, TArray<FColor>(), meshInfo.Tangents);
+			}
+			else
+			{
+				runtimeMesh->CreateMeshSection(j, meshInfo.Vertices, triangles, meshInfo.Normals, meshInfo.Uv1s, uv2s, TArray<FColor>(), meshInfo.Tangents, true, EUpdateFrequency::Infrequent);
+			}
+		}
+		if (bMaterials)
+		{
+			UMaterialInterface* pMaterial = mpEssImporter->GetNodeMaterial(nodeIndex, j, meshInfo.mtlIndex, runtimeMesh->GetOwner());
+			if (NULL == pMaterial)
+			{
+				pMaterial = GetDefaultMaterial();
+			}
+			runtimeMesh->SetMaterial(j, pMaterial);
+		}
+	}
+
+	if (bGeometry)
+	{
+		for (int j = pMeshArray->Num(); j <= runtimeMesh->GetLastSectionIndex(); ++j)
+		{
+			runtimeMesh->ClearMeshSection(j);
+		}
+		SetEssTag(runtimeMesh, ESS_MESH_TAG_PREFIX, pNodeInfo->meshName);
+		SetEssTag(runtimeMesh, ESS_GEOMETRY_TAG_PREFIX, FormatEssHash(mpEssImporter->GetMeshHash(pNodeInfo->meshName)));
+	}
+	if (bMaterials)
+	{
+		SetEssTag(runtimeMesh, ESS_MATERIALS_TAG_PREFIX, FormatEssHash(mpEssImporter->GetNodeMaterialHash(nodeIndex)));
+	}
+	if (bBatch)
+	{
+		runtimeMesh->EndBatchUpdates();
+	}
+	scope.SetGeometry(vertexCount, triangleCount);
+}
+
+URuntimeMeshComponent* URuntimeMeshLibrary::CreateNodeComponent(int nodeIndex, USceneComponent* RootComponent, bool bPlaceholder)
+{
+	const FMaxNodeInfo* pNodeInfo = mpEssImporter->GetNodeInfo(nodeIndex);
+	URuntimeMeshComponent* runtimeMesh = NewObject<URuntimeMeshComponent>(RootComponent, *pNodeInfo->name, RF_Transactional);
+	SetEssTag(runtimeMesh, ESS_NODE_TAG_PREFIX, pNodeInfo->name);
+	if (bPlaceholder)
+	{
+		BuildPlaceholderSection(runtimeMesh, nodeIndex);
+	}
+	else
+	{
+		BuildNodeSections(runtimeMesh, nodeIndex, true, true);
+	}
+
+	FTransform worldTransform(pNodeInfo->matrix);
+	runtimeMesh->SetWorldTransform(worldTransform);
+	runtimeMesh->DepthPriorityGroup = SDPG_World;
+	runtimeMesh->Mobility = EComponentMobility::Static;
+	runtimeMesh->SetFlags(RF_Transactional);
+	mCurrentActor->AddInstanceComponent(runtimeMesh);
+	mOcclusionScene->AddComponent(runtimeMesh);
+	runtimeMesh->RegisterComponent();
+	runtimeMesh->AttachToComponent(GetGroupParent(pNodeInfo->groupIndex, RootComponent), FAttachmentTransformRules::KeepWorldTransform);
+	return runtimeMesh;
+}
+
+void URuntimeMeshLibrary::BuildPlaceholderSection(URuntimeMeshComponent* runtimeMesh, int nodeIndex)
+{
+	const FBox& bounds = mpEssImporter->GetMeshBounds(mpEssImporter->GetNodeInfo(nodeIndex)->meshName);
+	if (!bounds.IsValid)
+	{
+		return;
+	}
+
+	// A box around the raw positions, replaced by the sections of the node once its mesh is built
+	TArray<FVector> vertices;
+	TArray<int32> triangles;
+	TArray<FVector> normals;
+	TArray<FVector2D> uvs;
+	TArray<FRuntimeMeshTangent> tangents;
+	CreateBoxMesh(bounds.GetExtent(), vertices, triangles, normals, uvs, tangents);
+	const FVector center = bounds.GetCenter();
+	for (FVector& vertex : vertices)
+	{
+		vertex += center;
+	}
+	runtimeMesh->CreateMeshSection(0, vertices, triangles, normals, uvs, TArray<FColor>(), tangents, false, EUpdateFrequency::Infrequent);
+	runtimeMesh->SetMaterial(0, GetDefaultMaterial());
+}
+
+USceneComponent* URuntimeMeshLibrary::CreateGroupComponent(int groupIndex, USceneComponent* RootComponent)
+{
+	const FMaxGroupInfo* pGroupInfo = mpEssImporter->GetGroupInfo(groupIndex);
+	USceneComponent* pGroup = NewObject<USceneComponent>(RootComponent, *pGroupInfo->name, RF_Transactional);
+	SetEssTag(pGroup, ESS_GROUP_TAG_PREFIX, pGroupInfo->name);
+	pGroup->SetWorldTransform(FTransform(pGroupInfo->matrix));
+	pGroup->Mobility = EComponentMobility::Static;
+	mCurrentActor->AddInstanceComponent(pGroup);
+	pGroup->RegisterComponent();
+	pGroup->AttachToComponent(GetGroupParent(pGroupInfo->parentIndex, RootComponent), FAttachmentTransformRules::KeepWorldTransform);
+	return pGroup;
+}
+
+USceneComponent* URuntimeMeshLibrary::GetGroupParent(int groupIndex, USceneComponent* RootComponent) const
+{
+	return mGroupComponents.IsValidIndex(groupIndex) && NULL != mGroupComponents[groupIndex] ? mGroupComponents[groupIndex] : RootComponent;
+}
+
+void URuntimeMeshLibrary::FinishImport()
+{
+	// Components a re-import kept join as well, the clusters cover the whole scene
+	if (NULL != mCurrentActor)
+	{
+		AddOcclusionComponents(mCurrentActor, *mOcclusionScene);
+		mOcclusionScene->Build();
+	}
+	mOcclusionScene.Reset();
+
+	mpEssImporter->LogMaterialSharing();
+	mpEssImporter->LogMeshOptimization();
+	mpEssImporter->GetProfiler().Finish(true);
+	FEssMaterialPermutations::Get().ScheduleReport(mpEssImporter->GetProfiler().GetSceneName());
+	delete mpEssImporter;
+	mpEssImporter = NULL;
+	DeleteTemporaryFile();
+	mCurrentActor = NULL;
+	mLastNodeIndex = INDEX_NONE;
+	mGroupComponents.Reset();
+	mNodeComponents.Reset();
+	mNodeBuilt.Empty();
+	mMeshNodes.Reset();
+	mPlaceholderQueue.Reset();
+	mGeometryQueue.Reset();
+	mPlaceholderCursor = 0;
+	mGeometryCursor = 0;
+	mFirstPixelSeconds = 0;
+	mFirstGeometrySeconds = 0;
+	mbParseDone = false;
+}
+
+void URuntimeMeshLibrary::BeginProgressiveImport()
+{
+	SpawnRootActor();
+	USceneComponent* RootComponent = mCurrentActor->GetRootComponent();
+	mGroupComponents.SetNumZeroed(mpEssImporter->GetGroupCount());
+	for (int i = 0; i < mGroupComponents.Num(); ++i)
+	{
+		mGroupComponents[i] = CreateGroupComponent(i, RootComponent);
+	}
+
+	int nodeCount = mpEssImporter->GetNodeCount();
+	mNodeComponents.SetNumZeroed(nodeCount);
+	mNodeBuilt.Init(false, nodeCount);
+	mPlaceholderQueue.Reserve(nodeCount);
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		mMeshNodes.Add(mpEssImporter->GetNodeInfo(i)->meshName, i);
+		mPlaceholderQueue.Add(i);
+	}
+
+	// Placeholders go in largest on screen first, so the first frames already show the shape of the scene
+	FVector viewLocation;
+	if (GetImportViewLocation(viewLocation))
+	{
+		TArray<float> screenSizes;
+		screenSizes.SetNumUninitialized(nodeCount);
+		for (int i = 0; i < nodeCount; ++i)
+		{
+			screenSizes[i] = mpEssImporter->GetNodeScreenSize(i, viewLocation);
+		}
+		mPlaceholderQueue.Sort([&screenSizes](int32 a, int32 b) { return screenSizes[a] > screenSizes[b]; });
+	}
+}
+
+void URuntimeMeshLibrary::DoProgressiveImport()
+{
+	FVector viewLocation;
+	if (GetImportViewLocation(viewLocation))
+	{
+		mpEssImporter->SetViewLocation(viewLocation);
+	}
+
+	if (mpEssImporter->CheckParseFinished())
+	{
+		mbParseDone = true;
+		if (!mpEssImporter->GetParseResult())
+		{
+			mpEssImporter->StopPolling();
+			GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("Ess file parse failure."));
+			mpEssImporter->GetProfiler().Finish(false);
+			if (NULL != mCurrentActor)
+			{
+				mCurrentActor->Destroy();
+			}
+			delete mpEssImporter;
+			mpEssImporter = NULL;
+			DeleteTemporaryFile();
+			mCurrentActor = NULL;
+			return;
+		}
+	}
+
+	if (!mpEssImporter->AreNodesReady())
+	{
+		return;
+	}
+	if (NULL == mCurrentActor)
+	{
+		BeginProgressiveImport();
+	}
+
+	FString meshName;
+	while (mpEssImporter->PopReadyMesh(meshName))
+	{
+		mMeshNodes.MultiFind(meshName, mGeometryQueue);
+	}
+
+	const double MAX_IMPORT_TIME_SPAN = 0.03;
+	double startTime = FPlatformTime::Seconds();
+	USceneComponent* RootComponent = mCurrentActor->GetRootComponent();
+	bool bFirstPlaceholders = 0 == mPlaceholderCursor;
+	while (mPlaceholderCursor < mPlaceholderQueue.Num() && FPlatformTime::Seconds() - startTime < MAX_IMPORT_TIME_SPAN)
+	{
+		int nodeIndex = mPlaceholderQueue[mPlaceholderCursor++];
+		if (NULL == mNodeComponents[nodeIndex])
+		{
+			mNodeComponents[nodeIndex] = CreateNodeComponent(nodeIndex, RootComponent, true);
+		}
+	}
+	if (bFirstPlaceholders && mPlaceholderCursor > 0)
+	{
+		mFirstPixelSeconds = mpEssImporter->GetProfiler().AddMilestone(TEXT("FirstPixel"));
+	}
+
+	bool bFirstGeometry = 0 == mGeometryCursor;
+	while (mGeometryCursor < mGeometryQueue.Num() && FPlatformTime::Seconds() - startTime < MAX_IMPORT_TIME_SPAN)
+	{
+		int nodeIndex = mGeometryQueue[mGeometryCursor++];
+		URuntimeMeshComponent* runtimeMesh = mNodeComponents[nodeIndex];
+		if (NULL == runtimeMesh)
+		{
+			mNodeComponents[nodeIndex] = CreateNodeComponent(nodeIndex, RootComponent);
+		}
+		else
+		{
+			runtimeMesh->ClearAllMeshSections();
+			BuildNodeSections(runtimeMesh, nodeIndex, true, true);
+		}
+		mNodeBuilt[nodeIndex] = true;
+	}
+	if (bFirstGeometry && mGeometryCursor > 0)
+	{
+		mFirstGeometrySeconds = mpEssImporter->GetProfiler().AddMilestone(TEXT("FirstGeometry"));
+	}
+
+	if (!mbParseDone || mPlaceholderCursor < mPlaceholderQueue.Num() || mGeometryCursor < mGeometryQueue.Num())
+	{
+		return;
+	}
+
+	// Nodes whose mesh was missing from the file end up without sections, as in a regular import
+	for (int i = 0; i < mNodeComponents.Num(); ++i)
+	{
+		if (!mNodeBuilt[i] && NULL != mNodeComponents[i])
+		{
+			mNodeComponents[i]->ClearAllMeshSections();
+			BuildNodeSections(mNodeComponents[i], i, true, true);
+		}
+	}
+
+	mpEssImporter->StopPolling();
+	double completeSeconds = mpEssImporter->GetProfiler().AddMilestone(TEXT("Complete"));
+	FString summary = FString::Printf(TEXT("Ess imported progressively: %d nodes, first pixel after %.2fs, first mesh after %.2fs, complete after %.2fs"),
+		mNodeComponents.Num(), mFirstPixelSeconds, mFirstGeometrySeconds, completeSeconds);
+	UE_LOG(RuntimeMeshLog, Log, TEXT("%s"), *summary);
+	FinishImport();
+
+	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, *summary);
+}
+
 void URuntimeMeshLibrary::DoImportMesh()
 {
 	if (NULL == mCurrentActor || INDEX_NONE == mLastNodeIndex)
@@ -220,92 +712,234 @@ void URuntimeMeshLibrary::DoImportMesh()
 			}
 		}
 
-		const FEssImporter::TMeshArray* pMeshArray = mpEssImporter->GetMeshInfo(pNodeInfo->meshName);
-		if (NULL == pMeshArray)
+		if (NULL == mpEssImporter->GetMeshInfo(pNodeInfo->meshName))
 		{
 			continue;
 		}
+		CreateNodeComponent(i, RootComponent);
+	}
+
+	GEngine->GameViewport->GetWorld()->GetTimerManager().ClearTimer(mTimerHandle);
+	FinishImport();
+
+	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("Ess Imported!"));
+}
+
+// A running game refuses to move static components, they are moved while unregistered so they keep their mobility
+static void MoveEssComponent(USceneComponent* pComponent, USceneComponent* pParent, const FTransform& worldTransform, bool bInEditor)
+{
+	pComponent->Modify();
+	const bool bReregister = !bInEditor && pComponent->Mobility == EComponentMobility::Static && pComponent->IsRegistered();
+	if (bReregister)
+	{
+		pComponent->UnregisterComponent();
+	}
+	if (pComponent->GetAttachParent() != pParent)
+	{
+		pComponent->AttachToComponent(pParent, FAttachmentTransformRules::KeepWorldTransform);
+	}
+	pComponent->SetWorldTransform(worldTransform);
+	if (bReregister)
+	{
+		pComponent->RegisterComponent();
+	}
+}
 
-		URuntimeMeshComponent* runtimeMesh = NewObject<URuntimeMeshComponent>(RootComponent, *pNodeInfo->name, RF_Transactional);
-		for (int j = 0; j < pMeshArray->Num(); ++j)
+void URuntimeMeshLibrary::DoReimport()
+{
+	double startTime = FPlatformTime::Seconds();
+	USceneComponent* RootComponent = mCurrentActor->GetRootComponent();
+
+	TMap<FString, URuntimeMeshComponent*> existingComponents;
+	TMap<FString, USceneComponent*> existingGroups;
+	TInlineComponentArray<USceneComponent*> components;
+	mCurrentActor->GetComponents(components);
+	for (USceneComponent* pComponent : components)
+	{
+		FString groupName = FindEssTag(pComponent, ESS_GROUP_TAG_PREFIX);
+		if (!groupName.IsEmpty())
 		{
-			const FMeshInfo& meshInfo = (*pMeshArray)[j];
-			runtimeMesh->CreateMeshSection(j, meshInfo.Vertices, !pNodeInfo->bInvertVertexOrder ? meshInfo.Triangles : meshInfo.InvertTriangles,
-				meshInfo.Normals, meshInfo.Uv1s, meshInfo.Uv2s.Num() > 0 ? meshInfo.Uv2s : meshInfo.Uv1s, TArray<FColor>(), meshInfo.Tangents, true, EUpdateFrequency::Infrequent);
-			UMaterialInterface* pMaterial = mpEssImporter->GetNodeMaterial(i, j, meshInfo.mtlIndex, runtimeMesh);
-			if (NULL == pMaterial)
-			{
-				pMaterial = GetDefaultMaterial();
-			}
-			runtimeMesh->SetMaterial(j, pMaterial);
+			existingGroups.Add(groupName, pComponent);
+		}
+		else if (URuntimeMeshComponent* pRuntimeMesh = Cast<URuntimeMeshComponent>(pComponent))
+		{
+			FString nodeName = FindEssTag(pRuntimeMesh, ESS_NODE_TAG_PREFIX);
+			existingComponents.Add(nodeName.IsEmpty() ? pRuntimeMesh->GetName() : nodeName, pRuntimeMesh);
+		}
+	}
+
+	// Groups come before their children, a moved group carries its unchanged nodes along so they aren't touched below
+	int32 movedGroupCount = 0;
+	int groupCount = mpEssImporter->GetGroupCount();
+	mGroupComponents.SetNumZeroed(groupCount);
+	for (int i = 0; i < groupCount; ++i)
+	{
+		const FMaxGroupInfo* pGroupInfo = mpEssImporter->GetGroupInfo(i);
+		USceneComponent* pGroup = NULL;
+		if (!existingGroups.RemoveAndCopyValue(pGroupInfo->name, pGroup) || NULL == pGroup)
+		{
+			mGroupComponents[i] = CreateGroupComponent(i, RootComponent);
+			continue;
+		}
+
+		mGroupComponents[i] = pGroup;
+		USceneComponent* pParent = GetGroupParent(pGroupInfo->parentIndex, RootComponent);
+		FTransform worldTransform(pGroupInfo->matrix);
+		if (pGroup->GetAttachParent() != pParent || !pGroup->GetComponentTransform().Equals(worldTransform))
+		{
+			MoveEssComponent(pGroup, pParent, worldTransform, mbInEditor);
+			++movedGroupCount;
+		}
+	}
+
+	int32 addedCount = 0;
+	int32 movedCount = 0;
+	int32 rebuiltCount = 0;
+	int32 rematerialedCount = 0;
+	int32 unchangedCount = 0;
+	int nodeCount = mpEssImporter->GetNodeCount();
+	for (int i = 0; i < nodeCount; ++i)
+	{
+		const FMaxNodeInfo* pNodeInfo = mpEssImporter->GetNodeInfo(i);
+		if (NULL == pNodeInfo || NULL == mpEssImporter->GetMeshInfo(pNodeInfo->meshName))
+		{
+			continue;
+		}
+
+		URuntimeMeshComponent* runtimeMesh = NULL;
+		if (!existingComponents.RemoveAndCopyValue(pNodeInfo->name, runtimeMesh) || NULL == runtimeMesh)
+		{
+			CreateNodeComponent(i, RootComponent);
+			++addedCount;
+			continue;
+		}
+
+		const bool bGeometryChanged = GetEssMeshName(runtimeMesh) != pNodeInfo->meshName ||
+			FindEssTag(runtimeMesh, ESS_GEOMETRY_TAG_PREFIX) != FormatEssHash(mpEssImporter->GetMeshHash(pNodeInfo->meshName));
+		const bool bMaterialsChanged = FindEssTag(runtimeMesh, ESS_MATERIALS_TAG_PREFIX) != FormatEssHash(mpEssImporter->GetNodeMaterialHash(i));
+		if (bGeometryChanged || bMaterialsChanged)
+		{
+			runtimeMesh->Modify();
+			BuildNodeSections(runtimeMesh, i, bGeometryChanged, bMaterialsChanged || bGeometryChanged);
+			rebuiltCount += bGeometryChanged ? 1 : 0;
+			rematerialedCount += !bGeometryChanged ? 1 : 0;
 		}
 
 		FTransform worldTransform(pNodeInfo->matrix);
-		runtimeMesh->SetWorldTransform(worldTransform);
-		runtimeMesh->DepthPriorityGroup = SDPG_World;
-		runtimeMesh->Mobility = EComponentMobility::Static;
-		runtimeMesh->SetFlags(RF_Transactional);
-		mCurrentActor->AddInstanceComponent(runtimeMesh);
-		runtimeMesh->RegisterComponent();
-		runtimeMesh->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
+		USceneComponent* pParent = GetGroupParent(pNodeInfo->groupIndex, RootComponent);
+		if (runtimeMesh->GetAttachParent() != pParent || !runtimeMesh->GetComponentTransform().Equals(worldTransform))
+		{
+			MoveEssComponent(runtimeMesh, pParent, worldTransform, mbInEditor);
+			++movedCount;
+		}
+		else if (!bGeometryChanged && !bMaterialsChanged)
+		{
+			++unchangedCount;
+		}
 	}
 
-	GEngine->GameViewport->GetWorld()->GetTimerManager().ClearTimer(mTimerHandle);
-	delete mpEssImporter;
-	mpEssImporter = NULL;
-	mCurrentActor = NULL;
-	mLastNodeIndex = INDEX_NONE;
+	// Whatever wasn't matched by a node has been deleted from the scene
+	int32 removedCount = 0;
+	for (const auto& iter : existingComponents)
+	{
+		mCurrentActor->RemoveInstanceComponent(iter.Value);
+		iter.Value->DestroyComponent();
+		++removedCount;
+	}
+	for (const auto& iter : existingGroups)
+	{
+		mCurrentActor->RemoveInstanceComponent(iter.Value);
+		iter.Value->DestroyComponent();
+	}
 
-	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("Ess Imported!"));
+	double seconds = FPlatformTime::Seconds() - startTime;
+	FString summary = FString::Printf(TEXT("Ess re-imported in %.3fs: %d added, %d removed, %d moved, %d rebuilt, %d rematerialed, %d unchanged, %d groups moved"),
+		seconds, addedCount, removedCount, movedCount, rebuiltCount, rematerialedCount, unchangedCount, movedGroupCount);
+	UE_LOG(RuntimeMeshLog, Log, TEXT("%s"), *summary);
+	FinishImport();
+
+	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, *summary);
+}
+
+void URuntimeMeshLibrary::SpawnRootActor()
+{
+	UWorld* world = GetImportWorld();
+	FActorSpawnParameters parameter;
+	parameter.Name = ESS_ROOT_ACTOR_NAME;
+	AActor* rootActor = (AActor*)world->SpawnActor(AActor::StaticClass(), &FTransform::Identity, parameter);
+#if WITH_EDITOR
+	rootActor->SetActorLabel(parameter.Name.ToString());
+#endif // WITH_EDITOR
+	USceneComponent* RootComponent = NewObject<USceneComponent>(rootActor, USceneComponent::GetDefaultSceneRootVariableName(), RF_Transactional);
+	RootComponent->Mobility = EComponentMobility::Static;
+	RootComponent->SetWorldTransform(FTransform::Identity);
+	RootComponent->SetWorldLocation(FVector::ZeroVector);
+
+	rootActor->SetRootComponent(RootComponent);
+	rootActor->AddInstanceComponent(RootComponent);
+	mCurrentActor = rootActor;
 }
 
 void URuntimeMeshLibrary::OnEssParseFinished()
 {
+	if (NULL != mpEssImporter && mpEssImporter->IsProgressive())
+	{
+		DoProgressiveImport();
+		return;
+	}
+
 	if (NULL != mpEssImporter && mpEssImporter->CheckParseFinished())
 	{
 		if (!mpEssImporter->GetParseResult())
 		{
 			GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, TEXT("Ess file parse failure."));
+			mpEssImporter->GetProfiler().Finish(false);
 			delete mpEssImporter;
 			mpEssImporter = NULL;
+			DeleteTemporaryFile();
 			return;
 		}
-#if WITH_EDITOR
-		UWorld* world = mbInEditor ? GEditor->LevelViewportClients[0]->GetWorld() : GEngine->GameViewport->GetWorld();
-#else
-		UWorld* world = GEngine->GameViewport->GetWorld();
-#endif
-		FActorSpawnParameters parameter;
-		parameter.Name = _T("3dsMaxRoot");
-		AActor* rootActor = (AActor*)world->SpawnActor(AActor::StaticClass(), &FTransform::Identity, parameter);
-#if WITH_EDITOR
-		rootActor->SetActorLabel(parameter.Name.ToString());
-#endif // WITH_EDITOR
-		USceneComponent* RootComponent = NewObject<USceneComponent>(rootActor, USceneComponent::GetDefaultSceneRootVariableName(), RF_Transactional);
-		RootComponent->Mobility = EComponentMobility::Static;
-		RootComponent->SetWorldTransform(FTransform::Identity);
-		RootComponent->SetWorldLocation(FVector::ZeroVector);
+		UWorld* world = GetImportWorld();
+		if (mbReimport)
+		{
+			for (TActorIterator<AActor> iter(world); iter; ++iter)
+			{
+				if (iter->GetName().StartsWith(ESS_ROOT_ACTOR_NAME))
+				{
+					mCurrentActor = *iter;
+					DoReimport();
+					return;
+				}
+			}
+			UE_LOG(RuntimeMeshLog, Log, TEXT("No imported ess scene found, importing %s from scratch"), *mpEssImporter->GetProfiler().GetSceneName());
+		}
 
-		rootActor->SetRootComponent(RootComponent);
-		rootActor->AddInstanceComponent(RootComponent);
+		SpawnRootActor();
+		USceneComponent* RootComponent = mCurrentActor->GetRootComponent();
 		mLastNodeIndex = 0;
-		mCurrentActor = rootActor;
+
+		// Groups are few, they all go in before the nodes are spread over the frames
+		mGroupComponents.SetNumZeroed(mpEssImporter->GetGroupCount());
+		for (int i = 0; i < mGroupComponents.Num(); ++i)
+		{
+			mGroupComponents[i] = CreateGroupComponent(i, RootComponent);
+		}
 
 		DoImportMesh();		
 	}
 }
 
-void FindVertOverlaps(int32 TestVertIndex, const IRuntimeMeshVerticesBuilder* Vertices, TArray<int32>& VertOverlaps)
+void FindVertOverlaps(int32 TestVertIndex, const TArray<FVector>& Positions, TArray<int32>& VertOverlaps)
 {
 	// Check if Verts is empty or test is outside range
-	if (TestVertIndex < Vertices->Length())
+	if (TestVertIndex < Positions.Num())
 	{
-		const FVector TestVert = Vertices->GetPosition(TestVertIndex);
+		const FVector TestVert = Positions[TestVertIndex];
 
-		for (int32 VertIdx = 0; VertIdx < Vertices->Length(); VertIdx++)
+		for (int32 VertIdx = 0; VertIdx < Positions.Num(); VertIdx++)
 		{
 			// First see if we overlap, and smoothing groups are the same
-			if (TestVert.Equals(Vertices->GetPosition(VertIdx)))
+			if (TestVert.Equals(Positions[VertIdx]))
 			{
 				// If it, so we are at least considered an 'overlap' for normal gen
 				VertOverlaps.Add(VertIdx);
@@ -323,6 +957,16 @@ void URuntimeMeshLibrary::CalculateTangentsForMesh(IRuntimeMeshVerticesBuilder*
 	// Number of verts
 	const int32 NumVerts = Vertices->Length();
 
+	// Read everything up front, the loops below touch every vertex many times
+	TArray<FVector> Positions;
+	Vertices->CopyPositions(Positions);
+	const bool bHasUVs = Vertices->HasUVComponent(0);
+	TArray<FVector2D> UVs;
+	if (bHasUVs)
+	{
+		Vertices->CopyUVs(0, UVs);
+	}
+
 	// Map of vertex to triangles in Triangles array
 	TMultiMap<int32, int32> VertToTriMap;
 	// Map of vertex to triangles to consider for normal calculation
@@ -346,11 +990,11 @@ void URuntimeMeshLibrary::CalculateTangentsForMesh(IRuntimeMeshVerticesBuilder*
 			int32 VertIndex = FMath::Min(Triangles->GetIndex((TriIdx * 3) + CornerIdx), NumVerts - 1);
 
 			CornerIndex[CornerIdx] = VertIndex;
-			P[CornerIdx] = Vertices->GetPosition(VertIndex);
+			P[CornerIdx] = Positions[VertIndex];
 
 			// Find/add this vert to index buffer
 			TArray<int32> VertOverlaps;
-			FindVertOverlaps(VertIndex, Vertices, VertOverlaps);
+			FindVertOverlaps(VertIndex, Positions, VertOverlaps);
 
 			// Remember which triangles map to this vert
 			VertToTriMap.AddUnique(VertIndex, TriIdx);
@@ -381,11 +1025,11 @@ void URuntimeMeshLibrary::CalculateTangentsForMesh(IRuntimeMeshVerticesBuilder*
 		const FVector TriNormal = (Edge21 ^ Edge20).GetSafeNormal();
 
 		// If we have UVs, use those to calc 
-		if (Vertices->HasUVComponent(0))
+		if (bHasUVs)
 		{
-			const FVector2D T1 = Vertices->GetUV(CornerIndex[0], 0);
-			const FVector2D T2 = Vertices->GetUV(CornerIndex[1], 0);
-			const FVector2D T3 = Vertices->GetUV(CornerIndex[2], 0);
+			const FVector2D T1 = UVs[CornerIndex[0]];
+			const FVector2D T2 = UVs[CornerIndex[1]];
+			const FVector2D T3 = UVs[CornerIndex[2]];
 
 			FMatrix	ParameterToLocal(
 				FPlane(P[1].X - P[0].X, P[1].Y - P[0].Y, P[1].Z - P[0].Z, 0),
@@ -424,7 +1068,7 @@ void URuntimeMeshLibrary::CalculateTangentsForMesh(IRuntimeMeshVerticesBuilder*
 	VertexTangentZSum.AddZeroed(NumVerts);
 
 	// For each vertex..
-	for (int VertxIdx = 0; VertxIdx < Vertices->Length(); VertxIdx++)
+	for (int VertxIdx = 0; VertxIdx < NumVerts; VertxIdx++)
 	{
 		// Find relevant triangles for normal
 		TArray<int32> SmoothTris;
@@ -449,6 +1093,8 @@ void URuntimeMeshLibrary::CalculateTangentsForMesh(IRuntimeMeshVerticesBuilder*
 	}
 
 	// Finally, normalize tangents and build output arrays
+	TArray<FVector4> OutNormals;
+	OutNormals.SetNumUninitialized(NumVerts);
 	
 	for (int VertxIdx = 0; VertxIdx < NumVerts; VertxIdx++)
 	{
@@ -463,8 +1109,11 @@ void URuntimeMeshLibrary::CalculateTangentsForMesh(IRuntimeMeshVerticesBuilder*
 		TangentX -= TangentZ * (TangentZ | TangentX);
 		TangentX.Normalize();
 
-		Vertices->SetTangents(VertxIdx, TangentX, TangentY, TangentZ);
+		OutNormals[VertxIdx] = FVector4(TangentZ, GetBasisDeterminantSign(TangentX, TangentY, TangentZ));
 	}
+
+	Vertices->SetNormalRange(0, NumVerts, OutNormals.GetData());
+	Vertices->SetTangentRange(0, NumVerts, VertexTangentXSum.GetData());
 }
 
 void URuntimeMeshLibrary::CalculateTangentsForMesh(const TArray<FVector>& Vertices, const TArray<int32>& Triangles, const TArray<FVector2D>& UVs, TArray<FVector>& Normals, TArray<FRuntimeMeshTangent>& Tangents)
@@ -497,7 +1146,7 @@ void URuntimeMeshLibrary::GenerateTessellationIndexBuffer(const TArray<FVector>&
 
 
 
-static int32 GetNewIndexForOldVertIndex(int32 MeshVertIndex, TMap<int32, int32>& MeshToSectionVertMap, const FPositionVertexBuffer* PosBuffer, const FStaticMeshVertexBuffer* VertBuffer, const FColorVertexBuffer* ColorBuffer, IRuntimeMeshVerticesBuilder* Vertices)
+static int32 GetNewIndexForOldVertIndex(int32 MeshVertIndex, TMap<int32, int32>& MeshToSectionVertMap, TArray<int32>& SectionToMeshVert)
 {
 	int32* NewIndexPtr = MeshToSectionVertMap.Find(MeshVertIndex);
 	if (NewIndexPtr != nullptr)
@@ -506,26 +1155,61 @@ static int32 GetNewIndexForOldVertIndex(int32 MeshVertIndex, TMap<int32, int32>&
 	}
 	else
 	{
-		// Copy position
-		int32 SectionVertIndex = Vertices->MoveNextOrAdd();
+		int32 SectionVertIndex = SectionToMeshVert.Add(MeshVertIndex);
+		MeshToSectionVertMap.Add(MeshVertIndex, SectionVertIndex);
+		return SectionVertIndex;
+	}
+}
+
+/* Copies the used vertices of the static mesh into the builder one component at a time */
+static void CopyStaticMeshVertices(const TArray<int32>& SectionToMeshVert, const FPositionVertexBuffer* PosBuffer, const FStaticMeshVertexBuffer* VertBuffer, const FColorVertexBuffer* ColorBuffer, IRuntimeMeshVerticesBuilder* Vertices)
+{
+	const int32 NumVertices = SectionToMeshVert.Num();
+
+	TArray<FVector> Positions;
+	Positions.SetNumUninitialized(NumVertices);
+	for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+	{
+		Positions[VertIdx] = PosBuffer->VertexPosition(SectionToMeshVert[VertIdx]);
+	}
+	Vertices->SetPositionRange(0, NumVertices, Positions.GetData());
 
-		Vertices->SetPosition(PosBuffer->VertexPosition(MeshVertIndex));
-		Vertices->SetNormal(VertBuffer->VertexTangentZ(MeshVertIndex));
-		Vertices->SetTangent(VertBuffer->VertexTangentX(MeshVertIndex));
-		if (ColorBuffer && ColorBuffer->GetNumVertices())
+	TArray<FVector4> Normals;
+	Normals.SetNumUninitialized(NumVertices);
+	for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+	{
+		Normals[VertIdx] = VertBuffer->VertexTangentZ(SectionToMeshVert[VertIdx]);
+	}
+	Vertices->SetNormalRange(0, NumVertices, Normals.GetData());
+
+	// Positions are done, their storage holds the tangents now
+	for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
+	{
+		Positions[VertIdx] = VertBuffer->VertexTangentX(SectionToMeshVert[VertIdx]);
+	}
+	Vertices->SetTangentRange(0, NumVertices, Positions.GetData());
+
+	if (ColorBuffer && ColorBuffer->GetNumVertices())
+	{
+		TArray<FColor> Colors;
+		Colors.SetNumUninitialized(NumVertices);
+		for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
 		{
-			Vertices->SetColor(ColorBuffer->VertexColor(MeshVertIndex));
+			Colors[VertIdx] = ColorBuffer->VertexColor(SectionToMeshVert[VertIdx]);
 		}
+		Vertices->SetColorRange(0, NumVertices, Colors.GetData());
+	}
 
-		// copy all uv channels
-		for (uint32 Index = 0; Index < VertBuffer->GetNumTexCoords(); Index++)
+	// copy all uv channels
+	TArray<FVector2D> UVs;
+	UVs.SetNumUninitialized(NumVertices);
+	for (uint32 Index = 0; Index < VertBuffer->GetNumTexCoords(); Index++)
+	{
+		for (int32 VertIdx = 0; VertIdx < NumVertices; VertIdx++)
 		{
-			Vertices->SetUV(Index, VertBuffer->GetVertexUV(MeshVertIndex, Index));
+			UVs[VertIdx] = VertBuffer->GetVertexUV(SectionToMeshVert[VertIdx], Index);
 		}
-
-		MeshToSectionVertMap.Add(MeshVertIndex, SectionVertIndex);
-
-		return SectionVertIndex;
+		Vertices->SetUVRange(Index, 0, NumVertices, UVs.GetData());
 	}
 }
 
@@ -556,6 +1240,7 @@ void URuntimeMeshLibrary::GetSectionFromStaticMesh(UStaticMesh* InMesh, int32 LO
 
 				// Map from vert buffer for whole mesh to vert buffer for section of interest
 				TMap<int32, int32> MeshToSectionVertMap;
+				TArray<int32> SectionToMeshVert;
 
 				const FStaticMeshSection& Section = LOD.Sections[SectionIndex];
 				const uint32 OnePastLastIndex = Section.FirstIndex + Section.NumTriangles * 3;
@@ -568,7 +1253,7 @@ void URuntimeMeshLibrary::GetSectionFromStaticMesh(UStaticMesh* InMesh, int32 LO
 					uint32 MeshVertIndex = Indices[i];
 
 					// See if we have this vert already in our section vert buffer, and copy vert in if not 
-					int32 SectionVertIndex = GetNewIndexForOldVertIndex(MeshVertIndex, MeshToSectionVertMap, &LOD.PositionVertexBuffer, &LOD.VertexBuffer, &LOD.ColorVertexBuffer, Vertices);
+					int32 SectionVertIndex = GetNewIndexForOldVertIndex(MeshVertIndex, MeshToSectionVertMap, SectionToMeshVert);
 
 					// Add to index buffer
 					Triangles->AddIndex(SectionVertIndex);
@@ -589,12 +1274,14 @@ void URuntimeMeshLibrary::GetSectionFromStaticMesh(UStaticMesh* InMesh, int32 LO
 						uint32 MeshVertIndex = AdjacencyIndices[i];
 
 						// See if we have this vert already in our section vert buffer, and copy vert in if not 
-						int32 SectionVertIndex = GetNewIndexForOldVertIndex(MeshVertIndex, MeshToSectionVertMap, &LOD.PositionVertexBuffer, &LOD.VertexBuffer, &LOD.ColorVertexBuffer, Vertices);
+						int32 SectionVertIndex = GetNewIndexForOldVertIndex(MeshVertIndex, MeshToSectionVertMap, SectionToMeshVert);
 
 						// Add to index buffer
 						AdjacencyTriangles->AddIndex(SectionVertIndex);
 					}
 				}
+
+				CopyStaticMeshVertices(SectionToMeshVert, &LOD.PositionVertexBuffer, &LOD.VertexBuffer, &LOD.ColorVertexBuffer, Vertices);
 			}
 		}
 #endif
@@ -706,3 +1393,34 @@ void URuntimeMeshLibrary::CopyRuntimeMeshFromStaticMeshComponent(UStaticMeshComp
 
 
 #undef LOCTEXT_NAMESPACE
+
+float URuntimeMeshLibrary::BakeAmbientOcclusion(const TArray<URuntimeMeshComponent*>& Components, int32 NumRays, float MaxDistance, bool bSkyVisibility)
+{
+	FRuntimeMeshAOBakeSettings Settings;
+	Settings.NumRays = NumRays;
+	Settings.MaxDistance = MaxDistance;
+	Settings.bSkyVisibility = bSkyVisibility;
+	return (float)FRuntimeMeshAOBaker::Bake(Components, Settings).GetRaysPerSecond();
+}
+
+bool URuntimeMeshLibrary::LineTraceRuntimeMeshes(const TArray<URuntimeMeshComponent*>& Components, const FVector& Start, const FVector& End, FRuntimeMeshQueryHit& OutHit)
+{
+	FRuntimeMeshSceneBVH Scene;
+	Scene.Build(Components);
+	return Scene.LineTrace(Start, End, OutHit);
+}
+
+bool URuntimeMeshLibrary::SweepSphereRuntimeMeshes(const TArray<URuntimeMeshComponent*>& Components, const FVector& Start, const FVector& End, float Radius, FRuntimeMeshQueryHit& OutHit)
+{
+	FRuntimeMeshSceneBVH Scene;
+	Scene.Build(Components);
+	return Scene.SweepSphere(Start, End, Radius, OutHit);
+}
+
+void URuntimeMeshLibrary::OverlapBoxRuntimeMeshes(const TArray<URuntimeMeshComponent*>& Components, const FVector& Center, const FVector& Extent, const FRotator& Rotation, TArray<FRuntimeMeshQueryHit>& OutHits)
+{
+	OutHits.Reset();
+	FRuntimeMeshSceneBVH Scene;
+	Scene.Build(Components);
+	Scene.OverlapBox(Center, Extent, Rotation, OutHits);
+}
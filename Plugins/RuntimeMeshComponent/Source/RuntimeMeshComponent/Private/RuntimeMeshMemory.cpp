@@ -0,0 +1,299 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "RuntimeMeshMemory.h"
+#include "RuntimeMeshComponent.h"
+#include "Tickable.h"
+
+static TAutoConsoleVariable<int32> CVarMemoryBudgetMB(
+	TEXT("RMC.MemoryBudgetMB"),
+	0,
+	TEXT("CPU memory in MB the RuntimeMeshComponents of game worlds may keep, 0 turns the budget off (default).\n")
+	TEXT("Over budget the collision positions and query BVHs are dropped first, then the section data of the components farthest from the view is compressed."));
+
+static int64 GVertexBufferBytes = 0;
+static int64 GIndexBufferBytes = 0;
+
+/** Textures created by the ess importer, only touched on the game thread */
+static TArray<TWeakObjectPtr<UTexture2D>> GImportedTextures;
+
+static double ToMB(int64 Bytes)
+{
+	return Bytes / (1024.0 * 1024.0);
+}
+
+static double ToKB(int64 Bytes)
+{
+	return Bytes / 1024.0;
+}
+
+/** Gathering walks every component, so it isn't done each frame */
+static const float GMemoryUpdateInterval = 1.0f;
+
+/** Enforces RMC.MemoryBudgetMB and keeps the memory stats current while stats are being collected */
+class FRuntimeMeshMemoryTicker : public FTickableGameObject
+{
+public:
+	FRuntimeMeshMemoryTicker() : TimeSinceUpdate(0.0f) { }
+
+	virtual void Tick(float DeltaTime) override
+	{
+		TimeSinceUpdate += DeltaTime;
+		if (TimeSinceUpdate < GMemoryUpdateInterval)
+		{
+			return;
+		}
+		TimeSinceUpdate = 0.0f;
+
+		const int32 BudgetMB = CVarMemoryBudgetMB.GetValueOnGameThread();
+		if (BudgetMB > 0)
+		{
+			FRuntimeMeshMemoryTracker::EnforceBudget((int64)BudgetMB * 1024 * 1024);
+		}
+#if STATS
+		else if (FThreadStats::IsCollectingData())
+		{
+			FRuntimeMeshMemoryTracker::GatherMemory();
+		}
+#endif
+	}
+
+	virtual bool IsTickable() const override { return true; }
+	virtual bool IsTickableInEditor() const override { return true; }
+	virtual TStatId GetStatId() const override { RETURN_QUICK_DECLARE_CYCLE_STAT(FRuntimeMeshMemoryTicker, STATGROUP_Tickables); }
+
+private:
+	float TimeSinceUpdate;
+};
+
+static FRuntimeMeshMemoryTicker* GMemoryTicker = nullptr;
+
+
+void FRuntimeMeshMemoryTracker::TrackVertexBuffer(int64 DeltaBytes)
+{
+	FPlatformAtomics::InterlockedAdd(&GVertexBufferBytes, DeltaBytes);
+}
+
+void FRuntimeMeshMemoryTracker::TrackIndexBuffer(int64 DeltaBytes)
+{
+	FPlatformAtomics::InterlockedAdd(&GIndexBufferBytes, DeltaBytes);
+}
+
+void FRuntimeMeshMemoryTracker::AddTexture(UTexture2D* Texture)
+{
+	check(IsInGameThread());
+
+	if (Texture)
+	{
+		GImportedTextures.Add(Texture);
+	}
+}
+
+int64 FRuntimeMeshMemoryTracker::GetVertexBufferBytes()
+{
+	return GVertexBufferBytes;
+}
+
+int64 FRuntimeMeshMemoryTracker::GetIndexBufferBytes()
+{
+	return GIndexBufferBytes;
+}
+
+int64 FRuntimeMeshMemoryTracker::GetTextureBytes()
+{
+	check(IsInGameThread());
+
+	GImportedTextures.RemoveAllSwap([](const TWeakObjectPtr<UTexture2D>& Texture) { return !Texture.IsValid(); });
+
+	int64 Bytes = 0;
+	for (const TWeakObjectPtr<UTexture2D>& Texture : GImportedTextures)
+	{
+		Bytes += Texture->CalcTextureMemorySizeEnum(TMC_ResidentMips);
+	}
+	return Bytes;
+}
+
+FRuntimeMeshComponentMemory FRuntimeMeshMemoryTracker::GatherMemory(TArray<TPair<URuntimeMeshComponent*, FRuntimeMeshComponentMemory>>* OutComponents)
+{
+	check(IsInGameThread());
+
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Memory_Gather);
+
+	FRuntimeMeshComponentMemory Total;
+	for (TObjectIterator<URuntimeMeshComponent> It; It; ++It)
+	{
+		URuntimeMeshComponent* Component = *It;
+		if (Component->IsTemplate() || Component->IsPendingKill())
+		{
+			continue;
+		}
+
+		FRuntimeMeshComponentMemory Memory;
+		Component->GetMemoryUsage(Memory);
+		Total += Memory;
+
+		if (OutComponents)
+		{
+			OutComponents->Emplace(Component, Memory);
+		}
+	}
+
+	SET_MEMORY_STAT(STAT_RuntimeMesh_Memory_VertexBuffers, GetVertexBufferBytes());
+	SET_MEMORY_STAT(STAT_RuntimeMesh_Memory_IndexBuffers, GetIndexBufferBytes());
+	SET_MEMORY_STAT(STAT_RuntimeMesh_Memory_SectionData, Total.SectionCPUBytes);
+	SET_MEMORY_STAT(STAT_RuntimeMesh_Memory_EvictedData, Total.EvictedBytes);
+	SET_MEMORY_STAT(STAT_RuntimeMesh_Memory_Collision, Total.CollisionBytes);
+	SET_MEMORY_STAT(STAT_RuntimeMesh_Memory_QueryBVH, Total.QueryBytes);
+	SET_MEMORY_STAT(STAT_RuntimeMesh_Memory_Textures, GetTextureBytes());
+
+	return Total;
+}
+
+int64 FRuntimeMeshMemoryTracker::EnforceBudget(int64 BudgetBytes)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Memory_EnforceBudget);
+
+	TArray<TPair<URuntimeMeshComponent*, FRuntimeMeshComponentMemory>> Components;
+	const FRuntimeMeshComponentMemory Total = GatherMemory(&Components);
+
+	const int64 OverBudget = Total.GetCPUBytes() - BudgetBytes;
+	if (OverBudget <= 0)
+	{
+		return 0;
+	}
+
+	// Order the components of game worlds by their distance to the view of the first player, farthest first
+	struct FCandidate
+	{
+		URuntimeMeshComponent* Component;
+		float DistanceSquared;
+	};
+	TArray<FCandidate> Candidates;
+	TMap<UWorld*, FVector> ViewLocations;
+
+	for (const TPair<URuntimeMeshComponent*, FRuntimeMeshComponentMemory>& Entry : Components)
+	{
+		URuntimeMeshComponent* Component = Entry.Key;
+		UWorld* World = Component->GetWorld();
+		if (World == nullptr || !World->IsGameWorld())
+		{
+			continue;
+		}
+
+		const FVector* ViewLocation = ViewLocations.Find(World);
+		if (ViewLocation == nullptr)
+		{
+			FVector Location(FVector::ZeroVector);
+			FRotator Rotation;
+			if (APlayerController* PlayerController = World->GetFirstPlayerController())
+			{
+				PlayerController->GetPlayerViewPoint(Location, Rotation);
+			}
+			ViewLocation = &ViewLocations.Add(World, Location);
+		}
+
+		FCandidate Candidate;
+		Candidate.Component = Component;
+		Candidate.DistanceSquared = FVector::DistSquared(*ViewLocation, Component->Bounds.Origin);
+		Candidates.Add(Candidate);
+	}
+
+	Candidates.Sort([](const FCandidate& A, const FCandidate& B) { return A.DistanceSquared > B.DistanceSquared; });
+
+	// Dropping what is rebuilt on demand is cheap to undo, so all of that goes before any section is evicted
+	int64 FreedBytes = 0;
+	for (const FCandidate& Candidate : Candidates)
+	{
+		if (FreedBytes >= OverBudget)
+		{
+			break;
+		}
+		FreedBytes += Candidate.Component->TrimDerivedData();
+	}
+
+	for (const FCandidate& Candidate : Candidates)
+	{
+		if (FreedBytes >= OverBudget)
+		{
+			break;
+		}
+		if (Candidate.Component->bAllowMemoryEviction)
+		{
+			FreedBytes += Candidate.Component->EvictSectionData();
+		}
+	}
+
+	UE_LOG(RuntimeMeshLog, Verbose, TEXT("Memory budget: %.2f MB over %.2f MB, freed %.2f MB"),
+		ToMB(OverBudget), ToMB(BudgetBytes), ToMB(FreedBytes));
+
+	return FreedBytes;
+}
+
+void FRuntimeMeshMemoryTracker::LogReport(bool bIncludeSections)
+{
+	TArray<TPair<URuntimeMeshComponent*, FRuntimeMeshComponentMemory>> Components;
+	const FRuntimeMeshComponentMemory Total = GatherMemory(&Components);
+
+	Components.Sort([](const TPair<URuntimeMeshComponent*, FRuntimeMeshComponentMemory>& A, const TPair<URuntimeMeshComponent*, FRuntimeMeshComponentMemory>& B)
+	{
+		return A.Value.GetCPUBytes() + A.Value.GetGPUBytes() > B.Value.GetCPUBytes() + B.Value.GetGPUBytes();
+	});
+
+	UE_LOG(RuntimeMeshLog, Log, TEXT("RuntimeMesh memory: %d components, %d sections (%d evicted)"),
+		Components.Num(), Total.NumSections, Total.NumEvictedSections);
+	UE_LOG(RuntimeMeshLog, Log, TEXT("  CPU: %.2f MB sections, %.2f MB evicted, %.2f MB collision, %.2f MB query BVH"),
+		ToMB(Total.SectionCPUBytes), ToMB(Total.EvictedBytes), ToMB(Total.CollisionBytes), ToMB(Total.QueryBytes));
+	UE_LOG(RuntimeMeshLog, Log, TEXT("  GPU: %.2f MB vertex buffers, %.2f MB index buffers (%.2f MB / %.2f MB estimated from the sections)"),
+		ToMB(GetVertexBufferBytes()), ToMB(GetIndexBufferBytes()), ToMB(Total.VertexBufferBytes), ToMB(Total.IndexBufferBytes));
+	UE_LOG(RuntimeMeshLog, Log, TEXT("  Imported textures: %.2f MB"), ToMB(GetTextureBytes()));
+
+	const int32 BudgetMB = CVarMemoryBudgetMB.GetValueOnGameThread();
+	if (BudgetMB > 0)
+	{
+		UE_LOG(RuntimeMeshLog, Log, TEXT("  Budget: %.2f MB of %d MB CPU"), ToMB(Total.GetCPUBytes()), BudgetMB);
+	}
+
+	TArray<FRuntimeMeshSectionMemory> Sections;
+	for (const TPair<URuntimeMeshComponent*, FRuntimeMeshComponentMemory>& Entry : Components)
+	{
+		const FRuntimeMeshComponentMemory& Memory = Entry.Value;
+		UE_LOG(RuntimeMeshLog, Log, TEXT("  %s.%s: CPU %.2f MB (sections %.2f, evicted %.2f, collision %.2f, query %.2f), GPU %.2f MB, %d sections"),
+			*GetNameSafe(Entry.Key->GetOwner()), *Entry.Key->GetName(), ToMB(Memory.GetCPUBytes()), ToMB(Memory.SectionCPUBytes),
+			ToMB(Memory.EvictedBytes), ToMB(Memory.CollisionBytes), ToMB(Memory.QueryBytes), ToMB(Memory.GetGPUBytes()), Memory.NumSections);
+
+		if (bIncludeSections)
+		{
+			Sections.Reset();
+			FRuntimeMeshComponentMemory Unused;
+			Entry.Key->GetMemoryUsage(Unused, &Sections);
+
+			for (const FRuntimeMeshSectionMemory& Section : Sections)
+			{
+				UE_LOG(RuntimeMeshLog, Log, TEXT("    Section %d: CPU %.1f KB, evicted %.1f KB, vertex buffer %.1f KB, index buffer %.1f KB"),
+					Section.SectionIndex, ToKB(Section.CPUBytes), ToKB(Section.EvictedBytes), ToKB(Section.VertexBufferBytes), ToKB(Section.IndexBufferBytes));
+			}
+		}
+	}
+}
+
+void FRuntimeMeshMemoryTracker::Startup()
+{
+	check(GMemoryTicker == nullptr);
+	GMemoryTicker = new FRuntimeMeshMemoryTicker();
+}
+
+void FRuntimeMeshMemoryTracker::Shutdown()
+{
+	delete GMemoryTicker;
+	GMemoryTicker = nullptr;
+}
+
+static void RuntimeMeshMemoryReport(const TArray<FString>& Args)
+{
+	FRuntimeMeshMemoryTracker::LogReport(Args.Num() > 0 && Args[0] == TEXT("Sections"));
+}
+
+static FAutoConsoleCommand GRuntimeMeshMemoryReportCommand(
+	TEXT("RMC.MemoryReport"),
+	TEXT("Logs the CPU and GPU memory of every RuntimeMeshComponent, largest first. Usage: RMC.MemoryReport [Sections]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&RuntimeMeshMemoryReport));
@@ -0,0 +1,807 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "RuntimeMeshOcclusion.h"
+#include "RuntimeMeshComponent.h"
+#include "Containers/Ticker.h"
+
+static TAutoConsoleVariable<int32> CVarOcclusion(
+	TEXT("RMC.Occlusion"),
+	1,
+	TEXT("Software occlusion culling of imported scenes. 0 draws every cluster, 1 culls the occluded ones (default)."));
+
+static TAutoConsoleVariable<int32> CVarOcclusionHardwareQueries(
+	TEXT("RMC.Occlusion.HardwareQueries"),
+	0,
+	TEXT("Keep the engine's occlusion queries for components culled in software as well, read when their proxy is created.\n")
+	TEXT("0 skips them (default), which saves one query per component but leaves small occluders out of the culling."));
+
+static TAutoConsoleVariable<int32> CVarOcclusionResolution(
+	TEXT("RMC.Occlusion.Resolution"),
+	256,
+	TEXT("Width in pixels of the software depth buffer, the height follows the aspect ratio of the view."));
+
+static TAutoConsoleVariable<float> CVarOcclusionMinOccluderSize(
+	TEXT("RMC.Occlusion.MinOccluderSize"),
+	300.0f,
+	TEXT("Bounding sphere radius a component needs to become an occluder when the scene is built."));
+
+static TAutoConsoleVariable<float> CVarOcclusionMinOccluderPixels(
+	TEXT("RMC.Occlusion.MinOccluderPixels"),
+	64.0f,
+	TEXT("Pixels of the depth buffer an occluder has to cover to be rasterized for a view."));
+
+static TAutoConsoleVariable<int32> CVarOcclusionMaxOccluderTriangles(
+	TEXT("RMC.Occlusion.MaxOccluderTriangles"),
+	65536,
+	TEXT("Triangles all occluders of a scene may have together, the largest components get them first."));
+
+// Components per cluster
+static const int32 OCCLUSION_MAX_CLUSTER_COMPONENTS = 8;
+// Components with more triangles cost more to rasterize than they are worth as occluders
+static const int32 OCCLUDER_MAX_COMPONENT_TRIANGLES = 4096;
+// Moves tested boxes slightly closer, an occluder flush with its own box would otherwise hide it
+static const float OCCLUSION_DEPTH_BIAS = 0.001f;
+// Results of views that stopped rendering are dropped after this many frames
+static const uint32 OCCLUSION_VIEW_RETIRE_FRAMES = 120;
+// Seconds from an invalidation to the rebuild, members tend to change in bursts that one rebuild covers
+static const float OCCLUSION_REBUILD_DELAY = 0.25f;
+
+// Culling since the last RMC.OcclusionStats
+static FThreadSafeCounter GOcclusionPasses;
+static FThreadSafeCounter GOcclusionPassMicroseconds;
+static FThreadSafeCounter GOcclusionOccluderTriangles;
+static FThreadSafeCounter GOcclusionClusters;
+static FThreadSafeCounter GOcclusionClustersOccluded;
+static FThreadSafeCounter GOcclusionClustersOutsideView;
+static FThreadSafeCounter GOcclusionPrimitives;
+static FThreadSafeCounter GOcclusionPrimitivesCulled;
+
+
+void FRuntimeMeshDepthBuffer::Init(int32 InWidth, int32 InHeight)
+{
+	// Rows are processed four pixels at a time, so they never end in a partial register
+	Width = Align(FMath::Max(InWidth, 4), 4);
+	Height = FMath::Max(InHeight, 1);
+	Depth.SetNumUninitialized(Width * Height);
+	Clear();
+}
+
+void FRuntimeMeshDepthBuffer::Clear()
+{
+	FMemory::Memzero(Depth.GetData(), Depth.Num() * sizeof(float));
+}
+
+FVector FRuntimeMeshDepthBuffer::ToScreen(const FVector4& Clip) const
+{
+	const float InvW = 1.0f / FMath::Max(Clip.W, KINDA_SMALL_NUMBER);
+	return FVector(
+		(Clip.X * InvW * 0.5f + 0.5f) * Width,
+		(0.5f - Clip.Y * InvW * 0.5f) * Height,
+		Clip.Z * InvW);
+}
+
+int32 FRuntimeMeshDepthBuffer::RasterizeMesh(const FMatrix& WorldToClip, const FVector* Positions, int32 NumPositions, const int32* Indices, int32 NumIndices)
+{
+	if (Width == 0)
+	{
+		return 0;
+	}
+
+	ClipPositions.SetNumUninitialized(NumPositions, false);
+	for (int32 VertexIdx = 0; VertexIdx < NumPositions; VertexIdx++)
+	{
+		ClipPositions[VertexIdx] = WorldToClip.TransformPosition(Positions[VertexIdx]);
+	}
+
+	int32 NumDrawn = 0;
+	for (int32 Index = 0; Index + 2 < NumIndices; Index += 3)
+	{
+		NumDrawn += ClipAndRasterizeTriangle(ClipPositions[Indices[Index]], ClipPositions[Indices[Index + 1]], ClipPositions[Indices[Index + 2]]);
+	}
+	return NumDrawn;
+}
+
+int32 FRuntimeMeshDepthBuffer::ClipAndRasterizeTriangle(const FVector4& C0, const FVector4& C1, const FVector4& C2)
+{
+	// With reversed Z the near plane is at z == w, anything in front of the camera and past it has w - z >= 0
+	const FVector4* Corners[3] = { &C0, &C1, &C2 };
+	float Distances[3];
+	int32 NumInside = 0;
+	for (int32 Corner = 0; Corner < 3; Corner++)
+	{
+		Distances[Corner] = Corners[Corner]->W - Corners[Corner]->Z;
+		NumInside += Distances[Corner] >= 0.0f ? 1 : 0;
+	}
+
+	if (NumInside == 0)
+	{
+		return 0;
+	}
+	if (NumInside == 3)
+	{
+		RasterizeTriangle(ToScreen(C0), ToScreen(C1), ToScreen(C2));
+		return 1;
+	}
+
+	// Clipping a triangle against one plane leaves a triangle or a quad
+	FVector4 Clipped[4];
+	int32 NumClipped = 0;
+	for (int32 Corner = 0; Corner < 3; Corner++)
+	{
+		const int32 Next = (Corner + 1) % 3;
+		const bool bInside = Distances[Corner] >= 0.0f;
+		if (bInside)
+		{
+			Clipped[NumClipped++] = *Corners[Corner];
+		}
+		if (bInside != (Distances[Next] >= 0.0f))
+		{
+			const float T = Distances[Corner] / (Distances[Corner] - Distances[Next]);
+			Clipped[NumClipped++] = *Corners[Corner] + (*Corners[Next] - *Corners[Corner]) * T;
+		}
+	}
+
+	const FVector First = ToScreen(Clipped[0]);
+	for (int32 Corner = 1; Corner + 1 < NumClipped; Corner++)
+	{
+		RasterizeTriangle(First, ToScreen(Clipped[Corner]), ToScreen(Clipped[Corner + 1]));
+	}
+	return 1;
+}
+
+void FRuntimeMeshDepthBuffer::RasterizeTriangle(const FVector& V0, const FVector& V1, const FVector& V2)
+{
+	const float SignedArea = (V1.X - V0.X) * (V2.Y - V0.Y) - (V2.X - V0.X) * (V1.Y - V0.Y);
+	if (FMath::Abs(SignedArea) < SMALL_NUMBER)
+	{
+		return;
+	}
+
+	// Occluders are drawn from both sides, swapping two corners of the back facing ones keeps the inside of every edge positive
+	const FVector& A = V0;
+	const FVector& B = SignedArea > 0.0f ? V1 : V2;
+	const FVector& C = SignedArea > 0.0f ? V2 : V1;
+	const float Area = FMath::Abs(SignedArea);
+
+	const int32 MinX = FMath::Max(0, FMath::FloorToInt(FMath::Min3(A.X, B.X, C.X)));
+	const int32 MaxX = FMath::Min(Width - 1, FMath::FloorToInt(FMath::Max3(A.X, B.X, C.X)));
+	const int32 MinY = FMath::Max(0, FMath::FloorToInt(FMath::Min3(A.Y, B.Y, C.Y)));
+	const int32 MaxY = FMath::Min(Height - 1, FMath::FloorToInt(FMath::Max3(A.Y, B.Y, C.Y)));
+	if (MinX > MaxX || MinY > MaxY)
+	{
+		return;
+	}
+
+	// Edge functions E = EdgeA * x + EdgeB * y + EdgeC of AB, BC and CA, sampled at pixel centers. Each edge is pulled in by
+	// half a pixel along both axes, so only pixels the triangle covers entirely pass and the buffer never hides more than the occluder
+	const FVector* EdgeStarts[3] = { &A, &B, &C };
+	const FVector* EdgeEnds[3] = { &B, &C, &A };
+	float EdgeA[3];
+	float EdgeB[3];
+	float EdgeC[3];
+	for (int32 Edge = 0; Edge < 3; Edge++)
+	{
+		EdgeA[Edge] = EdgeStarts[Edge]->Y - EdgeEnds[Edge]->Y;
+		EdgeB[Edge] = EdgeEnds[Edge]->X - EdgeStarts[Edge]->X;
+		EdgeC[Edge] = -(EdgeA[Edge] * EdgeStarts[Edge]->X + EdgeB[Edge] * EdgeStarts[Edge]->Y) - 0.5f * (FMath::Abs(EdgeA[Edge]) + FMath::Abs(EdgeB[Edge]));
+	}
+
+	// Depth is linear in screen space, Z = DepthX * x + DepthY * y + DepthC. Written as the farthest depth within the pixel, not the one at its center
+	const float DepthX = ((B.Z - A.Z) * (C.Y - A.Y) - (C.Z - A.Z) * (B.Y - A.Y)) / Area;
+	const float DepthY = ((C.Z - A.Z) * (B.X - A.X) - (B.Z - A.Z) * (C.X - A.X)) / Area;
+	const float DepthC = A.Z - DepthX * A.X - DepthY * A.Y - 0.5f * (FMath::Abs(DepthX) + FMath::Abs(DepthY));
+
+	const int32 StartX = MinX & ~3;
+	const VectorRegister Zero = VectorZero();
+	const VectorRegister LaneX = VectorAdd(VectorSetFloat1(StartX + 0.5f), MakeVectorRegister(0.0f, 1.0f, 2.0f, 3.0f));
+	const VectorRegister EdgeA0 = VectorSetFloat1(EdgeA[0]);
+	const VectorRegister EdgeA1 = VectorSetFloat1(EdgeA[1]);
+	const VectorRegister EdgeA2 = VectorSetFloat1(EdgeA[2]);
+	const VectorRegister DepthXVec = VectorSetFloat1(DepthX);
+	const VectorRegister Step0 = VectorSetFloat1(EdgeA[0] * 4.0f);
+	const VectorRegister Step1 = VectorSetFloat1(EdgeA[1] * 4.0f);
+	const VectorRegister Step2 = VectorSetFloat1(EdgeA[2] * 4.0f);
+	const VectorRegister StepDepth = VectorSetFloat1(DepthX * 4.0f);
+
+	for (int32 Y = MinY; Y <= MaxY; Y++)
+	{
+		const float PixelY = Y + 0.5f;
+		VectorRegister E0 = VectorMultiplyAdd(EdgeA0, LaneX, VectorSetFloat1(EdgeB[0] * PixelY + EdgeC[0]));
+		VectorRegister E1 = VectorMultiplyAdd(EdgeA1, LaneX, VectorSetFloat1(EdgeB[1] * PixelY + EdgeC[1]));
+		VectorRegister E2 = VectorMultiplyAdd(EdgeA2, LaneX, VectorSetFloat1(EdgeB[2] * PixelY + EdgeC[2]));
+		VectorRegister Z = VectorMultiplyAdd(DepthXVec, LaneX, VectorSetFloat1(DepthY * PixelY + DepthC));
+
+		float* Row = Depth.GetData() + Y * Width;
+		for (int32 X = StartX; X <= MaxX; X += 4)
+		{
+			const VectorRegister Inside = VectorBitwiseAnd(VectorBitwiseAnd(VectorCompareGE(E0, Zero), VectorCompareGE(E1, Zero)), VectorCompareGE(E2, Zero));
+			if (VectorMaskBits(Inside))
+			{
+				const VectorRegister Previous = VectorLoad(Row + X);
+				VectorStore(VectorSelect(Inside, VectorMax(Previous, Z), Previous), Row + X);
+			}
+
+			E0 = VectorAdd(E0, Step0);
+			E1 = VectorAdd(E1, Step1);
+			E2 = VectorAdd(E2, Step2);
+			Z = VectorAdd(Z, StepDepth);
+		}
+	}
+}
+
+bool FRuntimeMeshDepthBuffer::ProjectBox(const FMatrix& WorldToClip, const FBox& Box, FVector2D& OutMin, FVector2D& OutMax, float& OutMaxDepth) const
+{
+	OutMin = FVector2D(MAX_flt, MAX_flt);
+	OutMax = FVector2D(-MAX_flt, -MAX_flt);
+	OutMaxDepth = 0.0f;
+
+	for (int32 Corner = 0; Corner < 8; Corner++)
+	{
+		const FVector Position(
+			(Corner & 1) ? Box.Max.X : Box.Min.X,
+			(Corner & 2) ? Box.Max.Y : Box.Min.Y,
+			(Corner & 4) ? Box.Max.Z : Box.Min.Z);
+		const FVector4 Clip = WorldToClip.TransformPosition(Position);
+		if (Clip.W - Clip.Z < 0.0f || Clip.W <= KINDA_SMALL_NUMBER)
+		{
+			return false;
+		}
+
+		const FVector Screen = ToScreen(Clip);
+		OutMin.X = FMath::Min(OutMin.X, Screen.X);
+		OutMin.Y = FMath::Min(OutMin.Y, Screen.Y);
+		OutMax.X = FMath::Max(OutMax.X, Screen.X);
+		OutMax.Y = FMath::Max(OutMax.Y, Screen.Y);
+		OutMaxDepth = FMath::Max(OutMaxDepth, Screen.Z);
+	}
+	return true;
+}
+
+FRuntimeMeshDepthBuffer::EBoxVisibility FRuntimeMeshDepthBuffer::TestBox(const FMatrix& WorldToClip, const FBox& Box) const
+{
+	FVector2D Min;
+	FVector2D Max;
+	float MaxDepth;
+	if (Width == 0 || !ProjectBox(WorldToClip, Box, Min, Max, MaxDepth))
+	{
+		return EBoxVisibility::Visible;
+	}
+	if (Max.X < 0.0f || Max.Y < 0.0f || Min.X >= Width || Min.Y >= Height)
+	{
+		return EBoxVisibility::OutsideView;
+	}
+
+	// Every pixel the rectangle touches counts, the closest corner stands in for the whole box
+	const int32 MinX = FMath::Max(0, FMath::FloorToInt(Min.X));
+	const int32 MaxX = FMath::Min(Width - 1, FMath::FloorToInt(Max.X));
+	const int32 MinY = FMath::Max(0, FMath::FloorToInt(Min.Y));
+	const int32 MaxY = FMath::Min(Height - 1, FMath::FloorToInt(Max.Y));
+	const VectorRegister BoxDepth = VectorSetFloat1(MaxDepth * (1.0f + OCCLUSION_DEPTH_BIAS));
+	const int32 StartX = MinX & ~3;
+
+	for (int32 Y = MinY; Y <= MaxY; Y++)
+	{
+		const float* Row = Depth.GetData() + Y * Width;
+		for (int32 X = StartX; X <= MaxX; X += 4)
+		{
+			int32 Lanes = VectorMaskBits(VectorCompareGT(BoxDepth, VectorLoad(Row + X)));
+
+			// Lanes left of MinX or right of MaxX are pixels outside the rectangle
+			if (X < MinX)
+			{
+				Lanes &= 0xF << (MinX - X);
+			}
+			if (X + 3 > MaxX)
+			{
+				Lanes &= 0xF >> (X + 3 - MaxX);
+			}
+			if (Lanes != 0)
+			{
+				return EBoxVisibility::Visible;
+			}
+		}
+	}
+	return EBoxVisibility::Occluded;
+}
+
+
+void FRuntimeMeshOcclusionData::AddOccluder(const TArray<FVector>& Positions, const TArray<int32>& Indices)
+{
+	if (Positions.Num() == 0 || Indices.Num() < 3)
+	{
+		return;
+	}
+
+	FOccluder& Occluder = Occluders[Occluders.AddUninitialized()];
+	Occluder.Bounds = FBox(Positions);
+	Occluder.FirstVertex = OccluderPositions.Num();
+	Occluder.NumVertices = Positions.Num();
+	Occluder.FirstIndex = OccluderIndices.Num();
+	Occluder.NumIndices = Indices.Num() - Indices.Num() % 3;
+
+	OccluderPositions.Append(Positions);
+	OccluderIndices.Append(Indices.GetData(), Occluder.NumIndices);
+}
+
+void FRuntimeMeshOcclusionData::BuildClusters(const TArray<FBox>& ItemBounds, int32 MaxItemsPerCluster)
+{
+	Nodes.Reset();
+	NumClusters = 0;
+	ItemClusters.Init(INDEX_NONE, ItemBounds.Num());
+
+	TArray<FItemEntry> Entries;
+	Entries.Reserve(ItemBounds.Num());
+	for (int32 ItemIdx = 0; ItemIdx < ItemBounds.Num(); ItemIdx++)
+	{
+		if (ItemBounds[ItemIdx].IsValid)
+		{
+			FItemEntry& Entry = Entries[Entries.AddUninitialized()];
+			Entry.ItemIndex = ItemIdx;
+			Entry.Bounds = ItemBounds[ItemIdx];
+		}
+	}
+
+	if (Entries.Num() == 0)
+	{
+		return;
+	}
+
+	MaxItemsPerCluster = FMath::Max(MaxItemsPerCluster, 1);
+	Nodes.Reserve(2 * (Entries.Num() / MaxItemsPerCluster + 1));
+	Nodes.AddUninitialized(1);
+	Subdivide(Entries, 0, 0, Entries.Num(), MaxItemsPerCluster);
+}
+
+void FRuntimeMeshOcclusionData::Subdivide(TArray<FItemEntry>& Entries, int32 NodeIndex, int32 Start, int32 Count, int32 MaxItemsPerCluster)
+{
+	FBox Bounds(ForceInit);
+	FBox CentroidBounds(ForceInit);
+	for (int32 EntryIdx = Start; EntryIdx < Start + Count; EntryIdx++)
+	{
+		Bounds += Entries[EntryIdx].Bounds;
+		CentroidBounds += Entries[EntryIdx].Bounds.GetCenter();
+	}
+
+	Nodes[NodeIndex].Bounds = Bounds;
+	Nodes[NodeIndex].FirstCluster = NumClusters;
+	if (Count <= MaxItemsPerCluster)
+	{
+		Nodes[NodeIndex].FirstChild = INDEX_NONE;
+		Nodes[NodeIndex].NumClusters = 1;
+		for (int32 EntryIdx = Start; EntryIdx < Start + Count; EntryIdx++)
+		{
+			ItemClusters[Entries[EntryIdx].ItemIndex] = NumClusters;
+		}
+		NumClusters++;
+		return;
+	}
+
+	// Same median split as the scene BVH, clusters below a node get consecutive indices so culling a node is a range
+	const FVector CentroidExtent = CentroidBounds.GetSize();
+	const int32 Axis = CentroidExtent.X >= CentroidExtent.Y && CentroidExtent.X >= CentroidExtent.Z ? 0 : (CentroidExtent.Y >= CentroidExtent.Z ? 1 : 2);
+	Sort(Entries.GetData() + Start, Count, [Axis](const FItemEntry& A, const FItemEntry& B)
+	{
+		return A.Bounds.GetCenter()[Axis] < B.Bounds.GetCenter()[Axis];
+	});
+
+	const int32 Middle = Start + Count / 2;
+	const int32 ChildIndex = Nodes.AddUninitialized(2);
+	Nodes[NodeIndex].FirstChild = ChildIndex;
+	Subdivide(Entries, ChildIndex, Start, Middle - Start, MaxItemsPerCluster);
+	Subdivide(Entries, ChildIndex + 1, Middle, Start + Count - Middle, MaxItemsPerCluster);
+	Nodes[NodeIndex].NumClusters = NumClusters - Nodes[NodeIndex].FirstCluster;
+}
+
+void FRuntimeMeshOcclusionData::ComputeVisibility(const FMatrix& WorldToClip, float MinOccluderPixels, FRuntimeMeshDepthBuffer& DepthBuffer, TBitArray<>& OutVisibleClusters, FRuntimeMeshOcclusionStats& OutStats) const
+{
+	OutStats = FRuntimeMeshOcclusionStats();
+	OutStats.NumClusters = NumClusters;
+	OutVisibleClusters.Init(false, NumClusters);
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Occlusion_Rasterize);
+
+		DepthBuffer.Clear();
+		for (const FOccluder& Occluder : Occluders)
+		{
+			// Occluders off screen or small on it hide little for what they cost, the ones crossing the near plane are drawn clipped
+			FVector2D Min;
+			FVector2D Max;
+			float MaxDepth;
+			if (DepthBuffer.ProjectBox(WorldToClip, Occluder.Bounds, Min, Max, MaxDepth))
+			{
+				const float CoveredX = FMath::Min(Max.X, (float)DepthBuffer.GetWidth()) - FMath::Max(Min.X, 0.0f);
+				const float CoveredY = FMath::Min(Max.Y, (float)DepthBuffer.GetHeight()) - FMath::Max(Min.Y, 0.0f);
+				if (CoveredX <= 0.0f || CoveredY <= 0.0f || CoveredX * CoveredY < MinOccluderPixels)
+				{
+					continue;
+				}
+			}
+
+			OutStats.NumOccluders++;
+			OutStats.NumOccluderTriangles += DepthBuffer.RasterizeMesh(WorldToClip,
+				OccluderPositions.GetData() + Occluder.FirstVertex, Occluder.NumVertices,
+				OccluderIndices.GetData() + Occluder.FirstIndex, Occluder.NumIndices);
+		}
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Occlusion_TestClusters);
+
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+		OutStats.NumNodesTested++;
+
+		// A culled node takes every cluster below it along
+		const FRuntimeMeshDepthBuffer::EBoxVisibility Visibility = DepthBuffer.TestBox(WorldToClip, Node.Bounds);
+		if (Visibility == FRuntimeMeshDepthBuffer::EBoxVisibility::Occluded)
+		{
+			OutStats.NumClustersOccluded += Node.NumClusters;
+		}
+		else if (Visibility == FRuntimeMeshDepthBuffer::EBoxVisibility::OutsideView)
+		{
+			OutStats.NumClustersOutsideView += Node.NumClusters;
+		}
+		else if (Node.FirstChild == INDEX_NONE)
+		{
+			OutVisibleClusters[Node.FirstCluster] = true;
+		}
+		else
+		{
+			Stack.Add(Node.FirstChild);
+			Stack.Add(Node.FirstChild + 1);
+		}
+	}
+}
+
+
+/**
+*	World space copy of the opaque, visible sections of a component, false when it has none or more than MaxTriangles.
+*	Evicted sections are left out rather than brought back, part of the mesh still only hides what the whole would.
+*/
+static bool GatherOccluder(URuntimeMeshComponent* Component, int32 MaxTriangles, TArray<FVector>& OutPositions, TArray<int32>& OutIndices)
+{
+	OutPositions.Reset();
+	OutIndices.Reset();
+
+	const FTransform& Transform = Component->GetComponentTransform();
+	const int32 LastSectionIdx = Component->GetLastSectionIndex();
+	for (int32 SectionIdx = 0; SectionIdx <= LastSectionIdx; SectionIdx++)
+	{
+		if (!Component->DoesSectionExist(SectionIdx) || !Component->IsMeshSectionVisible(SectionIdx) || Component->IsSectionEvicted(SectionIdx))
+		{
+			continue;
+		}
+
+		// Masked and translucent sections can be seen through
+		UMaterialInterface* Material = Component->GetMaterial(SectionIdx);
+		if (Material != nullptr && Material->GetBlendMode() != BLEND_Opaque)
+		{
+			continue;
+		}
+
+		const IRuntimeMeshVerticesBuilder* Vertices = nullptr;
+		const FRuntimeMeshIndicesBuilder* SectionIndices = nullptr;
+		Component->GetSectionMesh(SectionIdx, Vertices, SectionIndices);
+
+		bool bOverBudget = false;
+		if (Vertices != nullptr && SectionIndices != nullptr)
+		{
+			const int32 NumTriangles = SectionIndices->Length() / 3;
+			if (OutIndices.Num() / 3 + NumTriangles > MaxTriangles)
+			{
+				bOverBudget = true;
+			}
+			else
+			{
+				const int32 FirstVertex = OutPositions.Num();
+				const int32 NumVertices = Vertices->Length();
+				OutPositions.AddUninitialized(NumVertices);
+				Vertices->GetPositionRange(0, NumVertices, OutPositions.GetData() + FirstVertex);
+				for (int32 VertexIdx = FirstVertex; VertexIdx < FirstVertex + NumVertices; VertexIdx++)
+				{
+					OutPositions[VertexIdx] = Transform.TransformPosition(OutPositions[VertexIdx]);
+				}
+
+				const int32 FirstIndex = OutIndices.AddUninitialized(NumTriangles * 3);
+				SectionIndices->Seek(0);
+				for (int32 Index = 0; Index < NumTriangles * 3; Index++)
+				{
+					OutIndices[FirstIndex + Index] = FirstVertex + SectionIndices->ReadOne();
+				}
+			}
+		}
+
+		delete Vertices;
+		delete SectionIndices;
+
+		if (bOverBudget)
+		{
+			return false;
+		}
+	}
+	return OutIndices.Num() > 0;
+}
+
+bool FRuntimeMeshOcclusionScene::UseHardwareQueries()
+{
+	return CVarOcclusion.GetValueOnAnyThread() == 0 || CVarOcclusionHardwareQueries.GetValueOnAnyThread() != 0;
+}
+
+void FRuntimeMeshOcclusionScene::AddComponent(URuntimeMeshComponent* Component)
+{
+	check(IsInGameThread());
+
+	if (Component == nullptr || Component->GetOcclusionScene() == this)
+	{
+		return;
+	}
+
+	const int32 Slot = Components.Add(Component);
+	Component->SetOcclusionScene(AsShared(), Slot);
+
+	// Members skip the hardware queries, so they are culled from the next rebuild on rather than waiting for the import to
+	// finish. A progressive import adds its placeholders first, their boxes come from the node bounds published at the start
+	ScheduleRebuild();
+}
+
+void FRuntimeMeshOcclusionScene::Build()
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Occlusion_Build);
+	check(IsInGameThread());
+
+	// A rebuild that is still scheduled finds nothing left to do
+	bRebuildPending = false;
+
+	TSharedRef<FRuntimeMeshOcclusionData, ESPMode::ThreadSafe> Data = MakeShareable(new FRuntimeMeshOcclusionData());
+
+	// Slots of components that left the scene or went away keep invalid bounds and no cluster
+	const float MinOccluderSize = CVarOcclusionMinOccluderSize.GetValueOnGameThread();
+	TArray<FBox> ItemBounds;
+	ItemBounds.SetNumUninitialized(Components.Num());
+	MovableSlots.Init(false, Components.Num());
+	TArray<URuntimeMeshComponent*> Candidates;
+	for (int32 Slot = 0; Slot < Components.Num(); Slot++)
+	{
+		URuntimeMeshComponent* Component = Components[Slot].Get();
+		if (Component == nullptr || !Component->IsRegistered() || Component->GetOcclusionScene() != this || Component->GetOcclusionSlot() != Slot)
+		{
+			ItemBounds[Slot].Init();
+			continue;
+		}
+
+		// Cluster boxes and occluders stay where they were built, a member that moves would invalidate them every frame
+		if (Component->Mobility == EComponentMobility::Movable)
+		{
+			ItemBounds[Slot].Init();
+			MovableSlots[Slot] = true;
+			continue;
+		}
+
+		ItemBounds[Slot] = Component->Bounds.GetBox();
+		if (Component->Bounds.SphereRadius >= MinOccluderSize && Component->IsVisible())
+		{
+			Candidates.Add(Component);
+		}
+	}
+
+	// Largest first, so the triangle budget goes to the occluders that hide the most
+	Candidates.Sort([](const URuntimeMeshComponent& A, const URuntimeMeshComponent& B)
+	{
+		return A.Bounds.SphereRadius > B.Bounds.SphereRadius;
+	});
+
+	int32 TriangleBudget = CVarOcclusionMaxOccluderTriangles.GetValueOnGameThread();
+	TArray<FVector> Positions;
+	TArray<int32> Indices;
+	for (URuntimeMeshComponent* Component : Candidates)
+	{
+		if (TriangleBudget <= 0)
+		{
+			break;
+		}
+		if (GatherOccluder(Component, FMath::Min(TriangleBudget, OCCLUDER_MAX_COMPONENT_TRIANGLES), Positions, Indices))
+		{
+			Data->AddOccluder(Positions, Indices);
+			TriangleBudget -= Indices.Num() / 3;
+		}
+	}
+
+	Data->BuildClusters(ItemBounds, OCCLUSION_MAX_CLUSTER_COMPONENTS);
+	Data->SetMovableItems(MovableSlots);
+
+	UE_LOG(RuntimeMeshLog, Log, TEXT("Software occlusion over %d components: %d clusters, %d occluders with %d triangles"),
+		Components.Num(), Data->GetNumClusters(), Data->GetNumOccluders(), Data->GetNumOccluderTriangles());
+
+	bHasRenderData = true;
+	FRuntimeMeshOcclusionDataPtr RenderDataToSet = Data;
+	ENQUEUE_UNIQUE_RENDER_COMMAND_TWOPARAMETER(
+		FRuntimeMeshOcclusionSetData,
+		FRuntimeMeshOcclusionScenePtr, OcclusionScene, AsShared(),
+		FRuntimeMeshOcclusionDataPtr, OcclusionData, RenderDataToSet,
+		{
+			OcclusionScene->SetRenderData_RenderThread(OcclusionData);
+		}
+	);
+}
+
+void FRuntimeMeshOcclusionScene::Invalidate()
+{
+	// Moving a group reaches every component below it, only the first one has anything to do
+	if (!bHasRenderData)
+	{
+		return;
+	}
+	bHasRenderData = false;
+	ScheduleRebuild();
+
+	ENQUEUE_UNIQUE_RENDER_COMMAND_ONEPARAMETER(
+		FRuntimeMeshOcclusionInvalidate,
+		FRuntimeMeshOcclusionScenePtr, OcclusionScene, AsShared(),
+		{
+			OcclusionScene->SetRenderData_RenderThread(nullptr);
+		}
+	);
+}
+
+void FRuntimeMeshOcclusionScene::InvalidateMember(int32 Slot)
+{
+	// Until the rebuild a member that turned movable still has a cluster where it was, so only the last Build decides
+	if (Slot >= 0 && Slot < MovableSlots.Num() && MovableSlots[Slot])
+	{
+		return;
+	}
+	Invalidate();
+}
+
+void FRuntimeMeshOcclusionScene::ScheduleRebuild()
+{
+	check(IsInGameThread());
+
+	if (bRebuildPending)
+	{
+		return;
+	}
+	bRebuildPending = true;
+
+	// Bound weakly, a scene whose last member went away before the delay is simply skipped
+	FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateThreadSafeSP(AsShared(), &FRuntimeMeshOcclusionScene::TickRebuild), OCCLUSION_REBUILD_DELAY);
+}
+
+bool FRuntimeMeshOcclusionScene::TickRebuild(float DeltaTime)
+{
+	if (bRebuildPending)
+	{
+		Build();
+	}
+	return false;
+}
+
+void FRuntimeMeshOcclusionScene::SetRenderData_RenderThread(const FRuntimeMeshOcclusionDataPtr& InRenderData)
+{
+	check(IsInRenderingThread());
+
+	FScopeLock Lock(&ViewLock);
+	RenderData = InRenderData;
+	ViewOcclusions.Empty();
+}
+
+bool FRuntimeMeshOcclusionScene::IsVisible(int32 Slot, const FSceneView& View, const FBox& Bounds)
+{
+	// The data only changes by render commands, never while the views are being set up
+	const FRuntimeMeshOcclusionData* Data = RenderData.Get();
+	if (Data == nullptr || View.State == nullptr || View.Family->EngineShowFlags.Wireframe || CVarOcclusion.GetValueOnAnyThread() == 0)
+	{
+		return true;
+	}
+
+	const bool bMovable = Data->IsItemMovable(Slot);
+	const int32 Cluster = Data->GetItemCluster(Slot);
+	if (!bMovable && Cluster == INDEX_NONE)
+	{
+		return true;
+	}
+
+	bool bVisible;
+	{
+		FScopeLock Lock(&ViewLock);
+
+		FViewOcclusion* ViewOcclusion = ViewOcclusions.Find(View.State);
+		if (ViewOcclusion == nullptr || ViewOcclusion->FrameNumber != GFrameNumberRenderThread || ViewOcclusion->VisibleClusters.Num() != Data->GetNumClusters())
+		{
+			for (auto It = ViewOcclusions.CreateIterator(); It; ++It)
+			{
+				if (GFrameNumberRenderThread - It.Value().FrameNumber > OCCLUSION_VIEW_RETIRE_FRAMES)
+				{
+					It.RemoveCurrent();
+				}
+			}
+
+			// The first proxy asking in a frame does the work for the view, the others wait on the lock
+			ViewOcclusion = &ViewOcclusions.FindOrAdd(View.State);
+			ComputeViewVisibility(*ViewOcclusion, View, *Data);
+		}
+		bVisible = bMovable ? ViewOcclusion->DepthBuffer.IsBoxVisible(ViewOcclusion->WorldToClip, Bounds) : ViewOcclusion->VisibleClusters[Cluster];
+	}
+
+	GOcclusionPrimitives.Increment();
+	INC_DWORD_STAT(STAT_RuntimeMesh_Occlusion_PrimitivesTested);
+	if (!bVisible)
+	{
+		GOcclusionPrimitivesCulled.Increment();
+		INC_DWORD_STAT(STAT_RuntimeMesh_Occlusion_PrimitivesCulled);
+	}
+	return bVisible;
+}
+
+void FRuntimeMeshOcclusionScene::ComputeViewVisibility(FViewOcclusion& ViewOcclusion, const FSceneView& View, const FRuntimeMeshOcclusionData& Data)
+{
+	const uint32 StartCycles = FPlatformTime::Cycles();
+
+	const int32 Width = FMath::Clamp(CVarOcclusionResolution.GetValueOnAnyThread(), 16, 2048);
+	const int32 Height = View.ViewRect.Width() > 0 ? FMath::Max(Width * View.ViewRect.Height() / View.ViewRect.Width(), 4) : Width;
+	if (ViewOcclusion.DepthBuffer.GetWidth() != Align(Width, 4) || ViewOcclusion.DepthBuffer.GetHeight() != Height)
+	{
+		ViewOcclusion.DepthBuffer.Init(Width, Height);
+	}
+
+	FRuntimeMeshOcclusionStats Stats;
+	ViewOcclusion.WorldToClip = View.ViewMatrices.GetViewProjectionMatrix();
+	Data.ComputeVisibility(ViewOcclusion.WorldToClip, CVarOcclusionMinOccluderPixels.GetValueOnAnyThread(),
+		ViewOcclusion.DepthBuffer, ViewOcclusion.VisibleClusters, Stats);
+	ViewOcclusion.FrameNumber = GFrameNumberRenderThread;
+
+	INC_DWORD_STAT_BY(STAT_RuntimeMesh_Occlusion_OccluderTriangles, Stats.NumOccluderTriangles);
+	INC_DWORD_STAT_BY(STAT_RuntimeMesh_Occlusion_ClustersTested, Stats.NumClusters);
+	INC_DWORD_STAT_BY(STAT_RuntimeMesh_Occlusion_ClustersCulled, Stats.GetNumClustersCulled());
+
+	GOcclusionPasses.Increment();
+	GOcclusionPassMicroseconds.Add(FMath::RoundToInt(FPlatformTime::ToMilliseconds(FPlatformTime::Cycles() - StartCycles) * 1000.0f));
+	GOcclusionOccluderTriangles.Add(Stats.NumOccluderTriangles);
+	GOcclusionClusters.Add(Stats.NumClusters);
+	GOcclusionClustersOccluded.Add(Stats.NumClustersOccluded);
+	GOcclusionClustersOutsideView.Add(Stats.NumClustersOutsideView);
+}
+
+static float ToPercent(int32 Part, int32 Total)
+{
+	return Total > 0 ? 100.0f * Part / Total : 0.0f;
+}
+
+void FRuntimeMeshOcclusionScene::LogStats()
+{
+	const int32 Passes = GOcclusionPasses.Reset();
+	const int32 PassMicroseconds = GOcclusionPassMicroseconds.Reset();
+	const int32 OccluderTriangles = GOcclusionOccluderTriangles.Reset();
+	const int32 Clusters = GOcclusionClusters.Reset();
+	const int32 ClustersOccluded = GOcclusionClustersOccluded.Reset();
+	const int32 ClustersOutsideView = GOcclusionClustersOutsideView.Reset();
+	const int32 Primitives = GOcclusionPrimitives.Reset();
+	const int32 PrimitivesCulled = GOcclusionPrimitivesCulled.Reset();
+
+	if (Passes == 0)
+	{
+		UE_LOG(RuntimeMeshLog, Log, TEXT("RMC.OcclusionStats: No view was culled in software since the last report"));
+		return;
+	}
+
+	UE_LOG(RuntimeMeshLog, Log, TEXT("RMC.OcclusionStats: %d view passes, %.3f ms and %d occluder triangles per pass"),
+		Passes, PassMicroseconds / 1000.0f / Passes, OccluderTriangles / Passes);
+	UE_LOG(RuntimeMeshLog, Log, TEXT("RMC.OcclusionStats: Clusters %.1f%% culled, %.1f%% occluded and %.1f%% outside the view, of %d tested"),
+		ToPercent(ClustersOccluded + ClustersOutsideView, Clusters), ToPercent(ClustersOccluded, Clusters), ToPercent(ClustersOutsideView, Clusters), Clusters);
+	UE_LOG(RuntimeMeshLog, Log, TEXT("RMC.OcclusionStats: Primitives past the frustum %.1f%% culled, of %d tested"),
+		ToPercent(PrimitivesCulled, Primitives), Primitives);
+}
+
+static FAutoConsoleCommand GRuntimeMeshOcclusionStatsCommand(
+	TEXT("RMC.OcclusionStats"),
+	TEXT("Logs the culling rate of the software occlusion of imported scenes since the last call"),
+	FConsoleCommandDelegate::CreateStatic(&FRuntimeMeshOcclusionScene::LogStats));
@@ -0,0 +1,384 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "RuntimeMeshOptimizer.h"
+
+const float FRuntimeMeshOptimizer::DefaultOverdrawThreshold = 1.05f;
+
+namespace
+{
+	/**
+	*	FIFO cache emulated with time stamps, a vertex is in the cache while fewer than CacheSize
+	*	misses happened since it was last loaded. Flush() empties it without touching every vertex.
+	*/
+	struct FVertexCacheSimulator
+	{
+		FVertexCacheSimulator(int32 NumVertices, int32 InCacheSize)
+			: CacheSize(InCacheSize)
+			, Time(InCacheSize + 1)
+		{
+			TimeStamps.SetNumZeroed(NumVertices);
+		}
+
+		/** Returns 1 when the vertex had to be transformed */
+		FORCEINLINE int32 Access(int32 Vertex)
+		{
+			if (Time - TimeStamps[Vertex] > CacheSize)
+			{
+				TimeStamps[Vertex] = Time++;
+				return 1;
+			}
+			return 0;
+		}
+
+		FORCEINLINE int32 AccessTriangle(const int32* Triangle)
+		{
+			return Access(Triangle[0]) + Access(Triangle[1]) + Access(Triangle[2]);
+		}
+
+		void Flush()
+		{
+			Time += CacheSize + 1;
+		}
+
+		TArray<int32> TimeStamps;
+		int32 CacheSize;
+		int32 Time;
+	};
+
+	/** Triangles around every vertex, stored back to back */
+	struct FVertexAdjacency
+	{
+		FVertexAdjacency(const TArray<int32>& Indices, int32 NumVertices)
+		{
+			Counts.SetNumZeroed(NumVertices);
+			Offsets.SetNumUninitialized(NumVertices + 1);
+			for (int32 Index : Indices)
+			{
+				Counts[Index]++;
+			}
+
+			int32 Offset = 0;
+			for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+			{
+				Offsets[Vertex] = Offset;
+				Offset += Counts[Vertex];
+			}
+			Offsets[NumVertices] = Offset;
+
+			Triangles.SetNumUninitialized(Indices.Num());
+			TArray<int32> Fill(Offsets.GetData(), NumVertices);
+			for (int32 Index = 0; Index < Indices.Num(); Index++)
+			{
+				Triangles[Fill[Indices[Index]]++] = Index / 3;
+			}
+		}
+
+		/** Triangles using the vertex that weren't emitted yet */
+		TArray<int32> Counts;
+		TArray<int32> Offsets;
+		TArray<int32> Triangles;
+	};
+
+	bool HasValidIndices(const TArray<int32>& Indices, int32 NumVertices)
+	{
+		if (Indices.Num() % 3 != 0)
+		{
+			return false;
+		}
+		for (int32 Index : Indices)
+		{
+			if (Index < 0 || Index >= NumVertices)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+FRuntimeMeshCacheStats FRuntimeMeshOptimizer::AnalyzeVertexCache(const TArray<int32>& Indices, int32 NumVertices, int32 CacheSize)
+{
+	FRuntimeMeshCacheStats Stats;
+	if (!HasValidIndices(Indices, NumVertices))
+	{
+		return Stats;
+	}
+
+	FVertexCacheSimulator Cache(NumVertices, CacheSize);
+	TBitArray<> Referenced(false, NumVertices);
+	for (int32 Index : Indices)
+	{
+		Stats.NumTransforms += Cache.Access(Index);
+		if (!Referenced[Index])
+		{
+			Referenced[Index] = true;
+			Stats.NumVertices++;
+		}
+	}
+	Stats.NumTriangles = Indices.Num() / 3;
+	return Stats;
+}
+
+void FRuntimeMeshOptimizer::OptimizeVertexCache(TArray<int32>& Indices, int32 NumVertices, int32 CacheSize, TArray<int32>* OutClusters)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Optimize_VertexCache);
+
+	if (OutClusters)
+	{
+		OutClusters->Reset();
+	}
+	if (Indices.Num() == 0 || !HasValidIndices(Indices, NumVertices))
+	{
+		return;
+	}
+
+	const int32 NumTriangles = Indices.Num() / 3;
+	FVertexAdjacency Adjacency(Indices, NumVertices);
+	TArray<int32>& LiveTriangles = Adjacency.Counts;
+	TBitArray<> Emitted(false, NumTriangles);
+	TArray<int32> CacheTimeStamps;
+	CacheTimeStamps.SetNumZeroed(NumVertices);
+	TArray<int32> DeadEnds;
+	TArray<int32> Candidates;
+	TArray<int32> Output;
+	Output.Reserve(Indices.Num());
+
+	int32 Time = CacheSize + 1;
+	int32 Cursor = 0;
+	int32 Fanning = 0;
+	bool bStartsCluster = true;
+	while (Fanning >= 0)
+	{
+		// Emit every remaining triangle around the fanning vertex
+		Candidates.Reset();
+		for (int32 AdjacentIdx = Adjacency.Offsets[Fanning]; AdjacentIdx < Adjacency.Offsets[Fanning + 1]; AdjacentIdx++)
+		{
+			const int32 Triangle = Adjacency.Triangles[AdjacentIdx];
+			if (Emitted[Triangle])
+			{
+				continue;
+			}
+			Emitted[Triangle] = true;
+
+			if (bStartsCluster && OutClusters)
+			{
+				OutClusters->Add(Output.Num() / 3);
+			}
+			bStartsCluster = false;
+
+			for (int32 Corner = 0; Corner < 3; Corner++)
+			{
+				const int32 Vertex = Indices[Triangle * 3 + Corner];
+				Output.Add(Vertex);
+				DeadEnds.Add(Vertex);
+				Candidates.Add(Vertex);
+				LiveTriangles[Vertex]--;
+				if (Time - CacheTimeStamps[Vertex] > CacheSize)
+				{
+					CacheTimeStamps[Vertex] = Time++;
+				}
+			}
+		}
+
+		// Continue at the candidate that stays in the cache longest while fanning it, unless fanning it would push it out
+		int32 Best = INDEX_NONE;
+		int32 BestPriority = -1;
+		for (int32 Candidate : Candidates)
+		{
+			if (LiveTriangles[Candidate] > 0)
+			{
+				int32 Priority = 0;
+				if (Time - CacheTimeStamps[Candidate] + 2 * LiveTriangles[Candidate] <= CacheSize)
+				{
+					Priority = Time - CacheTimeStamps[Candidate];
+				}
+				if (Priority > BestPriority)
+				{
+					BestPriority = Priority;
+					Best = Candidate;
+				}
+			}
+		}
+
+		// Dead end, go back to a recently used vertex that still has triangles or else to the next one in order
+		if (Best == INDEX_NONE)
+		{
+			while (DeadEnds.Num() > 0 && Best == INDEX_NONE)
+			{
+				const int32 Vertex = DeadEnds.Pop(false);
+				if (LiveTriangles[Vertex] > 0)
+				{
+					Best = Vertex;
+				}
+			}
+			while (Best == INDEX_NONE && Cursor < NumVertices)
+			{
+				if (LiveTriangles[Cursor] > 0)
+				{
+					Best = Cursor;
+				}
+				Cursor++;
+			}
+			bStartsCluster = true;
+		}
+		Fanning = Best;
+	}
+
+	check(Output.Num() == Indices.Num());
+	Indices = MoveTemp(Output);
+}
+
+void FRuntimeMeshOptimizer::OptimizeOverdraw(TArray<int32>& Indices, const TArray<FVector>& Positions, const TArray<int32>& Clusters, int32 CacheSize, float Threshold)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Optimize_Overdraw);
+
+	const int32 NumTriangles = Indices.Num() / 3;
+	if (NumTriangles == 0 || Clusters.Num() == 0 || !HasValidIndices(Indices, Positions.Num()))
+	{
+		return;
+	}
+
+	// Split the Tipsify runs wherever the ACMR up to that point is within the threshold of the whole run,
+	// smaller clusters sort better and the split costs next to nothing in cache efficiency
+	FVertexCacheSimulator Cache(Positions.Num(), CacheSize);
+	TArray<int32> SoftClusters;
+	for (int32 ClusterIdx = 0; ClusterIdx < Clusters.Num(); ClusterIdx++)
+	{
+		const int32 Start = Clusters[ClusterIdx];
+		const int32 End = ClusterIdx + 1 < Clusters.Num() ? Clusters[ClusterIdx + 1] : NumTriangles;
+
+		Cache.Flush();
+		int32 ClusterTransforms = 0;
+		for (int32 Triangle = Start; Triangle < End; Triangle++)
+		{
+			ClusterTransforms += Cache.AccessTriangle(&Indices[Triangle * 3]);
+		}
+		const float ClusterThreshold = Threshold * ClusterTransforms / (End - Start);
+
+		Cache.Flush();
+		SoftClusters.Add(Start);
+		int32 RunTransforms = 0;
+		int32 RunTriangles = 0;
+		for (int32 Triangle = Start; Triangle < End; Triangle++)
+		{
+			RunTransforms += Cache.AccessTriangle(&Indices[Triangle * 3]);
+			RunTriangles++;
+			if (Triangle + 1 < End && RunTransforms <= ClusterThreshold * RunTriangles)
+			{
+				SoftClusters.Add(Triangle + 1);
+				Cache.Flush();
+				RunTransforms = 0;
+				RunTriangles = 0;
+			}
+		}
+	}
+
+	// Area weighted center of the whole mesh and center and normal of every cluster
+	struct FCluster
+	{
+		int32 Start;
+		int32 End;
+		float SortKey;
+	};
+	TArray<FCluster> SortedClusters;
+	SortedClusters.SetNumUninitialized(SoftClusters.Num());
+	TArray<FVector> ClusterCenters;
+	TArray<FVector> ClusterNormals;
+	ClusterCenters.SetNumZeroed(SoftClusters.Num());
+	ClusterNormals.SetNumZeroed(SoftClusters.Num());
+	FVector MeshCenter = FVector::ZeroVector;
+	float MeshArea = 0.0f;
+	for (int32 ClusterIdx = 0; ClusterIdx < SoftClusters.Num(); ClusterIdx++)
+	{
+		FCluster& Cluster = SortedClusters[ClusterIdx];
+		Cluster.Start = SoftClusters[ClusterIdx];
+		Cluster.End = ClusterIdx + 1 < SoftClusters.Num() ? SoftClusters[ClusterIdx + 1] : NumTriangles;
+
+		float ClusterArea = 0.0f;
+		for (int32 Triangle = Cluster.Start; Triangle < Cluster.End; Triangle++)
+		{
+			const FVector& V0 = Positions[Indices[Triangle * 3]];
+			const FVector& V1 = Positions[Indices[Triangle * 3 + 1]];
+			const FVector& V2 = Positions[Indices[Triangle * 3 + 2]];
+			// Same winding as the tangent generation, so the normal points out of front faces
+			const FVector Normal = (V2 - V0) ^ (V1 - V0);
+			const float Area = Normal.Size();
+			ClusterCenters[ClusterIdx] += (V0 + V1 + V2) * (Area / 3.0f);
+			ClusterNormals[ClusterIdx] += Normal;
+			ClusterArea += Area;
+		}
+
+		MeshCenter += ClusterCenters[ClusterIdx];
+		MeshArea += ClusterArea;
+		ClusterCenters[ClusterIdx] /= ClusterArea > 0.0f ? ClusterArea : 1.0f;
+	}
+	MeshCenter /= MeshArea > 0.0f ? MeshArea : 1.0f;
+
+	for (int32 ClusterIdx = 0; ClusterIdx < SortedClusters.Num(); ClusterIdx++)
+	{
+		SortedClusters[ClusterIdx].SortKey = (ClusterCenters[ClusterIdx] - MeshCenter) | ClusterNormals[ClusterIdx].GetSafeNormal();
+	}
+
+	// Clusters on the outside facing outwards occlude the rest from most directions, draw them first
+	SortedClusters.StableSort([](const FCluster& A, const FCluster& B) { return A.SortKey > B.SortKey; });
+
+	TArray<int32> Output;
+	Output.Reserve(Indices.Num());
+	for (const FCluster& Cluster : SortedClusters)
+	{
+		Output.Append(&Indices[Cluster.Start * 3], (Cluster.End - Cluster.Start) * 3);
+	}
+	Indices = MoveTemp(Output);
+}
+
+void FRuntimeMeshOptimizer::OptimizeVertexFetch(TArray<int32>& Indices, int32 NumVertices, TArray<int32>& OutNewToOld)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Optimize_VertexFetch);
+
+	OutNewToOld.Reset();
+	if (!HasValidIndices(Indices, NumVertices))
+	{
+		return;
+	}
+
+	TArray<int32> OldToNew;
+	OldToNew.Init(INDEX_NONE, NumVertices);
+	OutNewToOld.Reserve(NumVertices);
+	for (int32& Index : Indices)
+	{
+		if (OldToNew[Index] == INDEX_NONE)
+		{
+			OldToNew[Index] = OutNewToOld.Add(Index);
+		}
+		Index = OldToNew[Index];
+	}
+
+	// Keep the vertex count, callers may rely on it
+	for (int32 Vertex = 0; Vertex < NumVertices; Vertex++)
+	{
+		if (OldToNew[Vertex] == INDEX_NONE)
+		{
+			OutNewToOld.Add(Vertex);
+		}
+	}
+}
+
+void FRuntimeMeshOptimizer::Optimize(TArray<int32>& Indices, const TArray<FVector>& Positions, TArray<int32>& OutNewToOld, FRuntimeMeshCacheStats* OutBefore, FRuntimeMeshCacheStats* OutAfter)
+{
+	const int32 NumVertices = Positions.Num();
+	if (OutBefore)
+	{
+		*OutBefore = AnalyzeVertexCache(Indices, NumVertices);
+	}
+
+	TArray<int32> Clusters;
+	OptimizeVertexCache(Indices, NumVertices, DefaultCacheSize, &Clusters);
+	OptimizeOverdraw(Indices, Positions, Clusters);
+	OptimizeVertexFetch(Indices, NumVertices, OutNewToOld);
+
+	if (OutAfter)
+	{
+		*OutAfter = AnalyzeVertexCache(Indices, NumVertices);
+	}
+}
@@ -0,0 +1,143 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "RuntimeMeshQuantizedVertex.h"
+#include "RuntimeMeshBuilder.h"
+
+static TAutoConsoleVariable<int32> CVarQuantizeStaticSections(
+	TEXT("RMC.QuantizeStaticSections"),
+	0,
+	TEXT("0: Infrequent sections are uploaded in their own vertex format (default)\n")
+	TEXT("1: Infrequent sections of components that aren't movable are uploaded with 16 bit positions, packed normals and half precision UVs where they fit"));
+
+const float FRuntimeMeshQuantizer::MaxHalfPrecisionUV = 32.0f;
+
+static int64 GQuantizedSections = 0;
+static int64 GQuantizedVertices = 0;
+static int64 GQuantizedSourceBytes = 0;
+
+RuntimeMeshVertexStructure FRuntimeMeshVertexQuantized::GetVertexStructure(const FVertexBuffer& VertexBuffer)
+{
+	RuntimeMeshVertexStructure VertexStructure;
+	VertexStructure.PositionComponent = RUNTIMEMESH_VERTEXCOMPONENT(VertexBuffer, FRuntimeMeshVertexQuantized, Position, VET_Short4N);
+	VertexStructure.TangentBasisComponents[0] = RUNTIMEMESH_VERTEXCOMPONENT(VertexBuffer, FRuntimeMeshVertexQuantized, TangentX, VET_PackedNormal);
+	VertexStructure.TangentBasisComponents[1] = RUNTIMEMESH_VERTEXCOMPONENT(VertexBuffer, FRuntimeMeshVertexQuantized, TangentZ, VET_PackedNormal);
+	VertexStructure.ColorComponent = RUNTIMEMESH_VERTEXCOMPONENT(VertexBuffer, FRuntimeMeshVertexQuantized, Color, VET_Color);
+	// Both channels are read as one stream component like the generic dual UV vertices do
+	VertexStructure.TextureCoordinates.Add(RUNTIMEMESH_VERTEXCOMPONENT(VertexBuffer, FRuntimeMeshVertexQuantized, UV0, VET_Half4));
+	return VertexStructure;
+}
+
+FRuntimeMeshQuantizationFrame FRuntimeMeshQuantizationFrame::FromBounds(const FBox& Bounds)
+{
+	FRuntimeMeshQuantizationFrame Frame;
+	if (!Bounds.IsValid)
+	{
+		return Frame;
+	}
+
+	Frame.Center = Bounds.GetCenter();
+	Frame.Extent = Bounds.GetExtent();
+	const float MinExtent = FMath::Max(Frame.Extent.GetMax() * 1.0e-3f, KINDA_SMALL_NUMBER);
+	Frame.Extent = Frame.Extent.ComponentMax(FVector(MinExtent));
+	return Frame;
+}
+
+bool FRuntimeMeshQuantizer::IsEnabled()
+{
+	return CVarQuantizeStaticSections.GetValueOnAnyThread() != 0;
+}
+
+bool FRuntimeMeshQuantizer::Quantize(const IRuntimeMeshVerticesBuilder& Vertices, const FRuntimeMeshQuantizationFrame& Frame, TArray<FRuntimeMeshVertexQuantized>& OutVertices)
+{
+	if (!Vertices.HasPositionComponent() || !Vertices.HasNormalComponent() || !Vertices.HasTangentComponent() || Vertices.HasUVComponent(2))
+	{
+		return false;
+	}
+
+	const int32 NumVertices = Vertices.Length();
+	const bool bHasColor = Vertices.HasColorComponent();
+	const bool bHasUV0 = Vertices.HasUVComponent(0);
+	const bool bHasUV1 = Vertices.HasUVComponent(1);
+	const FVector InvExtent = FVector(1.0f) / Frame.Extent;
+	// The section bounds the frame was built from can be user supplied, so they aren't trusted to contain the vertices
+	const float MaxNormalized = 1.0f + KINDA_SMALL_NUMBER;
+	for (int32 Index = 0; Index < NumVertices; Index++)
+	{
+		const FVector Normalized = (Vertices.GetPosition(Index) - Frame.Center) * InvExtent;
+		if (Normalized.GetAbsMax() > MaxNormalized)
+		{
+			return false;
+		}
+
+		if (bHasUV0 || bHasUV1)
+		{
+			const FVector2D UV0 = bHasUV0 ? Vertices.GetUV(Index, 0) : FVector2D::ZeroVector;
+			const FVector2D UV1 = bHasUV1 ? Vertices.GetUV(Index, 1) : FVector2D::ZeroVector;
+			if (UV0.GetAbsMax() > MaxHalfPrecisionUV || UV1.GetAbsMax() > MaxHalfPrecisionUV)
+			{
+				return false;
+			}
+		}
+	}
+
+	OutVertices.SetNumUninitialized(NumVertices);
+	for (int32 Index = 0; Index < NumVertices; Index++)
+	{
+		FRuntimeMeshVertexQuantized& Vertex = OutVertices[Index];
+
+		const FVector Normalized = (Vertices.GetPosition(Index) - Frame.Center) * InvExtent;
+		Vertex.Position.X = (int16)FMath::RoundToInt(FMath::Clamp(Normalized.X, -1.0f, 1.0f) * MAX_int16);
+		Vertex.Position.Y = (int16)FMath::RoundToInt(FMath::Clamp(Normalized.Y, -1.0f, 1.0f) * MAX_int16);
+		Vertex.Position.Z = (int16)FMath::RoundToInt(FMath::Clamp(Normalized.Z, -1.0f, 1.0f) * MAX_int16);
+		Vertex.Position.W = MAX_int16;
+
+		Vertex.TangentX = FPackedNormal(Vertices.GetTangent(Index));
+		Vertex.TangentZ = FPackedNormal(Vertices.GetNormal(Index));
+		Vertex.Color = bHasColor ? Vertices.GetColor(Index) : FColor::White;
+		Vertex.UV0 = FVector2DHalf(bHasUV0 ? Vertices.GetUV(Index, 0) : FVector2D::ZeroVector);
+		Vertex.UV1 = FVector2DHalf(bHasUV1 ? Vertices.GetUV(Index, 1) : FVector2D::ZeroVector);
+	}
+	return true;
+}
+
+void FRuntimeMeshQuantizer::AddSection(int32 NumVertices, int32 SourceStride)
+{
+	FPlatformAtomics::InterlockedIncrement(&GQuantizedSections);
+	FPlatformAtomics::InterlockedAdd(&GQuantizedVertices, (int64)NumVertices);
+	FPlatformAtomics::InterlockedAdd(&GQuantizedSourceBytes, (int64)NumVertices * SourceStride);
+}
+
+void FRuntimeMeshQuantizer::RemoveSection(int32 NumVertices, int32 SourceStride)
+{
+	if (NumVertices == 0)
+	{
+		return;
+	}
+	FPlatformAtomics::InterlockedDecrement(&GQuantizedSections);
+	FPlatformAtomics::InterlockedAdd(&GQuantizedVertices, -(int64)NumVertices);
+	FPlatformAtomics::InterlockedAdd(&GQuantizedSourceBytes, -(int64)NumVertices * SourceStride);
+}
+
+FRuntimeMeshQuantizationStats FRuntimeMeshQuantizer::GetStats()
+{
+	FRuntimeMeshQuantizationStats Stats;
+	Stats.NumSections = GQuantizedSections;
+	Stats.NumVertices = GQuantizedVertices;
+	Stats.SourceBytes = GQuantizedSourceBytes;
+	Stats.QuantizedBytes = Stats.NumVertices * sizeof(FRuntimeMeshVertexQuantized);
+	return Stats;
+}
+
+void FRuntimeMeshQuantizer::LogStats()
+{
+	const FRuntimeMeshQuantizationStats Stats = GetStats();
+	UE_LOG(RuntimeMeshLog, Log, TEXT("Quantized sections: %lld sections, %lld vertices, %.1f -> %.1f bytes/vertex, %.2f MB of vertex buffers saved"),
+		Stats.NumSections, Stats.NumVertices, Stats.GetSourceBytesPerVertex(), Stats.GetQuantizedBytesPerVertex(),
+		(Stats.SourceBytes - Stats.QuantizedBytes) / (1024.0 * 1024.0));
+}
+
+static FAutoConsoleCommand GRuntimeMeshQuantizationReportCommand(
+	TEXT("RMC.QuantizationReport"),
+	TEXT("Logs the vertex buffer memory saved by uploading static sections in the quantized vertex format"),
+	FConsoleCommandDelegate::CreateStatic(&FRuntimeMeshQuantizer::LogStats));
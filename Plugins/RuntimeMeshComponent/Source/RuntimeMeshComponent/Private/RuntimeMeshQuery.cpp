@@ -0,0 +1,384 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "RuntimeMeshQuery.h"
+#include "RuntimeMeshComponent.h"
+
+// Components per leaf of the scene tree
+static const int32 SCENE_MAX_LEAF_COMPONENTS = 2;
+
+void FRuntimeMeshComponentBVH::Gather(URuntimeMeshComponent* Component)
+{
+	Sections.Reset();
+	Positions.Reset();
+	UVs.Reset();
+	Indices.Reset();
+	BVH.Reset();
+
+	const int32 LastSectionIdx = Component->GetLastSectionIndex();
+	for (int32 SectionIdx = 0; SectionIdx <= LastSectionIdx; SectionIdx++)
+	{
+		if (!Component->DoesSectionExist(SectionIdx))
+		{
+			continue;
+		}
+
+		const IRuntimeMeshVerticesBuilder* Vertices = nullptr;
+		const FRuntimeMeshIndicesBuilder* SectionIndices = nullptr;
+		Component->MakeSectionResident(SectionIdx);
+		Component->GetSectionMesh(SectionIdx, Vertices, SectionIndices);
+		if (Vertices != nullptr && SectionIndices != nullptr)
+		{
+			FSection& Section = Sections[Sections.AddUninitialized()];
+			Section.SectionIndex = SectionIdx;
+			Section.FirstVertex = Positions.Num();
+			Section.NumVertices = Vertices->Length();
+			Section.FirstTriangle = Indices.Num() / 3;
+			Section.NumTriangles = SectionIndices->Length() / 3;
+
+			Positions.AddUninitialized(Section.NumVertices);
+			UVs.AddUninitialized(Section.NumVertices);
+			CopySectionVertices(Section, *Vertices);
+
+			// Indices are rebased so all sections share one position array
+			const int32 FirstIndex = Indices.AddUninitialized(Section.NumTriangles * 3);
+			SectionIndices->Seek(0);
+			for (int32 Index = 0; Index < Section.NumTriangles * 3; Index++)
+			{
+				Indices[FirstIndex + Index] = Section.FirstVertex + SectionIndices->ReadOne();
+			}
+		}
+
+		delete Vertices;
+		delete SectionIndices;
+	}
+}
+
+bool FRuntimeMeshComponentBVH::GatherVertices(URuntimeMeshComponent* Component)
+{
+	for (const FSection& Section : Sections)
+	{
+		if (!Component->DoesSectionExist(Section.SectionIndex))
+		{
+			return false;
+		}
+
+		const IRuntimeMeshVerticesBuilder* Vertices = nullptr;
+		const FRuntimeMeshIndicesBuilder* SectionIndices = nullptr;
+		Component->MakeSectionResident(Section.SectionIndex);
+		Component->GetSectionMesh(Section.SectionIndex, Vertices, SectionIndices);
+		const bool bSameTopology = Vertices != nullptr && SectionIndices != nullptr &&
+			Vertices->Length() == Section.NumVertices && SectionIndices->Length() / 3 == Section.NumTriangles;
+		if (bSameTopology)
+		{
+			CopySectionVertices(Section, *Vertices);
+		}
+
+		delete Vertices;
+		delete SectionIndices;
+
+		if (!bSameTopology)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void FRuntimeMeshComponentBVH::CopySectionVertices(const FSection& Section, const IRuntimeMeshVerticesBuilder& Vertices)
+{
+	Vertices.GetPositionRange(0, Section.NumVertices, Positions.GetData() + Section.FirstVertex);
+	if (Vertices.HasUVComponent(0))
+	{
+		Vertices.GetUVRange(0, 0, Section.NumVertices, UVs.GetData() + Section.FirstVertex);
+	}
+	else
+	{
+		FMemory::Memzero(UVs.GetData() + Section.FirstVertex, Section.NumVertices * sizeof(FVector2D));
+	}
+}
+
+void FRuntimeMeshComponentBVH::Build()
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Query_BuildBVH);
+
+	BVH.Reset();
+	BVH.AddTriangles(Positions, Indices);
+	BVH.Build();
+}
+
+void FRuntimeMeshComponentBVH::Refit()
+{
+	BVH.Refit([this](int32 Triangle, FVector& OutV0, FVector& OutV1, FVector& OutV2)
+	{
+		GetTriangle(Triangle, OutV0, OutV1, OutV2);
+	});
+}
+
+void FRuntimeMeshComponentBVH::GetTriangle(int32 Triangle, FVector& OutV0, FVector& OutV1, FVector& OutV2) const
+{
+	OutV0 = Positions[Indices[Triangle * 3 + 0]];
+	OutV1 = Positions[Indices[Triangle * 3 + 1]];
+	OutV2 = Positions[Indices[Triangle * 3 + 2]];
+}
+
+void FRuntimeMeshComponentBVH::FillHit(int32 Triangle, float U, float V, FRuntimeMeshQueryHit& OutHit) const
+{
+	// Last section starting at or before the triangle, empty sections share their start with the next one
+	int32 Low = 0;
+	int32 High = Sections.Num() - 1;
+	while (Low < High)
+	{
+		const int32 Middle = (Low + High + 1) / 2;
+		if (Sections[Middle].FirstTriangle <= Triangle)
+		{
+			Low = Middle;
+		}
+		else
+		{
+			High = Middle - 1;
+		}
+	}
+	const FSection& Section = Sections[Low];
+
+	const int32 I0 = Indices[Triangle * 3 + 0];
+	const int32 I1 = Indices[Triangle * 3 + 1];
+	const int32 I2 = Indices[Triangle * 3 + 2];
+	const float W = 1.0f - U - V;
+
+	OutHit.SectionIndex = Section.SectionIndex;
+	OutHit.TriangleIndex = Triangle - Section.FirstTriangle;
+	OutHit.Barycentrics = FVector(W, U, V);
+	OutHit.Location = Positions[I0] * W + Positions[I1] * U + Positions[I2] * V;
+	// Same winding as the normals the library calculates
+	OutHit.Normal = ((Positions[I1] - Positions[I2]) ^ (Positions[I0] - Positions[I2])).GetSafeNormal();
+	OutHit.UV = UVs[I0] * W + UVs[I1] * U + UVs[I2] * V;
+}
+
+bool FRuntimeMeshComponentBVH::Raycast(const FVector& Origin, const FVector& Direction, float MaxDistance, FRuntimeMeshQueryHit& OutHit) const
+{
+	FRuntimeMeshBVH::FHit Hit;
+	if (!BVH.Raycast(Origin, Direction, MaxDistance, Hit))
+	{
+		return false;
+	}
+
+	FillHit(Hit.TriangleIndex, Hit.U, Hit.V, OutHit);
+	OutHit.Distance = Hit.Distance;
+	return true;
+}
+
+bool FRuntimeMeshComponentBVH::SweepSphere(const FVector& Origin, const FVector& Direction, float Radius, float MaxDistance, FRuntimeMeshQueryHit& OutHit) const
+{
+	FRuntimeMeshBVH::FHit Hit;
+	if (!BVH.SweepSphere(Origin, Direction, Radius, MaxDistance, Hit))
+	{
+		return false;
+	}
+
+	FillHit(Hit.TriangleIndex, Hit.U, Hit.V, OutHit);
+	OutHit.Distance = Hit.Distance;
+	return true;
+}
+
+void FRuntimeMeshComponentBVH::OverlapBox(const FMatrix& BoxToComponent, const FVector& Extent, TArray<FRuntimeMeshQueryHit>& OutHits) const
+{
+	// The tree is searched with the bounds of the box, the candidates are then tested in the space of the box itself
+	TArray<int32> Candidates;
+	BVH.OverlapBox(FBox(-Extent, Extent).TransformBy(BoxToComponent), Candidates);
+
+	const FMatrix ComponentToBox = BoxToComponent.InverseFast();
+	for (int32 Triangle : Candidates)
+	{
+		FVector V0, V1, V2;
+		GetTriangle(Triangle, V0, V1, V2);
+		if (FRuntimeMeshBVH::TriangleIntersectsBox(ComponentToBox.TransformPosition(V0), ComponentToBox.TransformPosition(V1), ComponentToBox.TransformPosition(V2), FVector::ZeroVector, Extent))
+		{
+			FillHit(Triangle, 1.0f / 3.0f, 1.0f / 3.0f, OutHits[OutHits.AddDefaulted()]);
+		}
+	}
+}
+
+
+void FRuntimeMeshSceneBVH::Reset()
+{
+	Components.Reset();
+	Nodes.Reset();
+}
+
+void FRuntimeMeshSceneBVH::Build(const TArray<URuntimeMeshComponent*>& InComponents)
+{
+	SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_Query_BuildSceneBVH);
+
+	Reset();
+
+	// Start every stale build before waiting on any of them so they run on the thread pool side by side
+	for (URuntimeMeshComponent* Component : InComponents)
+	{
+		if (Component != nullptr)
+		{
+			Component->UpdateQueryBVH(true);
+		}
+	}
+
+	for (URuntimeMeshComponent* Component : InComponents)
+	{
+		if (Component == nullptr)
+		{
+			continue;
+		}
+
+		const FRuntimeMeshComponentBVH* ComponentBVH = Component->GetQueryBVH();
+		if (ComponentBVH->IsEmpty())
+		{
+			continue;
+		}
+
+		FComponentEntry& Entry = Components[Components.AddDefaulted()];
+		Entry.Component = Component;
+		Entry.Bounds = ComponentBVH->GetBounds().TransformBy(Component->GetComponentTransform());
+	}
+
+	if (Components.Num() == 0)
+	{
+		return;
+	}
+
+	Nodes.Reserve(Components.Num() * 2);
+	Nodes.AddUninitialized(1);
+	Subdivide(0, 0, Components.Num());
+}
+
+void FRuntimeMeshSceneBVH::Subdivide(int32 NodeIndex, int32 Start, int32 Count)
+{
+	FBox Bounds(ForceInit);
+	FBox CentroidBounds(ForceInit);
+	for (int32 EntryIdx = Start; EntryIdx < Start + Count; EntryIdx++)
+	{
+		Bounds += Components[EntryIdx].Bounds;
+		CentroidBounds += Components[EntryIdx].Bounds.GetCenter();
+	}
+
+	Nodes[NodeIndex].Bounds = Bounds;
+	Nodes[NodeIndex].Start = Start;
+	Nodes[NodeIndex].Count = Count;
+	if (Count <= SCENE_MAX_LEAF_COMPONENTS)
+	{
+		return;
+	}
+
+	// Components are few next to triangles, a median split on the longest axis is good enough
+	const FVector CentroidExtent = CentroidBounds.GetSize();
+	const int32 Axis = CentroidExtent.X >= CentroidExtent.Y && CentroidExtent.X >= CentroidExtent.Z ? 0 : (CentroidExtent.Y >= CentroidExtent.Z ? 1 : 2);
+	Sort(Components.GetData() + Start, Count, [Axis](const FComponentEntry& A, const FComponentEntry& B)
+	{
+		return A.Bounds.GetCenter()[Axis] < B.Bounds.GetCenter()[Axis];
+	});
+
+	const int32 Middle = Start + Count / 2;
+	const int32 ChildIndex = Nodes.AddUninitialized(2);
+	Nodes[NodeIndex].Start = ChildIndex;
+	Nodes[NodeIndex].Count = 0;
+	Subdivide(ChildIndex, Start, Middle - Start);
+	Subdivide(ChildIndex + 1, Middle, Start + Count - Middle);
+}
+
+bool FRuntimeMeshSceneBVH::Trace(const FVector& Start, const FVector& End, float Radius, FRuntimeMeshQueryHit& OutHit) const
+{
+	FVector Direction;
+	float BestDistance;
+	(End - Start).ToDirectionAndLength(Direction, BestDistance);
+	if (Nodes.Num() == 0 || BestDistance <= SMALL_NUMBER)
+	{
+		return false;
+	}
+
+	bool bHit = false;
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+
+		// Every hit shortens the trace the remaining nodes are tested with
+		const FVector ClippedEnd = Start + Direction * BestDistance;
+		if (!FMath::LineBoxIntersection(Node.Bounds.ExpandBy(Radius), Start, ClippedEnd, ClippedEnd - Start))
+		{
+			continue;
+		}
+
+		if (Node.Count == 0)
+		{
+			Stack.Add(Node.Start + 1);
+			Stack.Add(Node.Start);
+			continue;
+		}
+
+		for (int32 EntryIdx = Node.Start; EntryIdx < Node.Start + Node.Count; EntryIdx++)
+		{
+			URuntimeMeshComponent* Component = Components[EntryIdx].Component.Get();
+			if (Component == nullptr)
+			{
+				continue;
+			}
+
+			FRuntimeMeshQueryHit Hit;
+			const bool bComponentHit = Radius > 0.0f ? Component->SweepSphereMesh(Start, ClippedEnd, Radius, Hit) : Component->LineTraceMesh(Start, ClippedEnd, Hit);
+			if (bComponentHit && Hit.Distance <= BestDistance)
+			{
+				BestDistance = Hit.Distance;
+				OutHit = Hit;
+				bHit = true;
+			}
+		}
+	}
+
+	return bHit;
+}
+
+bool FRuntimeMeshSceneBVH::LineTrace(const FVector& Start, const FVector& End, FRuntimeMeshQueryHit& OutHit) const
+{
+	return Trace(Start, End, 0.0f, OutHit);
+}
+
+bool FRuntimeMeshSceneBVH::SweepSphere(const FVector& Start, const FVector& End, float Radius, FRuntimeMeshQueryHit& OutHit) const
+{
+	return Trace(Start, End, FMath::Max(Radius, 0.0f), OutHit);
+}
+
+void FRuntimeMeshSceneBVH::OverlapBox(const FVector& Center, const FVector& Extent, const FRotator& Rotation, TArray<FRuntimeMeshQueryHit>& OutHits) const
+{
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	const FBox WorldBox = FBox(-Extent, Extent).TransformBy(FRotationTranslationMatrix(Rotation, Center));
+	TArray<FRuntimeMeshQueryHit> ComponentHits;
+	TArray<int32, TInlineAllocator<64>> Stack;
+	Stack.Add(0);
+	while (Stack.Num() > 0)
+	{
+		const FNode& Node = Nodes[Stack.Pop(false)];
+		if (!Node.Bounds.Intersect(WorldBox))
+		{
+			continue;
+		}
+
+		if (Node.Count == 0)
+		{
+			Stack.Add(Node.Start + 1);
+			Stack.Add(Node.Start);
+			continue;
+		}
+
+		for (int32 EntryIdx = Node.Start; EntryIdx < Node.Start + Node.Count; EntryIdx++)
+		{
+			if (URuntimeMeshComponent* Component = Components[EntryIdx].Component.Get())
+			{
+				Component->OverlapBoxMesh(Center, Extent, Rotation, ComponentHits);
+				OutHits.Append(ComponentHits);
+			}
+		}
+	}
+}
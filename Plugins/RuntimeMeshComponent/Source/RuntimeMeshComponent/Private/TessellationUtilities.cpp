@@ -33,14 +33,20 @@ void TessellationUtilities::CalculateTessellationIndices(const IRuntimeMeshVerti
 	PosDict.Reserve(Indices->Length());
 
 	TessellationIndices->Reset(PnAenDomCorner_IndicesPerPatch * Indices->Length() / IndicesPerTriangle);
+
+	// Every vertex is read once per triangle using it in both passes, so read them all once up front
+	TArray<FVector> Positions;
+	Vertices->CopyPositions(Positions);
+	TArray<FVector2D> TexCoords;
+	Vertices->CopyUVs(0, TexCoords);
 	
-	ExpandIB(Vertices, Indices, EdgeDict, PosDict, TessellationIndices);
+	ExpandIB(Positions, TexCoords, Indices, EdgeDict, PosDict, TessellationIndices);
 
-	ReplacePlaceholderIndices(Vertices, Indices, EdgeDict, PosDict, TessellationIndices);
+	ReplacePlaceholderIndices(Positions, TexCoords, Indices, EdgeDict, PosDict, TessellationIndices);
 }
 
 
-void TessellationUtilities::ExpandIB(const IRuntimeMeshVerticesBuilder* Vertices, const FRuntimeMeshIndicesBuilder* Indices,
+void TessellationUtilities::ExpandIB(const TArray<FVector>& Positions, const TArray<FVector2D>& TexCoords, const FRuntimeMeshIndicesBuilder* Indices,
 	EdgeDictionary& OutEdgeDict, PositionDictionary& OutPosDict, FRuntimeMeshIndicesBuilder* OutIndices)
 {
 	const uint32 TriangleCount = Indices->Length() / IndicesPerTriangle;
@@ -55,12 +61,9 @@ void TessellationUtilities::ExpandIB(const IRuntimeMeshVerticesBuilder* Vertices
 		const uint32 Index1 = Indices->ReadOne();
 		const uint32 Index2 = Indices->ReadOne();
 
-		Vertices->Seek(Index0);
-		const Vertex Vertex0(Vertices->GetPosition(), Vertices->GetUV(0));
-		Vertices->Seek(Index1);
-		const Vertex Vertex1(Vertices->GetPosition(), Vertices->GetUV(0));
-		Vertices->Seek(Index2);
-		const Vertex Vertex2(Vertices->GetPosition(), Vertices->GetUV(0));
+		const Vertex Vertex0(Positions[Index0], TexCoords[Index0]);
+		const Vertex Vertex1(Positions[Index1], TexCoords[Index1]);
+		const Vertex Vertex2(Positions[Index2], TexCoords[Index2]);
 
 		Triangle Tri(Index0, Index1, Index2, Vertex0, Vertex1, Vertex2);
 
@@ -95,7 +98,7 @@ void TessellationUtilities::ExpandIB(const IRuntimeMeshVerticesBuilder* Vertices
 
 
 
-void TessellationUtilities::ReplacePlaceholderIndices(const IRuntimeMeshVerticesBuilder* Vertices, const FRuntimeMeshIndicesBuilder* Indices,
+void TessellationUtilities::ReplacePlaceholderIndices(const TArray<FVector>& Positions, const TArray<FVector2D>& TexCoords, const FRuntimeMeshIndicesBuilder* Indices,
 	EdgeDictionary& EdgeDict, PositionDictionary& PosDict, FRuntimeMeshIndicesBuilder* OutIndices)
 {
 	const uint32 TriangleCount = Indices->Length() / PnAenDomCorner_IndicesPerPatch;
@@ -109,12 +112,9 @@ void TessellationUtilities::ReplacePlaceholderIndices(const IRuntimeMeshVertices
 		const uint32 Index1 = OutIndices->ReadOne();
 		const uint32 Index2 = OutIndices->ReadOne();
 
-		Vertices->Seek(Index0);
-		const Vertex Vertex0(Vertices->GetPosition(), Vertices->GetUV(0));
-		Vertices->Seek(Index1);
-		const Vertex Vertex1(Vertices->GetPosition(), Vertices->GetUV(0));
-		Vertices->Seek(Index2);
-		const Vertex Vertex2(Vertices->GetPosition(), Vertices->GetUV(0));
+		const Vertex Vertex0(Positions[Index0], TexCoords[Index0]);
+		const Vertex Vertex1(Positions[Index1], TexCoords[Index1]);
+		const Vertex Vertex2(Positions[Index2], TexCoords[Index2]);
 
 		Triangle Tri(Index0, Index1, Index2, Vertex0, Vertex1, Vertex2);
 
@@ -170,9 +170,9 @@ private:
 
 	static void AddIfLeastUV(PositionDictionary& PosDict, const Vertex& Vert, uint32 Index);
 
-	static void ReplacePlaceholderIndices(const IRuntimeMeshVerticesBuilder* Vertices, const FRuntimeMeshIndicesBuilder* Indices,
+	static void ReplacePlaceholderIndices(const TArray<FVector>& Positions, const TArray<FVector2D>& TexCoords, const FRuntimeMeshIndicesBuilder* Indices,
 		EdgeDictionary& EdgeDict, PositionDictionary& PosDict, FRuntimeMeshIndicesBuilder* OutIndices);
 
-	static void ExpandIB(const IRuntimeMeshVerticesBuilder* Vertices, const FRuntimeMeshIndicesBuilder* Indices,
+	static void ExpandIB(const TArray<FVector>& Positions, const TArray<FVector2D>& TexCoords, const FRuntimeMeshIndicesBuilder* Indices,
 		EdgeDictionary& OutEdgeDict, PositionDictionary& OutPosDict, FRuntimeMeshIndicesBuilder* OutIndices);
 };
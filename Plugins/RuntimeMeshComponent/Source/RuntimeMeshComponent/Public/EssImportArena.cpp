@@ -0,0 +1,56 @@
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "EssImportArena.h"
+#include "EssImportProfiler.h"
+
+FEssArenaScope::FEssArenaScope(FEssImportProfiler& inProfiler, bool bArena) : mProfiler(inProfiler), mMark(FMemStack::Get())
+{
+	FEssArenaThreadState& state = FEssArenaThreadState::Get();
+	mbOuterArena = state.bArena;
+	mOuterAllocations = state.allocations;
+	mOuterBytes = state.bytes;
+	state.bArena = bArena;
+	state.allocations = 0;
+	state.bytes = 0;
+}
+
+FEssArenaScope::~FEssArenaScope()
+{
+	FEssArenaThreadState& state = FEssArenaThreadState::Get();
+	mProfiler.AddTransientAllocations(state.allocations, state.bytes, state.bArena);
+	state.bArena = mbOuterArena;
+	state.allocations = mOuterAllocations;
+	state.bytes = mOuterBytes;
+	// mMark pops everything pushed since the scope opened once the destructor body is done
+}
+
+void* FEssArenaScope::Resize(void* pData, bool& bInOutHeap, SIZE_T oldBytes, SIZE_T newBytes, uint32 alignment)
+{
+	if (newBytes == 0)
+	{
+		if (bInOutHeap && NULL != pData)
+		{
+			FMemory::Free(pData);
+		}
+		bInOutHeap = false;
+		return NULL;
+	}
+
+	FEssArenaThreadState& state = FEssArenaThreadState::Get();
+	state.allocations++;
+	state.bytes += newBytes;
+
+	// A container keeps taking memory from where its first allocation came from
+	if (NULL == pData ? !state.bArena : bInOutHeap)
+	{
+		bInOutHeap = true;
+		return FMemory::Realloc(pData, newBytes, alignment);
+	}
+
+	check(newBytes <= (SIZE_T)MAX_int32);
+	void* pNewData = FMemStack::Get().PushBytes((int32)newBytes, alignment);
+	if (NULL != pData)
+	{
+		FMemory::Memcpy(pNewData, pData, FMath::Min(oldBytes, newBytes));
+	}
+	return pNewData;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include "Engine.h"
+#include "Misc/MemStack.h"
+#include "HAL/ThreadSingleton.h"
+
+class FEssImportProfiler;
+
+/* Transient allocations of the calling thread, counted from whichever scope is open on it */
+class FEssArenaThreadState : public TThreadSingleton<FEssArenaThreadState>
+{
+public:
+	FEssArenaThreadState() : bArena(false), allocations(0), bytes(0) { }
+
+	bool bArena;
+	int64 allocations;
+	int64 bytes;
+};
+
+/*
+*	Scope of the transient data of one mesh on a parse worker. While it is open, containers using TEssArenaAllocator
+*	take their memory from the linear per thread FMemStack of the worker, closing the scope releases all of it at once.
+*	With the arena off they use the general heap, the allocations are counted either way and handed to the profiler.
+*/
+class FEssArenaScope
+{
+public:
+	FEssArenaScope(FEssImportProfiler& inProfiler, bool bArena);
+	~FEssArenaScope();
+
+	/* Moves an allocation to newBytes, pData is NULL for containers that have none yet. bInOutHeap tells where it came from. */
+	static void* Resize(void* pData, bool& bInOutHeap, SIZE_T oldBytes, SIZE_T newBytes, uint32 alignment);
+
+private:
+	FEssImportProfiler& mProfiler;
+	FMemMark mMark;
+	bool mbOuterArena;
+	int64 mOuterAllocations;
+	int64 mOuterBytes;
+};
+
+/* Allocator for containers that only live while an FEssArenaScope is open on their thread, outside of one it falls back to the heap */
+template<uint32 Alignment = DEFAULT_ALIGNMENT>
+class TEssArenaAllocator
+{
+public:
+	typedef int32 SizeType;
+
+	enum { NeedsElementType = true };
+	enum { RequireRangeCheck = true };
+
+	template<typename ElementType>
+	class ForElementType
+	{
+	public:
+		ForElementType() : Data(NULL), bHeap(false) { }
+
+		~ForElementType()
+		{
+			if (bHeap && NULL != Data)
+			{
+				FMemory::Free(Data);
+			}
+		}
+
+		FORCEINLINE void MoveToEmpty(ForElementType& Other)
+		{
+			checkSlow(this != &Other);
+			if (bHeap && NULL != Data)
+			{
+				FMemory::Free(Data);
+			}
+			Data = Other.Data;
+			bHeap = Other.bHeap;
+			Other.Data = NULL;
+			Other.bHeap = false;
+		}
+
+		FORCEINLINE ElementType* GetAllocation() const { return Data; }
+
+		void ResizeAllocation(SizeType PreviousNumElements, SizeType NumElements, SIZE_T NumBytesPerElement)
+		{
+			Data = (ElementType*)FEssArenaScope::Resize(Data, bHeap, PreviousNumElements * NumBytesPerElement, NumElements * NumBytesPerElement,
+				FMath::Max(Alignment, (uint32)ALIGNOF(ElementType)));
+		}
+
+		FORCEINLINE SizeType CalculateSlackReserve(SizeType NumElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackReserve(NumElements, NumBytesPerElement, true, Alignment);
+		}
+
+		FORCEINLINE SizeType CalculateSlackShrink(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackShrink(NumElements, NumAllocatedElements, NumBytesPerElement, true, Alignment);
+		}
+
+		FORCEINLINE SizeType CalculateSlackGrow(SizeType NumElements, SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return DefaultCalculateSlackGrow(NumElements, NumAllocatedElements, NumBytesPerElement, true, Alignment);
+		}
+
+		SIZE_T GetAllocatedSize(SizeType NumAllocatedElements, SIZE_T NumBytesPerElement) const
+		{
+			return NumAllocatedElements * NumBytesPerElement;
+		}
+
+		bool HasAllocation()
+		{
+			return NULL != Data;
+		}
+
+	private:
+		ForElementType(const ForElementType&);
+		ForElementType& operator=(const ForElementType&);
+
+		ElementType* Data;
+		/* Set when Data came from the heap and has to be freed, arena memory goes with its scope */
+		bool bHeap;
+	};
+
+	typedef void ForAnyElementType;
+};
+
+typedef TEssArenaAllocator<> FEssArenaAllocator;
+typedef TSetAllocator<TSparseArrayAllocator<FEssArenaAllocator, FEssArenaAllocator>, FEssArenaAllocator> FEssArenaSetAllocator;
@@ -0,0 +1,256 @@
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "EssImportProfiler.h"
+#include "RuntimeMeshProfiling.h"
+
+static TAutoConsoleVariable<int32> CVarEssImportTelemetry(
+	TEXT("RMC.EssImportTelemetry"),
+	1,
+	TEXT("0: Don't profile ESS imports\n")
+	TEXT("1: Log a per stage summary and write JSON/CSV reports to Saved/Profiling/EssImport (default)"));
+
+FEssImportProfiler::FEssImportProfiler() : StartTime(0), bEnabled(false)
+{ }
+
+void FEssImportProfiler::Start(const FString& InSceneName)
+{
+	bEnabled = CVarEssImportTelemetry.GetValueOnAnyThread() != 0;
+	SceneName = InSceneName;
+	StartTime = FPlatformTime::Seconds();
+}
+
+void FEssImportProfiler::BeginStage(EEssImportStage Stage)
+{
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	FStageState& State = States[(int32)Stage];
+	if (State.ActiveScopes++ == 0)
+	{
+		State.FirstBegin = FPlatformTime::Seconds();
+		State.MemoryAtBegin = FPlatformMemory::GetStats().UsedPhysical;
+	}
+}
+
+void FEssImportProfiler::EndStage(EEssImportStage Stage, double ThreadSeconds)
+{
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	FStageState& State = States[(int32)Stage];
+	FEssImportStageRecord& Record = Stages[(int32)Stage];
+	Record.BusySeconds += ThreadSeconds;
+	if (--State.ActiveScopes == 0)
+	{
+		FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+		Record.WallSeconds += FPlatformTime::Seconds() - State.FirstBegin;
+		Record.Calls++;
+		Record.MemoryDeltaBytes += (int64)MemoryStats.UsedPhysical - (int64)State.MemoryAtBegin;
+		Record.PeakUsedPhysical = FMath::Max<uint64>(Record.PeakUsedPhysical, MemoryStats.PeakUsedPhysical);
+	}
+}
+
+void FEssImportProfiler::AddNode(EEssImportStage Stage, const FString& Name, double Seconds, int32 Vertices, int32 Triangles)
+{
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	FEssImportNodeRecord& Node = Nodes[Nodes.AddDefaulted()];
+	Node.Name = Name;
+	Node.Stage = Stage;
+	Node.Seconds = Seconds;
+	Node.ThreadId = FPlatformTLS::GetCurrentThreadId();
+	Node.Vertices = Vertices;
+	Node.Triangles = Triangles;
+}
+
+void FEssImportProfiler::AddTransientAllocations(int64 Allocations, int64 Bytes, bool bArena)
+{
+	if (!bEnabled)
+	{
+		return;
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	Transient.Scopes++;
+	Transient.Allocations += Allocations;
+	Transient.Bytes += Bytes;
+	Transient.PeakScopeBytes = FMath::Max(Transient.PeakScopeBytes, Bytes);
+	Transient.bArena = bArena;
+}
+
+double FEssImportProfiler::AddMilestone(const FString& Name)
+{
+	double Seconds = FPlatformTime::Seconds() - StartTime;
+	if (bEnabled)
+	{
+		FScopeLock ScopeLock(&Lock);
+		Milestones.Emplace(Name, Seconds);
+	}
+	return Seconds;
+}
+
+const TCHAR* FEssImportProfiler::GetStageName(EEssImportStage Stage)
+{
+	switch (Stage)
+	{
+	case EEssImportStage::Parse: return TEXT("Parse");
+	case EEssImportStage::GatherNodes: return TEXT("GatherNodes");
+	case EEssImportStage::BuildMeshes: return TEXT("BuildMeshes");
+	case EEssImportStage::DecodeTextures: return TEXT("DecodeTextures");
+	case EEssImportStage::BuildMaterials: return TEXT("BuildMaterials");
+	case EEssImportStage::CreateComponents: return TEXT("CreateComponents");
+	}
+	return TEXT("Unknown");
+}
+
+TStatId FEssImportProfiler::GetStatId(EEssImportStage Stage)
+{
+	switch (Stage)
+	{
+	case EEssImportStage::Parse: return GET_STATID(STAT_RuntimeMesh_EssImport_Parse);
+	case EEssImportStage::GatherNodes: return GET_STATID(STAT_RuntimeMesh_EssImport_GatherNodes);
+	case EEssImportStage::BuildMeshes: return GET_STATID(STAT_RuntimeMesh_EssImport_BuildMeshes);
+	case EEssImportStage::DecodeTextures: return GET_STATID(STAT_RuntimeMesh_EssImport_DecodeTextures);
+	case EEssImportStage::BuildMaterials: return GET_STATID(STAT_RuntimeMesh_EssImport_BuildMaterials);
+	case EEssImportStage::CreateComponents: return GET_STATID(STAT_RuntimeMesh_EssImport_CreateComponents);
+	}
+	return TStatId();
+}
+
+FString FEssImportProfiler::Finish(bool bSucceeded)
+{
+	if (!bEnabled)
+	{
+		return FString();
+	}
+
+	FScopeLock ScopeLock(&Lock);
+	double TotalSeconds = FPlatformTime::Seconds() - StartTime;
+
+	UE_LOG(RuntimeMeshLog, Log, TEXT("Ess import of %s %s in %.2f ms"), *SceneName, bSucceeded ? TEXT("finished") : TEXT("failed"), TotalSeconds * 1000.0);
+	for (int32 StageIndex = 0; StageIndex < (int32)EEssImportStage::Num; StageIndex++)
+	{
+		const FEssImportStageRecord& Record = Stages[StageIndex];
+		if (Record.Calls > 0)
+		{
+			UE_LOG(RuntimeMeshLog, Log, TEXT("    %-16s wall %9.2f ms  busy %9.2f ms  memory %+8.2f MB"), GetStageName((EEssImportStage)StageIndex),
+				Record.WallSeconds * 1000.0, Record.BusySeconds * 1000.0, Record.MemoryDeltaBytes / (1024.0 * 1024.0));
+		}
+	}
+	if (Transient.Scopes > 0)
+	{
+		UE_LOG(RuntimeMeshLog, Log, TEXT("    %-16s %lld allocations  %.2f MB from the %s  peak %.2f MB per mesh"), TEXT("Transient"), Transient.Allocations,
+			Transient.Bytes / (1024.0 * 1024.0), Transient.bArena ? TEXT("worker arenas") : TEXT("heap"), Transient.PeakScopeBytes / (1024.0 * 1024.0));
+	}
+	for (const TPair<FString, double>& Milestone : Milestones)
+	{
+		UE_LOG(RuntimeMeshLog, Log, TEXT("    %-16s at   %9.2f ms"), *Milestone.Key, Milestone.Value * 1000.0);
+	}
+
+	FString Directory = FPaths::Combine(*FPaths::GameSavedDir(), TEXT("Profiling"), TEXT("EssImport"));
+	FString BaseName = FPaths::Combine(*Directory, *FString::Printf(TEXT("%s-%s"), *FPaths::GetBaseFilename(SceneName), *FDateTime::Now().ToString()));
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	FString JsonFile = BaseName + TEXT(".json");
+	if (!FFileHelper::SaveStringToFile(ToJson(bSucceeded, TotalSeconds), *JsonFile) ||
+		!FFileHelper::SaveStringToFile(ToCsv(), *(BaseName + TEXT(".csv"))))
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Failed to write ess import report %s"), *BaseName);
+		return FString();
+	}
+
+	return JsonFile;
+}
+
+FString FEssImportProfiler::ToJson(bool bSucceeded, double TotalSeconds) const
+{
+	const int32 NumWorkers = FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1);
+
+	FString Json;
+	Json += TEXT("{\n");
+	Json += FString::Printf(TEXT("\t\"scene\": \"%s\",\n"), *SceneName.ReplaceCharWithEscapedChar());
+	Json += FString::Printf(TEXT("\t\"succeeded\": %s,\n"), bSucceeded ? TEXT("true") : TEXT("false"));
+	Json += FString::Printf(TEXT("\t\"engine\": \"%d.%d.%d\",\n"), ENGINE_MAJOR_VERSION, ENGINE_MINOR_VERSION, ENGINE_PATCH_VERSION);
+	Json += FString::Printf(TEXT("\t\"timestamp\": \"%s\",\n"), *FDateTime::UtcNow().ToIso8601());
+	Json += FString::Printf(TEXT("\t\"threads\": %d,\n"), NumWorkers);
+	Json += FString::Printf(TEXT("\t\"total_ms\": %.3f,\n"), TotalSeconds * 1000.0);
+	Json += TEXT("\t\"stages\": [\n");
+
+	bool bFirst = true;
+	for (int32 StageIndex = 0; StageIndex < (int32)EEssImportStage::Num; StageIndex++)
+	{
+		const FEssImportStageRecord& Record = Stages[StageIndex];
+		if (Record.Calls == 0)
+		{
+			continue;
+		}
+
+		// Busy time over the time all threads could have spent in the stage
+		double Utilization = Record.WallSeconds > 0.0 ? Record.BusySeconds / (Record.WallSeconds * NumWorkers) : 0.0;
+
+		Json += bFirst ? TEXT("") : TEXT(",\n");
+		Json += FString::Printf(TEXT("\t\t{ \"name\": \"%s\", \"calls\": %d, \"wall_ms\": %.3f, \"busy_ms\": %.3f, \"utilization\": %.3f, \"memory_delta_bytes\": %lld, \"peak_used_physical_bytes\": %llu }"),
+			GetStageName((EEssImportStage)StageIndex), Record.Calls, Record.WallSeconds * 1000.0, Record.BusySeconds * 1000.0,
+			FMath::Min(Utilization, 1.0), Record.MemoryDeltaBytes, Record.PeakUsedPhysical);
+		bFirst = false;
+	}
+
+	Json += TEXT("\n\t],\n");
+	Json += FString::Printf(TEXT("\t\"transient\": { \"source\": \"%s\", \"scopes\": %d, \"allocations\": %lld, \"bytes\": %lld, \"peak_scope_bytes\": %lld },\n"),
+		Transient.bArena ? TEXT("arena") : TEXT("heap"), Transient.Scopes, Transient.Allocations, Transient.Bytes, Transient.PeakScopeBytes);
+	Json += TEXT("\t\"milestones\": [\n");
+
+	for (int32 MilestoneIndex = 0; MilestoneIndex < Milestones.Num(); MilestoneIndex++)
+	{
+		Json += FString::Printf(TEXT("\t\t{ \"name\": \"%s\", \"ms\": %.3f }%s\n"), *Milestones[MilestoneIndex].Key.ReplaceCharWithEscapedChar(),
+			Milestones[MilestoneIndex].Value * 1000.0, MilestoneIndex + 1 < Milestones.Num() ? TEXT(",") : TEXT(""));
+	}
+
+	Json += TEXT("\t],\n");
+	Json += TEXT("\t\"nodes\": [\n");
+
+	for (int32 NodeIndex = 0; NodeIndex < Nodes.Num(); NodeIndex++)
+	{
+		const FEssImportNodeRecord& Node = Nodes[NodeIndex];
+		Json += FString::Printf(TEXT("\t\t{ \"name\": \"%s\", \"stage\": \"%s\", \"ms\": %.3f, \"thread\": %u, \"vertices\": %d, \"triangles\": %d }%s\n"),
+			*Node.Name.ReplaceCharWithEscapedChar(), GetStageName(Node.Stage), Node.Seconds * 1000.0, Node.ThreadId, Node.Vertices, Node.Triangles,
+			NodeIndex + 1 < Nodes.Num() ? TEXT(",") : TEXT(""));
+	}
+
+	Json += TEXT("\t]\n");
+	Json += TEXT("}\n");
+	return Json;
+}
+
+FString FEssImportProfiler::ToCsv() const
+{
+	FString Csv = TEXT("Kind,Name,Stage,Calls,WallMs,BusyMs,MemoryDeltaBytes,Thread,Vertices,Triangles\n");
+
+	for (int32 StageIndex = 0; StageIndex < (int32)EEssImportStage::Num; StageIndex++)
+	{
+		const FEssImportStageRecord& Record = Stages[StageIndex];
+		if (Record.Calls > 0)
+		{
+			const TCHAR* StageName = GetStageName((EEssImportStage)StageIndex);
+			Csv += FString::Printf(TEXT("Stage,%s,%s,%d,%.3f,%.3f,%lld,,,\n"), StageName, StageName, Record.Calls,
+				Record.WallSeconds * 1000.0, Record.BusySeconds * 1000.0, Record.MemoryDeltaBytes);
+		}
+	}
+
+	for (const FEssImportNodeRecord& Node : Nodes)
+	{
+		Csv += FString::Printf(TEXT("Node,\"%s\",%s,1,%.3f,%.3f,,%u,%d,%d\n"), *Node.Name.Replace(TEXT("\""), TEXT("\"\"")), GetStageName(Node.Stage),
+			Node.Seconds * 1000.0, Node.Seconds * 1000.0, Node.ThreadId, Node.Vertices, Node.Triangles);
+	}
+
+	return Csv;
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include "Engine.h"
+
+/* Stages of an ESS import. Stages nest: components include the materials they build, materials include their texture decodes. */
+enum class EEssImportStage : uint8
+{
+	Parse,
+	GatherNodes,
+	BuildMeshes,
+	DecodeTextures,
+	BuildMaterials,
+	CreateComponents,
+	Num
+};
+
+struct FEssImportStageRecord
+{
+	FEssImportStageRecord() : WallSeconds(0), BusySeconds(0), Calls(0), MemoryDeltaBytes(0), PeakUsedPhysical(0) { }
+
+	/* Time from the first scope opening to the last one closing, summed over separate runs of the stage */
+	double WallSeconds;
+	/* Sum of time all threads spent inside the stage, exceeds WallSeconds when the stage runs in parallel */
+	double BusySeconds;
+	int32 Calls;
+	int64 MemoryDeltaBytes;
+	uint64 PeakUsedPhysical;
+};
+
+/* Short lived containers of the mesh builds, summed over every worker */
+struct FEssImportTransientRecord
+{
+	FEssImportTransientRecord() : Scopes(0), Allocations(0), Bytes(0), PeakScopeBytes(0), bArena(false) { }
+
+	int32 Scopes;
+	int64 Allocations;
+	int64 Bytes;
+	/* Most bytes a single scope allocated, what one worker needs in its arena at a time */
+	int64 PeakScopeBytes;
+	/* Whether the memory came from the per worker arenas rather than the heap */
+	bool bArena;
+};
+
+struct FEssImportNodeRecord
+{
+	FString Name;
+	EEssImportStage Stage;
+	double Seconds;
+	uint32 ThreadId;
+	int32 Vertices;
+	int32 Triangles;
+};
+
+/**
+*	Collects per stage and per node timings and memory for one ESS import and writes them as JSON and CSV.
+*	Scopes may be opened from any thread, the ones opened from ParallelFor workers count towards BusySeconds.
+*/
+class FEssImportProfiler
+{
+public:
+	FEssImportProfiler();
+
+	void Start(const FString& InSceneName);
+
+	void BeginStage(EEssImportStage Stage);
+	void EndStage(EEssImportStage Stage, double ThreadSeconds);
+
+	void AddNode(EEssImportStage Stage, const FString& Name, double Seconds, int32 Vertices = 0, int32 Triangles = 0);
+
+	/* Adds the transient allocations of one FEssArenaScope */
+	void AddTransientAllocations(int64 Allocations, int64 Bytes, bool bArena);
+
+	/* Records a point in time of the import, like the first frame that shows something. Returns the seconds since Start. */
+	double AddMilestone(const FString& Name);
+
+	bool IsEnabled() const { return bEnabled; }
+	const FString& GetSceneName() const { return SceneName; }
+	const FEssImportStageRecord& GetStage(EEssImportStage Stage) const { return Stages[(int32)Stage]; }
+	const FEssImportTransientRecord& GetTransient() const { return Transient; }
+
+	/* Logs a summary and writes the reports to Saved/Profiling/EssImport. Returns the JSON path or an empty string. */
+	FString Finish(bool bSucceeded);
+
+	static const TCHAR* GetStageName(EEssImportStage Stage);
+	static TStatId GetStatId(EEssImportStage Stage);
+
+private:
+	FString ToJson(bool bSucceeded, double TotalSeconds) const;
+	FString ToCsv() const;
+
+	struct FStageState
+	{
+		FStageState() : ActiveScopes(0), FirstBegin(0), MemoryAtBegin(0) { }
+
+		int32 ActiveScopes;
+		double FirstBegin;
+		uint64 MemoryAtBegin;
+	};
+
+	FCriticalSection Lock;
+	FString SceneName;
+	double StartTime;
+	bool bEnabled;
+	FEssImportStageRecord Stages[(int32)EEssImportStage::Num];
+	FStageState States[(int32)EEssImportStage::Num];
+	FEssImportTransientRecord Transient;
+	TArray<FEssImportNodeRecord> Nodes;
+	TArray<TPair<FString, double>> Milestones;
+};
+
+/* Times a stage on the calling thread, optionally recording it as a node */
+class FEssImportScope
+{
+public:
+	FEssImportScope(FEssImportProfiler& InProfiler, EEssImportStage InStage, const FString* InNodeName = nullptr)
+		: Profiler(InProfiler), Stage(InStage), NodeName(InNodeName), Vertices(0), Triangles(0)
+		, CycleCounter(FEssImportProfiler::GetStatId(InStage)), StartTime(FPlatformTime::Seconds())
+	{
+		Profiler.BeginStage(Stage);
+	}
+
+	~FEssImportScope()
+	{
+		double Seconds = FPlatformTime::Seconds() - StartTime;
+		if (NodeName)
+		{
+			Profiler.AddNode(Stage, *NodeName, Seconds, Vertices, Triangles);
+		}
+		Profiler.EndStage(Stage, Seconds);
+	}
+
+	void SetGeometry(int32 InVertices, int32 InTriangles)
+	{
+		Vertices = InVertices;
+		Triangles = InTriangles;
+	}
+
+private:
+	FEssImportProfiler& Profiler;
+	EEssImportStage Stage;
+	const FString* NodeName;
+	int32 Vertices;
+	int32 Triangles;
+	FScopeCycleCounter CycleCounter;
+	double StartTime;
+};
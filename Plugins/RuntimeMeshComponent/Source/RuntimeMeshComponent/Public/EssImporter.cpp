@@ -1,14 +1,45 @@
 #include "RuntimeMeshComponentPluginPrivatePCH.h"
 #include "EssImporter.h"
+#include "EssMaterialPermutations.h"
+#include "EssImportArena.h"
+#include "RuntimeMeshMemory.h"
+#include "Materials/MaterialInstanceConstant.h"
 #include "Classes/Engine/World.h"
 #include "Public/Async/ParallelFor.h"
 #include "Public/Interfaces/IImageWrapper.h"
 #include "Public/Interfaces/IImageWrapperModule.h"
 
 #define MULTI_THREADING_BUILD 1
-#define INVERT_VERTEX_ORDER_FOR_NEGATIVE_SACLE 0
+// The build order of a progressive import is refreshed once the view moved further than this
+#define PROGRESSIVE_RESORT_DISTANCE 500.0f
+// Instance groups nested deeper than this are taken for a cycle and skipped
+#define MAX_INSTANCE_GROUP_DEPTH 32
 #undef UpdateResource
 
+static TAutoConsoleVariable<int32> CVarEssNativeReader(
+	TEXT("RMC.EssNativeReader"),
+	0,
+	TEXT("0: Parse ess files with the Elara SDK where it is available (default)\n")
+	TEXT("1: Parse them with the plugin's own multithreaded reader, always used on platforms without the SDK"));
+
+static TAutoConsoleVariable<int32> CVarEssOptimizeMeshes(
+	TEXT("RMC.EssOptimizeMeshes"),
+	1,
+	TEXT("0: Keep the face order of the ess file and the vertex order of the welding\n")
+	TEXT("1: Reorder imported sections for the vertex cache, overdraw and vertex fetch on the parse workers (default)"));
+
+static TAutoConsoleVariable<int32> CVarEssProgressiveImport(
+	TEXT("RMC.EssProgressiveImport"),
+	0,
+	TEXT("0: Create the components once every mesh of the scene is built, in node order (default)\n")
+	TEXT("1: Show boxes at the node bounds as soon as the nodes are read, build and swap in the meshes nearest the camera first"));
+
+static TAutoConsoleVariable<int32> CVarEssImportArena(
+	TEXT("RMC.EssImportArena"),
+	1,
+	TEXT("0: Allocate the transient data of each mesh build on the general heap\n")
+	TEXT("1: Allocate it from a linear arena per worker that is reset once the mesh is built (default)"));
+
 enum EShaderID
 {
 	SHADER_ID_BITMAP,
@@ -48,19 +79,50 @@ extern int32 GetShaderTypeID(const FString& shaderType)
 	return INDEX_NONE;
 }
 
-FEssImporter::FEssImporter() : m_pThread(NULL), mParseResult(false), mbInEditor(false)
-{ }
+FEssImporter::FEssImporter() : m_pThread(NULL), mParseResult(false), mResolvedMaterialCount(0), mbInEditor(false), mbBlockingContext(false),
+	mViewLocation(FVector::ZeroVector), mbHasViewLocation(false)
+{
+	mEssMaterials[0] = mEssMaterials[1] = NULL;
+	SetNativeReader(CVarEssNativeReader.GetValueOnAnyThread() != 0);
+	SetProgressive(CVarEssProgressiveImport.GetValueOnAnyThread() != 0);
+	mbTransientArena = CVarEssImportArena.GetValueOnAnyThread() != 0;
+}
 
 FEssImporter::~FEssImporter()
 {
-	if (m_pThread)
+#if WITH_ERSDK
+	if (!mbNativeReader && (m_pThread || mbBlockingContext))
 	{
 		ei_end_context();
+	}
+#endif
+	if (m_pThread)
+	{
 		delete m_pThread;
 		m_pThread = nullptr;
 	}
 }
 
+void FEssImporter::SetNativeReader(bool bNativeReader)
+{
+	if (m_pThread || mbBlockingContext)
+	{
+		return;
+	}
+
+	mbNativeReader = bNativeReader || !WITH_ERSDK;
+}
+
+void FEssImporter::SetProgressive(bool bProgressive)
+{
+	if (m_pThread || mbBlockingContext)
+	{
+		return;
+	}
+
+	mbProgressive = bProgressive;
+}
+
 bool FEssImporter::Initialize(const FString& FullPath, const FTimerDelegate& timerDelegate, bool inEditor)
 {
 	if (!FPaths::FileExists(FullPath))
@@ -68,14 +130,44 @@ bool FEssImporter::Initialize(const FString& FullPath, const FTimerDelegate& tim
 		return false;
 	}
 
-	ei_context();
+#if WITH_ERSDK
+	if (!mbNativeReader)
+	{
+		ei_context();
+	}
+#endif
 	m_strFullPath = FullPath;
+	mProfiler.Start(FullPath);
+	PrepareMaterialLayouts();
 	m_pThread = FRunnableThread::Create(this, TEXT("FEssImporter"), 0, EThreadPriority::TPri_BelowNormal);
-	GEngine->GameViewport->GetWorld()->GetTimerManager().SetTimer(mTimerHandle, timerDelegate, 1.0f, true);
+	// Progressive imports have work for the game thread long before the parse finishes
+	GEngine->GameViewport->GetWorld()->GetTimerManager().SetTimer(mTimerHandle, timerDelegate, mbProgressive ? 0.05f : 1.0f, true);
 	mbInEditor = inEditor;
 	return true;
 }
 
+bool FEssImporter::ParseBlocking(const FString& FullPath)
+{
+	if (m_pThread || mbBlockingContext || !FPaths::FileExists(FullPath))
+	{
+		return false;
+	}
+
+#if WITH_ERSDK
+	if (!mbNativeReader)
+	{
+		ei_context();
+	}
+#endif
+	mbBlockingContext = true;
+	mbProgressive = false;
+	m_strFullPath = FullPath;
+	mProfiler.Start(FullPath);
+	PrepareMaterialLayouts();
+	mParseResult = DoParseEssFile();
+	return mParseResult;
+}
+
 struct FVertexKey
 {
 	int32 indices[5];
@@ -107,112 +199,188 @@ bool FEssImporter::CheckParseFinished()
 {
 	if (mParseFinished.AtomicSet(false))
 	{
-		GEngine->GameViewport->GetWorld()->GetTimerManager().ClearTimer(mTimerHandle);
+		if (!mbProgressive)
+		{
+			StopPolling();
+		}
 		return true;
 	}
 
 	return false;
 }
 
-eiTag getArrayTag(const eiDataAccessor<eiNode>& node, const char* arrayName)
+void FEssImporter::StopPolling()
 {
-	eiIndex index = ei_node_find_param(node.get(), arrayName);
-	if (index != EI_NULL_INDEX)
-	{
-		return ei_node_get_array(node.get(), index);
-	}
+	GEngine->GameViewport->GetWorld()->GetTimerManager().ClearTimer(mTimerHandle);
+}
 
-	return EI_NULL_TAG;
+const FBox& FEssImporter::GetMeshBounds(const FString& meshName) const
+{
+	static const FBox emptyBounds(ForceInit);
+	const FMeshMapInfo* pMeshMapInfo = mMeshMap.Find(meshName);
+	return NULL != pMeshMapInfo ? pMeshMapInfo->bounds : emptyBounds;
 }
 
-bool FEssImporter::ParseMesh(const eiNodeAccessor& node, FMeshMapInfo& meshMapInfo)
+float FEssImporter::GetNodeScreenSize(int nodeIndex, const FVector& viewLocation) const
 {
-	TMeshArray& meshArray = meshMapInfo.meshArray;
-	eiTag positionsTag = getArrayTag(node, "pos_list");
-	if (EI_NULL_TAG == positionsTag)
-	{
-		return false;
-	}
-	eiTag triListTag = getArrayTag(node, "triangle_list");
-	if (EI_NULL_TAG == triListTag)
-	{
-		return false;
-	}
-	eiTag normalTag = getArrayTag(node, "N");
-	if (EI_NULL_TAG == normalTag)
-	{
-		return  false;
-	}
-	eiTag normalIndicesTag = getArrayTag(node, "N_idx");
-	if (EI_NULL_TAG == normalIndicesTag)
+	if (!mNodeBounds.IsValidIndex(nodeIndex))
 	{
-		return false;
+		return 0.0f;
 	}
 
-	eiTag uv1Tag = getArrayTag(node, "uv1");
-	eiTag uv1IndicesTag = getArrayTag(node, "uv1_idx"); 
-	eiTag uv2Tag = getArrayTag(node, "uv2"); 
-	eiTag uv2IndicesTag = getArrayTag(node, "uv2_idx"); 
-	eiTag dPduTag = getArrayTag(node, "dPdu"); 
-	eiTag dPduIndicesTag = getArrayTag(node, "dPdu_idx"); 
+	// Nodes around the view cover all of it
+	const FBoxSphereBounds& bounds = mNodeBounds[nodeIndex];
+	float distance = FVector::Dist(bounds.Origin, viewLocation);
+	return bounds.SphereRadius / FMath::Max3(distance, bounds.SphereRadius, KINDA_SMALL_NUMBER);
+}
 
-	eiDataTableAccessor<eiIndex> tri_list(triListTag);
-	eiDataTableAccessor<eiVector> positions(positionsTag);
-	eiDataTableAccessor<eiVector> normals(normalTag);
-	eiDataTableAccessor<eiIndex> normalIndices(normalIndicesTag);
-	eiDataTableAccessor<eiVector> uv1s(uv1Tag);
-	eiDataTableAccessor<eiIndex> uv1Indices(uv1IndicesTag);
-	eiDataTableAccessor<eiVector> uv2s(uv2Tag);
-	eiDataTableAccessor<eiIndex> uv2Indices(uv2IndicesTag);
-	eiDataTableAccessor<eiVector> dPdus(dPduTag);
-	eiDataTableAccessor<eiIndex> dPduIndices(dPduIndicesTag);
+void FEssImporter::SetViewLocation(const FVector& viewLocation)
+{
+	FScopeLock lock(&mViewLock);
+	mViewLocation = viewLocation;
+	mbHasViewLocation = true;
+}
+
+bool FEssImporter::GetViewLocation(FVector& outViewLocation)
+{
+	FScopeLock lock(&mViewLock);
+	outViewLocation = mViewLocation;
+	return mbHasViewLocation;
+}
 
-	TArray<FVector> Vertices;
-	TArray<FVector> Normals;
-	TArray<FVector2D> Uv1s;
-	TArray<FVector2D> Uv2s;
-	TArray<FRuntimeMeshTangent> Tangents;
-	int channelNum = 2 + (EI_NULL_TAG != uv1Tag) + (EI_NULL_TAG != uv2Tag) + (EI_NULL_TAG != dPduTag);
+bool FEssImporter::PopReadyMesh(FString& outMeshName)
+{
+	return mReadyMeshes.Dequeue(outMeshName);
+}
 
-	for (int i = 0; i < positions.size(); ++i)
+void FEssImporter::PublishNodes()
+{
+	mNodeBounds.SetNumUninitialized(mNodeArray.Num());
+	for (int i = 0; i < mNodeArray.Num(); ++i)
 	{
-		eiVector& position = positions.get(i);
-		Vertices.Add(FVector(position.x, position.y, position.z));
+		const FMaxNodeInfo& nodeInfo = mNodeArray[i];
+		const FBox& meshBounds = GetMeshBounds(nodeInfo.meshName);
+		mNodeBounds[i] = meshBounds.IsValid ? FBoxSphereBounds(meshBounds.TransformBy(nodeInfo.matrix)) : FBoxSphereBounds(nodeInfo.matrix.GetOrigin(), FVector::ZeroVector, 0.0f);
 	}
-	for (int i = 0; i < normals.size(); ++i)
+	mNodesReady.AtomicSet(true);
+}
+
+void FEssImporter::BuildMeshesByPriority(const TArray<FString>& meshNames, TFunctionRef<void(int32)> buildMesh)
+{
+	TMap<FString, int32> meshIndices;
+	meshIndices.Reserve(meshNames.Num());
+	for (int32 i = 0; i < meshNames.Num(); ++i)
 	{
-		eiVector& normal = normals.get(i);
-		Normals.Add(FVector(normal.x, normal.y, normal.z));
+		meshIndices.Add(meshNames[i], i);
 	}
-	if (EI_NULL_TAG != uv1Tag)
+	TArray<TArray<int32>> meshNodes;
+	meshNodes.SetNum(meshNames.Num());
+	for (int i = 0; i < mNodeArray.Num(); ++i)
 	{
-		for (int i = 0; i < uv1s.size(); ++i)
+		const int32* pMeshIndex = meshIndices.Find(mNodeArray[i].meshName);
+		if (NULL != pMeshIndex)
 		{
-			eiVector& uv1 = uv1s.get(i);
-			Uv1s.Add(FVector2D(uv1.x, uv1.y));
+			meshNodes[*pMeshIndex].Add(i);
 		}
 	}
-	if (EI_NULL_TAG != uv2Tag)
+
+	TArray<int32> order;
+	TArray<float> priorities;
+	order.SetNumUninitialized(meshNames.Num());
+	priorities.SetNumZeroed(meshNames.Num());
+	for (int32 i = 0; i < order.Num(); ++i)
 	{
-		for (int i = 0; i < uv2s.size(); ++i)
-		{
-			eiVector& uv2 = uv2s.get(i);
-			Uv2s.Add(FVector2D(uv2.x, uv2.y));
-		}
+		order[i] = i;
 	}
-	if (EI_NULL_TAG != dPduTag)
+
+	// Small batches so a camera move reaches the build order quickly, large enough to keep every worker busy
+	const int32 batchSize = FMath::Max(4, (FTaskGraphInterface::Get().GetNumWorkerThreads() + 1) * 2);
+	FVector sortedViewLocation(FVector::ZeroVector);
+	bool bSorted = false;
+	int32 next = 0;
+	while (next < order.Num())
 	{
-		for (int i = 0; i < dPdus.size(); ++i)
+		FVector viewLocation;
+		if (GetViewLocation(viewLocation) && (!bSorted || FVector::DistSquared(viewLocation, sortedViewLocation) > FMath::Square(PROGRESSIVE_RESORT_DISTANCE)))
 		{
-			eiVector& dPdu = dPdus.get(i);
-			Tangents.Add(FVector(dPdu.x, dPdu.y, dPdu.z));
+			// A mesh is as important as the largest of its nodes on screen
+			for (int32 i = next; i < order.Num(); ++i)
+			{
+				float priority = 0.0f;
+				for (int nodeIndex : meshNodes[order[i]])
+				{
+					priority = FMath::Max(priority, GetNodeScreenSize(nodeIndex, viewLocation));
+				}
+				priorities[order[i]] = priority;
+			}
+			Sort(order.GetData() + next, order.Num() - next, [&priorities](int32 a, int32 b) { return priorities[a] > priorities[b]; });
+			sortedViewLocation = viewLocation;
+			bSorted = true;
 		}
+
+		const int32 count = FMath::Min(batchSize, order.Num() - next);
+		ParallelFor(count, [&](int32 index)
+		{
+			int32 meshIndex = order[next + index];
+			buildMesh(meshIndex);
+			mReadyMeshes.Enqueue(meshNames[meshIndex]);
+		}, !MULTI_THREADING_BUILD);
+		next += count;
 	}
+}
+
+/* Vertex attributes of a poly, the index tables pick from them per triangle corner. Only lives while its mesh is built. */
+struct FEssPolyAttributes
+{
+	TArray<FVector, FEssArenaAllocator> Vertices;
+	TArray<FVector, FEssArenaAllocator> Normals;
+	TArray<FVector2D, FEssArenaAllocator> Uv1s;
+	TArray<FVector2D, FEssArenaAllocator> Uv2s;
+	TArray<FRuntimeMeshTangent, FEssArenaAllocator> Tangents;
+};
+
+/* Index table over an array of the native reader, with the accessor interface of the SDK data tables */
+struct FEssIndexView
+{
+	FEssIndexView(const int32* inData, int32 inNum) : data(inData), num(inNum) { }
+
+	FORCEINLINE int32 get(int32 i) const { return data[i]; }
+	FORCEINLINE int32 size() const { return num; }
+
+	const int32* data;
+	int32 num;
+};
+
+/* Per corner index tables of a poly, optional tables the poly doesn't have are NULL */
+template <typename TIndexTable>
+struct FEssPolyIndices
+{
+	FEssPolyIndices() : pTriList(NULL), pNormals(NULL), pUv1s(NULL), pUv2s(NULL), pDPdus(NULL), pMtlIndices(NULL) { }
+
+	TIndexTable* pTriList;
+	TIndexTable* pNormals;
+	TIndexTable* pUv1s;
+	TIndexTable* pUv2s;
+	TIndexTable* pDPdus;
+	TIndexTable* pMtlIndices;
+};
+
+/*
+*	Splits a poly into one mesh per material. The corners of each face are swapped as max winds the other way round,
+*	instances with mirroring transforms share the same triangles, the scene proxy reverses culling for them.
+*/
+template <typename TIndexTable>
+static void BuildPolyMeshes(const FEssPolyAttributes& attributes, const FEssPolyIndices<TIndexTable>& polyIndices, FEssImporter::TMeshArray& meshArray)
+{
+	TIndexTable& tri_list = *polyIndices.pTriList;
+	TIndexTable& normalIndices = *polyIndices.pNormals;
+	int channelNum = 2 + (NULL != polyIndices.pUv1s) + (NULL != polyIndices.pUv2s) + (NULL != polyIndices.pDPdus);
 
-	auto BuildMesh = [&](FMeshInfo& meshInfo, bool bHasOriginalVertexOrder, bool bHasInvertVertexOrder)
+	auto BuildMesh = [&](FMeshInfo& meshInfo)
 	{
-		TMap<FVertexKey, int32> VertexMap;
-		TArray<int32> indices;
+		// Sized for the worst case up front, growing it would leave every smaller table behind in the arena
+		TMap<FVertexKey, int32, FEssArenaSetAllocator> VertexMap;
+		VertexMap.Reserve(meshInfo.Triangles.Num());
 		for (int i = 0; i < meshInfo.Triangles.Num(); ++i)
 		{
 			FVertexKey vertexKey;
@@ -221,17 +389,17 @@ bool FEssImporter::ParseMesh(const eiNodeAccessor& node, FMeshMapInfo& meshMapIn
 			int j = 2;
 			vertexKey.indices[0] = tri_list.get(index);
 			vertexKey.indices[1] = normalIndices.get(index);
-			if (EI_NULL_TAG != uv1Tag)
+			if (NULL != polyIndices.pUv1s)
 			{
-				vertexKey.indices[j++] = uv1Indices.get(index);
+				vertexKey.indices[j++] = polyIndices.pUv1s->get(index);
 			}
-			if (EI_NULL_TAG != uv2Tag)
+			if (NULL != polyIndices.pUv2s)
 			{
-				vertexKey.indices[j++] = uv2Indices.get(index);
+				vertexKey.indices[j++] = polyIndices.pUv2s->get(index);
 			}
-			if (EI_NULL_TAG != dPduTag)
+			if (NULL != polyIndices.pDPdus)
 			{
-				vertexKey.indices[j] = dPduIndices.get(index);
+				vertexKey.indices[j] = polyIndices.pDPdus->get(index);
 			}
 			vertexKey.BuildHashKey();
 			int32* pMappedIndex = VertexMap.Find(vertexKey);
@@ -240,61 +408,41 @@ bool FEssImporter::ParseMesh(const eiNodeAccessor& node, FMeshMapInfo& meshMapIn
 			{
 				mappedIndex = VertexMap.Num();
 				VertexMap.Add(vertexKey, mappedIndex);
-				meshInfo.Vertices.Add(Vertices[vertexKey.indices[0]]);
-				meshInfo.Normals.Add(Normals[vertexKey.indices[1]]);
+				meshInfo.Vertices.Add(attributes.Vertices[vertexKey.indices[0]]);
+				meshInfo.Normals.Add(attributes.Normals[vertexKey.indices[1]]);
 				j = 2;
-				if (EI_NULL_TAG != uv1Tag)
+				if (NULL != polyIndices.pUv1s)
 				{
-					meshInfo.Uv1s.Add(Uv1s[vertexKey.indices[j++]]);
+					meshInfo.Uv1s.Add(attributes.Uv1s[vertexKey.indices[j++]]);
 				}
-				if (EI_NULL_TAG != uv2Tag)
+				if (NULL != polyIndices.pUv2s)
 				{
-					meshInfo.Uv2s.Add(Uv2s[vertexKey.indices[j++]]);
+					meshInfo.Uv2s.Add(attributes.Uv2s[vertexKey.indices[j++]]);
 				}
-				if (EI_NULL_TAG != dPduTag)
+				if (NULL != polyIndices.pDPdus)
 				{
-					meshInfo.Tangents.Add(Tangents[vertexKey.indices[j++]]);
+					meshInfo.Tangents.Add(attributes.Tangents[vertexKey.indices[j++]]);
 				}
 			}
 			else
 			{
 				mappedIndex = *pMappedIndex;
 			}
-			indices.Add(mappedIndex);
-		}
-		if (bHasOriginalVertexOrder)
-		{
-			meshInfo.Triangles = indices;
-			if (bHasInvertVertexOrder)
-			{
-				int numFace = meshInfo.Triangles.Num() / 3;
-				meshInfo.InvertTriangles.SetNum(numFace * 3);
-				for (int i = 0; i < numFace; ++i)
-				{
-					meshInfo.InvertTriangles[i * 3] = indices[i * 3];
-					meshInfo.InvertTriangles[i * 3 + 1] = indices[i * 3 + 2];
-					meshInfo.InvertTriangles[i * 3 + 2] = indices[i * 3 + 1];
-				}
-			}
-		}
-		else if (bHasInvertVertexOrder)
-		{
-			meshInfo.Triangles.SetNum(0);
-			meshInfo.InvertTriangles = indices;
+			// Each corner is read before it is overwritten, the welded indices replace the corners in place
+			meshInfo.Triangles[i] = mappedIndex;
 		}
 	};
 
 	int numFace = tri_list.size() / 3;
-	int secondVertIndex = meshMapInfo.bHasOriginalVertexOrder ? 2 : 1;
-	int thirdVertIndex = meshMapInfo.bHasOriginalVertexOrder ? 1 : 2;
-	eiTag mtlIndexTag = getArrayTag(node, "mtl_index");
-	if (EI_NULL_TAG != mtlIndexTag)
+	const int secondVertIndex = 2;
+	const int thirdVertIndex = 1;
+	if (NULL != polyIndices.pMtlIndices)
 	{
-		eiDataTableAccessor<eiIndex> mtlIndexList(mtlIndexTag);
-		TMap<eiIndex, int> mtlIndexToMeshIndex;
+		TIndexTable& mtlIndexList = *polyIndices.pMtlIndices;
+		TMap<int32, int, FEssArenaSetAllocator> mtlIndexToMeshIndex;
 		for (int i = 0; i < numFace; ++i)
 		{
-			eiIndex mtlIndex = mtlIndexList.get(i);
+			int32 mtlIndex = mtlIndexList.get(i);
 			int meshIndex = 0;
 			int* pMeshIndex = mtlIndexToMeshIndex.Find(mtlIndex);
 			if (NULL == pMeshIndex)
@@ -308,7 +456,7 @@ bool FEssImporter::ParseMesh(const eiNodeAccessor& node, FMeshMapInfo& meshMapIn
 			{
 				meshIndex = *pMeshIndex;
 			}
-			
+
 			TArray<int32>& triangles = meshArray[meshIndex].Triangles;
 			triangles.Add(i * 3);
 			triangles.Add(i * 3 + secondVertIndex);
@@ -317,7 +465,7 @@ bool FEssImporter::ParseMesh(const eiNodeAccessor& node, FMeshMapInfo& meshMapIn
 
 		for (auto& mesh : meshArray)
 		{
-			BuildMesh(mesh, meshMapInfo.bHasOriginalVertexOrder, meshMapInfo.bHasInvertVertexOrder);
+			BuildMesh(mesh);
 		}
 	}
 	else
@@ -331,85 +479,182 @@ bool FEssImporter::ParseMesh(const eiNodeAccessor& node, FMeshMapInfo& meshMapIn
 			triangles.Add(i * 3 + secondVertIndex);
 			triangles.Add(i * 3 + thirdVertIndex);
 		}
-		BuildMesh(meshArray.Last(), meshMapInfo.bHasOriginalVertexOrder, meshMapInfo.bHasInvertVertexOrder);
+		BuildMesh(meshArray.Last());
 	}
-	
-	return true;
 }
 
-void FEssImporter::InsertNodeInfo(const eiNodeAccessor& node)
+#if WITH_ERSDK
+eiTag getArrayTag(const eiDataAccessor<eiNode>& node, const char* arrayName)
 {
-	eiTag elementTag = ei_node_get_node(node.get(), ei_node_find_param(node.get(), "element"));
-	if (EI_NULL_TAG == elementTag)
+	eiIndex index = ei_node_find_param(node.get(), arrayName);
+	if (index != EI_NULL_INDEX)
 	{
-		return;
+		return ei_node_get_array(node.get(), index);
 	}
 
-	eiDeferNodeAccessor element(elementTag);
-	eiDataAccessor<eiNodeDesc> desc(element->desc);
-	if (strcmp(ei_node_desc_name(desc.get()), "poly") != 0)
+	return EI_NULL_TAG;
+}
+
+bool FEssImporter::ParseMesh(const eiNodeAccessor& node, FMeshMapInfo& meshMapInfo)
+{
+	eiTag positionsTag = getArrayTag(node, "pos_list");
+	if (EI_NULL_TAG == positionsTag)
 	{
-		return;
+		return false;
+	}
+	eiTag triListTag = getArrayTag(node, "triangle_list");
+	if (EI_NULL_TAG == triListTag)
+	{
+		return false;
+	}
+	eiTag normalTag = getArrayTag(node, "N");
+	if (EI_NULL_TAG == normalTag)
+	{
+		return  false;
+	}
+	eiTag normalIndicesTag = getArrayTag(node, "N_idx");
+	if (EI_NULL_TAG == normalIndicesTag)
+	{
+		return false;
 	}
 
-	mNodeArray.AddDefaulted();
-	FMaxNodeInfo& nodeInfo = mNodeArray.Last();
-	nodeInfo.name = UTF8_TO_TCHAR(node->unique_name);
-	nodeInfo.bInvertVertexOrder = false;
-		
-	nodeInfo.meshName = UTF8_TO_TCHAR(element->unique_name);
-	FMeshMapInfo* pMeshMapInfo = mMeshMap.Find(nodeInfo.meshName);
-	if (NULL == pMeshMapInfo)
+	eiTag uv1Tag = getArrayTag(node, "uv1");
+	eiTag uv1IndicesTag = getArrayTag(node, "uv1_idx"); 
+	eiTag uv2Tag = getArrayTag(node, "uv2"); 
+	eiTag uv2IndicesTag = getArrayTag(node, "uv2_idx"); 
+	eiTag dPduTag = getArrayTag(node, "dPdu"); 
+	eiTag dPduIndicesTag = getArrayTag(node, "dPdu_idx"); 
+	eiTag mtlIndexTag = getArrayTag(node, "mtl_index");
+
+	typedef eiDataTableAccessor<eiIndex> eiIndexAccessor;
+	eiIndexAccessor tri_list(triListTag);
+	eiDataTableAccessor<eiVector> positions(positionsTag);
+	eiDataTableAccessor<eiVector> normals(normalTag);
+	eiIndexAccessor normalIndices(normalIndicesTag);
+	eiDataTableAccessor<eiVector> uv1s(uv1Tag);
+	eiIndexAccessor uv1Indices(uv1IndicesTag);
+	eiDataTableAccessor<eiVector> uv2s(uv2Tag);
+	eiIndexAccessor uv2Indices(uv2IndicesTag);
+	eiDataTableAccessor<eiVector> dPdus(dPduTag);
+	eiIndexAccessor dPduIndices(dPduIndicesTag);
+	eiIndexAccessor mtlIndexList(mtlIndexTag);
+
+	FEssPolyAttributes attributes;
+	attributes.Vertices.Reserve(positions.size());
+	attributes.Normals.Reserve(normals.size());
+	for (int i = 0; i < positions.size(); ++i)
 	{
-		pMeshMapInfo = &mMeshMap.Add(nodeInfo.meshName);
+		eiVector& position = positions.get(i);
+		attributes.Vertices.Add(FVector(position.x, position.y, position.z));
 	}
-	
-	eiMatrix* matrix = ei_node_get_matrix(node.get(), ei_node_find_param(node.get(), "transform"));
-	if (NULL != matrix)
+	for (int i = 0; i < normals.size(); ++i)
 	{
-		memcpy((void*)(&nodeInfo.matrix.M[0][0]), (void*)(&matrix->m[0][0]), sizeof(float) * 16);
-#if INVERT_VERTEX_ORDER_FOR_NEGATIVE_SACLE
-		if (nodeInfo.matrix.Determinant() < 0)
+		eiVector& normal = normals.get(i);
+		attributes.Normals.Add(FVector(normal.x, normal.y, normal.z));
+	}
+	if (EI_NULL_TAG != uv1Tag)
+	{
+		attributes.Uv1s.Reserve(uv1s.size());
+		for (int i = 0; i < uv1s.size(); ++i)
 		{
-			pMeshMapInfo->bHasInvertVertexOrder = true;
-			nodeInfo.bInvertVertexOrder = true;
+			eiVector& uv1 = uv1s.get(i);
+			attributes.Uv1s.Add(FVector2D(uv1.x, uv1.y));
 		}
-		else
+	}
+	if (EI_NULL_TAG != uv2Tag)
+	{
+		attributes.Uv2s.Reserve(uv2s.size());
+		for (int i = 0; i < uv2s.size(); ++i)
 		{
-			pMeshMapInfo->bHasOriginalVertexOrder = true;
+			eiVector& uv2 = uv2s.get(i);
+			attributes.Uv2s.Add(FVector2D(uv2.x, uv2.y));
 		}
-#else
-		pMeshMapInfo->bHasOriginalVertexOrder = true;
-#endif
+	}
+	if (EI_NULL_TAG != dPduTag)
+	{
+		attributes.Tangents.Reserve(dPdus.size());
+		for (int i = 0; i < dPdus.size(); ++i)
+		{
+			eiVector& dPdu = dPdus.get(i);
+			attributes.Tangents.Add(FVector(dPdu.x, dPdu.y, dPdu.z));
+		}
+	}
+
+	FEssPolyIndices<eiIndexAccessor> polyIndices;
+	polyIndices.pTriList = &tri_list;
+	polyIndices.pNormals = &normalIndices;
+	polyIndices.pUv1s = EI_NULL_TAG != uv1Tag ? &uv1Indices : NULL;
+	polyIndices.pUv2s = EI_NULL_TAG != uv2Tag ? &uv2Indices : NULL;
+	polyIndices.pDPdus = EI_NULL_TAG != dPduTag ? &dPduIndices : NULL;
+	polyIndices.pMtlIndices = EI_NULL_TAG != mtlIndexTag ? &mtlIndexList : NULL;
+	BuildPolyMeshes(attributes, polyIndices, meshMapInfo.meshArray);
+	OptimizeMeshArray(meshMapInfo.meshArray);
+	return true;
+}
 
-		nodeInfo.matrix.M[0][1] = -nodeInfo.matrix.M[0][1];
-		nodeInfo.matrix.M[1][1] = -nodeInfo.matrix.M[1][1];
-		nodeInfo.matrix.M[2][1] = -nodeInfo.matrix.M[2][1];
-		nodeInfo.matrix.M[3][1] = -nodeInfo.matrix.M[3][1];
+// Bounds of the raw positions, read without welding for progressive imports
+static FBox GetPositionBounds(const eiDataAccessor<eiNode>& mesh)
+{
+	FBox bounds(ForceInit);
+	eiTag positionsTag = getArrayTag(mesh, "pos_list");
+	if (EI_NULL_TAG != positionsTag)
+	{
+		eiDataTableAccessor<eiVector> positions(positionsTag);
+		for (int i = 0; i < positions.size(); ++i)
+		{
+			eiVector& position = positions.get(i);
+			bounds += FVector(position.x, position.y, position.z);
+		}
 	}
+	return bounds;
 }
 
-bool FEssImporter::DoParseEssFile()
+void FEssImporter::InsertNodeInfo(const eiNodeAccessor& node, int groupIndex, const FMatrix& parentMatrix, int depth)
 {
-	char* filename = TCHAR_TO_UTF8(*m_strFullPath);
-	FString pluginPath = FPaths::GamePluginsDir() + TEXT("RuntimeMeshComponent/ThirdParty/ERSDK/shaders");
-	ei_add_shader_searchpath(TCHAR_TO_UTF8(*pluginPath));
-	if (!ei_parse2(filename, EI_TRUE)) {
-		ei_error("Failed to parse file: %s\n", filename);
-		return false;
+	eiTag elementTag = ei_node_get_node(node.get(), ei_node_find_param(node.get(), "element"));
+	if (EI_NULL_TAG == elementTag)
+	{
+		return;
 	}
 
-	eiTag tagGroup = ei_find_node("mtoer_instgroup_00");
-	if (EI_NULL_TAG == tagGroup)
+	FMatrix matrix = FMatrix::Identity;
+	eiMatrix* pMatrix = ei_node_get_matrix(node.get(), ei_node_find_param(node.get(), "transform"));
+	if (NULL != pMatrix)
 	{
-		return false;
+		memcpy((void*)(&matrix.M[0][0]), (void*)(&pMatrix->m[0][0]), sizeof(float) * 16);
 	}
+	matrix = matrix * parentMatrix;
 
-	eiNodeAccessor instGroup(tagGroup);
-	eiTag tagNodeTable = getArrayTag(instGroup, "instance_list");
+	// The element accessor is released before the group is walked, its instances are read through another accessor
+	FString elementName;
+	{
+		eiDeferNodeAccessor element(elementTag);
+		eiDataAccessor<eiNodeDesc> desc(element->desc);
+		const char* descName = ei_node_desc_name(desc.get());
+		elementName = UTF8_TO_TCHAR(element->unique_name);
+		if (strcmp(descName, "poly") == 0)
+		{
+			AddNodeInfo(UTF8_TO_TCHAR(node->unique_name), elementName, matrix, groupIndex);
+			return;
+		}
+		if (strcmp(descName, "instgroup") != 0)
+		{
+			return;
+		}
+	}
+
+	if (depth >= MAX_INSTANCE_GROUP_DEPTH)
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Instance group %s is nested more than %d levels deep, skipped"), *elementName, MAX_INSTANCE_GROUP_DEPTH);
+		return;
+	}
+
+	int childGroupIndex = AddGroupInfo(UTF8_TO_TCHAR(node->unique_name), matrix, groupIndex);
+	eiNodeAccessor group(elementTag);
+	eiTag tagNodeTable = getArrayTag(group, "instance_list");
 	if (EI_NULL_TAG == tagNodeTable)
 	{
-		return false;
+		return;
 	}
 
 	eiDataTableAccessor<eiTag> nodeTable(tagNodeTable);
@@ -418,18 +663,287 @@ bool FEssImporter::DoParseEssFile()
 		eiTag nodeTag = nodeTable.get(i);
 		if (EI_NULL_TAG != nodeTag)
 		{
-			eiDataAccessor<eiNode> node(nodeTag);
-			InsertNodeInfo(node);
+			eiDataAccessor<eiNode> child(nodeTag);
+			InsertNodeInfo(child, childGroupIndex, matrix, depth + 1);
 		}
 	}
+}
+#endif
 
-#if MULTI_THREADING_BUILD
-	struct Pair
-	{
-		FString meshkey;
-		FMeshMapInfo* meshMapInfo;
-	};
-	TArray<Pair> pairArray;
+// Max is right handed, flipping the y column brings a max world matrix over to unreal
+static FMatrix ConvertMaxMatrix(const FMatrix& maxMatrix)
+{
+	FMatrix matrix = maxMatrix;
+	matrix.M[0][1] = -matrix.M[0][1];
+	matrix.M[1][1] = -matrix.M[1][1];
+	matrix.M[2][1] = -matrix.M[2][1];
+	matrix.M[3][1] = -matrix.M[3][1];
+	return matrix;
+}
+
+FString FEssImporter::GetScopedName(const FString& name, int groupIndex) const
+{
+	// An instance group can be placed more than once, its nodes only have unique names together with the group
+	return INDEX_NONE == groupIndex ? name : mGroupArray[groupIndex].name + TEXT("_") + name;
+}
+
+void FEssImporter::AddNodeInfo(const FString& name, const FString& meshName, const FMatrix& maxMatrix, int groupIndex)
+{
+	mNodeArray.AddDefaulted();
+	FMaxNodeInfo& nodeInfo = mNodeArray.Last();
+	nodeInfo.name = GetScopedName(name, groupIndex);
+	nodeInfo.essName = name;
+	nodeInfo.groupIndex = groupIndex;
+		
+	nodeInfo.meshName = meshName;
+	if (NULL == mMeshMap.Find(nodeInfo.meshName))
+	{
+		mMeshMap.Add(nodeInfo.meshName);
+	}
+
+	// Mirroring matrices are kept as they are, the component transform carries the negative determinant
+	nodeInfo.matrix = ConvertMaxMatrix(maxMatrix);
+}
+
+int FEssImporter::AddGroupInfo(const FString& name, const FMatrix& maxMatrix, int parentIndex)
+{
+	FMaxGroupInfo groupInfo;
+	groupInfo.name = GetScopedName(name, parentIndex);
+	groupInfo.parentIndex = parentIndex;
+	groupInfo.matrix = ConvertMaxMatrix(maxMatrix);
+	return mGroupArray.Add(groupInfo);
+}
+
+// Leaves the view empty when the table is missing or too short for the corners
+static bool GetNativeIndices(const FEssNativeNode& node, const TCHAR* name, int32 numCorners, FEssIndexView& outView)
+{
+	int32 num = 0;
+	const int32* pIndices = node.GetInts(name, num);
+	if (NULL == pIndices)
+	{
+		return false;
+	}
+	if (num < numCorners)
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Ess poly %s has %d %s indices for %d corners, ignoring them"), *node.Name, num, name, numCorners);
+		return false;
+	}
+
+	outView = FEssIndexView(pIndices, num);
+	return true;
+}
+
+static FORCEINLINE void ConvertNativeElement(const float* pValues, int32 components, FVector& outElement)
+{
+	outElement = FVector(pValues[0], pValues[1], components > 2 ? pValues[2] : 0.0f);
+}
+
+static FORCEINLINE void ConvertNativeElement(const float* pValues, int32 components, FVector2D& outElement)
+{
+	outElement = FVector2D(pValues[0], pValues[1]);
+}
+
+static FORCEINLINE void ConvertNativeElement(const float* pValues, int32 components, FRuntimeMeshTangent& outElement)
+{
+	outElement = FRuntimeMeshTangent(FVector(pValues[0], pValues[1], components > 2 ? pValues[2] : 0.0f));
+}
+
+template <typename TElement, typename TAllocator>
+static bool GetNativeAttribute(const FEssNativeNode& node, const TCHAR* name, TArray<TElement, TAllocator>& outElements)
+{
+	int32 num = 0;
+	int32 components = 0;
+	const float* pValues = node.GetFloats(name, num, components);
+	if (NULL == pValues || components < 2)
+	{
+		return false;
+	}
+
+	outElements.SetNumUninitialized(num);
+	for (int32 i = 0; i < num; ++i, pValues += components)
+	{
+		ConvertNativeElement(pValues, components, outElements[i]);
+	}
+	return true;
+}
+
+bool FEssImporter::ParseMesh(const FEssNativeNode& node, FMeshMapInfo& meshMapInfo)
+{
+	int32 numCorners = 0;
+	const int32* pTriList = node.GetInts(TEXT("triangle_list"), numCorners);
+	FEssPolyAttributes attributes;
+	FEssIndexView normalIndices(NULL, 0);
+	if (NULL == pTriList || !GetNativeAttribute(node, TEXT("pos_list"), attributes.Vertices) || !GetNativeAttribute(node, TEXT("N"), attributes.Normals) ||
+		!GetNativeIndices(node, TEXT("N_idx"), numCorners, normalIndices))
+	{
+		return false;
+	}
+
+	// An attribute only counts when both its values and its indices are there
+	FEssIndexView uv1Indices(NULL, 0), uv2Indices(NULL, 0), dPduIndices(NULL, 0), mtlIndices(NULL, 0);
+	bool bHasUv1 = GetNativeAttribute(node, TEXT("uv1"), attributes.Uv1s) && GetNativeIndices(node, TEXT("uv1_idx"), numCorners, uv1Indices);
+	bool bHasUv2 = GetNativeAttribute(node, TEXT("uv2"), attributes.Uv2s) && GetNativeIndices(node, TEXT("uv2_idx"), numCorners, uv2Indices);
+	bool bHasDPdu = GetNativeAttribute(node, TEXT("dPdu"), attributes.Tangents) && GetNativeIndices(node, TEXT("dPdu_idx"), numCorners, dPduIndices);
+	bool bHasMtlIndices = GetNativeIndices(node, TEXT("mtl_index"), numCorners / 3, mtlIndices);
+
+	FEssIndexView triList(pTriList, numCorners);
+	FEssPolyIndices<FEssIndexView> polyIndices;
+	polyIndices.pTriList = &triList;
+	polyIndices.pNormals = &normalIndices;
+	polyIndices.pUv1s = bHasUv1 ? &uv1Indices : NULL;
+	polyIndices.pUv2s = bHasUv2 ? &uv2Indices : NULL;
+	polyIndices.pDPdus = bHasDPdu ? &dPduIndices : NULL;
+	polyIndices.pMtlIndices = bHasMtlIndices ? &mtlIndices : NULL;
+	BuildPolyMeshes(attributes, polyIndices, meshMapInfo.meshArray);
+	OptimizeMeshArray(meshMapInfo.meshArray);
+	return true;
+}
+
+static FBox GetPositionBounds(const FEssNativeNode& mesh)
+{
+	FBox bounds(ForceInit);
+	int32 num = 0;
+	int32 components = 0;
+	const float* pValues = mesh.GetFloats(TEXT("pos_list"), num, components);
+	if (NULL != pValues && components >= 2)
+	{
+		for (int32 i = 0; i < num; ++i, pValues += components)
+		{
+			FVector position;
+			ConvertNativeElement(pValues, components, position);
+			bounds += position;
+		}
+	}
+	return bounds;
+}
+
+void FEssImporter::InsertNodeInfo(const FEssNativeNode& node, int groupIndex, const FMatrix& parentMatrix, int depth)
+{
+	const FString* pElementName = node.GetNodeRef(TEXT("element"));
+	const FEssNativeNode* pElement = NULL != pElementName ? mNativeScene.FindNode(*pElementName) : NULL;
+	if (NULL == pElement)
+	{
+		return;
+	}
+
+	FMatrix matrix = FMatrix::Identity;
+	node.GetMatrix(TEXT("transform"), matrix);
+	matrix = matrix * parentMatrix;
+	if (pElement->Type == TEXT("poly"))
+	{
+		AddNodeInfo(node.Name, pElement->Name, matrix, groupIndex);
+		return;
+	}
+	if (pElement->Type != TEXT("instgroup"))
+	{
+		return;
+	}
+
+	if (depth >= MAX_INSTANCE_GROUP_DEPTH)
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Instance group %s is nested more than %d levels deep, skipped"), *pElement->Name, MAX_INSTANCE_GROUP_DEPTH);
+		return;
+	}
+
+	int childGroupIndex = AddGroupInfo(node.Name, matrix, groupIndex);
+	int32 instanceCount = 0;
+	const FString* pInstanceNames = pElement->GetStrings(TEXT("instance_list"), instanceCount);
+	for (int32 i = 0; i < instanceCount; ++i)
+	{
+		const FEssNativeNode* pNode = mNativeScene.FindNode(pInstanceNames[i]);
+		if (NULL != pNode)
+		{
+			InsertNodeInfo(*pNode, childGroupIndex, matrix, depth + 1);
+		}
+	}
+}
+
+// Content hash of built meshes, re-imports compare it to find the meshes that changed
+static uint32 HashMeshArray(const FEssImporter::TMeshArray& meshArray)
+{
+	uint32 hash = 0;
+	for (const FMeshInfo& meshInfo : meshArray)
+	{
+		hash = FCrc::MemCrc32(meshInfo.Vertices.GetData(), meshInfo.Vertices.Num() * meshInfo.Vertices.GetTypeSize(), hash);
+		hash = FCrc::MemCrc32(meshInfo.Normals.GetData(), meshInfo.Normals.Num() * meshInfo.Normals.GetTypeSize(), hash);
+		hash = FCrc::MemCrc32(meshInfo.Uv1s.GetData(), meshInfo.Uv1s.Num() * meshInfo.Uv1s.GetTypeSize(), hash);
+		hash = FCrc::MemCrc32(meshInfo.Uv2s.GetData(), meshInfo.Uv2s.Num() * meshInfo.Uv2s.GetTypeSize(), hash);
+		hash = FCrc::MemCrc32(meshInfo.Triangles.GetData(), meshInfo.Triangles.Num() * meshInfo.Triangles.GetTypeSize(), hash);
+		// Tangents carry padding after the flip flag, only the direction is hashed
+		for (const FRuntimeMeshTangent& tangent : meshInfo.Tangents)
+		{
+			hash = FCrc::MemCrc32(&tangent.TangentX, sizeof(tangent.TangentX), hash);
+		}
+		hash = FCrc::MemCrc32(&meshInfo.mtlIndex, sizeof(meshInfo.mtlIndex), hash);
+	}
+	return hash;
+}
+
+static void RecordMeshGeometry(FEssImportScope& scope, const FEssImporter::TMeshArray& meshArray)
+{
+	int32 vertexCount = 0;
+	int32 triangleCount = 0;
+	for (const FMeshInfo& meshInfo : meshArray)
+	{
+		vertexCount += meshInfo.Vertices.Num();
+		triangleCount += meshInfo.Triangles.Num() / 3;
+	}
+	scope.SetGeometry(vertexCount, triangleCount);
+}
+
+bool FEssImporter::DoParseEssFile()
+{
+	if (mbNativeReader)
+	{
+		return DoParseEssFileNative();
+	}
+
+#if WITH_ERSDK
+	char* filename = TCHAR_TO_UTF8(*m_strFullPath);
+	FString pluginPath = FPaths::GamePluginsDir() + TEXT("RuntimeMeshComponent/ThirdParty/ERSDK/shaders");
+	ei_add_shader_searchpath(TCHAR_TO_UTF8(*pluginPath));
+	{
+		FEssImportScope scope(mProfiler, EEssImportStage::Parse);
+		if (!ei_parse2(filename, EI_TRUE)) {
+			ei_error("Failed to parse file: %s\n", filename);
+			return false;
+		}
+	}
+
+	eiTag tagGroup = ei_find_node("mtoer_instgroup_00");
+	if (EI_NULL_TAG == tagGroup)
+	{
+		return false;
+	}
+
+	eiNodeAccessor instGroup(tagGroup);
+	eiTag tagNodeTable = getArrayTag(instGroup, "instance_list");
+	if (EI_NULL_TAG == tagNodeTable)
+	{
+		return false;
+	}
+
+	{
+		FEssImportScope scope(mProfiler, EEssImportStage::GatherNodes);
+		eiDataTableAccessor<eiTag> nodeTable(tagNodeTable);
+		for (eiInt i = 0; i < nodeTable.size(); ++i)
+		{
+			eiTag nodeTag = nodeTable.get(i);
+			if (EI_NULL_TAG != nodeTag)
+			{
+				eiDataAccessor<eiNode> node(nodeTag);
+				InsertNodeInfo(node, INDEX_NONE, FMatrix::Identity, 0);
+			}
+		}
+	}
+
+#if MULTI_THREADING_BUILD
+	struct Pair
+	{
+		FString meshkey;
+		FMeshMapInfo* meshMapInfo;
+	};
+	TArray<Pair> pairArray;
 	for (auto& iter : mMeshMap)
 	{
 		Pair pair;
@@ -440,7 +954,32 @@ bool FEssImporter::DoParseEssFile()
 
 	DWORD threadID = GetCurrentThreadId();
 
-	ParallelFor(pairArray.Num(), [&](int32 index)
+	if (mbProgressive)
+	{
+		ParallelFor(pairArray.Num(), [&](int32 index)
+		{
+			DWORD subThreadID = GetCurrentThreadId();
+			if (subThreadID != threadID)
+			{
+				ei_job_register_thread();
+			}
+			Pair& pair = pairArray[index];
+			eiTag meshTag = ei_find_node(TCHAR_TO_UTF8(*pair.meshkey));
+			if (EI_NULL_TAG != meshTag)
+			{
+				eiNodeAccessor mesh(meshTag);
+				pair.meshMapInfo->bounds = GetPositionBounds(mesh);
+			}
+			if (subThreadID != threadID)
+			{
+				ei_job_unregister_thread();
+			}
+		});
+		PublishNodes();
+		ResolveMaterials();
+	}
+
+	auto buildMesh = [&](int32 index)
 	{
 		DWORD subThreadID = GetCurrentThreadId();
 		if (subThreadID != threadID)
@@ -451,30 +990,170 @@ bool FEssImporter::DoParseEssFile()
 		eiTag meshTag = ei_find_node(TCHAR_TO_UTF8(*pair.meshkey));
 		if (EI_NULL_TAG != meshTag)
 		{
+			FEssImportScope scope(mProfiler, EEssImportStage::BuildMeshes, &pair.meshkey);
 			eiNodeAccessor mesh(meshTag);
-			ParseMesh(mesh, *pair.meshMapInfo);
+			{
+				FEssArenaScope arenaScope(mProfiler, mbTransientArena);
+				ParseMesh(mesh, *pair.meshMapInfo);
+			}
+			RecordMeshGeometry(scope, pair.meshMapInfo->meshArray);
+			pair.meshMapInfo->contentHash = HashMeshArray(pair.meshMapInfo->meshArray);
 		}
 		if (subThreadID != threadID)
 		{
 			ei_job_unregister_thread();
 		}
-	});
+	};
+
+	if (mbProgressive)
+	{
+		TArray<FString> meshNames;
+		meshNames.Reserve(pairArray.Num());
+		for (const Pair& pair : pairArray)
+		{
+			meshNames.Add(pair.meshkey);
+		}
+		BuildMeshesByPriority(meshNames, buildMesh);
+	}
+	else
+	{
+		ParallelFor(pairArray.Num(), buildMesh);
+	}
 #else
+	if (mbProgressive)
+	{
+		for (auto& iter : mMeshMap)
+		{
+			eiTag meshTag = ei_find_node(TCHAR_TO_UTF8(*iter.Key));
+			if (EI_NULL_TAG != meshTag)
+			{
+				eiNodeAccessor mesh(meshTag);
+				iter.Value.bounds = GetPositionBounds(mesh);
+			}
+		}
+		PublishNodes();
+		ResolveMaterials();
+	}
+
 	for (auto& iter : mMeshMap)
 	{
 		char* meshKey = TCHAR_TO_UTF8(*iter.Key);
 		eiTag meshTag = ei_find_node(meshKey);
 		if (EI_NULL_TAG != meshTag)
 		{
+			FEssImportScope scope(mProfiler, EEssImportStage::BuildMeshes, &iter.Key);
 			eiNodeAccessor mesh(meshTag);
-			ParseMesh(mesh, iter.Value);
+			{
+				FEssArenaScope arenaScope(mProfiler, mbTransientArena);
+				ParseMesh(mesh, iter.Value);
+			}
+			RecordMeshGeometry(scope, iter.Value.meshArray);
+			iter.Value.contentHash = HashMeshArray(iter.Value.meshArray);
+		}
+		if (mbProgressive)
+		{
+			mReadyMeshes.Enqueue(iter.Key);
 		}
 	}
 #endif
 
+	if (!mbProgressive)
+	{
+		ResolveMaterials();
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool FEssImporter::DoParseEssFileNative()
+{
+	{
+		FEssImportScope scope(mProfiler, EEssImportStage::Parse);
+		if (!mNativeScene.Load(m_strFullPath))
+		{
+			return false;
+		}
+	}
+
+	const FEssNativeNode* pInstGroup = mNativeScene.FindNode(TEXT("mtoer_instgroup_00"));
+	int32 instanceCount = 0;
+	const FString* pInstanceNames = NULL != pInstGroup ? pInstGroup->GetStrings(TEXT("instance_list"), instanceCount) : NULL;
+	if (NULL == pInstanceNames)
+	{
+		return false;
+	}
+
+	{
+		FEssImportScope scope(mProfiler, EEssImportStage::GatherNodes);
+		for (int32 i = 0; i < instanceCount; ++i)
+		{
+			const FEssNativeNode* pNode = mNativeScene.FindNode(pInstanceNames[i]);
+			if (NULL != pNode)
+			{
+				InsertNodeInfo(*pNode, INDEX_NONE, FMatrix::Identity, 0);
+			}
+		}
+	}
+
+	// The scene is read only from here on, workers need no registration like with the SDK
+	struct Pair
+	{
+		const FEssNativeNode* pMesh;
+		FMeshMapInfo* meshMapInfo;
+	};
+	TArray<Pair> pairArray;
+	pairArray.Reserve(mMeshMap.Num());
+	for (auto& iter : mMeshMap)
+	{
+		Pair pair;
+		pair.pMesh = mNativeScene.FindNode(iter.Key);
+		pair.meshMapInfo = &iter.Value;
+		if (NULL != pair.pMesh)
+		{
+			pairArray.Add(pair);
+		}
+	}
+
+	auto buildMesh = [&](int32 index)
+	{
+		Pair& pair = pairArray[index];
+		FEssImportScope scope(mProfiler, EEssImportStage::BuildMeshes, &pair.pMesh->Name);
+		{
+			// Everything ParseMesh allocated on the way to the mesh array goes at once when the scope closes
+			FEssArenaScope arenaScope(mProfiler, mbTransientArena);
+			ParseMesh(*pair.pMesh, *pair.meshMapInfo);
+		}
+		RecordMeshGeometry(scope, pair.meshMapInfo->meshArray);
+		pair.meshMapInfo->contentHash = HashMeshArray(pair.meshMapInfo->meshArray);
+	};
+
+	if (!mbProgressive)
+	{
+		ParallelFor(pairArray.Num(), buildMesh, !MULTI_THREADING_BUILD);
+		ResolveMaterials();
+		return true;
+	}
+
+	ParallelFor(pairArray.Num(), [&](int32 index)
+	{
+		pairArray[index].meshMapInfo->bounds = GetPositionBounds(*pairArray[index].pMesh);
+	}, !MULTI_THREADING_BUILD);
+	PublishNodes();
+	ResolveMaterials();
+
+	TArray<FString> meshNames;
+	meshNames.Reserve(pairArray.Num());
+	for (const Pair& pair : pairArray)
+	{
+		meshNames.Add(pair.pMesh->Name);
+	}
+	BuildMeshesByPriority(meshNames, buildMesh);
 	return true;
 }
 
+#if WITH_ERSDK
 int32 GetShaderID(const eiDataAccessor<eiNode>& node)
 {
 	eiDataAccessor<eiNodeDesc> desc(node->desc);
@@ -557,21 +1236,67 @@ bool IsScalarType(eiShort type)
 
 	return false;
 }
+#endif
 
-struct FParseMaterialContext
+bool IsTransparentMaterial(const FEssNativeNode& node)
 {
-	FParseMaterialContext(UMaterialInstanceDynamic* pDynamicMaterialInstance) :
-		pMaterial(pDynamicMaterialInstance)
+	int32 colorCount = 0;
+	int32 components = 0;
+	const float* pColor = node.GetFloats(TEXT("refraction_color"), colorCount, components);
+	if (NULL != pColor && colorCount > 0 && (pColor[0] > 0 || pColor[1] > 0 || (components > 2 && pColor[2] > 0)))
 	{
-		int32 numshaders = GetShaderTypeMap().Num();
-		shaderNodesCountPerType.AddZeroed(numshaders);
+		return true;
 	}
 
-	UMaterialInstanceDynamic* pMaterial;
-	TMap<FString, int32> existingShaderNodesMap;
-	TArray<int32> shaderNodesCountPerType;
-	TArray<int32> shaderNodeIDs;
-};
+	int32 refractionOn = 0;
+	int32 refractionIsNull = 0;
+	if (node.GetInt(TEXT("texmap_refraction_on"), refractionOn) && node.GetInt(TEXT("texmap_refraction_isnull"), refractionIsNull) && refractionOn && !refractionIsNull)
+	{
+		return true;
+	}
+
+	int32 opacityOn = 0;
+	int32 opacityIsNull = 0;
+	if (node.GetInt(TEXT("texmap_opacity_on"), opacityOn) && node.GetInt(TEXT("texmap_opacity_isnull"), opacityIsNull) && opacityOn && !opacityIsNull)
+	{
+		return true;
+	}
+
+	return false;
+}
+
+void FEssMaterialParameters::BuildHashKey()
+{
+	hashKey = FCrc::MemCrc32(&pParent, sizeof(pParent));
+	hashKey = FCrc::MemCrc32(scalars.GetData(), scalars.Num() * scalars.GetTypeSize(), hashKey);
+	hashKey = FCrc::MemCrc32(vectors.GetData(), vectors.Num() * vectors.GetTypeSize(), hashKey);
+	for (int i = 0; i < textureNames.Num(); ++i)
+	{
+		hashKey = HashCombine(hashKey, GetTypeHash(textureNames[i]));
+		hashKey = FCrc::StrCrc32(*textureFiles[i], hashKey);
+	}
+}
+
+uint32 FEssMaterialParameters::BuildContentHash() const
+{
+	// Unlike hashKey this has to hold across sessions, so the base material goes in by path and the permutation not at all
+	uint32 contentHash = NULL != pBaseMaterial ? FCrc::StrCrc32(*pBaseMaterial->GetPathName()) : 0;
+	contentHash = FCrc::MemCrc32(shaderNodeIDs.GetData(), shaderNodeIDs.Num() * shaderNodeIDs.GetTypeSize(), contentHash);
+	contentHash = FCrc::MemCrc32(scalars.GetData(), scalars.Num() * scalars.GetTypeSize(), contentHash);
+	contentHash = FCrc::MemCrc32(vectors.GetData(), vectors.Num() * vectors.GetTypeSize(), contentHash);
+	for (int i = 0; i < textureNames.Num(); ++i)
+	{
+		contentHash = FCrc::StrCrc32(*textureNames[i].ToString(), contentHash);
+		contentHash = FCrc::StrCrc32(*textureFiles[i], contentHash);
+	}
+	return contentHash;
+}
+
+bool operator==(const FEssMaterialParameters& A, const FEssMaterialParameters& B)
+{
+	return A.hashKey == B.hashKey && A.pParent == B.pParent && A.scalars == B.scalars && A.vectors == B.vectors &&
+		A.textureNames == B.textureNames && A.textureFiles == B.textureFiles;
+}
 
 UTexture2D* CreateTexture2D(const FString& filename, UObject* pOwner, bool inEditor)
 {
@@ -617,7 +1342,7 @@ UTexture2D* CreateTexture2D(const FString& filename, UObject* pOwner, bool inEdi
 					bool isGrayScale = EImageFormat::GrayscaleJPEG == format;
 					if (ImageWrapper->GetRaw(isGrayScale ? ERGBFormat::Gray : ERGBFormat::BGRA, 8, UncompressedBGRA))
 					{
-						UTexture2D* textureParam = NewObject<UTexture2D>(pOwner, FName(*cleanName), inEditor ? RF_Transactional : RF_Transient);
+						UTexture2D* textureParam = NewObject<UTexture2D>(pOwner, MakeUniqueObjectName(pOwner, UTexture2D::StaticClass(), FName(*cleanName)), inEditor ? RF_Transactional : RF_Transient);
 						textureParam->Source.Init(ImageWrapper->GetWidth(), ImageWrapper->GetHeight(), /*NumSlices=*/ 1, /*NumMips=*/ 1, isGrayScale ? TSF_G8 : TSF_BGRA8);
 						// textureParam->MipGenSettings = TMGS_NoMipmaps;
 						//textureParam->AddressX = TA_Clamp;
@@ -648,15 +1373,143 @@ UTexture2D* CreateTexture2D(const FString& filename, UObject* pOwner, bool inEdi
 	return NULL;
 }
 
-bool FEssImporter::ParseMaterial(const eiNodeAccessor& shaderNode, FParseMaterialContext& context)
+struct FParseMaterialContext
 {
-	eiInt paramCount = ei_node_param_count(shaderNode.get());
-	int32 shaderID = GetShaderID(shaderNode);
-	if (INDEX_NONE == shaderID)
+	FParseMaterialContext(const FEssMaterialLayout& materialLayout, FEssMaterialParameters& materialParams) :
+		layout(materialLayout),
+		params(materialParams)
 	{
-		return false;
+		int32 numshaders = GetShaderTypeMap().Num();
+		shaderNodesCountPerType.AddZeroed(numshaders);
+		params.scalars = layout.scalarDefaults;
+		params.vectors = layout.vectorDefaults;
+	}
+
+	const FEssMaterialLayout& layout;
+	FEssMaterialParameters& params;
+#if WITH_ERSDK
+	// Tags of the parsed shader nodes, in the order of params.shaderNodeIDs
+	TArray<eiTag> parsedNodes;
+#endif
+	// The same for the native reader
+	TArray<const FEssNativeNode*> parsedNativeNodes;
+	TArray<int32> shaderNodesCountPerType;
+};
+
+// The uber material walks the graph through the ids of the shader nodes in parse order
+static void WriteShaderNodeIDs(const FEssMaterialLayout& layout, FEssMaterialParameters& params)
+{
+	for (int i = 0; i < params.shaderNodeIDs.Num() && i < layout.nodeIDSlots.Num(); ++i)
+	{
+		params.scalars[layout.nodeIDSlots[i]] = params.shaderNodeIDs[i];
+	}
+	if (INDEX_NONE != layout.shaderCountSlot)
+	{
+		params.scalars[layout.shaderCountSlot] = params.shaderNodeIDs.Num();
+	}
+}
+
+static FEssParamBinding MakeParamBinding(const FEssMaterialLayout& layout, int32 shaderID, const char* uniqueName)
+{
+	FEssParamBinding binding;
+	binding.uniqueName.Append(uniqueName, FCStringAnsi::Strlen(uniqueName) + 1);
+	binding.bMapChannel = SHADER_ID_STDUV == shaderID && FCStringAnsi::Strcmp(uniqueName, "mapChannel") == 0;
+	binding.bTextureFile = SHADER_ID_BITMAP == shaderID && FCStringAnsi::Strcmp(uniqueName, "tex_fileName") == 0;
+	if (FCStringAnsi::Strcmp(uniqueName, "result") == 0)
+	{
+		binding.outputIndex = 0;
+	}
+	else if (FCStringAnsi::Strcmp(uniqueName, "result_bump") == 0)
+	{
+		binding.outputIndex = 1;
+	}
+	else if (FCStringAnsi::Strcmp(uniqueName, "result_mono") == 0)
+	{
+		binding.outputIndex = 2;
+	}
+
+	FString name = UTF8_TO_TCHAR(uniqueName);
+	bool bBound = false;
+	for (int32 slot = 0; slot < ESS_MAX_SHADER_SLOTS; ++slot)
+	{
+		FString paramName = FString::Printf(TEXT("e%d%s%d"), shaderID, *name, slot);
+		const int32* pVectorIndex = layout.vectorParamMap.Find(paramName);
+		const int32* pScalarIndex = layout.scalarParamMap.Find(paramName);
+		binding.vectorSlots.Add(pVectorIndex ? *pVectorIndex : INDEX_NONE);
+		binding.scalarSlots.Add(pScalarIndex ? *pScalarIndex : INDEX_NONE);
+		bBound |= pVectorIndex || pScalarIndex;
+		if (binding.bTextureFile)
+		{
+			binding.textureSlots.Add(FName(*paramName));
+		}
+	}
+
+	if (!bBound)
+	{
+		binding.vectorSlots.Reset();
+		binding.scalarSlots.Reset();
+	}
+	return binding;
+}
+
+#if WITH_ERSDK
+int32 FEssMaterialLayout::FindShaderID(eiTag descTag) const
+{
+	for (int32 shaderID = 0; shaderID < shaderBindings.Num(); ++shaderID)
+	{
+		if (shaderBindings[shaderID].descTag == descTag)
+		{
+			return shaderID;
+		}
+	}
+	return INDEX_NONE;
+}
+
+const FEssParamBinding* FEssMaterialLayout::FindBinding(int32 shaderID, eiInt paramIndex, const char* uniqueName) const
+{
+	if (!shaderBindings.IsValidIndex(shaderID) || !shaderBindings[shaderID].params.IsValidIndex(paramIndex))
+	{
+		return NULL;
+	}
+
+	// Nodes can declare parameters of their own, the index only holds when the name still matches the desc
+	const FEssParamBinding& binding = shaderBindings[shaderID].params[paramIndex];
+	return FCStringAnsi::Strcmp(binding.uniqueName.GetData(), uniqueName) == 0 ? &binding : NULL;
+}
+#endif
+
+const FEssParamBinding* FEssMaterialLayout::FindBinding(int32 shaderID, const FString& uniqueName) const
+{
+	return shaderBindings.IsValidIndex(shaderID) ? shaderBindings[shaderID].namedParams.Find(uniqueName) : NULL;
+}
+
+#if WITH_ERSDK
+bool FEssImporter::ParseMaterial(const eiNodeAccessor& shaderNode, FParseMaterialContext& context)
+{
+	eiInt paramCount = ei_node_param_count(shaderNode.get());
+	int32 shaderID = context.layout.FindShaderID(shaderNode->desc);
+	if (INDEX_NONE == shaderID)
+	{
+		shaderID = GetShaderID(shaderNode);
+		if (INDEX_NONE == shaderID)
+		{
+			return false;
+		}
 	}
 
+	FEssParamBinding fallbackBinding;
+	auto getBinding = [&](int32 bindingShaderID, eiInt index, const eiNodeParam* pNodeParam) -> const FEssParamBinding&
+	{
+		const FEssParamBinding* pBinding = context.layout.FindBinding(bindingShaderID, index, pNodeParam->unique_name);
+		if (NULL != pBinding)
+		{
+			return *pBinding;
+		}
+
+		fallbackBinding = MakeParamBinding(context.layout, bindingShaderID, pNodeParam->unique_name);
+		return fallbackBinding;
+	};
+
 	for (eiInt i = 0; i < paramCount; ++i)
 	{
 		eiNodeParam* pNodeParam = ei_node_read_param(shaderNode.get(), i);
@@ -665,16 +1518,10 @@ bool FEssImporter::ParseMaterial(const eiNodeAccessor& shaderNode, FParseMateria
 			continue;
 		}
 
-		eiNodeAccessor inputNode(pNodeParam->inst);
-		FString inputName = FString::Printf(TEXT("e%d%s0"), shaderID, UTF8_TO_TCHAR(pNodeParam->unique_name));
-		int32* pInputParamIndex = mVectorParamMap.Find(inputName);
-		if (pInputParamIndex)
+		if (INDEX_NONE != getBinding(shaderID, i, pNodeParam).GetVectorSlot(0) && INDEX_NONE == context.parsedNodes.Find(pNodeParam->inst))
 		{
-			int* pOutputShaderNodexIndex = context.existingShaderNodesMap.Find(UTF8_TO_TCHAR(inputNode->unique_name));
-			if (NULL == pOutputShaderNodexIndex)
-			{
-				ParseMaterial(inputNode, context);
-			}
+			eiNodeAccessor inputNode(pNodeParam->inst);
+			ParseMaterial(inputNode, context);
 		}
 	}
 
@@ -687,59 +1534,48 @@ bool FEssImporter::ParseMaterial(const eiNodeAccessor& shaderNode, FParseMateria
 			continue;
 		}
 
-		FString paramName = FString::Printf(TEXT("e%d%s%d"), shaderID, UTF8_TO_TCHAR(pNodeParam->unique_name), countOfNodesOfShaderID);
+		const FEssParamBinding& binding = getBinding(shaderID, i, pNodeParam);
 		if (EI_NULL_TAG != pNodeParam->inst)
 		{
-			int32* pInputParamIndex = mVectorParamMap.Find(paramName);
-			if (pInputParamIndex)
+			int32 inputParamIndex = binding.GetVectorSlot(countOfNodesOfShaderID);
+			int32 outputShaderNodeIndex = INDEX_NONE != inputParamIndex ? context.parsedNodes.Find(pNodeParam->inst) : INDEX_NONE;
+			if (INDEX_NONE == outputShaderNodeIndex)
 			{
-				eiNodeAccessor inputNode(pNodeParam->inst);
-				int* pOutputShaderNodexIndex = context.existingShaderNodesMap.Find(UTF8_TO_TCHAR(inputNode->unique_name));
-				if (NULL == pOutputShaderNodexIndex)
-				{
-					continue;
-				}
+				continue;
+			}
 
-				eiNodeParam* pOutputParam = ei_node_read_param(inputNode.get(), pNodeParam->param);
-				if (pOutputParam)
+			eiNodeAccessor inputNode(pNodeParam->inst);
+			eiNodeParam* pOutputParam = ei_node_read_param(inputNode.get(), pNodeParam->param);
+			if (pOutputParam)
+			{
+				int32 outputShaderID = context.params.shaderNodeIDs[outputShaderNodeIndex] / 10;
+				int32 outputIndexInShader = getBinding(outputShaderID, pNodeParam->param, pOutputParam).outputIndex;
+				if (INDEX_NONE != outputIndexInShader)
 				{
-					static TMap<FString, int32> sOutputIndexMap;
-					if (sOutputIndexMap.Num() == 0)
-					{
-						sOutputIndexMap.Add(TEXT("result"), 0);
-						sOutputIndexMap.Add(TEXT("result_bump"), 1);
-						sOutputIndexMap.Add(TEXT("result_mono"), 2);
-					}
-
-					int* pOutputIndexInShader = sOutputIndexMap.Find(UTF8_TO_TCHAR(pOutputParam->unique_name));
-					if (pOutputIndexInShader)
-					{
-						FLinearColor vector = context.pMaterial->VectorParameterValues[*pInputParamIndex].ParameterValue;
-						vector.A = (*pOutputShaderNodexIndex) * 10 + *pOutputIndexInShader;
-						context.pMaterial->SetVectorParameterByIndex(*pInputParamIndex, vector);
-					}
+					context.params.vectors[inputParamIndex].A = outputShaderNodeIndex * 10 + outputIndexInShader;
+					context.params.shaderLinks.Add(inputParamIndex);
+					context.params.shaderLinks.Add(outputShaderNodeIndex * 10 + outputIndexInShader);
 				}
 			}
 		}
 		else if (IsVectorType(pNodeParam->type))
 		{
-			int32* pInputParamIndex = mVectorParamMap.Find(paramName);
-			if (pInputParamIndex)
+			int32 inputParamIndex = binding.GetVectorSlot(countOfNodesOfShaderID);
+			if (INDEX_NONE != inputParamIndex)
 			{
-				FLinearColor vector = context.pMaterial->VectorParameterValues[*pInputParamIndex].ParameterValue;
+				FLinearColor& vector = context.params.vectors[inputParamIndex];
 				vector.R = pNodeParam->value.as_vector.x;
 				vector.G = pNodeParam->value.as_vector.y;
 				if (pNodeParam->type != EI_TYPE_VECTOR2 && pNodeParam->type != EI_TYPE_HVECTOR2)
 				{
 					vector.B = pNodeParam->value.as_vector.z;
 				}
-				context.pMaterial->SetVectorParameterByIndex(*pInputParamIndex, vector);
 			}
 		}
 		else if (IsScalarType(pNodeParam->type))
 		{
-			int32* pInputParamIndex = mScalarParamMap.Find(paramName);
-			if (pInputParamIndex)
+			int32 inputParamIndex = binding.GetScalarSlot(countOfNodesOfShaderID);
+			if (INDEX_NONE != inputParamIndex)
 			{
 				float scalar = 0;
 				switch (pNodeParam->type)
@@ -757,37 +1593,142 @@ bool FEssImporter::ParseMaterial(const eiNodeAccessor& shaderNode, FParseMateria
 					scalar = pNodeParam->value.as_scalar;
 					break;
 				}
-				context.pMaterial->SetScalarParameterByIndex(*pInputParamIndex, scalar);
+				context.params.scalars[inputParamIndex] = scalar;
 			}
 		}
 		else if (EI_TYPE_TOKEN == pNodeParam->type)
 		{
 			eiToken& token = pNodeParam->value.as_token;
-			if (SHADER_ID_STDUV == shaderID && strcmp(pNodeParam->unique_name, "mapChannel") == 0)
+			if (binding.bMapChannel)
 			{
 				int uv = token.str[2] - '1';
 				uv = uv >= 2 ? 0 : uv;
-				int32* pInputParamIndex = mScalarParamMap.Find(paramName);
-				if (pInputParamIndex)
+				int32 inputParamIndex = binding.GetScalarSlot(countOfNodesOfShaderID);
+				if (INDEX_NONE != inputParamIndex)
 				{
-					context.pMaterial->SetScalarParameterByIndex(*pInputParamIndex, uv);
+					context.params.scalars[inputParamIndex] = uv;
 				}
 			}
-			else if (SHADER_ID_BITMAP == shaderID && strcmp(pNodeParam->unique_name, "tex_fileName") == 0)
+			else if (binding.bTextureFile && binding.textureSlots.IsValidIndex(countOfNodesOfShaderID))
 			{
-				FString filename = UTF8_TO_TCHAR(token.str);
-				UTexture2D* textureParam = CreateTexture2D(filename, context.pMaterial, mbInEditor);
-				if (NULL != textureParam)
+				context.params.textureNames.Add(binding.textureSlots[countOfNodesOfShaderID]);
+				context.params.textureFiles.Add(UTF8_TO_TCHAR(token.str));
+			}
+		}
+	}
+
+	context.parsedNodes.Add(shaderNode->tag);
+	int nodeID = shaderID * 10 + countOfNodesOfShaderID;
+	context.params.shaderNodeIDs.Add(nodeID);
+	countOfNodesOfShaderID++;
+	return true;
+}
+#endif
+
+bool FEssImporter::ParseMaterial(const FEssNativeNode& shaderNode, FParseMaterialContext& context)
+{
+	int32 shaderID = GetShaderTypeID(shaderNode.Type);
+	if (INDEX_NONE == shaderID)
+	{
+		return false;
+	}
+
+	// Every name the scene uses was bound up front, a missing binding means the material doesn't use the parameter
+	const FEssParamBinding unboundBinding;
+	auto getBinding = [&](int32 bindingShaderID, const FString& uniqueName) -> const FEssParamBinding&
+	{
+		const FEssParamBinding* pBinding = context.layout.FindBinding(bindingShaderID, uniqueName);
+		return NULL != pBinding ? *pBinding : unboundBinding;
+	};
+
+	for (const FEssNativeParam& param : shaderNode.Params)
+	{
+		if (!param.IsLinked() || INDEX_NONE == getBinding(shaderID, param.Name).GetVectorSlot(0))
+		{
+			continue;
+		}
+
+		const FEssNativeNode* pInputNode = mNativeScene.FindNode(param.LinkNode);
+		if (NULL != pInputNode && INDEX_NONE == context.parsedNativeNodes.Find(pInputNode))
+		{
+			ParseMaterial(*pInputNode, context);
+		}
+	}
+
+	int32& countOfNodesOfShaderID = context.shaderNodesCountPerType[shaderID];
+	for (const FEssNativeParam& param : shaderNode.Params)
+	{
+		const FEssParamBinding& binding = getBinding(shaderID, param.Name);
+		if (param.IsLinked())
+		{
+			int32 inputParamIndex = binding.GetVectorSlot(countOfNodesOfShaderID);
+			const FEssNativeNode* pInputNode = INDEX_NONE != inputParamIndex ? mNativeScene.FindNode(param.LinkNode) : NULL;
+			int32 outputShaderNodeIndex = NULL != pInputNode ? context.parsedNativeNodes.Find(pInputNode) : INDEX_NONE;
+			if (INDEX_NONE == outputShaderNodeIndex)
+			{
+				continue;
+			}
+
+			int32 outputShaderID = context.params.shaderNodeIDs[outputShaderNodeIndex] / 10;
+			int32 outputIndexInShader = getBinding(outputShaderID, param.LinkOutput).outputIndex;
+			if (INDEX_NONE != outputIndexInShader)
+			{
+				context.params.vectors[inputParamIndex].A = outputShaderNodeIndex * 10 + outputIndexInShader;
+				context.params.shaderLinks.Add(inputParamIndex);
+				context.params.shaderLinks.Add(outputShaderNodeIndex * 10 + outputIndexInShader);
+			}
+		}
+		else if (param.bArray || param.Num < 1)
+		{
+			continue;
+		}
+		else if (EEssNativeType::Vector2 == param.Type || EEssNativeType::Vector == param.Type || EEssNativeType::Vector4 == param.Type)
+		{
+			int32 inputParamIndex = binding.GetVectorSlot(countOfNodesOfShaderID);
+			if (INDEX_NONE != inputParamIndex)
+			{
+				const float* pValues = shaderNode.Floats.GetData() + param.Offset;
+				FLinearColor& vector = context.params.vectors[inputParamIndex];
+				vector.R = pValues[0];
+				vector.G = pValues[1];
+				if (EEssNativeType::Vector2 != param.Type)
 				{
-					context.pMaterial->SetTextureParameterValue(*paramName, textureParam);
+					vector.B = pValues[2];
 				}
 			}
 		}
+		else if (EEssNativeType::Int == param.Type || EEssNativeType::Scalar == param.Type)
+		{
+			int32 inputParamIndex = binding.GetScalarSlot(countOfNodesOfShaderID);
+			if (INDEX_NONE != inputParamIndex)
+			{
+				context.params.scalars[inputParamIndex] = EEssNativeType::Int == param.Type ? (float)shaderNode.Ints[param.Offset] : shaderNode.Floats[param.Offset];
+			}
+		}
+		else if (EEssNativeType::Token == param.Type)
+		{
+			const FString& token = shaderNode.Strings[param.Offset];
+			if (binding.bMapChannel && token.Len() > 2)
+			{
+				int uv = token[2] - TEXT('1');
+				uv = uv >= 2 ? 0 : uv;
+				int32 inputParamIndex = binding.GetScalarSlot(countOfNodesOfShaderID);
+				if (INDEX_NONE != inputParamIndex)
+				{
+					context.params.scalars[inputParamIndex] = uv;
+				}
+			}
+			else if (binding.bTextureFile && binding.textureSlots.IsValidIndex(countOfNodesOfShaderID))
+			{
+				context.params.textureNames.Add(binding.textureSlots[countOfNodesOfShaderID]);
+				context.params.textureFiles.Add(token);
+			}
+		}
 	}
 
-	context.existingShaderNodesMap.Add(UTF8_TO_TCHAR(shaderNode->unique_name), context.shaderNodeIDs.Num());
+	context.parsedNativeNodes.Add(&shaderNode);
 	int nodeID = shaderID * 10 + countOfNodesOfShaderID;
-	context.shaderNodeIDs.Add(nodeID);
+	context.params.shaderNodeIDs.Add(nodeID);
 	countOfNodesOfShaderID++;
 	return true;
 }
@@ -810,139 +1751,597 @@ UMaterial* GetDefaultMaterial()
 	return LoadMatFromPath(FName(TEXT("Material'/RuntimeMeshComponent/DefaultEssMat.DefaultEssMat'")));
 }
 
-UMaterialInterface* FEssImporter::GetNodeMaterial(int nodeIndex, int subMeshIndex, int mtlIndex, UPrimitiveComponent* pMeshComponent)
+UMaterialInterface* FEssImporter::GetNodeMaterial(int nodeIndex, int subMeshIndex, int mtlIndex, AActor* pSceneActor)
 {
-	char* nodeName = TCHAR_TO_UTF8(*mNodeArray[nodeIndex].name);
-	eiTag nodeTag = ei_find_node(nodeName);
-	if (EI_NULL_TAG == nodeTag)
+	if (!mNodeMaterialNames.IsValidIndex(nodeIndex) || !mNodeMaterialNames[nodeIndex].IsValidIndex(mtlIndex))
 	{
 		return NULL;
 	}
 
-	eiNodeAccessor node(nodeTag);
-	eiTag mtlListTag = getArrayTag(node, "mtl_list");
-	if (EI_NULL_TAG == mtlListTag)
+	const FString& materialName = mNodeMaterialNames[nodeIndex][mtlIndex];
+	UMaterialInterface** ppMaterial = mMaterailMap.Find(materialName);
+	if (NULL != ppMaterial && NULL != *ppMaterial)
 	{
-		return false;
+		return *ppMaterial;
 	}
 
-	eiDataTableAccessor<eiTag> mtlList(mtlListTag);
-	if (mtlIndex >= mtlList.size())
+	// Graphs were resolved by the parse workers, only creating the instance is left for the game thread
+	FEssMaterialParameters params;
+	if (!mResolvedMaterials.RemoveAndCopyValue(materialName, params))
 	{
 		return NULL;
 	}
 
-	eiTag mtlTag = mtlList.get(mtlIndex);
-	if (EI_NULL_TAG == mtlTag)
+	FEssImportScope scope(mProfiler, EEssImportStage::BuildMaterials, &materialName);
+	// Materials that only differ by name resolve to the same parameters and share one instance
+	params.pParent = FEssMaterialPermutations::Get().FindOrCreate(params.pBaseMaterial, params.shaderNodeIDs, params.shaderLinks);
+	params.BuildHashKey();
+	mResolvedMaterialCount++;
+	UMaterialInterface** ppSharedMaterial = mSharedMaterialMap.Find(params);
+	if (NULL != ppSharedMaterial)
+	{
+		mMaterailMap.Add(materialName, *ppSharedMaterial);
+		return *ppSharedMaterial;
+	}
+
+	UMaterialInterface* pMaterialInstance = CreateMaterialInstance(mMaterialLayouts[params.pBaseMaterial], params, pSceneActor);
+	if (NULL == pMaterialInstance)
 	{
 		return NULL;
 	}
 
-	eiNodeAccessor mtl(mtlTag);
-	FString materialName = UTF8_TO_TCHAR(mtl->unique_name);
-	UMaterialInstanceDynamic** ppMaterial = mMaterailMap.Find(materialName);
-	if (NULL != ppMaterial && NULL != *ppMaterial)
+	mSharedMaterialMap.Add(params, pMaterialInstance);
+	mMaterailMap.Add(materialName, pMaterialInstance);
+	return pMaterialInstance;
+}
+
+// Every node was read from the scene, so it can always be found again by its ess name. Nodes of nested groups
+// are where a scoped name would slip through, their failures say which group they are in.
+void FEssImporter::LogMissingNode(int nodeIndex) const
+{
+	const FMaxNodeInfo& nodeInfo = mNodeArray[nodeIndex];
+	if (INDEX_NONE != nodeInfo.groupIndex)
 	{
-		return *ppMaterial;
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Ess node %s of group %s can't be found in the scene, it gets the default material"),
+			*nodeInfo.essName, *mGroupArray[nodeInfo.groupIndex].name);
 	}
+	else
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Ess node %s can't be found in the scene, it gets the default material"), *nodeInfo.essName);
+	}
+}
 
+void FEssImporter::GatherMaterialNames()
+{
+	mNodeMaterialNames.Reset();
+	mNodeMaterialNames.SetNum(mNodeArray.Num());
+	for (int nodeIndex = 0; nodeIndex < mNodeArray.Num(); ++nodeIndex)
+	{
+		if (mbNativeReader)
+		{
+			// Entries without a material are empty names, the SDK has null tags there
+			const FEssNativeNode* pNode = mNativeScene.FindNode(mNodeArray[nodeIndex].essName);
+			if (NULL == pNode)
+			{
+				LogMissingNode(nodeIndex);
+				continue;
+			}
+			int32 mtlCount = 0;
+			const FString* pMtlNames = pNode->GetStrings(TEXT("mtl_list"), mtlCount);
+			if (NULL != pMtlNames)
+			{
+				mNodeMaterialNames[nodeIndex].Append(pMtlNames, mtlCount);
+			}
+			continue;
+		}
+
+#if WITH_ERSDK
+		eiTag nodeTag = ei_find_node(TCHAR_TO_UTF8(*mNodeArray[nodeIndex].essName));
+		if (EI_NULL_TAG == nodeTag)
+		{
+			LogMissingNode(nodeIndex);
+			continue;
+		}
+
+		eiNodeAccessor node(nodeTag);
+		eiTag mtlListTag = getArrayTag(node, "mtl_list");
+		if (EI_NULL_TAG == mtlListTag)
+		{
+			continue;
+		}
+
+		eiDataTableAccessor<eiTag> mtlList(mtlListTag);
+		TArray<FString>& names = mNodeMaterialNames[nodeIndex];
+		for (int i = 0; i < mtlList.size(); ++i)
+		{
+			eiTag mtlTag = mtlList.get(i);
+			if (EI_NULL_TAG != mtlTag)
+			{
+				eiNodeAccessor mtl(mtlTag);
+				names.Add(UTF8_TO_TCHAR(mtl->unique_name));
+			}
+			else
+			{
+				names.AddDefaulted();
+			}
+		}
+#endif
+	}
+}
+
+void FEssImporter::GetMaterialNames(TArray<FString>& outNames)
+{
+	if (mNodeMaterialNames.Num() != mNodeArray.Num())
+	{
+		GatherMaterialNames();
+	}
+
+	TSet<FString> names;
+	for (const TArray<FString>& nodeMaterialNames : mNodeMaterialNames)
+	{
+		for (const FString& name : nodeMaterialNames)
+		{
+			if (!name.IsEmpty())
+			{
+				names.Add(name);
+			}
+		}
+	}
+	outNames = names.Array();
+}
+
+void FEssImporter::ResolveMaterials()
+{
+	// Shader descs only exist once the file is parsed, and the bindings have to be complete before workers read them.
+	// The shader type map fills itself on first use, that must not happen on the workers either.
+	GetShaderTypeMap();
+	for (auto& iter : mMaterialLayouts)
+	{
+		BindShaderParameters(iter.Value);
+	}
+
+	TArray<FString> materialNames;
+	GetMaterialNames(materialNames);
+	TArray<FEssMaterialParameters> resolvedParams;
+	resolvedParams.SetNum(materialNames.Num());
+	TArray<bool> resolved;
+	resolved.SetNumZeroed(materialNames.Num());
+
+#if WITH_ERSDK
+	uint32 threadID = FPlatformTLS::GetCurrentThreadId();
+#endif
+	ParallelFor(materialNames.Num(), [&](int32 index)
+	{
+#if WITH_ERSDK
+		// Only the SDK needs its worker threads registered, the native scene is plain read only data
+		bool bRegisterThread = !mbNativeReader && FPlatformTLS::GetCurrentThreadId() != threadID;
+		if (bRegisterThread)
+		{
+			ei_job_register_thread();
+		}
+#endif
+		{
+			FEssImportScope scope(mProfiler, EEssImportStage::BuildMaterials, &materialNames[index]);
+			resolved[index] = ResolveMaterial(materialNames[index], resolvedParams[index]);
+		}
+#if WITH_ERSDK
+		if (bRegisterThread)
+		{
+			ei_job_unregister_thread();
+		}
+#endif
+	}, !MULTI_THREADING_BUILD);
+
+	for (int32 index = 0; index < materialNames.Num(); ++index)
+	{
+		if (resolved[index])
+		{
+			mMaterialHashes.Add(materialNames[index], resolvedParams[index].BuildContentHash());
+			mResolvedMaterials.Add(materialNames[index], MoveTemp(resolvedParams[index]));
+		}
+	}
+}
+
+bool FEssImporter::ResolveMaterial(const FString& materialName, FEssMaterialParameters& outParams)
+{
+	if (mbNativeReader)
+	{
+		const FEssNativeNode* pMtl = mNativeScene.FindNode(materialName);
+		return NULL != pMtl && ResolveMaterial(*pMtl, outParams);
+	}
+
+#if WITH_ERSDK
+	eiTag mtlTag = ei_find_node(TCHAR_TO_UTF8(*materialName));
+	if (EI_NULL_TAG == mtlTag)
+	{
+		return false;
+	}
+
+	eiNodeAccessor mtl(mtlTag);
+	return ResolveMaterial(mtl, outParams);
+#else
+	return false;
+#endif
+}
+
+#if WITH_ERSDK
+
+bool FEssImporter::ResolveMaterial(const eiNodeAccessor& mtl, FEssMaterialParameters& params)
+{
 	eiTag surfaceShaderTag = ei_node_get_node(mtl.get(), ei_node_find_param(mtl.get(), "surface_shader"));
 	if (EI_NULL_TAG == surfaceShaderTag)
 	{
-		return NULL;
+		return false;
 	}
 
 	eiNodeAccessor surfaceShader(surfaceShaderTag);
 	eiTag shaderNodesListTag = getArrayTag(surfaceShader, "nodes");
 	if (EI_NULL_TAG == shaderNodesListTag)
 	{
-		return NULL;
+		return false;
 	}
 
 	eiDataTableAccessor<eiTag> shaderNodes(shaderNodesListTag);
 	eiTag shaderNodeTag = shaderNodes.get(0);
 	if (EI_NULL_TAG == shaderNodeTag)
 	{
-		return NULL;
+		return false;
 	}
 
 	eiNodeAccessor shaderNode(shaderNodeTag);
 	eiInt inputIndex = ei_node_find_param(shaderNode.get(), "input");
 	if (EI_NULL_INDEX == inputIndex)
 	{
-		return NULL;
+		return false;
 	}
 
 	eiNodeParam* pNodeParam = ei_node_read_param(shaderNode.get(), inputIndex);
 	if (NULL == pNodeParam || EI_NULL_TAG == pNodeParam->inst)
 	{
-		return NULL;
+		return false;
 	}
 
 	eiNodeAccessor shaderRoot(pNodeParam->inst);
 	if (GetShaderID(shaderRoot) == INDEX_NONE)
 	{
-		return NULL;
+		return false;
 	}
 
 	bool isTransparent = IsTransparentMaterial(shaderRoot);
-	UMaterial* pEssMaterial = LoadMatFromPath(isTransparent ? FName(TEXT("Material'/RuntimeMeshComponent/EssMaterialTransparent.EssMaterialTransparent'")) : 
-		FName(TEXT("Material'/RuntimeMeshComponent/EssMaterial.EssMaterial'")));
-	if (NULL == pEssMaterial)
+	UMaterial* pEssMaterial = mEssMaterials[isTransparent ? 1 : 0];
+	const FEssMaterialLayout* pLayout = mMaterialLayouts.Find(pEssMaterial);
+	if (NULL == pEssMaterial || NULL == pLayout)
 	{
-		return NULL;
+		return false;
 	}
 
-	UMaterialInstanceDynamic* pDynamicMaterialInstance = pMeshComponent->CreateDynamicMaterialInstance(subMeshIndex, pEssMaterial);
-	if (NULL == pDynamicMaterialInstance)
+	params.pBaseMaterial = pEssMaterial;
+	FParseMaterialContext context(*pLayout, params);
+	ParseMaterial(shaderRoot, context);
+	WriteShaderNodeIDs(*pLayout, params);
+	return true;
+}
+#endif
+
+bool FEssImporter::ResolveMaterial(const FEssNativeNode& mtl, FEssMaterialParameters& params)
+{
+	const FString* pSurfaceShaderName = mtl.GetNodeRef(TEXT("surface_shader"));
+	const FEssNativeNode* pSurfaceShader = NULL != pSurfaceShaderName ? mNativeScene.FindNode(*pSurfaceShaderName) : NULL;
+	if (NULL == pSurfaceShader)
 	{
-		return NULL;
+		return false;
 	}
 
+	const FString* pShaderNodeName = pSurfaceShader->GetNodeRef(TEXT("nodes"));
+	const FEssNativeNode* pShaderNode = NULL != pShaderNodeName ? mNativeScene.FindNode(*pShaderNodeName) : NULL;
+	const FEssNativeParam* pInput = NULL != pShaderNode ? pShaderNode->FindParam(TEXT("input")) : NULL;
+	if (NULL == pInput || !pInput->IsLinked())
+	{
+		return false;
+	}
+
+	const FEssNativeNode* pShaderRoot = mNativeScene.FindNode(pInput->LinkNode);
+	if (NULL == pShaderRoot || GetShaderTypeID(pShaderRoot->Type) == INDEX_NONE)
+	{
+		return false;
+	}
+
+	bool isTransparent = IsTransparentMaterial(*pShaderRoot);
+	UMaterial* pEssMaterial = mEssMaterials[isTransparent ? 1 : 0];
+	const FEssMaterialLayout* pLayout = mMaterialLayouts.Find(pEssMaterial);
+	if (NULL == pEssMaterial || NULL == pLayout)
+	{
+		return false;
+	}
+
+	params.pBaseMaterial = pEssMaterial;
+	FParseMaterialContext context(*pLayout, params);
+	ParseMaterial(*pShaderRoot, context);
+	WriteShaderNodeIDs(*pLayout, params);
+	return true;
+}
+
+void FEssImporter::PrepareMaterialLayouts()
+{
+	mEssMaterials[0] = LoadMatFromPath(FName(TEXT("Material'/RuntimeMeshComponent/EssMaterial.EssMaterial'")));
+	mEssMaterials[1] = LoadMatFromPath(FName(TEXT("Material'/RuntimeMeshComponent/EssMaterialTransparent.EssMaterialTransparent'")));
+	for (UMaterial* pEssMaterial : mEssMaterials)
+	{
+		if (NULL != pEssMaterial && !mMaterialLayouts.Contains(pEssMaterial))
+		{
+			BuildMaterialLayout(pEssMaterial, mMaterialLayouts.Add(pEssMaterial));
+		}
+	}
+}
+
+void FEssImporter::BuildMaterialLayout(UMaterial* pEssMaterial, FEssMaterialLayout& layout)
+{
+	// A throwaway instance is the cheapest way to enumerate the parameters with their defaults
+	UMaterialInstanceDynamic* pDynamicMaterialInstance = UMaterialInstanceDynamic::Create(pEssMaterial, GetTransientPackage());
 	pDynamicMaterialInstance->CopyScalarAndVectorParameters(*pEssMaterial, ERHIFeatureLevel::SM5);
-	mMaterailMap.Add(materialName, pDynamicMaterialInstance);
-	if (mVectorParamMap.Num() == 0)
+	for (int i = 0; i < pDynamicMaterialInstance->VectorParameterValues.Num(); ++i)
 	{
-		for (int i = 0; i < pDynamicMaterialInstance->VectorParameterValues.Num(); ++i)
+		const FVectorParameterValue& value = pDynamicMaterialInstance->VectorParameterValues[i];
+		layout.vectorParamMap.Add(value.ParameterName.ToString(), i);
+		layout.vectorNames.Add(value.ParameterName);
+		layout.vectorDefaults.Add(value.ParameterValue);
+	}
+
+	for (int i = 0; i < pDynamicMaterialInstance->ScalarParameterValues.Num(); ++i)
+	{
+		const FScalarParameterValue& value = pDynamicMaterialInstance->ScalarParameterValues[i];
+		layout.scalarParamMap.Add(value.ParameterName.ToString(), i);
+		layout.scalarNames.Add(value.ParameterName);
+		layout.scalarDefaults.Add(value.ParameterValue);
+	}
+	pDynamicMaterialInstance->MarkPendingKill();
+
+	for (int i = 0; ; ++i)
+	{
+		const int32* pNodeIdIndex = layout.scalarParamMap.Find(FString::Printf(TEXT("ess_nodeID%d"), i));
+		if (NULL == pNodeIdIndex)
 		{
-			mVectorParamMap.Add(pDynamicMaterialInstance->VectorParameterValues[i].ParameterName.ToString(), i);
+			break;
 		}
+		layout.nodeIDSlots.Add(*pNodeIdIndex);
 	}
-	
-	if (mScalarParamMap.Num() == 0)
+	const int32* pShaderCountIndex = layout.scalarParamMap.Find(TEXT("ess_shaderCount"));
+	layout.shaderCountSlot = pShaderCountIndex ? *pShaderCountIndex : INDEX_NONE;
+}
+
+static void BindNamedParameter(FEssMaterialLayout& layout, int32 shaderID, const FString& uniqueName)
+{
+	TMap<FString, FEssParamBinding>& namedParams = layout.shaderBindings[shaderID].namedParams;
+	if (!namedParams.Contains(uniqueName))
 	{
-		for (int i = 0; i < pDynamicMaterialInstance->ScalarParameterValues.Num(); ++i)
+		namedParams.Add(uniqueName, MakeParamBinding(layout, shaderID, TCHAR_TO_UTF8(*uniqueName)));
+	}
+}
+
+void FEssImporter::BindShaderParameters(FEssMaterialLayout& layout)
+{
+	// Every parameter of every shader type is bound once here, parsing then only indexes these tables
+	layout.shaderBindings.Reset();
+	layout.shaderBindings.SetNum(GetShaderTypeMap().Num());
+	if (mbNativeReader)
+	{
+		// Without descs the names the shader nodes set and the outputs links read from are all there is to bind
+		for (const FEssNativeNode& node : mNativeScene.GetNodes())
 		{
-			mScalarParamMap.Add(pDynamicMaterialInstance->ScalarParameterValues[i].ParameterName.ToString(), i);
+			int32 shaderID = GetShaderTypeID(node.Type);
+			if (INDEX_NONE == shaderID)
+			{
+				continue;
+			}
+
+			for (const FEssNativeParam& param : node.Params)
+			{
+				BindNamedParameter(layout, shaderID, param.Name);
+				const FEssNativeNode* pLinkedNode = param.IsLinked() ? mNativeScene.FindNode(param.LinkNode) : NULL;
+				int32 linkedShaderID = NULL != pLinkedNode ? GetShaderTypeID(pLinkedNode->Type) : INDEX_NONE;
+				if (INDEX_NONE != linkedShaderID)
+				{
+					BindNamedParameter(layout, linkedShaderID, param.LinkOutput);
+				}
+			}
 		}
+		return;
 	}
-	
-	FParseMaterialContext context(pDynamicMaterialInstance);
-	ParseMaterial(shaderRoot, context);
-	for (int i = 0; i < context.shaderNodeIDs.Num(); ++i)
+
+#if WITH_ERSDK
+	for (auto& iter : GetShaderTypeMap())
+	{
+		eiTag descTag = ei_find_node_desc(TCHAR_TO_UTF8(*iter.Key));
+		if (EI_NULL_TAG == descTag)
+		{
+			continue;
+		}
+
+		FEssShaderBindings& shaderBindings = layout.shaderBindings[iter.Value];
+		shaderBindings.descTag = descTag;
+		eiDataAccessor<eiNodeDesc> desc(descTag);
+		eiUint paramCount = ei_node_desc_param_count(desc.get());
+		for (eiUint i = 0; i < paramCount; ++i)
+		{
+			shaderBindings.params.Add(MakeParamBinding(layout, iter.Value, ei_node_desc_param_name(desc.get(), i)));
+		}
+	}
+#endif
+}
+
+
+UTexture2D* FEssImporter::GetTexture(const FString& filename, UObject* pOwner)
+{
+	UTexture2D** ppTexture = mTextureMap.Find(filename);
+	if (NULL != ppTexture)
+	{
+		return *ppTexture;
+	}
+
+	// Failed decodes are cached too so a missing file is only tried once
+	FEssImportScope scope(mProfiler, EEssImportStage::DecodeTextures, &filename);
+	UTexture2D* pTexture = CreateTexture2D(filename, pOwner, mbInEditor);
+	mTextureMap.Add(filename, pTexture);
+	FRuntimeMeshMemoryTracker::AddTexture(pTexture);
+	return pTexture;
+}
+
+UMaterialInterface* FEssImporter::CreateMaterialInstance(const FEssMaterialLayout& layout, const FEssMaterialParameters& params, AActor* pSceneActor)
+{
+	// Only parameters that differ from the material defaults become overrides
+#if WITH_EDITOR
+	if (mbInEditor)
+	{
+		// Imported scenes are static, constant instances skip the per instance uniform updates of dynamic ones
+		UMaterialInstanceConstant* pConstantInstance = NewObject<UMaterialInstanceConstant>(pSceneActor, NAME_None, RF_Transactional);
+		pConstantInstance->SetParentEditorOnly(params.pParent);
+		for (int i = 0; i < params.scalars.Num(); ++i)
+		{
+			if (params.scalars[i] != layout.scalarDefaults[i])
+			{
+				pConstantInstance->SetScalarParameterValueEditorOnly(layout.scalarNames[i], params.scalars[i]);
+			}
+		}
+		for (int i = 0; i < params.vectors.Num(); ++i)
+		{
+			if (params.vectors[i] != layout.vectorDefaults[i])
+			{
+				pConstantInstance->SetVectorParameterValueEditorOnly(layout.vectorNames[i], params.vectors[i]);
+			}
+		}
+		for (int i = 0; i < params.textureNames.Num(); ++i)
+		{
+			UTexture2D* pTexture = GetTexture(params.textureFiles[i], pSceneActor);
+			if (NULL != pTexture)
+			{
+				pConstantInstance->SetTextureParameterValueEditorOnly(params.textureNames[i], pTexture);
+			}
+		}
+		pConstantInstance->PostEditChange();
+		return pConstantInstance;
+	}
+#endif
+
+	UMaterialInstanceDynamic* pDynamicMaterialInstance = UMaterialInstanceDynamic::Create(params.pParent, pSceneActor);
+	if (NULL == pDynamicMaterialInstance)
 	{
-		FString paramName = FString::Printf(TEXT("ess_nodeID%d"), i);
-		int32* pNodeIdIndex = mScalarParamMap.Find(paramName);
-		if (pNodeIdIndex)
+		return NULL;
+	}
+
+	for (int i = 0; i < params.scalars.Num(); ++i)
+	{
+		if (params.scalars[i] != layout.scalarDefaults[i])
 		{
-			context.pMaterial->SetScalarParameterByIndex(*pNodeIdIndex, context.shaderNodeIDs[i]);
+			pDynamicMaterialInstance->SetScalarParameterValue(layout.scalarNames[i], params.scalars[i]);
 		}
 	}
-	int32* pScalarIndex = mScalarParamMap.Find(TEXT("ess_shaderCount"));
-	if (pScalarIndex)
+	for (int i = 0; i < params.vectors.Num(); ++i)
 	{
-		context.pMaterial->SetScalarParameterByIndex(*pScalarIndex, context.shaderNodeIDs.Num());
+		if (params.vectors[i] != layout.vectorDefaults[i])
+		{
+			pDynamicMaterialInstance->SetVectorParameterValue(layout.vectorNames[i], params.vectors[i]);
+		}
+	}
+	for (int i = 0; i < params.textureNames.Num(); ++i)
+	{
+		UTexture2D* pTexture = GetTexture(params.textureFiles[i], pSceneActor);
+		if (NULL != pTexture)
+		{
+			pDynamicMaterialInstance->SetTextureParameterValue(params.textureNames[i], pTexture);
+		}
 	}
 	return pDynamicMaterialInstance;
 }
 
+void FEssImporter::AddReferencedObjects(FReferenceCollector& Collector)
+{
+	for (auto& iter : mMaterailMap)
+	{
+		Collector.AddReferencedObject(iter.Value);
+	}
+	for (auto& iter : mSharedMaterialMap)
+	{
+		Collector.AddReferencedObject(iter.Value);
+	}
+	for (auto& iter : mTextureMap)
+	{
+		Collector.AddReferencedObject(iter.Value);
+	}
+}
+
+void FEssImporter::LogMaterialSharing() const
+{
+	if (mResolvedMaterialCount == 0)
+	{
+		return;
+	}
+
+	int32 instanceCount = mSharedMaterialMap.Num();
+	UE_LOG(RuntimeMeshLog, Log, TEXT("Ess materials: %d resolved, %d unique instances, dedup ratio %.2f, %d textures"),
+		mResolvedMaterialCount, instanceCount, (float)mResolvedMaterialCount / FMath::Max(instanceCount, 1), mTextureMap.Num());
+}
+
+void FEssImporter::OptimizeMeshArray(TMeshArray& meshArray)
+{
+	if (CVarEssOptimizeMeshes.GetValueOnAnyThread() == 0)
+	{
+		return;
+	}
+
+	FRuntimeMeshCacheStats totalBefore, totalAfter;
+	for (FMeshInfo& meshInfo : meshArray)
+	{
+		TArray<int32> newToOld;
+		FRuntimeMeshCacheStats before, after;
+		FRuntimeMeshOptimizer::Optimize(meshInfo.Triangles, meshInfo.Vertices, newToOld, &before, &after);
+		if (newToOld.Num() == 0)
+		{
+			continue;
+		}
+
+		FRuntimeMeshOptimizer::RemapVertices(meshInfo.Vertices, newToOld);
+		FRuntimeMeshOptimizer::RemapVertices(meshInfo.Normals, newToOld);
+		FRuntimeMeshOptimizer::RemapVertices(meshInfo.Tangents, newToOld);
+		FRuntimeMeshOptimizer::RemapVertices(meshInfo.Uv1s, newToOld);
+		FRuntimeMeshOptimizer::RemapVertices(meshInfo.Uv2s, newToOld);
+
+		totalBefore += before;
+		totalAfter += after;
+	}
+
+	FScopeLock lock(&mCacheStatsLock);
+	mCacheStatsBefore += totalBefore;
+	mCacheStatsAfter += totalAfter;
+}
+
+void FEssImporter::LogMeshOptimization() const
+{
+	if (mCacheStatsBefore.NumTriangles == 0)
+	{
+		return;
+	}
+
+	UE_LOG(RuntimeMeshLog, Log, TEXT("Ess meshes: %d triangles optimized for a %d entry vertex cache, ACMR %.3f -> %.3f, ATVR %.3f -> %.3f"),
+		mCacheStatsAfter.NumTriangles, FRuntimeMeshOptimizer::DefaultCacheSize, mCacheStatsBefore.GetACMR(), mCacheStatsAfter.GetACMR(),
+		mCacheStatsBefore.GetATVR(), mCacheStatsAfter.GetATVR());
+}
+
 uint32 FEssImporter::Run()
 {
-	ei_job_register_thread();
-	ei_sub_context();
-	mParseResult = DoParseEssFile();
-	ei_end_sub_context();
-	ei_job_unregister_thread();
+	if (mbNativeReader)
+	{
+		mParseResult = DoParseEssFile();
+	}
+#if WITH_ERSDK
+	else
+	{
+		ei_job_register_thread();
+		ei_sub_context();
+		mParseResult = DoParseEssFile();
+		ei_end_sub_context();
+		ei_job_unregister_thread();
+	}
+#endif
 	mParseFinished.AtomicSet(true);
 	return 0;
 }
@@ -952,6 +2351,16 @@ int FEssImporter::GetNodeCount() const
 	return mNodeArray.Num();
 }
 
+int FEssImporter::GetGroupCount() const
+{
+	return mGroupArray.Num();
+}
+
+const FMaxGroupInfo* FEssImporter::GetGroupInfo(int index) const
+{
+	return mGroupArray.IsValidIndex(index) ? &mGroupArray[index] : NULL;
+}
+
 const FMaxNodeInfo* FEssImporter::GetNodeInfo(int index) const
 {
 	if (index < GetNodeCount())
@@ -962,6 +2371,34 @@ const FMaxNodeInfo* FEssImporter::GetNodeInfo(int index) const
 	return NULL;
 }
 
+uint32 FEssImporter::GetMeshHash(const FString& meshName) const
+{
+	const FMeshMapInfo* pMeshMapInfo = mMeshMap.Find(meshName);
+	return NULL != pMeshMapInfo ? pMeshMapInfo->contentHash : 0;
+}
+
+uint32 FEssImporter::GetNodeMaterialHash(int nodeIndex)
+{
+	if (mNodeMaterialNames.Num() != mNodeArray.Num())
+	{
+		GatherMaterialNames();
+	}
+	if (!mNodeMaterialNames.IsValidIndex(nodeIndex))
+	{
+		return 0;
+	}
+
+	uint32 hash = 0;
+	for (const FString& materialName : mNodeMaterialNames[nodeIndex])
+	{
+		hash = FCrc::StrCrc32(*materialName, hash);
+		const uint32* pMaterialHash = mMaterialHashes.Find(materialName);
+		uint32 materialHash = NULL != pMaterialHash ? *pMaterialHash : 0;
+		hash = FCrc::MemCrc32(&materialHash, sizeof(materialHash), hash);
+	}
+	return hash;
+}
+
 const FEssImporter::TMeshArray* FEssImporter::GetMeshInfo(const FString& meshName) const
 {
 	const FMeshMapInfo* pMeshMapInfo = mMeshMap.Find(meshName);
@@ -1,16 +1,38 @@
 #pragma once
 #include "Engine.h"
 #include "RuntimeMeshCore.h"
+#include "EssImportProfiler.h"
+#include "EssNativeReader.h"
+#include "RuntimeMeshOptimizer.h"
+#if WITH_ERSDK
 #include <ei.h>
 #include <ei_data_table.h>
+#endif
 #include <Public/HAL/ThreadSafeBool.h>
+#include "Containers/Queue.h"
 
 struct FMaxNodeInfo
 {
+	FMaxNodeInfo() : groupIndex(INDEX_NONE) { }
+
+	/* Name scoped by the enclosing groups, unique within the scene and used for the component */
 	FString name;
+	/* Name of the node in the ess scene, lookups into the scene have to use this one */
+	FString essName;
 	FString meshName;
 	FMatrix matrix;
-	bool bInvertVertexOrder;
+	/* Instance group the node is nested in, INDEX_NONE for nodes directly under the scene */
+	int groupIndex;
+};
+
+/* A nested instance group, the nodes and groups below it move along with it */
+struct FMaxGroupInfo
+{
+	FString name;
+	/* Enclosing group, groups always come after their parent in the group array */
+	int parentIndex;
+	/* World transform, converted the same way as the node matrices */
+	FMatrix matrix;
 };
 
 struct FMeshInfo
@@ -21,14 +43,98 @@ struct FMeshInfo
 	TArray<FVector2D> Uv1s;
 	TArray<FVector2D> Uv2s;
 	TArray<int32> Triangles;
-	TArray<int32> InvertTriangles;
 	
 	int mtlIndex;
 };
 
+// Node ids encode the instance of a shader type in their last decimal digit
+#define ESS_MAX_SHADER_SLOTS 10
+
+/* Material parameters one parameter of an ess shader type binds to, indexed by the instance slot of the node within its type */
+struct FEssParamBinding
+{
+	FEssParamBinding() : outputIndex(INDEX_NONE), bMapChannel(false), bTextureFile(false) { }
+
+	inline int32 GetVectorSlot(int32 slot) const { return slot < vectorSlots.Num() ? vectorSlots[slot] : INDEX_NONE; }
+	inline int32 GetScalarSlot(int32 slot) const { return slot < scalarSlots.Num() ? scalarSlots[slot] : INDEX_NONE; }
+
+	TArray<ANSICHAR> uniqueName;
+	TArray<int32> vectorSlots;
+	TArray<int32> scalarSlots;
+	TArray<FName> textureSlots;
+	// When another node links to this parameter as its input: 0 result, 1 result_bump, 2 result_mono
+	int32 outputIndex;
+	bool bMapChannel;
+	bool bTextureFile;
+};
+
+/* Bindings of every parameter of one shader type, in the parameter order of its node desc */
+struct FEssShaderBindings
+{
+#if WITH_ERSDK
+	FEssShaderBindings() : descTag(EI_NULL_TAG) { }
+
+	eiTag descTag;
+#endif
+	TArray<FEssParamBinding> params;
+	// The native reader has no descs, it binds every parameter name the scene uses instead
+	TMap<FString, FEssParamBinding> namedParams;
+};
+
+/* Parameter names of an ess uber material with their defaults, indices match the parameter value arrays of FEssMaterialParameters */
+struct FEssMaterialLayout
+{
+	FEssMaterialLayout() : shaderCountSlot(INDEX_NONE) { }
+
+#if WITH_ERSDK
+	int32 FindShaderID(eiTag descTag) const;
+	// Returns NULL when the node doesn't follow the parameter order of its desc at this index
+	const FEssParamBinding* FindBinding(int32 shaderID, eiInt paramIndex, const char* uniqueName) const;
+#endif
+	const FEssParamBinding* FindBinding(int32 shaderID, const FString& uniqueName) const;
+
+	TMap<FString, int32> vectorParamMap;
+	TMap<FString, int32> scalarParamMap;
+	TArray<FName> vectorNames;
+	TArray<FName> scalarNames;
+	TArray<FLinearColor> vectorDefaults;
+	TArray<float> scalarDefaults;
+	TArray<int32> nodeIDSlots;
+	int32 shaderCountSlot;
+	TArray<FEssShaderBindings> shaderBindings;
+};
+
+/* Fully resolved parameters of one ess material, materials with equal parameters share one instance */
+struct FEssMaterialParameters
+{
+	FEssMaterialParameters() : pBaseMaterial(NULL), pParent(NULL), hashKey(0) { }
+
+	UMaterial* pBaseMaterial;
+	UMaterial* pParent;
+	TArray<int32> shaderNodeIDs;
+	// Wiring between the nodes, pairs of the vector slot of a linked input and the output it reads (node index * 10 + output)
+	TArray<int32> shaderLinks;
+	TArray<float> scalars;
+	TArray<FLinearColor> vectors;
+	TArray<FName> textureNames;
+	TArray<FString> textureFiles;
+	uint32 hashKey;
+
+	void BuildHashKey();
+	// Hash of the parameter values that stays the same across sessions
+	uint32 BuildContentHash() const;
+};
+
+bool operator==(const FEssMaterialParameters& A, const FEssMaterialParameters& B);
+
+inline uint32 GetTypeHash(const FEssMaterialParameters& Key)
+{
+	return Key.hashKey;
+}
+
 struct FParseMaterialContext;
 
-class FEssImporter : public FRunnable
+class FEssImporter : public FRunnable, public FGCObject
 {
 public:
 	FEssImporter();
@@ -36,47 +142,137 @@ public:
 
 	typedef TArray<FMeshInfo> TMeshArray;
 	bool Initialize(const FString& FullPath, const FTimerDelegate& timerDelegate, bool inEditor);
+	// Parses on the calling thread without the viewport timer, for tools and headless runs
+	bool ParseBlocking(const FString& FullPath);
+	// Reads the file with FEssNativeScene instead of the Elara SDK, has to be set before parsing starts
+	void SetNativeReader(bool bNativeReader);
+	inline bool IsNativeReader() const { return mbNativeReader; }
+	// Publishes the nodes with their bounds before any mesh is built, then builds the meshes nearest the view first.
+	// Has to be set before parsing starts, the poll timer keeps running until StopPolling
+	void SetProgressive(bool bProgressive);
+	inline bool IsProgressive() const { return mbProgressive; }
+	inline bool AreNodesReady() const { return mNodesReady; }
+	// Bounds of the raw positions of a mesh, valid once the nodes are ready
+	const FBox& GetMeshBounds(const FString& meshName) const;
+	// Fraction of the view a node covers, its bounding sphere radius over its distance
+	float GetNodeScreenSize(int nodeIndex, const FVector& viewLocation) const;
+	// Called from the game thread, the workers pick the next meshes by it
+	void SetViewLocation(const FVector& viewLocation);
+	// Meshes finished since the last call, in the order they were built
+	bool PopReadyMesh(FString& outMeshName);
+	void StopPolling();
 
 	int GetNodeCount() const;
 	const FMaxNodeInfo* GetNodeInfo(int index) const;
+	int GetGroupCount() const;
+	const FMaxGroupInfo* GetGroupInfo(int index) const;
 	const TMeshArray* GetMeshInfo(const FString& meshName) const;
+	// Content hash of the built sections of a mesh, equal hashes mean the sections are identical
+	uint32 GetMeshHash(const FString& meshName) const;
+	// Hash of the names and parameters of every material a node uses
+	uint32 GetNodeMaterialHash(int nodeIndex);
 	bool CheckParseFinished();
 	inline bool GetParseResult() const { return mParseResult; };
-	UMaterialInterface* GetNodeMaterial(int nodeIndex, int subMeshIndex, int mtlIndex, UPrimitiveComponent* pMeshComponent);
+	// Instances and textures are shared across the components of a scene, so they are outered to the scene actor
+	UMaterialInterface* GetNodeMaterial(int nodeIndex, int subMeshIndex, int mtlIndex, AActor* pSceneActor);
+	inline FEssImportProfiler& GetProfiler() { return mProfiler; }
+	// Logs how many ess materials collapsed into each shared material instance
+	void LogMaterialSharing() const;
+	// Logs the vertex cache efficiency of the imported sections before and after they were optimized
+	void LogMeshOptimization() const;
+	// Unique names of every material referenced by the scene nodes
+	void GetMaterialNames(TArray<FString>& outNames);
+	// Resolves a material to its parameters without instantiating it
+	bool ResolveMaterial(const FString& materialName, FEssMaterialParameters& outParams);
+
+	// FGCObject, the material and texture caches hold the only references until a component uses them
+	virtual void AddReferencedObjects(FReferenceCollector& Collector) override;
 
 private:
 	struct FMeshMapInfo
 	{
 		FMeshMapInfo()
 		{
-			bHasOriginalVertexOrder = false;
-			bHasInvertVertexOrder = false;
+			contentHash = 0;
+			bounds.Init();
 		}
 
-		bool bHasOriginalVertexOrder;
-		bool bHasInvertVertexOrder;
 		TMeshArray meshArray;
+		uint32 contentHash;
+		FBox bounds;
 	};
-	typedef eiDataAccessor<eiNode> eiNodeAccessor;
-	typedef eiDeferDataAccessor<eiNode> eiDeferNodeAccessor;
 	typedef TMap<FString, FMeshMapInfo> TMeshMap;
 
 	bool DoParseEssFile();
-	void InsertNodeInfo(const eiNodeAccessor& node);
+	// Matrices are world transforms in max space, names are made unique by the group they are nested in
+	void AddNodeInfo(const FString& name, const FString& meshName, const FMatrix& maxMatrix, int groupIndex);
+	int AddGroupInfo(const FString& name, const FMatrix& maxMatrix, int parentIndex);
+	FString GetScopedName(const FString& name, int groupIndex) const;
+#if WITH_ERSDK
+	typedef eiDataAccessor<eiNode> eiNodeAccessor;
+	typedef eiDeferDataAccessor<eiNode> eiDeferNodeAccessor;
+
+	void InsertNodeInfo(const eiNodeAccessor& node, int groupIndex, const FMatrix& parentMatrix, int depth);
 	bool ParseMesh(const eiNodeAccessor& node, FMeshMapInfo& meshMapInfo);
+	bool ResolveMaterial(const eiNodeAccessor& mtl, FEssMaterialParameters& params);
 	bool ParseMaterial(const eiNodeAccessor& shaderNode, FParseMaterialContext& context);
+#endif
+	bool DoParseEssFileNative();
+	void InsertNodeInfo(const FEssNativeNode& node, int groupIndex, const FMatrix& parentMatrix, int depth);
+	bool ParseMesh(const FEssNativeNode& node, FMeshMapInfo& meshMapInfo);
+	bool ResolveMaterial(const FEssNativeNode& mtl, FEssMaterialParameters& params);
+	bool ParseMaterial(const FEssNativeNode& shaderNode, FParseMaterialContext& context);
+	// Worker side of material import, resolves the graph of every referenced material into plain parameters
+	void ResolveMaterials();
+	void GatherMaterialNames();
+	void LogMissingNode(int nodeIndex) const;
+	// Reorders the sections of a parsed mesh for the vertex cache, overdraw and vertex fetch
+	void OptimizeMeshArray(TMeshArray& meshArray);
+	// Progressive imports: node bounds from the mesh bounds, then the meshes in order of the screen size of their nodes
+	void PublishNodes();
+	bool GetViewLocation(FVector& outViewLocation);
+	void BuildMeshesByPriority(const TArray<FString>& meshNames, TFunctionRef<void(int32)> buildMesh);
+	// Loads the uber materials and enumerates their parameters, needs the game thread
+	void PrepareMaterialLayouts();
+	void BuildMaterialLayout(UMaterial* pEssMaterial, FEssMaterialLayout& layout);
+	void BindShaderParameters(FEssMaterialLayout& layout);
+	UTexture2D* GetTexture(const FString& filename, UObject* pOwner);
+	UMaterialInterface* CreateMaterialInstance(const FEssMaterialLayout& layout, const FEssMaterialParameters& params, AActor* pSceneActor);
 	FRunnableThread* m_pThread;
 	FString m_strFullPath;
 
 	virtual uint32 Run() override;
 
 	TArray<FMaxNodeInfo> mNodeArray;
+	TArray<FMaxGroupInfo> mGroupArray;
 	TMeshMap mMeshMap;
 	FTimerHandle mTimerHandle;
 	FThreadSafeBool mParseFinished;
 	bool mParseResult;
-	TMap<FString, UMaterialInstanceDynamic*> mMaterailMap;
-	TMap<FString, int32> mVectorParamMap;
-	TMap<FString, int32> mScalarParamMap;
+	TMap<FString, UMaterialInterface*> mMaterailMap;
+	TMap<FEssMaterialParameters, UMaterialInterface*> mSharedMaterialMap;
+	TMap<UMaterial*, FEssMaterialLayout> mMaterialLayouts;
+	TArray<TArray<FString>> mNodeMaterialNames;
+	TMap<FString, FEssMaterialParameters> mResolvedMaterials;
+	TMap<FString, uint32> mMaterialHashes;
+	TMap<FString, UTexture2D*> mTextureMap;
+	UMaterial* mEssMaterials[2];
+	int32 mResolvedMaterialCount;
 	bool mbInEditor;
+	bool mbBlockingContext;
+	bool mbNativeReader;
+	bool mbProgressive;
+	// Transient mesh build data goes to per worker arenas instead of the heap
+	bool mbTransientArena;
+	FThreadSafeBool mNodesReady;
+	TArray<FBoxSphereBounds> mNodeBounds;
+	TQueue<FString, EQueueMode::Mpsc> mReadyMeshes;
+	FCriticalSection mViewLock;
+	FVector mViewLocation;
+	bool mbHasViewLocation;
+	FEssNativeScene mNativeScene;
+	FEssImportProfiler mProfiler;
+	FCriticalSection mCacheStatsLock;
+	FRuntimeMeshCacheStats mCacheStatsBefore;
+	FRuntimeMeshCacheStats mCacheStatsAfter;
 };
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "EssLiveSync.h"
+#include "RuntimeMeshLibrary.h"
+#include "Common/TcpListener.h"
+#include "Interfaces/IPv4/IPv4Endpoint.h"
+#include "Sockets.h"
+#include "SocketSubsystem.h"
+#include "Async/Async.h"
+
+static const int32 ESS_LIVE_SYNC_DEFAULT_PORT = 7171;
+// Connections that stall longer than this are dropped so one broken client can't block the listener
+static const double ESS_LIVE_SYNC_TIMEOUT = 10.0;
+// Scenes are received into one TArray
+static const uint64 ESS_LIVE_SYNC_MAX_SCENE_SIZE = MAX_int32;
+
+FEssLiveSync& FEssLiveSync::Get()
+{
+	static FEssLiveSync Instance;
+	return Instance;
+}
+
+void FEssLiveSync::Shutdown()
+{
+	FEssLiveSync& liveSync = Get();
+	liveSync.Stop();
+	liveSync.DeletePendingFile();
+}
+
+bool FEssLiveSync::Start(int32 port, bool bInEditor)
+{
+	Stop();
+
+	mbInEditor = bInEditor;
+	mpListener = new FTcpListener(FIPv4Endpoint(FIPv4Address(127, 0, 0, 1), port));
+	if (!mpListener->IsActive())
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Ess live sync can't listen on port %d"), port);
+		Stop();
+		return false;
+	}
+	mpListener->OnConnectionAccepted().BindRaw(this, &FEssLiveSync::OnConnectionAccepted);
+	UE_LOG(RuntimeMeshLog, Log, TEXT("Ess live sync listening on localhost:%d"), port);
+	return true;
+}
+
+void FEssLiveSync::Stop()
+{
+	if (NULL != mpListener)
+	{
+		mpListener->Stop();
+		delete mpListener;
+		mpListener = NULL;
+	}
+}
+
+bool FEssLiveSync::ReceiveScene(FSocket* pSocket, TArray<uint8>& sceneData)
+{
+	uint8 header[sizeof(uint64)];
+	int32 received = 0;
+	uint64 sceneSize = 0;
+	int64 offset = 0;
+	int64 total = sizeof(header);
+	uint8* pDest = header;
+	bool bHeader = true;
+	while (offset < total)
+	{
+		if (!pSocket->Wait(ESocketWaitConditions::WaitForRead, FTimespan::FromSeconds(ESS_LIVE_SYNC_TIMEOUT)) ||
+			!pSocket->Recv(pDest + offset, (int32)FMath::Min<int64>(total - offset, 1024 * 1024), received) || received <= 0)
+		{
+			return false;
+		}
+		offset += received;
+
+		if (bHeader && offset == total)
+		{
+			FMemory::Memcpy(&sceneSize, header, sizeof(sceneSize));
+			sceneSize = INTEL_ORDER64(sceneSize);
+			if (0 == sceneSize || sceneSize > ESS_LIVE_SYNC_MAX_SCENE_SIZE)
+			{
+				UE_LOG(RuntimeMeshLog, Warning, TEXT("Ess live sync rejected a scene of %llu bytes"), sceneSize);
+				return false;
+			}
+			sceneData.SetNumUninitialized((int32)sceneSize);
+			pDest = sceneData.GetData();
+			offset = 0;
+			total = sceneSize;
+			bHeader = false;
+		}
+	}
+	return !bHeader;
+}
+
+bool FEssLiveSync::OnConnectionAccepted(FSocket* pSocket, const FIPv4Endpoint& endpoint)
+{
+	TArray<uint8> sceneData;
+	bool bReceived = ReceiveScene(pSocket, sceneData);
+	pSocket->Close();
+	ISocketSubsystem::Get(PLATFORM_SOCKETSUBSYSTEM)->DestroySocket(pSocket);
+	if (!bReceived)
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Ess live sync dropped an incomplete scene from %s"), *endpoint.ToString());
+		return true;
+	}
+
+	// A push can arrive while the one before is still being parsed, so each gets a file of its own
+	FString fileName = FPaths::CreateTempFilename(*FPaths::Combine(*FPaths::GameSavedDir(), TEXT("EssLiveSync")), TEXT("LiveSync"), TEXT(".ess"));
+	if (!FFileHelper::SaveArrayToFile(sceneData, *fileName))
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Ess live sync can't write %s"), *fileName);
+		return true;
+	}
+
+	AsyncTask(ENamedThreads::GameThread, [fileName]()
+	{
+		FEssLiveSync::Get().QueueImport(fileName);
+	});
+	return true;
+}
+
+void FEssLiveSync::QueueImport(const FString& fileName)
+{
+	// Stopped while the push was on its way
+	if (!IsRunning())
+	{
+		IFileManager::Get().Delete(*fileName);
+		return;
+	}
+
+	// Only the latest scene matters, a push nobody imported yet is replaced
+	if (mbImporting)
+	{
+		DeletePendingFile();
+		mPendingFile = fileName;
+		return;
+	}
+
+	mbImporting = true;
+	URuntimeMeshLibrary::ReimportTemporaryEss(fileName, mbInEditor, FSimpleDelegate::CreateRaw(this, &FEssLiveSync::OnImportFinished));
+}
+
+void FEssLiveSync::OnImportFinished()
+{
+	mbImporting = false;
+	if (!mPendingFile.IsEmpty())
+	{
+		FString fileName = mPendingFile;
+		mPendingFile.Empty();
+		QueueImport(fileName);
+	}
+}
+
+void FEssLiveSync::DeletePendingFile()
+{
+	if (!mPendingFile.IsEmpty())
+	{
+		IFileManager::Get().Delete(*mPendingFile);
+		mPendingFile.Empty();
+	}
+}
+
+static void EssLiveSyncCommand(const TArray<FString>& Args)
+{
+	if (Args.Num() > 0 && Args[0] == TEXT("stop"))
+	{
+		FEssLiveSync::Get().Stop();
+		UE_LOG(RuntimeMeshLog, Log, TEXT("Ess live sync stopped"));
+		return;
+	}
+	int32 port = Args.Num() > 0 ? FCString::Atoi(*Args[0]) : ESS_LIVE_SYNC_DEFAULT_PORT;
+	FEssLiveSync::Get().Start(port > 0 ? port : ESS_LIVE_SYNC_DEFAULT_PORT, GIsEditor && !GIsPlayInEditorWorld);
+}
+
+static void EssReimportCommand(const TArray<FString>& Args)
+{
+	if (Args.Num() == 0)
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Usage: RMC.EssReimport <File>"));
+		return;
+	}
+	URuntimeMeshLibrary::ReimportEss(Args[0], GIsEditor && !GIsPlayInEditorWorld);
+}
+
+static FAutoConsoleCommand GEssLiveSyncCommand(
+	TEXT("RMC.EssLiveSync"),
+	TEXT("Re-imports ess scenes pushed to a localhost socket. Usage: RMC.EssLiveSync [Port|stop]"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&EssLiveSyncCommand));
+
+static FAutoConsoleCommand GEssReimportCommand(
+	TEXT("RMC.EssReimport"),
+	TEXT("Re-imports an ess file over the scene imported before, only what changed is rebuilt. Usage: RMC.EssReimport <File>"),
+	FConsoleCommandWithArgsDelegate::CreateStatic(&EssReimportCommand));
@@ -0,0 +1,44 @@
+#pragma once
+#include "Engine.h"
+
+class FTcpListener;
+class FSocket;
+struct FIPv4Endpoint;
+
+/**
+*	Lets an exporter push scenes straight into a running session. Clients connect to localhost, send the size of
+*	the scene as a little endian uint64 followed by the ess text, the scene is stored under Saved/EssLiveSync and
+*	re-imported over the scene that is already in the world, so only what changed since the last push is rebuilt.
+*	One import runs at a time, pushes arriving meanwhile replace each other and only the latest is imported once
+*	the running one finishes. Every push gets its own file, deleted once imported or replaced.
+*/
+class FEssLiveSync
+{
+public:
+	static FEssLiveSync& Get();
+
+	/** Called by the module, the listener thread has to be gone before the module unloads */
+	static void Shutdown();
+
+	bool Start(int32 Port, bool bInEditor);
+	void Stop();
+	bool IsRunning() const { return NULL != mpListener; }
+
+private:
+	FEssLiveSync() : mpListener(NULL), mbInEditor(false), mbImporting(false) { }
+
+	/* Runs on the listener thread, a connection is read to the end before the next one is accepted */
+	bool OnConnectionAccepted(FSocket* pSocket, const FIPv4Endpoint& endpoint);
+	bool ReceiveScene(FSocket* pSocket, TArray<uint8>& sceneData);
+
+	/* Game thread, imports the file now or keeps it as the pending push */
+	void QueueImport(const FString& fileName);
+	void OnImportFinished();
+	void DeletePendingFile();
+
+	FTcpListener* mpListener;
+	bool mbInEditor;
+	/* Game thread only */
+	bool mbImporting;
+	FString mPendingFile;
+};
@@ -0,0 +1,261 @@
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "EssMaterialPermutations.h"
+#include "MaterialShared.h"
+#include "MaterialExpressionCustomMultiOut.h"
+
+static TAutoConsoleVariable<int32> CVarEssSpecializeMaterials(
+	TEXT("RMC.EssSpecializeMaterials"),
+	0,
+	TEXT("0: Ess materials are instances of the uber material that walks the shader graph at runtime (default)\n")
+	TEXT("1: Compile a material per distinct shader graph with the graph inlined, editor only"));
+
+/* Seconds between the checks whether the permutations of a scheduled report finished compiling */
+static const float ESS_REPORT_POLL_INTERVAL = 0.5f;
+
+FEssMaterialPermutations& FEssMaterialPermutations::Get()
+{
+	static FEssMaterialPermutations Instance;
+	return Instance;
+}
+
+FDelegateHandle FEssMaterialPermutations::WorldCleanupHandle;
+
+void FEssMaterialPermutations::Startup()
+{
+	WorldCleanupHandle = FWorldDelegates::OnWorldCleanup.AddStatic(&FEssMaterialPermutations::OnWorldCleanup);
+}
+
+void FEssMaterialPermutations::Shutdown()
+{
+	FWorldDelegates::OnWorldCleanup.Remove(WorldCleanupHandle);
+
+	FEssMaterialPermutations& Instance = Get();
+	if (Instance.ReportTickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(Instance.ReportTickerHandle);
+		Instance.ReportTickerHandle.Reset();
+	}
+	Instance.PendingReport.Empty();
+	Instance.Reset();
+}
+
+void FEssMaterialPermutations::OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources)
+{
+	// The materials belong to the scenes of the world going away
+	Get().Reset();
+}
+
+bool FEssMaterialPermutations::IsEnabled()
+{
+#if WITH_EDITOR
+	return CVarEssSpecializeMaterials.GetValueOnGameThread() != 0;
+#else
+	return false;
+#endif
+}
+
+uint32 FEssMaterialPermutations::GetPermutationHash(const UMaterial* BaseMaterial, const TArray<int32>& NodeIDs, const TArray<int32>& Links)
+{
+	uint32 Hash = FCrc::StrCrc32(*BaseMaterial->GetPathName());
+	Hash = FCrc::MemCrc32(NodeIDs.GetData(), NodeIDs.Num() * NodeIDs.GetTypeSize(), Hash);
+	return FCrc::MemCrc32(Links.GetData(), Links.Num() * Links.GetTypeSize(), Hash);
+}
+
+UMaterial* FEssMaterialPermutations::FindOrCreate(UMaterial* BaseMaterial, const TArray<int32>& NodeIDs, const TArray<int32>& Links)
+{
+	if (!IsEnabled() || nullptr == BaseMaterial || NodeIDs.Num() == 0)
+	{
+		return BaseMaterial;
+	}
+
+#if WITH_EDITOR
+	uint32 Hash = GetPermutationHash(BaseMaterial, NodeIDs, Links);
+	FEssMaterialPermutation* Existing = Permutations.Find(Hash);
+	if (Existing && Existing->Material.IsValid())
+	{
+		// A hash collision between two graphs keeps the second one on the uber material
+		if (Existing->BaseMaterial.Get() != BaseMaterial || Existing->NodeIDs != NodeIDs || Existing->Links != Links)
+		{
+			return BaseMaterial;
+		}
+
+		Existing->Uses++;
+		return Existing->Material.Get();
+	}
+
+	// Transient so the session never dirties or leaves packages behind, it lives as long as instances parent to it
+	FName AssetName = MakeUniqueObjectName(GetTransientPackage(), UMaterial::StaticClass(), *FString::Printf(TEXT("%s_%08X"), *BaseMaterial->GetName(), Hash));
+	UMaterial* Material = DuplicateObject<UMaterial>(BaseMaterial, GetTransientPackage(), AssetName);
+	if (nullptr == Material)
+	{
+		return BaseMaterial;
+	}
+	Material->ClearFlags(RF_Public | RF_Standalone);
+	Material->SetFlags(RF_Transient);
+
+	bool bSpecialized = false;
+	bool bFailed = false;
+	for (UMaterialExpression* Expression : Material->Expressions)
+	{
+		UMaterialExpressionCustomMultiOut* CustomExpression = Cast<UMaterialExpressionCustomMultiOut>(Expression);
+		if (CustomExpression)
+		{
+			bFailed |= !CustomExpression->SpecializeForNodes(NodeIDs);
+			bSpecialized = true;
+		}
+	}
+
+	if (!bSpecialized || bFailed)
+	{
+		Material->MarkPendingKill();
+		return BaseMaterial;
+	}
+
+	// Hands the shader maps to the shader compiling manager instead of waiting for them the way PostEditChange does.
+	// Instances render with the default material until the compile lands.
+	Material->ForceRecompileForRendering();
+
+	FEssMaterialPermutation& Permutation = Permutations.Add(Hash);
+	Permutation.BaseMaterial = BaseMaterial;
+	Permutation.Material = Material;
+	Permutation.NodeIDs = NodeIDs;
+	Permutation.Links = Links;
+	Permutation.Uses = 1;
+	return Material;
+#else
+	return BaseMaterial;
+#endif
+}
+
+int32 FEssMaterialPermutations::GetInstructionCount(UMaterial* Material, FString& OutDescription)
+{
+	int32 Count = INDEX_NONE;
+#if WITH_EDITOR
+	FMaterialResource* Resource = Material ? Material->GetMaterialResource(ERHIFeatureLevel::SM5) : nullptr;
+	if (Resource && Resource->IsCompilationFinished())
+	{
+		TArray<FString> Descriptions;
+		TArray<int32> InstructionCounts;
+		Resource->GetRepresentativeInstructionCounts(Descriptions, InstructionCounts);
+		// The first entry is the base pass pixel shader, the one the node graph ends up in
+		if (InstructionCounts.Num() > 0)
+		{
+			OutDescription = Descriptions[0];
+			Count = InstructionCounts[0];
+		}
+	}
+#endif
+	return Count;
+}
+
+bool FEssMaterialPermutations::IsCompilationFinished(UMaterial* Material)
+{
+#if WITH_EDITOR
+	FMaterialResource* Resource = Material ? Material->GetMaterialResource(ERHIFeatureLevel::SM5) : nullptr;
+	return nullptr == Resource || Resource->IsCompilationFinished();
+#else
+	return true;
+#endif
+}
+
+void FEssMaterialPermutations::ScheduleReport(const FString& SceneName)
+{
+	if (!IsEnabled() || Permutations.Num() == 0)
+	{
+		return;
+	}
+
+	// A newer report covers everything the waiting one would have
+	Permutations.GenerateValueArray(PendingReport);
+	PendingReportScene = SceneName;
+	if (!ReportTickerHandle.IsValid())
+	{
+		ReportTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FEssMaterialPermutations::TickReport), ESS_REPORT_POLL_INTERVAL);
+	}
+}
+
+bool FEssMaterialPermutations::TickReport(float DeltaTime)
+{
+	for (const FEssMaterialPermutation& Permutation : PendingReport)
+	{
+		if (!IsCompilationFinished(Permutation.BaseMaterial.Get()) || !IsCompilationFinished(Permutation.Material.Get()))
+		{
+			return true;
+		}
+	}
+
+	WriteReport(PendingReportScene, PendingReport);
+	PendingReport.Empty();
+	PendingReportScene.Empty();
+	ReportTickerHandle.Reset();
+	return false;
+}
+
+void FEssMaterialPermutations::Reset()
+{
+	Permutations.Empty();
+}
+
+FString FEssMaterialPermutations::WriteReport(const FString& SceneName, const TArray<FEssMaterialPermutation>& ReportPermutations)
+{
+
+	TMap<UMaterial*, int32> BaseCounts;
+	FString Csv = TEXT("permutation,base_material,nodes,uses,instructions,base_instructions\n");
+	FString Json;
+	Json += TEXT("{\n");
+	Json += FString::Printf(TEXT("\t\"scene\": \"%s\",\n"), *SceneName.ReplaceCharWithEscapedChar());
+	Json += FString::Printf(TEXT("\t\"timestamp\": \"%s\",\n"), *FDateTime::UtcNow().ToIso8601());
+	Json += FString::Printf(TEXT("\t\"unique_permutations\": %d,\n"), ReportPermutations.Num());
+	Json += TEXT("\t\"permutations\": [\n");
+
+	UE_LOG(RuntimeMeshLog, Log, TEXT("%d unique ess material permutations"), ReportPermutations.Num());
+	bool bFirst = true;
+	for (const FEssMaterialPermutation& Permutation : ReportPermutations)
+	{
+		UMaterial* BaseMaterial = Permutation.BaseMaterial.Get();
+		UMaterial* Material = Permutation.Material.Get();
+		if (nullptr == BaseMaterial || nullptr == Material)
+		{
+			continue;
+		}
+
+		FString Description;
+		int32* BaseCount = BaseCounts.Find(BaseMaterial);
+		if (nullptr == BaseCount)
+		{
+			BaseCount = &BaseCounts.Add(BaseMaterial, GetInstructionCount(BaseMaterial, Description));
+		}
+		int32 Count = GetInstructionCount(Material, Description);
+
+		TArray<FString> NodeStrings;
+		for (int32 NodeID : Permutation.NodeIDs)
+		{
+			NodeStrings.Add(FString::FromInt(NodeID));
+		}
+		FString Nodes = FString::Join(NodeStrings, TEXT(" "));
+
+		UE_LOG(RuntimeMeshLog, Log, TEXT("    %-40s nodes [%s] used %d times, %d instructions (uber %d)"), *Material->GetName(), *Nodes, Permutation.Uses, Count, *BaseCount);
+		Csv += FString::Printf(TEXT("%s,%s,%s,%d,%d,%d\n"), *Material->GetName(), *BaseMaterial->GetName(), *Nodes, Permutation.Uses, Count, *BaseCount);
+		Json += bFirst ? TEXT("") : TEXT(",\n");
+		Json += FString::Printf(TEXT("\t\t{ \"name\": \"%s\", \"base_material\": \"%s\", \"nodes\": [%s], \"uses\": %d, \"instructions\": %d, \"base_instructions\": %d, \"shader\": \"%s\" }"),
+			*Material->GetName(), *BaseMaterial->GetName(), *FString::Join(NodeStrings, TEXT(", ")), Permutation.Uses, Count, *BaseCount, *Description.ReplaceCharWithEscapedChar());
+		bFirst = false;
+	}
+
+	Json += TEXT("\n\t]\n");
+	Json += TEXT("}\n");
+
+	FString Directory = FPaths::Combine(*FPaths::GameSavedDir(), TEXT("Profiling"), TEXT("EssMaterials"));
+	FString BaseName = FPaths::Combine(*Directory, *FString::Printf(TEXT("%s-%s"), *FPaths::GetBaseFilename(SceneName), *FDateTime::Now().ToString()));
+	IFileManager::Get().MakeDirectory(*Directory, true);
+
+	FString JsonFile = BaseName + TEXT(".json");
+	if (!FFileHelper::SaveStringToFile(Json, *JsonFile) ||
+		!FFileHelper::SaveStringToFile(Csv, *(BaseName + TEXT(".csv"))))
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Failed to write ess material report %s"), *BaseName);
+		return FString();
+	}
+
+	return JsonFile;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "Engine.h"
+
+struct FEssMaterialPermutation
+{
+	FEssMaterialPermutation() : Uses(0) { }
+
+	TWeakObjectPtr<UMaterial> BaseMaterial;
+	TWeakObjectPtr<UMaterial> Material;
+	TArray<int32> NodeIDs;
+	TArray<int32> Links;
+	/* Ess materials that resolved to this permutation */
+	int32 Uses;
+};
+
+/**
+*	Compiles one copy of an ess uber material per distinct shader graph, with the node loop and the switch on the
+*	node type replaced by straight line code for exactly the nodes of that graph. Materials sharing a graph share
+*	the permutation and only differ in their parameter values.
+*	Permutations are transient objects compiled in the background, nothing is written to the project. Shaders can only
+*	be compiled in the editor, other builds always keep using the uber material.
+*/
+class FEssMaterialPermutations
+{
+public:
+	static FEssMaterialPermutations& Get();
+
+	/* Resets the permutations whenever a world is cleaned up, called by the module */
+	static void Startup();
+	static void Shutdown();
+
+	/* Whether RMC.EssSpecializeMaterials is on and this build can compile shaders */
+	static bool IsEnabled();
+
+	/* Returns the permutation of BaseMaterial for the node graph and its wiring, or BaseMaterial itself when it can't be specialized */
+	UMaterial* FindOrCreate(UMaterial* BaseMaterial, const TArray<int32>& NodeIDs, const TArray<int32>& Links);
+
+	/* 
+	*	Logs the instruction counts of every permutation against its uber material and writes them to Saved/Profiling/EssMaterials
+	*	once all of them finished compiling. Polled from the core ticker, nothing waits for the shader compiler.
+	*/
+	void ScheduleReport(const FString& SceneName);
+
+	/* Forgets every permutation, for a new scene or world. A scheduled report still covers the ones it was scheduled with. */
+	void Reset();
+
+	int32 Num() const { return Permutations.Num(); }
+
+private:
+	static uint32 GetPermutationHash(const UMaterial* BaseMaterial, const TArray<int32>& NodeIDs, const TArray<int32>& Links);
+	/* INDEX_NONE until the material finished compiling */
+	static int32 GetInstructionCount(UMaterial* Material, FString& OutDescription);
+	static bool IsCompilationFinished(UMaterial* Material);
+
+	bool TickReport(float DeltaTime);
+	FString WriteReport(const FString& SceneName, const TArray<FEssMaterialPermutation>& ReportPermutations);
+
+	TMap<uint32, FEssMaterialPermutation> Permutations;
+
+	/* The permutations of the scheduled report, taken when it was scheduled */
+	TArray<FEssMaterialPermutation> PendingReport;
+	FString PendingReportScene;
+	FDelegateHandle ReportTickerHandle;
+
+	static void OnWorldCleanup(UWorld* World, bool bSessionEnded, bool bCleanupResources);
+	static FDelegateHandle WorldCleanupHandle;
+};
@@ -0,0 +1,847 @@
+#include "RuntimeMeshComponentPluginPrivatePCH.h"
+#include "EssNativeReader.h"
+#include "Public/Async/ParallelFor.h"
+
+#if PLATFORM_WINDOWS
+#include "AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "HideWindowsPlatformTypes.h"
+#elif PLATFORM_LINUX || PLATFORM_MAC
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Chunks smaller than this cost more to schedule than they take to parse
+static const int64 ESS_MIN_CHUNK_BYTES = 1024 * 1024;
+
+namespace
+{
+	/* Read only view of a whole file, mapped where the platform allows it and loaded otherwise */
+	class FEssMappedFile
+	{
+	public:
+		FEssMappedFile() : Data(NULL), Size(0)
+#if PLATFORM_WINDOWS
+			, File(INVALID_HANDLE_VALUE), Mapping(NULL)
+#endif
+		{ }
+
+		~FEssMappedFile()
+		{
+#if PLATFORM_WINDOWS
+			if (NULL != Mapping)
+			{
+				UnmapViewOfFile(Data);
+				CloseHandle(Mapping);
+			}
+			if (INVALID_HANDLE_VALUE != File)
+			{
+				CloseHandle(File);
+			}
+#elif PLATFORM_LINUX || PLATFORM_MAC
+			if (NULL != Data && Loaded.Num() == 0)
+			{
+				munmap((void*)Data, Size);
+			}
+#endif
+		}
+
+		bool Open(const FString& FileName)
+		{
+			FString fullPath = FPaths::ConvertRelativePathToFull(FileName);
+#if PLATFORM_WINDOWS
+			File = CreateFileW(*fullPath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+			LARGE_INTEGER fileSize;
+			if (INVALID_HANDLE_VALUE != File && GetFileSizeEx(File, &fileSize) && fileSize.QuadPart > 0)
+			{
+				Mapping = CreateFileMappingW(File, NULL, PAGE_READONLY, 0, 0, NULL);
+				if (NULL != Mapping)
+				{
+					Data = (const ANSICHAR*)MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0);
+					Size = fileSize.QuadPart;
+					if (NULL != Data)
+					{
+						return true;
+					}
+					CloseHandle(Mapping);
+					Mapping = NULL;
+				}
+			}
+#elif PLATFORM_LINUX || PLATFORM_MAC
+			int descriptor = open(TCHAR_TO_UTF8(*fullPath), O_RDONLY);
+			if (descriptor >= 0)
+			{
+				struct stat fileStat;
+				if (fstat(descriptor, &fileStat) == 0 && fileStat.st_size > 0)
+				{
+					void* mapped = mmap(NULL, fileStat.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+					if (MAP_FAILED != mapped)
+					{
+						// Every chunk is read right away, ask for all pages up front instead of faulting them in one by one
+						madvise(mapped, fileStat.st_size, MADV_WILLNEED);
+						Data = (const ANSICHAR*)mapped;
+						Size = fileStat.st_size;
+					}
+				}
+				close(descriptor);
+				if (NULL != Data)
+				{
+					return true;
+				}
+			}
+#endif
+			if (!FFileHelper::LoadFileToArray(Loaded, *FileName))
+			{
+				return false;
+			}
+			Data = (const ANSICHAR*)Loaded.GetData();
+			Size = Loaded.Num();
+			return Size > 0;
+		}
+
+		const ANSICHAR* GetData() const { return Data; }
+		int64 GetSize() const { return Size; }
+
+	private:
+		const ANSICHAR* Data;
+		int64 Size;
+		TArray<uint8> Loaded;
+#if PLATFORM_WINDOWS
+		HANDLE File;
+		HANDLE Mapping;
+#endif
+	};
+
+	enum class EEssToken : uint8
+	{
+		Word,
+		String,
+		Number,
+		End
+	};
+
+	struct FEssToken
+	{
+		FEssToken() : Type(EEssToken::End), Begin(NULL), Len(0), bEscaped(false) { }
+
+		EEssToken Type;
+		const ANSICHAR* Begin;
+		int32 Len;
+		bool bEscaped;
+	};
+
+	FORCEINLINE bool IsSpace(ANSICHAR c)
+	{
+		return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+	}
+
+	FORCEINLINE bool IsDigit(ANSICHAR c)
+	{
+		return c >= '0' && c <= '9';
+	}
+
+	bool TokenEquals(const FEssToken& Token, const ANSICHAR* Literal)
+	{
+		int32 i = 0;
+		for (; i < Token.Len; ++i)
+		{
+			if (Literal[i] != Token.Begin[i])
+			{
+				return false;
+			}
+		}
+		return Literal[i] == '\0';
+	}
+
+	class FEssLexer
+	{
+	public:
+		FEssLexer(const ANSICHAR* InBegin, const ANSICHAR* InEnd) : Cursor(InBegin), End(InEnd)
+		{
+			Advance();
+		}
+
+		const FEssToken& Peek() const { return Current; }
+
+		FEssToken Next()
+		{
+			FEssToken token = Current;
+			Advance();
+			return token;
+		}
+
+	private:
+		void Advance()
+		{
+			while (Cursor < End)
+			{
+				if (IsSpace(*Cursor))
+				{
+					Cursor++;
+				}
+				else if (*Cursor == '#')
+				{
+					while (Cursor < End && *Cursor != '\n')
+					{
+						Cursor++;
+					}
+				}
+				else
+				{
+					break;
+				}
+			}
+
+			Current = FEssToken();
+			if (Cursor >= End)
+			{
+				return;
+			}
+
+			if (*Cursor == '"')
+			{
+				Current.Type = EEssToken::String;
+				Current.Begin = ++Cursor;
+				while (Cursor < End && *Cursor != '"')
+				{
+					if (*Cursor == '\\' && Cursor + 1 < End)
+					{
+						Current.bEscaped = true;
+						Cursor++;
+					}
+					Cursor++;
+				}
+				Current.Len = (int32)(Cursor - Current.Begin);
+				Cursor = FMath::Min(Cursor + 1, End);
+				return;
+			}
+
+			ANSICHAR first = *Cursor;
+			Current.Type = IsDigit(first) || first == '-' || first == '+' || first == '.' ? EEssToken::Number : EEssToken::Word;
+			Current.Begin = Cursor;
+			while (Cursor < End && !IsSpace(*Cursor) && *Cursor != '"')
+			{
+				Cursor++;
+			}
+			Current.Len = (int32)(Cursor - Current.Begin);
+
+			// Booleans may be spelled out, they are numbers to every statement that reads them
+			if (EEssToken::Word == Current.Type)
+			{
+				if (TokenEquals(Current, "true") || TokenEquals(Current, "on"))
+				{
+					Current.Type = EEssToken::Number;
+					Current.Begin = "1";
+					Current.Len = 1;
+				}
+				else if (TokenEquals(Current, "false") || TokenEquals(Current, "off"))
+				{
+					Current.Type = EEssToken::Number;
+					Current.Begin = "0";
+					Current.Len = 1;
+				}
+			}
+		}
+
+		const ANSICHAR* Cursor;
+		const ANSICHAR* End;
+		FEssToken Current;
+	};
+
+	double PowerOfTen(int32 Exponent)
+	{
+		static const double Powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+		double result = 1.0;
+		while (Exponent > 22)
+		{
+			result *= 1e22;
+			Exponent -= 22;
+		}
+		return result * Powers[Exponent];
+	}
+
+	// Exporters write plain decimals, this avoids the locale handling and the double round trip of atof
+	float ParseFloat(const FEssToken& Token)
+	{
+		const ANSICHAR* p = Token.Begin;
+		const ANSICHAR* end = Token.Begin + Token.Len;
+		bool bNegative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			bNegative = *p == '-';
+			p++;
+		}
+
+		uint64 mantissa = 0;
+		int32 digits = 0;
+		int32 exponent = 0;
+		for (; p < end && IsDigit(*p); ++p)
+		{
+			if (digits < 19)
+			{
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += mantissa != 0;
+			}
+			else
+			{
+				exponent++;
+			}
+		}
+		if (p < end && *p == '.')
+		{
+			for (++p; p < end && IsDigit(*p); ++p)
+			{
+				if (digits < 19)
+				{
+					mantissa = mantissa * 10 + (*p - '0');
+					digits += mantissa != 0;
+					exponent--;
+				}
+			}
+		}
+		if (p < end && (*p == 'e' || *p == 'E'))
+		{
+			++p;
+			bool bNegativeExponent = false;
+			if (p < end && (*p == '-' || *p == '+'))
+			{
+				bNegativeExponent = *p == '-';
+				p++;
+			}
+			int32 value = 0;
+			for (; p < end && IsDigit(*p); ++p)
+			{
+				value = FMath::Min(value * 10 + (*p - '0'), 1000);
+			}
+			exponent += bNegativeExponent ? -value : value;
+		}
+
+		double result = (double)mantissa;
+		result = exponent < 0 ? result / PowerOfTen(-exponent) : result * PowerOfTen(exponent);
+		return (float)(bNegative ? -result : result);
+	}
+
+	int32 ParseInt(const FEssToken& Token)
+	{
+		const ANSICHAR* p = Token.Begin;
+		const ANSICHAR* end = Token.Begin + Token.Len;
+		bool bNegative = false;
+		if (p < end && (*p == '-' || *p == '+'))
+		{
+			bNegative = *p == '-';
+			p++;
+		}
+
+		int64 value = 0;
+		for (; p < end && IsDigit(*p); ++p)
+		{
+			value = value * 10 + (*p - '0');
+		}
+		if (p < end)
+		{
+			// Written as a float
+			return (int32)ParseFloat(Token);
+		}
+		return (int32)(bNegative ? -value : value);
+	}
+
+	FString TokenToString(const FEssToken& Token)
+	{
+		if (!Token.bEscaped)
+		{
+			FUTF8ToTCHAR converted(Token.Begin, Token.Len);
+			return FString(converted.Length(), converted.Get());
+		}
+
+		TArray<ANSICHAR> unescaped;
+		unescaped.Reserve(Token.Len);
+		for (int32 i = 0; i < Token.Len; ++i)
+		{
+			ANSICHAR c = Token.Begin[i];
+			if (c == '\\' && i + 1 < Token.Len)
+			{
+				c = Token.Begin[++i];
+				c = c == 'n' ? '\n' : c == 't' ? '\t' : c;
+			}
+			unescaped.Add(c);
+		}
+		FUTF8ToTCHAR converted(unescaped.GetData(), unescaped.Num());
+		return FString(converted.Length(), converted.Get());
+	}
+
+	EEssNativeType GetTypeFromName(const FEssToken& Token)
+	{
+		struct FTypeName { const ANSICHAR* Name; EEssNativeType Type; };
+		static const FTypeName TypeNames[] =
+		{
+			{ "int", EEssNativeType::Int },
+			{ "bool", EEssNativeType::Int },
+			{ "index", EEssNativeType::Int },
+			{ "byte", EEssNativeType::Int },
+			{ "enum", EEssNativeType::Int },
+			{ "long", EEssNativeType::Int },
+			{ "scalar", EEssNativeType::Scalar },
+			{ "geoscalar", EEssNativeType::Scalar },
+			{ "vector", EEssNativeType::Vector },
+			{ "point", EEssNativeType::Vector },
+			{ "color", EEssNativeType::Vector },
+			{ "cvector", EEssNativeType::Vector },
+			{ "vector2", EEssNativeType::Vector2 },
+			{ "hvector2", EEssNativeType::Vector2 },
+			{ "vector4", EEssNativeType::Vector4 },
+			{ "hvector", EEssNativeType::Vector4 },
+			{ "matrix", EEssNativeType::Matrix },
+			{ "token", EEssNativeType::Token },
+			{ "string", EEssNativeType::Token },
+			{ "node", EEssNativeType::Node },
+			{ "tag", EEssNativeType::Node },
+		};
+
+		// Array declarations spell the element type with a trailing []
+		FEssToken name = Token;
+		if (name.Len > 2 && name.Begin[name.Len - 2] == '[' && name.Begin[name.Len - 1] == ']')
+		{
+			name.Len -= 2;
+		}
+		for (const FTypeName& typeName : TypeNames)
+		{
+			if (TokenEquals(name, typeName.Name))
+			{
+				return typeName.Type;
+			}
+		}
+		return EEssNativeType::Unknown;
+	}
+
+	/* Parses the nodes of one chunk, a chunk always starts outside of a node */
+	class FEssChunkParser
+	{
+	public:
+		FEssChunkParser(const ANSICHAR* Begin, const ANSICHAR* End, TArray<FEssNativeNode>& OutNodes) : Lexer(Begin, End), Nodes(OutNodes), Errors(0) { }
+
+		int32 Run()
+		{
+			while (EEssToken::End != Lexer.Peek().Type)
+			{
+				FEssToken keyword = Lexer.Next();
+				if (EEssToken::Word == keyword.Type && TokenEquals(keyword, "node") && EEssToken::String == Lexer.Peek().Type)
+				{
+					FEssNativeNode& node = Nodes[Nodes.AddDefaulted()];
+					node.Type = TokenToString(Lexer.Next());
+					if (EEssToken::String == Lexer.Peek().Type)
+					{
+						node.Name = TokenToString(Lexer.Next());
+					}
+					ParseNodeBody(node);
+				}
+				else
+				{
+					SkipArguments();
+				}
+			}
+			return Errors;
+		}
+
+	private:
+		void SkipArguments()
+		{
+			while (EEssToken::String == Lexer.Peek().Type || EEssToken::Number == Lexer.Peek().Type)
+			{
+				Lexer.Next();
+			}
+		}
+
+		void ParseNodeBody(FEssNativeNode& Node)
+		{
+			while (EEssToken::End != Lexer.Peek().Type)
+			{
+				FEssToken keyword = Lexer.Next();
+				if (EEssToken::Word != keyword.Type)
+				{
+					continue;
+				}
+				if (TokenEquals(keyword, "end"))
+				{
+					return;
+				}
+
+				if (TokenEquals(keyword, "link"))
+				{
+					ParseLink(Node);
+				}
+				else if (TokenEquals(keyword, "array"))
+				{
+					ParseArray(Node);
+				}
+				else
+				{
+					EEssNativeType type = GetTypeFromName(keyword);
+					if (EEssNativeType::Unknown == type || EEssToken::String != Lexer.Peek().Type)
+					{
+						SkipArguments();
+						continue;
+					}
+
+					FEssNativeParam& param = Node.Params[Node.Params.AddDefaulted()];
+					param.Name = TokenToString(Lexer.Next());
+					param.bArray = keyword.Begin[keyword.Len - 1] == ']';
+					ReadValues(Node, param, type, INDEX_NONE);
+				}
+			}
+
+			UE_LOG(RuntimeMeshLog, Warning, TEXT("Ess node %s isn't closed by end"), *Node.Name);
+			Errors++;
+		}
+
+		void ParseLink(FEssNativeNode& Node)
+		{
+			FEssToken tokens[3];
+			for (FEssToken& token : tokens)
+			{
+				if (EEssToken::String != Lexer.Peek().Type)
+				{
+					SkipArguments();
+					Errors++;
+					return;
+				}
+				token = Lexer.Next();
+			}
+
+			FString paramName = TokenToString(tokens[0]);
+			FEssNativeParam* pParam = Node.Params.FindByPredicate([&](const FEssNativeParam& param) { return param.Name == paramName; });
+			if (NULL == pParam)
+			{
+				pParam = &Node.Params[Node.Params.AddDefaulted()];
+				pParam->Name = paramName;
+			}
+			pParam->LinkNode = TokenToString(tokens[1]);
+			pParam->LinkOutput = TokenToString(tokens[2]);
+		}
+
+		void ParseArray(FEssNativeNode& Node)
+		{
+			if (EEssToken::String != Lexer.Peek().Type)
+			{
+				SkipArguments();
+				return;
+			}
+			FString paramName = TokenToString(Lexer.Next());
+			EEssNativeType type = EEssToken::String == Lexer.Peek().Type ? GetTypeFromName(Lexer.Next()) : EEssNativeType::Unknown;
+			if (EEssNativeType::Unknown == type || EEssToken::Number != Lexer.Peek().Type)
+			{
+				SkipArguments();
+				return;
+			}
+
+			int32 count = ParseInt(Lexer.Next());
+			FEssNativeParam& param = Node.Params[Node.Params.AddDefaulted()];
+			param.Name = paramName;
+			param.bArray = true;
+			ReadValues(Node, param, type, count);
+		}
+
+		void ReadValues(FEssNativeNode& Node, FEssNativeParam& Param, EEssNativeType Type, int32 ExpectedCount)
+		{
+			Param.Type = Type;
+			int32 components = FEssNativeNode::GetComponentCount(Type);
+			int32 numValues = 0;
+			switch (Type)
+			{
+			case EEssNativeType::Int:
+				Param.Offset = Node.Ints.Num();
+				if (ExpectedCount > 0)
+				{
+					Node.Ints.Reserve(Node.Ints.Num() + ExpectedCount);
+				}
+				while (EEssToken::Number == Lexer.Peek().Type)
+				{
+					Node.Ints.Add(ParseInt(Lexer.Next()));
+				}
+				numValues = Node.Ints.Num() - Param.Offset;
+				break;
+			case EEssNativeType::Token:
+			case EEssNativeType::Node:
+				Param.Offset = Node.Strings.Num();
+				if (ExpectedCount > 0)
+				{
+					Node.Strings.Reserve(Node.Strings.Num() + ExpectedCount);
+				}
+				while (EEssToken::String == Lexer.Peek().Type)
+				{
+					Node.Strings.Add(TokenToString(Lexer.Next()));
+				}
+				numValues = Node.Strings.Num() - Param.Offset;
+				break;
+			default:
+				Param.Offset = Node.Floats.Num();
+				if (ExpectedCount > 0)
+				{
+					Node.Floats.Reserve(Node.Floats.Num() + ExpectedCount * components);
+				}
+				while (EEssToken::Number == Lexer.Peek().Type)
+				{
+					Node.Floats.Add(ParseFloat(Lexer.Next()));
+				}
+				numValues = Node.Floats.Num() - Param.Offset;
+				break;
+			}
+			SkipArguments();
+
+			Param.Num = numValues / components;
+			if (numValues % components != 0 || (ExpectedCount >= 0 && ExpectedCount != Param.Num))
+			{
+				UE_LOG(RuntimeMeshLog, Warning, TEXT("Ess parameter %s of %s has %d values, expected %d elements of %d"),
+					*Param.Name, *Node.Name, numValues, ExpectedCount >= 0 ? ExpectedCount : Param.Num, components);
+				Errors++;
+			}
+		}
+
+		FEssLexer Lexer;
+		TArray<FEssNativeNode>& Nodes;
+		int32 Errors;
+	};
+
+	// Offset of the line after the next node end at or after From, nodes never straddle it
+	int64 FindChunkBoundary(const ANSICHAR* Data, int64 From, int64 Size)
+	{
+		int64 offset = From;
+		while (offset < Size && Data[offset] != '\n')
+		{
+			offset++;
+		}
+
+		while (offset < Size)
+		{
+			offset++;
+			while (offset < Size && (Data[offset] == ' ' || Data[offset] == '\t'))
+			{
+				offset++;
+			}
+
+			bool bEnd = offset + 3 <= Size && Data[offset] == 'e' && Data[offset + 1] == 'n' && Data[offset + 2] == 'd' &&
+				(offset + 3 == Size || IsSpace(Data[offset + 3]) || Data[offset + 3] == '#');
+			while (offset < Size && Data[offset] != '\n')
+			{
+				offset++;
+			}
+			if (bEnd)
+			{
+				return FMath::Min(offset + 1, Size);
+			}
+		}
+		return Size;
+	}
+}
+
+int32 FEssNativeNode::GetComponentCount(EEssNativeType Type)
+{
+	switch (Type)
+	{
+	case EEssNativeType::Vector2:
+		return 2;
+	case EEssNativeType::Vector:
+		return 3;
+	case EEssNativeType::Vector4:
+		return 4;
+	case EEssNativeType::Matrix:
+		return 16;
+	default:
+		return 1;
+	}
+}
+
+const FEssNativeParam* FEssNativeNode::FindParam(const TCHAR* ParamName) const
+{
+	for (const FEssNativeParam& param : Params)
+	{
+		if (param.Name == ParamName)
+		{
+			return &param;
+		}
+	}
+	return NULL;
+}
+
+const int32* FEssNativeNode::GetInts(const TCHAR* ParamName, int32& OutNum) const
+{
+	const FEssNativeParam* pParam = FindParam(ParamName);
+	if (NULL == pParam || EEssNativeType::Int != pParam->Type)
+	{
+		OutNum = 0;
+		return NULL;
+	}
+
+	OutNum = pParam->Num;
+	return Ints.GetData() + pParam->Offset;
+}
+
+const float* FEssNativeNode::GetFloats(const TCHAR* ParamName, int32& OutNum, int32& OutComponents) const
+{
+	const FEssNativeParam* pParam = FindParam(ParamName);
+	if (NULL == pParam || EEssNativeType::Unknown == pParam->Type || EEssNativeType::Int == pParam->Type ||
+		EEssNativeType::Token == pParam->Type || EEssNativeType::Node == pParam->Type)
+	{
+		OutNum = 0;
+		OutComponents = 0;
+		return NULL;
+	}
+
+	OutNum = pParam->Num;
+	OutComponents = GetComponentCount(pParam->Type);
+	return Floats.GetData() + pParam->Offset;
+}
+
+const FString* FEssNativeNode::GetNodeRef(const TCHAR* ParamName) const
+{
+	int32 num = 0;
+	const FString* pNames = GetStrings(ParamName, num);
+	return num > 0 && !pNames[0].IsEmpty() ? pNames : NULL;
+}
+
+const FString* FEssNativeNode::GetStrings(const TCHAR* ParamName, int32& OutNum) const
+{
+	const FEssNativeParam* pParam = FindParam(ParamName);
+	if (NULL == pParam || (EEssNativeType::Token != pParam->Type && EEssNativeType::Node != pParam->Type))
+	{
+		OutNum = 0;
+		return NULL;
+	}
+
+	OutNum = pParam->Num;
+	return Strings.GetData() + pParam->Offset;
+}
+
+bool FEssNativeNode::GetMatrix(const TCHAR* ParamName, FMatrix& OutMatrix) const
+{
+	const FEssNativeParam* pParam = FindParam(ParamName);
+	if (NULL == pParam || EEssNativeType::Matrix != pParam->Type || pParam->Num < 1)
+	{
+		return false;
+	}
+
+	FMemory::Memcpy(&OutMatrix.M[0][0], Floats.GetData() + pParam->Offset, sizeof(float) * 16);
+	return true;
+}
+
+bool FEssNativeNode::GetInt(const TCHAR* ParamName, int32& OutValue) const
+{
+	const FEssNativeParam* pParam = FindParam(ParamName);
+	if (NULL == pParam || pParam->Num < 1)
+	{
+		return false;
+	}
+
+	if (EEssNativeType::Int == pParam->Type)
+	{
+		OutValue = Ints[pParam->Offset];
+		return true;
+	}
+	if (EEssNativeType::Scalar == pParam->Type)
+	{
+		OutValue = (int32)Floats[pParam->Offset];
+		return true;
+	}
+	return false;
+}
+
+bool FEssNativeScene::Load(const FString& FileName)
+{
+	Reset();
+	double startTime = FPlatformTime::Seconds();
+	FEssMappedFile file;
+	if (!file.Open(FileName))
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("Failed to open ess file %s"), *FileName);
+		return false;
+	}
+	Stats.FileBytes = file.GetSize();
+	Stats.MapSeconds = FPlatformTime::Seconds() - startTime;
+
+	if (!Parse(file.GetData(), file.GetSize()))
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("No nodes in ess file %s"), *FileName);
+		return false;
+	}
+
+	UE_LOG(RuntimeMeshLog, Log, TEXT("Read %s: %.1f MB, %d nodes in %d chunks, map %.3fs, parse %.3fs, index %.3fs, %.1f MB/s"),
+		*FPaths::GetCleanFilename(FileName), Stats.FileBytes / (1024.0 * 1024.0), Stats.NumNodes, Stats.NumChunks,
+		Stats.MapSeconds, Stats.ParseSeconds, Stats.IndexSeconds, Stats.GetMegabytesPerSecond());
+	return true;
+}
+
+bool FEssNativeScene::Parse(const ANSICHAR* Data, int64 Size)
+{
+	double startTime = FPlatformTime::Seconds();
+
+	// A few chunks per worker so a chunk of big meshes doesn't leave the other cores idle at the end
+	int32 maxChunks = FMath::Max(FTaskGraphInterface::Get().GetNumWorkerThreads(), 1) * 4;
+	int32 desiredChunks = (int32)FMath::Clamp<int64>(Size / ESS_MIN_CHUNK_BYTES, 1, maxChunks);
+	int64 chunkBytes = Size / desiredChunks;
+	TArray<int64> boundaries;
+	boundaries.Add(0);
+	for (int32 i = 1; i < desiredChunks && boundaries.Last() < Size; ++i)
+	{
+		int64 boundary = FindChunkBoundary(Data, FMath::Max(i * chunkBytes, boundaries.Last()), Size);
+		if (boundary > boundaries.Last() && boundary < Size)
+		{
+			boundaries.Add(boundary);
+		}
+	}
+	boundaries.Add(Size);
+
+	Stats.NumChunks = boundaries.Num() - 1;
+	TArray<TArray<FEssNativeNode>> chunkNodes;
+	chunkNodes.SetNum(Stats.NumChunks);
+	int32 errors = 0;
+	ParallelFor(Stats.NumChunks, [&](int32 chunk)
+	{
+		FEssChunkParser parser(Data + boundaries[chunk], Data + boundaries[chunk + 1], chunkNodes[chunk]);
+		int32 chunkErrors = parser.Run();
+		if (chunkErrors > 0)
+		{
+			FPlatformAtomics::InterlockedAdd(&errors, chunkErrors);
+		}
+	});
+	double parsedTime = FPlatformTime::Seconds();
+	Stats.ParseSeconds = parsedTime - startTime;
+
+	int32 numNodes = 0;
+	for (const TArray<FEssNativeNode>& nodes : chunkNodes)
+	{
+		numNodes += nodes.Num();
+	}
+	Nodes.Reserve(numNodes);
+	NodeMap.Reserve(numNodes);
+	for (TArray<FEssNativeNode>& nodes : chunkNodes)
+	{
+		for (FEssNativeNode& node : nodes)
+		{
+			// Like the SDK a node defined again replaces the earlier definition
+			NodeMap.Add(node.Name, Nodes.Num());
+			Nodes.Add(MoveTemp(node));
+		}
+	}
+	Stats.NumNodes = Nodes.Num();
+	Stats.IndexSeconds = FPlatformTime::Seconds() - parsedTime;
+
+	if (errors > 0)
+	{
+		UE_LOG(RuntimeMeshLog, Warning, TEXT("%d errors while reading the ess file, affected parameters may be incomplete"), errors);
+	}
+	return Nodes.Num() > 0;
+}
+
+const FEssNativeNode* FEssNativeScene::FindNode(const FString& NodeName) const
+{
+	const int32* pIndex = NodeMap.Find(NodeName);
+	return NULL != pIndex ? &Nodes[*pIndex] : NULL;
+}
+
+void FEssNativeScene::Reset()
+{
+	Nodes.Reset();
+	NodeMap.Reset();
+	Stats = FEssNativeReadStats();
+}
@@ -0,0 +1,106 @@
+#pragma once
+#include "Engine.h"
+
+/* Value type of a parameter, vector types keep their own component count */
+enum class EEssNativeType : uint8
+{
+	Unknown,
+	Int,
+	Scalar,
+	Vector2,
+	Vector,
+	Vector4,
+	Matrix,
+	Token,
+	Node
+};
+
+struct FEssNativeParam
+{
+	FEssNativeParam() : Type(EEssNativeType::Unknown), bArray(false), Offset(0), Num(0) { }
+
+	FString Name;
+	EEssNativeType Type;
+	bool bArray;
+	/* First value in the pool of the node the type reads from: Ints, Floats or Strings */
+	int32 Offset;
+	/* Elements, 1 for plain values */
+	int32 Num;
+	/* Set when the parameter is linked to the output LinkOutput of another node */
+	FString LinkNode;
+	FString LinkOutput;
+
+	bool IsLinked() const { return !LinkNode.IsEmpty(); }
+};
+
+/* One node of an ess file with its parameters in file order */
+struct FEssNativeNode
+{
+	FString Type;
+	FString Name;
+	TArray<FEssNativeParam> Params;
+	TArray<int32> Ints;
+	TArray<float> Floats;
+	TArray<FString> Strings;
+
+	const FEssNativeParam* FindParam(const TCHAR* ParamName) const;
+	/* Values of an int typed parameter, NULL when it is missing or of another type */
+	const int32* GetInts(const TCHAR* ParamName, int32& OutNum) const;
+	/* Values of a float typed parameter with their component count, NULL when it is missing or not made of floats */
+	const float* GetFloats(const TCHAR* ParamName, int32& OutNum, int32& OutComponents) const;
+	/* Name of the node a node parameter refers to, NULL when unset */
+	const FString* GetNodeRef(const TCHAR* ParamName) const;
+	/* Node names of a node or token array */
+	const FString* GetStrings(const TCHAR* ParamName, int32& OutNum) const;
+	bool GetMatrix(const TCHAR* ParamName, FMatrix& OutMatrix) const;
+	/* Int or scalar value converted to int */
+	bool GetInt(const TCHAR* ParamName, int32& OutValue) const;
+
+	static int32 GetComponentCount(EEssNativeType Type);
+};
+
+struct FEssNativeReadStats
+{
+	FEssNativeReadStats() : FileBytes(0), NumChunks(0), NumNodes(0), MapSeconds(0), ParseSeconds(0), IndexSeconds(0) { }
+
+	int64 FileBytes;
+	int32 NumChunks;
+	int32 NumNodes;
+	double MapSeconds;
+	double ParseSeconds;
+	double IndexSeconds;
+
+	double GetTotalSeconds() const { return MapSeconds + ParseSeconds + IndexSeconds; }
+	double GetMegabytesPerSecond() const { double Seconds = GetTotalSeconds(); return Seconds > 0 ? FileBytes / (1024.0 * 1024.0) / Seconds : 0; }
+};
+
+/**
+*	Reads ess scene files without the Elara SDK, so imports also run where liber isn't available.
+*	The file is mapped into memory and cut into chunks at node boundaries, the chunks are tokenized and decoded
+*	on all cores and the nodes end up in file order. A chunk never splits a node, a file with one huge node parses on one core.
+*
+*	Grammar, # starts a comment that runs to the end of the line:
+*		node "<type>" "<name>"
+*			<type> "<param>" <values>					int, bool, index, scalar, vector, color, point, matrix, token, node, ...
+*			array "<param>" "<element type>" <count> <values>
+*			link "<param>" "<node>" "<output param>"
+*		end
+*	Statements the reader doesn't know, like declare and the top level render commands, are skipped.
+*/
+class FEssNativeScene
+{
+public:
+	bool Load(const FString& FileName);
+
+	const FEssNativeNode* FindNode(const FString& NodeName) const;
+	const TArray<FEssNativeNode>& GetNodes() const { return Nodes; }
+	const FEssNativeReadStats& GetStats() const { return Stats; }
+	void Reset();
+
+private:
+	bool Parse(const ANSICHAR* Data, int64 Size);
+
+	TArray<FEssNativeNode> Nodes;
+	TMap<FString, int32> NodeMap;
+	FEssNativeReadStats Stats;
+};
@@ -54,8 +54,16 @@ public:
 		FString externalDepedency;
 		FString innerFunctionBody;
 		const FString START_FUNCTION_BODY("START FUNCTION BODY");
+		const bool bSpecialized = Custom->SpecializedNodeIDs.Num() > 0;
 		for (auto& shaderInfo : inputShaders)
 		{
+			// A specialized graph only pulls in the shader types it uses
+			TArray<int32> usedIndices;
+			if (bSpecialized && !Custom->GetSpecializedIndices(GetShaderTypeID(shaderInfo.ShaderType), usedIndices))
+			{
+				continue;
+			}
+
 			FString fileString;
 			if (!LoadFileString(const_cast<FInputShaderInfo&>(shaderInfo), fileString))
 			{
@@ -95,7 +103,12 @@ public:
 							// replacedCodes += spaces + TEXT("switch (shaderIndex){\r\n");
 							for (int i = 0; i < shaderInfo.MaxShaderCount; ++i)
 							{
-								replacedCodes += spaces + FString::Printf(TEXT("if (shaderIndex == %d) "), i);
+								if (bSpecialized && !usedIndices.Contains(i))
+								{
+									continue;
+								}
+								// Only one node of this type, the texture can be sampled without selecting it
+								replacedCodes += spaces + (bSpecialized && usedIndices.Num() == 1 ? FString() : FString::Printf(TEXT("if (shaderIndex == %d) "), i));
 								FString actualTexParameter = FString::Printf(TEXT("e%d%s%d"), shaderID, *textureParameter, i);
 								replacedCodes += line.Replace(*textureParameter, *actualTexParameter);
 								replacedCodes += TEXT("\r\n");
@@ -744,7 +757,7 @@ bool UMaterialExpressionCustomMultiOut::DoImportShader(int32 currentShaderIndex)
 	PostAddInputs(parameterNames, outGraphPins);
 	pMaterialEditor->UpdateMaterialAfterGraphChange();
 
-	shaderInfo.ShaderFunctionBody = FString::Printf(TEXT("	case %d:\n"), typeID);
+	FString caseBody;
 	for (auto& inParameter : inParameters)
 	{
 		FString inParamaeterInitCode = inParameter.AlphaVariableName.Len() > 0 ? FString::Printf(TEXT(
@@ -764,11 +777,12 @@ bool UMaterialExpressionCustomMultiOut::DoImportShader(int32 currentShaderIndex)
 				"		%s[shaderIndex].xyz = outputs[output_node_index][output_index].xyz;\n"
 				"	}\n"),
 				*inParameter.Name, *inParameter.Name, *inParameter.Name, *inParameter.Name);
-		shaderInfo.ShaderFunctionBody += inParamaeterInitCode;
+		caseBody += inParamaeterInitCode;
 	}
 	FString functionCallParameter = FString::Join(functioncallParameters, TEXT(","));
-	shaderInfo.ShaderFunctionBody += FString::Printf(TEXT("	f.%s(%s);\n"), *shaderType, *functionCallParameter);
-	shaderInfo.ShaderFunctionBody += TEXT("	break;\n");
+	caseBody += FString::Printf(TEXT("	f.%s(%s);\n"), *shaderType, *functionCallParameter);
+	shaderInfo.ShaderCaseBody = caseBody;
+	shaderInfo.ShaderFunctionBody.Empty();
 	shaderInfo.ParameterDeclartion = variableDeclaration;
 #endif
 
@@ -805,9 +819,89 @@ void UMaterialExpressionCustomMultiOut::DoModifyShaderNodeInputs()
 #endif
 }
 
+bool UMaterialExpressionCustomMultiOut::SpecializeForNodes(const TArray<int32>& NodeIDs)
+{
+	SpecializedNodeIDs = NodeIDs;
+	return DoCreateSpecializedShaderBody();
+}
+
+bool UMaterialExpressionCustomMultiOut::GetSpecializedIndices(int32 ShaderTypeID, TArray<int32>& OutIndices) const
+{
+	OutIndices.Reset();
+	for (int32 nodeID : SpecializedNodeIDs)
+	{
+		if (nodeID / 10 == ShaderTypeID)
+		{
+			OutIndices.AddUnique(nodeID % 10);
+		}
+	}
+	return OutIndices.Num() > 0;
+}
+
+bool UMaterialExpressionCustomMultiOut::DoCreateSpecializedShaderBody()
+{
+	const int32 nodeCount = SpecializedNodeIDs.Num();
+	TArray<FString> codeParts;
+	codeParts.Add(FString::Printf(TEXT(
+		"float4 outputs[%d][4];\n"
+		"int i = 0;\n"
+		"for (i = 0; i < %d; ++i)\n"
+		"{\n"
+		"	for (int j = 0; j < 4; ++j)\n"
+		"	{\n"
+		"		outputs[i][j] = 0;\n"
+		"	}\n"
+		"}\n"), nodeCount, nodeCount));
+
+	TArray<int32> usedIndices;
+	for (auto& shaderInfo : InputShaders)
+	{
+		if (GetSpecializedIndices(GetShaderTypeID(shaderInfo.ShaderType), usedIndices))
+		{
+			codeParts.Add(shaderInfo.ParameterDeclartion);
+		}
+	}
+
+	// Each node becomes its case body with constant indices, so neither the loop nor the switch survive
+	codeParts.Add(TEXT("Functions f;\n"));
+	for (int32 i = 0; i < nodeCount; ++i)
+	{
+		int32 nodeType = SpecializedNodeIDs[i] / 10;
+		const FInputShaderInfo* pNodeShader = InputShaders.FindByPredicate([&](const FInputShaderInfo& shaderInfo)
+		{
+			return GetShaderTypeID(shaderInfo.ShaderType) == nodeType;
+		});
+
+		// Shaders imported before the case bodies were kept on their own only have the whole switch case
+		if (NULL == pNodeShader || pNodeShader->ShaderCaseBody.IsEmpty())
+		{
+			return false;
+		}
+		codeParts.Add(FString::Printf(TEXT("i = %d;\nshaderIndex = %d;\n{\n%s}\n"), i, SpecializedNodeIDs[i] % 10, *pNodeShader->ShaderCaseBody));
+	}
+
+	codeParts.Add(FString::Printf(TEXT(
+		"float3 output_diffuse = outputs[%d][0].xyz;\n"
+		"output_specular = outputs[%d][0].w;\n"
+		"output_emissive = outputs[%d][1];\n"
+		"output_roughness = outputs[%d][1].w;\n"
+		"output_normal = outputs[%d][2];\n"
+		"return output_diffuse;\n"), nodeCount - 1, nodeCount - 1, nodeCount - 1, nodeCount - 1, nodeCount - 1));
+
+	Code = FString::Join(codeParts, TEXT(""));
+	return true;
+}
+
 void UMaterialExpressionCustomMultiOut::DoCreateShaderBody()
 {
-	Code = FString::Printf(TEXT(
+	if (SpecializedNodeIDs.Num() > 0)
+	{
+		DoCreateSpecializedShaderBody();
+		return;
+	}
+
+	TArray<FString> codeParts;
+	codeParts.Add(FString::Printf(TEXT(
 		"float4 outputs[%d][4];\n"
 		"%s"
 		"for (int i = 0; i < ess_shaderCount; ++i)\n"
@@ -816,27 +910,34 @@ void UMaterialExpressionCustomMultiOut::DoCreateShaderBody()
 		"	{\n"
 		"		outputs[i][j] = 0;\n"
 		"	}\n"
-		"}\n"), MaxShaderNodes, *EssNodeDeclaration);
+		"}\n"), MaxShaderNodes, *EssNodeDeclaration));
 
 	for (auto& shaderInfo : InputShaders)
 	{
-		Code += shaderInfo.ParameterDeclartion;
+		codeParts.Add(shaderInfo.ParameterDeclartion);
 	}
 
-	Code += TEXT(
+	codeParts.Add(TEXT(
 		"Functions f;\n"
 		"for (i = 0; i < ess_shaderCount; ++i)\n"
 		"{\n"
 		"	uint nodeType = nodeId[i] / 10;\n"
 		"	shaderIndex = nodeId[i] % 10;\n"
 		"	switch (nodeType)\n"
-		"	{\n");
+		"	{\n"));
 	for (auto& shaderInfo : InputShaders)
 	{
-		Code += shaderInfo.ShaderFunctionBody;
+		if (shaderInfo.ShaderCaseBody.IsEmpty())
+		{
+			codeParts.Add(shaderInfo.ShaderFunctionBody);
+		}
+		else
+		{
+			codeParts.Add(FString::Printf(TEXT("	case %d:\n%s	break;\n"), GetShaderTypeID(shaderInfo.ShaderType), *shaderInfo.ShaderCaseBody));
+		}
 	}
 
-	Code += TEXT(
+	codeParts.Add(TEXT(
 		"	default:\n"
 		"	break;\n"
 		"	}\n"
@@ -847,7 +948,9 @@ void UMaterialExpressionCustomMultiOut::DoCreateShaderBody()
 		"output_emissive = outputs[lastIndex][1];\n"
 		"output_roughness = outputs[lastIndex][1].w;\n"
 		"output_normal = outputs[lastIndex][2];\n"
-		"return output_diffuse;\n");
+		"return output_diffuse;\n"));
+
+	Code = FString::Join(codeParts, TEXT(""));
 }
 
 #if WITH_EDITOR
@@ -44,9 +44,14 @@ struct FInputShaderInfo
 	UPROPERTY()
 	FString ParameterDeclartion;
 
+	/** Whole switch case of shaders imported before ShaderCaseBody existed, no longer written */
 	UPROPERTY()
 	FString ShaderFunctionBody;
 
+	/** Statements of the node's switch case, without the label and the break */
+	UPROPERTY()
+	FString ShaderCaseBody;
+
 	UPROPERTY()
 	TArray<FString> TextureParameters;
 
@@ -82,6 +87,16 @@ class UMaterialExpressionCustomMultiOut : public UMaterialExpression
 	UPROPERTY()
 	FString EssNodeDeclaration;
 
+	/** Node ids of the one shader graph this expression is specialized for, empty for the generic node loop */
+	UPROPERTY()
+	TArray<int32> SpecializedNodeIDs;
+
+	/** Replaces the node loop with straight line code for the given shader graph, false when a shader has to be imported again first */
+	bool SpecializeForNodes(const TArray<int32>& NodeIDs);
+
+	/** Collects the indices of the nodes of a shader type in the specialized graph, returns false when the type isn't used */
+	bool GetSpecializedIndices(int32 ShaderTypeID, TArray<int32>& OutIndices) const;
+
 	//~ Begin UObject Interface.
 #if WITH_EDITOR
 	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
@@ -107,6 +122,7 @@ private:
 	bool DoImportShader(int32 currentShaderIndex);
 	void DoModifyShaderNodeInputs();
 	void DoCreateShaderBody();
+	bool DoCreateSpecializedShaderBody();
 	FVector2D PreDeleteInputs(const FString& prefix, int nodeCountsPerRow);
 	void PostAddInputs(const TArray<FString> parameterNames, TArray<UEdGraphPin*> outGraphPins);
 	FString mFrameStamp;
@@ -0,0 +1,57 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#pragma once
+
+#include "Engine.h"
+
+class URuntimeMeshComponent;
+
+struct FRuntimeMeshAOBakeSettings
+{
+	FRuntimeMeshAOBakeSettings()
+		: NumRays(64)
+		, MaxDistance(200.0f)
+		, Bias(0.5f)
+		, bSkyVisibility(false)
+	{ }
+
+	/** Hemisphere rays per vertex, rounded up to a multiple of four */
+	int32 NumRays;
+	/** Occluders further away than this don't darken a vertex */
+	float MaxDistance;
+	/** Offset of the ray origins along the normal, keeps rays from hitting the triangles around the vertex */
+	float Bias;
+	/** Also trace the unoccluded rays out of the scene and store the fraction that escapes in the alpha channel */
+	bool bSkyVisibility;
+};
+
+struct FRuntimeMeshAOBakeStats
+{
+	FRuntimeMeshAOBakeStats()
+		: NumVertices(0)
+		, NumTriangles(0)
+		, NumRays(0)
+		, BuildSeconds(0)
+		, TraceSeconds(0)
+	{ }
+
+	int32 NumVertices;
+	int32 NumTriangles;
+	int64 NumRays;
+	double BuildSeconds;
+	double TraceSeconds;
+
+	double GetRaysPerSecond() const { return TraceSeconds > 0 ? NumRays / TraceSeconds : 0; }
+};
+
+/**
+*	Bakes ambient occlusion into the vertex colors of RuntimeMeshComponents.
+*	All sections of the components are gathered in world space into one BVH, so the components occlude each other.
+*	The vertices are traced on all cores in packets of four rays, the occlusion ends up in RGB (1 is unoccluded)
+*	and the optional sky visibility in A. Sections without a color component are skipped.
+*/
+class RUNTIMEMESHCOMPONENT_API FRuntimeMeshAOBaker
+{
+public:
+	static FRuntimeMeshAOBakeStats Bake(const TArray<URuntimeMeshComponent*>& Components, const FRuntimeMeshAOBakeSettings& Settings);
+};
@@ -36,7 +36,7 @@
 																																				\
 		static ESubsequentsMode::Type GetSubsequentsMode()																						\
 		{																																		\
-			return ESubsequentsMode::FireAndForget;																								\
+			return ESubsequentsMode::TrackSubsequents;																							\
 		}																																		\
 																																				\
 		void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)											\
@@ -48,15 +48,356 @@
 			}																																	\
 		}																																		\
 	};																																			\
-	TGraphTask<FParallelRuntimeMeshComponentTask_##TaskType>::CreateTask().ConstructAndDispatchWhenReady(RuntimeMesh, DataPtr);
+	DispatchInOrder<FParallelRuntimeMeshComponentTask_##TaskType>(RuntimeMesh, FGraphEventRef(), RuntimeMesh, DataPtr);
 
 
 
 
 class RUNTIMEMESHCOMPONENT_API FRuntimeMeshAsync
 {
+	/* 
+	*	A detached section on its way through the preparation tasks. Each task only starts once the one before it
+	*	finished, so the section is never touched by two threads at once even though its reference count isn't thread safe.
+	*/
+	struct FPreparedSection
+	{
+		FPreparedSection(int32 InSectionIndex, RuntimeMeshSectionPtr&& InSection, bool bInRecalculateBounds, ESectionUpdateFlags InUpdateFlags, ERuntimeMeshSectionBatchUpdateType InUpdateType)
+			: SectionIndex(InSectionIndex), Section(MoveTemp(InSection)), bRecalculateBounds(bInRecalculateBounds), UpdateFlags(InUpdateFlags), UpdateType(InUpdateType)
+			, PositionsBoundingBox(EForceInit::ForceInitToZero), bIsValid(true)
+		{
+		}
+
+		int32 SectionIndex;
+
+		/* Null for a position only update until the worker builds it */
+		RuntimeMeshSectionPtr Section;
+		bool bRecalculateBounds;
+		ESectionUpdateFlags UpdateFlags;
+
+		/* Create, or the buffers an update brings */
+		ERuntimeMeshSectionBatchUpdateType UpdateType;
+
+		/* Position only updates carry their positions here as there is no vertex type to make a section with */
+		TArray<FVector> Positions;
+		FBox PositionsBoundingBox;
+
+		/* 
+		*	The section an update replaces, set and released on the game thread. The worker reads the buffers the update
+		*	doesn't bring from it, and the commit only applies if it is still the component's section.
+		*/
+		RuntimeMeshSectionPtr LayoutSource;
+
+		/* Cleared by the first task that rejects the section, the later ones skip it */
+		bool bIsValid;
+
+		bool IsUpdate() const { return !(UpdateType & ERuntimeMeshSectionBatchUpdateType::Create); }
+	};
+	typedef TSharedPtr<FPreparedSection, ESPMode::ThreadSafe> FPreparedSectionPtr;
+
+	/* Hands a prepared update the section it replaces, on the game thread. */
+	class FMatchSectionLayoutTask
+	{
+		TWeakObjectPtr<URuntimeMeshComponent> RuntimeMeshComponent;
+		FPreparedSectionPtr Data;
+	public:
+		FMatchSectionLayoutTask(TWeakObjectPtr<URuntimeMeshComponent> InRMC, const FPreparedSectionPtr& InData)
+			: RuntimeMeshComponent(InRMC), Data(InData)
+		{
+		}
+
+		FORCEINLINE TStatId GetStatId() const
+		{
+			RETURN_QUICK_DECLARE_CYCLE_STAT(FRuntimeMeshAsync_MatchSectionLayoutTask, STATGROUP_TaskGraphTasks);
+		}
+
+		static ENamedThreads::Type GetDesiredThread()
+		{
+			return ENamedThreads::GameThread;
+		}
+
+		static ESubsequentsMode::Type GetSubsequentsMode()
+		{
+			return ESubsequentsMode::TrackSubsequents;
+		}
+
+		void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+		{
+			URuntimeMeshComponent* Mesh = RuntimeMeshComponent.Get();
+			Data->bIsValid = Mesh != nullptr && Mesh->MatchPreparedSectionLayout(Data->SectionIndex, Data->Section, Data->UpdateType, Data->LayoutSource);
+		}
+	};
+
+	/* Commits a prepared section on the game thread. */
+	class FCommitSectionTask
+	{
+		TWeakObjectPtr<URuntimeMeshComponent> RuntimeMeshComponent;
+		FPreparedSectionPtr Data;
+	public:
+		FCommitSectionTask(TWeakObjectPtr<URuntimeMeshComponent> InRMC, const FPreparedSectionPtr& InData)
+			: RuntimeMeshComponent(InRMC), Data(InData)
+		{
+		}
+
+		FORCEINLINE TStatId GetStatId() const
+		{
+			RETURN_QUICK_DECLARE_CYCLE_STAT(FRuntimeMeshAsync_CommitSectionTask, STATGROUP_TaskGraphTasks);
+		}
+
+		static ENamedThreads::Type GetDesiredThread()
+		{
+			return ENamedThreads::GameThread;
+		}
+
+		static ESubsequentsMode::Type GetSubsequentsMode()
+		{
+			return ESubsequentsMode::TrackSubsequents;
+		}
+
+		void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+		{
+			// Both are let go of here so their reference counts are only ever changed on the game thread
+			RuntimeMeshSectionPtr Section = MoveTemp(Data->Section);
+			RuntimeMeshSectionPtr LayoutSource = MoveTemp(Data->LayoutSource);
+
+			URuntimeMeshComponent* Mesh = RuntimeMeshComponent.Get();
+			if (Mesh && Data->bIsValid)
+			{
+				if (Data->IsUpdate())
+				{
+					Mesh->CommitPreparedSectionUpdate(Data->SectionIndex, Section, LayoutSource, Data->UpdateType, Data->UpdateFlags);
+				}
+				else
+				{
+					Mesh->CommitPreparedSection(Data->SectionIndex, Section, Data->UpdateFlags);
+				}
+			}
+		}
+	};
+
+	/* Completes an update from the section it replaces, validates it and builds its derived data on a task graph worker. */
+	class FPrepareSectionTask
+	{
+		FPreparedSectionPtr Data;
+	public:
+		FPrepareSectionTask(const FPreparedSectionPtr& InData)
+			: Data(InData)
+		{
+		}
+
+		FORCEINLINE TStatId GetStatId() const
+		{
+			RETURN_QUICK_DECLARE_CYCLE_STAT(FRuntimeMeshAsync_PrepareSectionTask, STATGROUP_TaskGraphTasks);
+		}
+
+		static ENamedThreads::Type GetDesiredThread()
+		{
+			return ENamedThreads::AnyThread;
+		}
+
+		static ESubsequentsMode::Type GetSubsequentsMode()
+		{
+			return ESubsequentsMode::TrackSubsequents;
+		}
+
+		void DoTask(ENamedThreads::Type CurrentThread, const FGraphEventRef& MyCompletionGraphEvent)
+		{
+			if (Data->bIsValid && Data->IsUpdate())
+			{
+				MergeWithLayoutSource(*Data);
+			}
+
+			if (Data->bIsValid && ValidatePreparedSection(*Data))
+			{
+				Data->Section->PrepareDerivedData(Data->UpdateFlags, Data->bRecalculateBounds);
+			}
+			else
+			{
+				Data->bIsValid = false;
+			}
+		}
+	};
+
+	/* Internal log helper for the validation macros */
+	static void Log(FString Text, bool bIsError = false)
+	{
+		URuntimeMeshComponent::Log(Text, bIsError);
+	}
+
+	/* 
+	*	Builds the section an update commits from the buffers it brought and the ones of the section it replaces.
+	*	Runs on the worker so the game thread never copies the buffers the update leaves alone.
+	*/
+	static void MergeWithLayoutSource(FPreparedSection& Data)
+	{
+		const FRuntimeMeshSectionInterface& Source = *Data.LayoutSource;
+
+		const bool bHasPositions = !!(Data.UpdateType & ERuntimeMeshSectionBatchUpdateType::PositionsUpdate);
+		const bool bHasVertices = !!(Data.UpdateType & ERuntimeMeshSectionBatchUpdateType::VerticesUpdate);
+		const bool bHasIndices = !!(Data.UpdateType & ERuntimeMeshSectionBatchUpdateType::IndicesUpdate);
+
+		if (bHasVertices && bHasIndices && bHasPositions == Source.IsDualBufferSection())
+		{
+			// Nothing is missing, the section is committed as it is
+			Data.Section->CollisionEnabled = Source.CollisionEnabled;
+			return;
+		}
+
+		FRuntimeMeshSectionInterface* Update = Data.Section.Get();
+		TArray<FVector>* Positions = !bHasPositions ? nullptr : (Update ? &Update->PositionVertexBuffer : &Data.Positions);
+		const FBox SuppliedBoundingBox = Update ? Update->LocalBoundingBox : Data.PositionsBoundingBox;
+
+		RuntimeMeshSectionPtr Merged = Source.MergeUpdate(Update, Positions, bHasVertices, bHasIndices);
+
+		// The bounds of a dual buffer section only move with its positions
+		if (!bHasPositions && Source.IsDualBufferSection())
+		{
+			Data.bRecalculateBounds = false;
+		}
+		else if (!Data.bRecalculateBounds)
+		{
+			Merged->LocalBoundingBox = SuppliedBoundingBox;
+		}
+
+		// Reordering is only done along with new indices, as the game thread update does
+		if (!bHasIndices)
+		{
+			Data.UpdateFlags &= ~ESectionUpdateFlags::OptimizeMesh;
+		}
+
+		Data.Section = MoveTemp(Merged);
+	}
+
+	/* The checks the game thread create and update calls make, run on the worker before any derived data is built. */
+	static bool ValidatePreparedSection(const FPreparedSection& Data)
+	{
+		const FRuntimeMeshSectionInterface& Section = *Data.Section;
+		const int32 NumVertices = Section.GetNumVertices();
+
+		RMC_CHECKINGAME_LOGINEDITOR((Data.SectionIndex >= 0), "SectionIndex cannot be negative.", false);
+		RMC_CHECKINGAME_LOGINEDITOR((NumVertices > 0), "Vertices length must not be 0.", false);
+		RMC_CHECKINGAME_LOGINEDITOR((Section.IndexBuffer.Num() > 0), "Triangles length must not be 0", false);
+		RMC_CHECKINGAME_LOGINEDITOR((Section.IndexBuffer.Num() % 3 == 0), "Triangles length must be a multiple of 3.", false);
+		RMC_CHECKINGAME_LOGINEDITOR((!Section.IsDualBufferSection() || Section.PositionVertexBuffer.Num() == NumVertices), "Positions must be the same length as Vertices", false);
+		RMC_CHECKINGAME_LOGINEDITOR((Data.bRecalculateBounds || Section.LocalBoundingBox.IsValid), "BoundingBox must be valid.", false);
+
+		// Out of range indices would reach the RHI, the worker can afford the pass over them
+		bool bIndicesInRange = true;
+		for (int32 Index : Section.IndexBuffer)
+		{
+			bIndicesInRange &= (uint32)Index < (uint32)NumVertices;
+		}
+		RMC_CHECKINGAME_LOGINEDITOR(bIndicesInRange, "Triangles must only reference existing vertices.", false);
+
+		return true;
+	}
+
+	/* 
+	*	Last task queued for each component. Every game thread task applying to a component waits on the one queued
+	*	before it, so creates, updates and clears reach the component in the order they were called.
+	*/
+	static FCriticalSection OrderLock;
+	static TMap<TWeakObjectPtr<URuntimeMeshComponent>, FGraphEventRef> LastComponentTasks;
+
+	/* Adds the last task queued for the component to Prerequisites, call with OrderLock held */
+	static void AddLastComponentTask(const TWeakObjectPtr<URuntimeMeshComponent>& InRuntimeMeshComponent, FGraphEventArray& Prerequisites);
+
+	/* Makes Event the last task queued for the component, call with OrderLock held */
+	static void SetLastComponentTask(const TWeakObjectPtr<URuntimeMeshComponent>& InRuntimeMeshComponent, const FGraphEventRef& Event);
+
+	/* Queues a game thread task for a component behind the ones queued before it and an optional extra prerequisite */
+	template<typename TaskType, typename... ArgTypes>
+	static FGraphEventRef DispatchInOrder(const TWeakObjectPtr<URuntimeMeshComponent>& InRuntimeMeshComponent, const FGraphEventRef& Prerequisite, ArgTypes&&... Args)
+	{
+		FScopeLock Lock(&OrderLock);
+
+		FGraphEventArray Prerequisites;
+		if (Prerequisite.IsValid())
+		{
+			Prerequisites.Add(Prerequisite);
+		}
+		AddLastComponentTask(InRuntimeMeshComponent, Prerequisites);
+
+		FGraphEventRef Event = TGraphTask<TaskType>::CreateTask(&Prerequisites).ConstructAndDispatchWhenReady(Forward<ArgTypes>(Args)...);
+		SetLastComponentTask(InRuntimeMeshComponent, Event);
+		return Event;
+	}
+
+	/* 
+	*	Creates a section that isn't owned by any component yet and fills its buffers. This only moves/copies the arrays,
+	*	all per vertex work is left for the preparation task.
+	*/
+	template<typename VertexType>
+	static RuntimeMeshSectionPtr MakeDetachedSection(TArray<FVector>* VertexPositions, TArray<VertexType>& Vertices, TArray<int32>* Triangles, const FBox* BoundingBox, ESectionUpdateFlags UpdateFlags)
+	{
+		TSharedPtr<FRuntimeMeshSection<VertexType>> Section = MakeShareable(new FRuntimeMeshSection<VertexType>(VertexPositions != nullptr));
+
+		bool bShouldUseMove = !!(UpdateFlags & ESectionUpdateFlags::MoveArrays);
+
+		// Use the supplied bounds, or a placeholder that the worker will replace, so the fill doesn't walk the vertices here.
+		FBox PlaceholderBounds(EForceInit::ForceInitToZero);
+		const FBox* FillBounds = BoundingBox ? BoundingBox : &PlaceholderBounds;
+
+		if (VertexPositions)
+		{
+			Section->UpdateVertexPositionBuffer(*VertexPositions, FillBounds, bShouldUseMove);
+		}
+		Section->UpdateVertexBuffer(Vertices, FillBounds, bShouldUseMove);
+		if (Triangles)
+		{
+			Section->UpdateIndexBuffer(*Triangles, bShouldUseMove);
+		}
+
+		return Section;
+	}
+
+	/* 
+	*	Queues the derived data preparation of a detached section on a worker, followed by the game thread commit.
+	*	Preparations run in parallel but the commits keep the call order. An update first waits for the game thread
+	*	to hand it the section it replaces, so updates to one component are prepared one after another.
+	*/
+	static void DispatchSectionPreparation(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, RuntimeMeshSectionPtr&& Section,
+		bool bRecalculateBounds, ESectionUpdateFlags UpdateFlags, ERuntimeMeshSectionBatchUpdateType UpdateType)
+	{
+		DispatchSectionPreparation(InRuntimeMeshComponent, MakeShareable(new FPreparedSection(SectionIndex, MoveTemp(Section), bRecalculateBounds, UpdateFlags, UpdateType)));
+	}
+
+	static void DispatchSectionPreparation(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, const FPreparedSectionPtr& Data)
+	{
+		// Held throughout so no other task of the component lands between the steps
+		FScopeLock Lock(&OrderLock);
+
+		FGraphEventArray PreparePrerequisites;
+		if (Data->IsUpdate())
+		{
+			PreparePrerequisites.Add(DispatchInOrder<FMatchSectionLayoutTask>(InRuntimeMeshComponent, FGraphEventRef(), InRuntimeMeshComponent, Data));
+		}
 
+		FGraphEventRef PrepareEvent = TGraphTask<FPrepareSectionTask>::CreateTask(&PreparePrerequisites).ConstructAndDispatchWhenReady(Data);
+		DispatchInOrder<FCommitSectionTask>(InRuntimeMeshComponent, PrepareEvent, InRuntimeMeshComponent, Data);
+	}
 
+	/* Queues a position only update, the worker combines the positions with the rest of the section they replace. */
+	static void DispatchPositionUpdate(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<FVector>& VertexPositions,
+		const FBox* BoundingBox, ESectionUpdateFlags UpdateFlags)
+	{
+		FPreparedSectionPtr Data = MakeShareable(new FPreparedSection(SectionIndex, nullptr, BoundingBox == nullptr, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::PositionsUpdate));
+
+		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
+		{
+			Data->Positions = MoveTemp(VertexPositions);
+		}
+		else
+		{
+			Data->Positions = VertexPositions;
+		}
+
+		if (BoundingBox)
+		{
+			Data->PositionsBoundingBox = *BoundingBox;
+		}
+
+		DispatchSectionPreparation(InRuntimeMeshComponent, Data);
+	}
 
 public:
 
@@ -73,37 +414,11 @@ public:
 	static void CreateMeshSection(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<VertexType>& Vertices, TArray<int32>& Triangles, 
 		bool bCreateCollision = false, EUpdateFrequency UpdateFrequency = EUpdateFrequency::Average, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<VertexType> Vertices;
-			TArray<int32> Triangles;
-			bool bCreateCollision;
-			EUpdateFrequency UpdateFrequency;
-			ESectionUpdateFlags UpdateFlags;
-		};
-
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->Vertices = MoveTemp(Vertices);
-			CallData->Triangles = MoveTemp(Triangles);
-		}
-		else
-		{
-			CallData->Vertices = Vertices;
-			CallData->Triangles = Triangles;
-		}
-		CallData->bCreateCollision = bCreateCollision;
-		CallData->UpdateFrequency = UpdateFrequency;
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(nullptr, Vertices, &Triangles, nullptr, UpdateFlags);
+		Section->CollisionEnabled = bCreateCollision;
+		Section->UpdateFrequency = UpdateFrequency;
 
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(CreateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->CreateMeshSection(Data->SectionIndex, Data->Vertices, Data->Triangles, Data->bCreateCollision, Data->UpdateFrequency, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), true, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::Create);
 	}
 
 
@@ -121,39 +436,11 @@ public:
 	static void CreateMeshSection(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<VertexType>& Vertices, TArray<int32>& Triangles,
 		const FBox& BoundingBox, bool bCreateCollision = false, EUpdateFrequency UpdateFrequency = EUpdateFrequency::Average, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<VertexType> Vertices;
-			TArray<int32> Triangles;
-			FBox BoundingBox;
-			bool bCreateCollision;
-			EUpdateFrequency UpdateFrequency;
-			ESectionUpdateFlags UpdateFlags;
-		};
-
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->Vertices = MoveTemp(Vertices);
-			CallData->Triangles = MoveTemp(Triangles);
-		}
-		else
-		{
-			CallData->Vertices = Vertices;
-			CallData->Triangles = Triangles;
-		}
-		CallData->BoundingBox = BoundingBox;
-		CallData->bCreateCollision = bCreateCollision;
-		CallData->UpdateFrequency = UpdateFrequency;
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(nullptr, Vertices, &Triangles, &BoundingBox, UpdateFlags);
+		Section->CollisionEnabled = bCreateCollision;
+		Section->UpdateFrequency = UpdateFrequency;
 
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(CreateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->CreateMeshSection(Data->SectionIndex, Data->Vertices, Data->Triangles, Data->BoundingBox, Data->bCreateCollision, Data->UpdateFrequency, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), false, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::Create);
 	}
 
 	/**
@@ -171,40 +458,11 @@ public:
 		TArray<VertexType>& VertexData, TArray<int32>& Triangles, bool bCreateCollision = false,
 		EUpdateFrequency UpdateFrequency = EUpdateFrequency::Average, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<FVector> VertexPositions;
-			TArray<VertexType> Vertices;
-			TArray<int32> Triangles;
-			bool bCreateCollision;
-			EUpdateFrequency UpdateFrequency;
-			ESectionUpdateFlags UpdateFlags;
-		};
-
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->VertexPositions = MoveTemp(VertexPositions);
-			CallData->Vertices = MoveTemp(VertexData);
-			CallData->Triangles = MoveTemp(Triangles);
-		}
-		else
-		{
-			CallData->VertexPositions = VertexPositions;
-			CallData->Vertices = VertexData;
-			CallData->Triangles = Triangles;
-		}
-		CallData->bCreateCollision = bCreateCollision;
-		CallData->UpdateFrequency = UpdateFrequency;
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(&VertexPositions, VertexData, &Triangles, nullptr, UpdateFlags);
+		Section->CollisionEnabled = bCreateCollision;
+		Section->UpdateFrequency = UpdateFrequency;
 
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(CreateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->CreateMeshSection(Data->SectionIndex, Data->VertexPositions, Data->Vertices, Data->Triangles, Data->bCreateCollision, Data->UpdateFrequency, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), true, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::Create);
 	}
 
 	/**
@@ -223,42 +481,11 @@ public:
 		TArray<VertexType>& VertexData, TArray<int32>& Triangles, const FBox& BoundingBox,
 		bool bCreateCollision = false, EUpdateFrequency UpdateFrequency = EUpdateFrequency::Average, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<FVector> VertexPositions;
-			TArray<VertexType> Vertices;
-			TArray<int32> Triangles;
-			FBox BoundingBox;
-			bool bCreateCollision;
-			EUpdateFrequency UpdateFrequency;
-			ESectionUpdateFlags UpdateFlags;
-		};
-
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->VertexPositions = MoveTemp(VertexPositions);
-			CallData->Vertices = MoveTemp(VertexData);
-			CallData->Triangles = MoveTemp(Triangles);
-		}
-		else
-		{
-			CallData->VertexPositions = VertexPositions;
-			CallData->Vertices = VertexData;
-			CallData->Triangles = Triangles;
-		}
-		CallData->BoundingBox = BoundingBox;
-		CallData->bCreateCollision = bCreateCollision;
-		CallData->UpdateFrequency = UpdateFrequency;
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(&VertexPositions, VertexData, &Triangles, &BoundingBox, UpdateFlags);
+		Section->CollisionEnabled = bCreateCollision;
+		Section->UpdateFrequency = UpdateFrequency;
 
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(CreateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->CreateMeshSection(Data->SectionIndex, Data->VertexPositions, Data->Vertices, Data->Triangles, Data->BoundingBox, Data->bCreateCollision, Data->UpdateFrequency, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), false, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::Create);
 	}
 
 
@@ -272,31 +499,9 @@ public:
 	static void UpdateMeshSection(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<VertexType>& Vertices,
 		ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<VertexType> Vertices;
-			ESectionUpdateFlags UpdateFlags;
-		};
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(nullptr, Vertices, nullptr, nullptr, UpdateFlags);
 
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->Vertices = MoveTemp(Vertices);
-		}
-		else
-		{
-			CallData->Vertices = Vertices;
-		}
-
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
-
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(UpdateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->UpdateMeshSection(Data->SectionIndex, Data->Vertices, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), true, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::VerticesUpdate);
 	}
 
 	/**
@@ -310,33 +515,9 @@ public:
 	static void UpdateMeshSection(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<VertexType>& Vertices,
 		const FBox& BoundingBox, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<VertexType> Vertices;
-			FBox BoundingBox;
-			ESectionUpdateFlags UpdateFlags;
-		};
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(nullptr, Vertices, nullptr, &BoundingBox, UpdateFlags);
 
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->Vertices = MoveTemp(Vertices);
-		}
-		else
-		{
-			CallData->Vertices = Vertices;
-		}
-		
-		CallData->BoundingBox = BoundingBox;
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
-
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(UpdateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->UpdateMeshSection(Data->SectionIndex, Data->Vertices, Data->BoundingBox, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), false, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::VerticesUpdate);
 	}
 
 	/**
@@ -350,34 +531,9 @@ public:
 	static void UpdateMeshSection(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<VertexType>& Vertices,
 		TArray<int32>& Triangles, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<VertexType> Vertices;
-			TArray<int32> Triangles;
-			ESectionUpdateFlags UpdateFlags;
-		};
-
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(nullptr, Vertices, &Triangles, nullptr, UpdateFlags);
 
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->Vertices = MoveTemp(Vertices);
-			CallData->Triangles = MoveTemp(Triangles);
-		}
-		else
-		{
-			CallData->Vertices = Vertices;
-			CallData->Triangles = Triangles;
-		}
-
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
-
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(UpdateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->UpdateMeshSection(Data->SectionIndex, Data->Vertices, Data->Triangles, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), true, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::VerticesUpdate | ERuntimeMeshSectionBatchUpdateType::IndicesUpdate);
 	}
 
 	/**
@@ -392,36 +548,9 @@ public:
 	static void UpdateMeshSection(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<VertexType>& Vertices,
 		TArray<int32>& Triangles, const FBox& BoundingBox, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<VertexType> Vertices;
-			TArray<int32> Triangles;
-			FBox BoundingBox;
-			ESectionUpdateFlags UpdateFlags;
-		};
-
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->Vertices = MoveTemp(Vertices);
-			CallData->Triangles = MoveTemp(Triangles);
-		}
-		else
-		{
-			CallData->Vertices = Vertices;
-			CallData->Triangles = Triangles;
-		}
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(nullptr, Vertices, &Triangles, &BoundingBox, UpdateFlags);
 
-		CallData->BoundingBox = BoundingBox;
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
-
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(UpdateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->UpdateMeshSection(Data->SectionIndex, Data->Vertices, Data->Triangles, Data->BoundingBox, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), false, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::VerticesUpdate | ERuntimeMeshSectionBatchUpdateType::IndicesUpdate);
 	}
 
 
@@ -436,34 +565,9 @@ public:
 	static void UpdateMeshSection(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<FVector>& VertexPositions,
 		TArray<VertexType>& Vertices, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<FVector> VertexPositions;
-			TArray<VertexType> Vertices;
-			ESectionUpdateFlags UpdateFlags;
-		};
-
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->VertexPositions = MoveTemp(VertexPositions);
-			CallData->Vertices = MoveTemp(Vertices);
-		}
-		else
-		{
-			CallData->VertexPositions = VertexPositions;
-			CallData->Vertices = Vertices;
-		}
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(&VertexPositions, Vertices, nullptr, nullptr, UpdateFlags);
 
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
-
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(UpdateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->UpdateMeshSection(Data->SectionIndex, Data->VertexPositions, Data->Vertices, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), true, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::PositionsUpdate | ERuntimeMeshSectionBatchUpdateType::VerticesUpdate);
 	}
 
 	/**
@@ -478,36 +582,9 @@ public:
 	static void UpdateMeshSection(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<FVector>& VertexPositions,
 		TArray<VertexType>& Vertices, const FBox& BoundingBox, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<FVector> VertexPositions;
-			TArray<VertexType> Vertices;
-			FBox BoundingBox;
-			ESectionUpdateFlags UpdateFlags;
-		};
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(&VertexPositions, Vertices, nullptr, &BoundingBox, UpdateFlags);
 
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->VertexPositions = MoveTemp(VertexPositions);
-			CallData->Vertices = MoveTemp(Vertices);
-		}
-		else
-		{
-			CallData->VertexPositions = VertexPositions;
-			CallData->Vertices = Vertices;
-		}
-
-		CallData->BoundingBox = BoundingBox;
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
-
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(UpdateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->UpdateMeshSection(Data->SectionIndex, Data->VertexPositions, Data->Vertices, Data->BoundingBox, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), false, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::PositionsUpdate | ERuntimeMeshSectionBatchUpdateType::VerticesUpdate);
 	}
 
 	/**
@@ -522,37 +599,9 @@ public:
 	static void UpdateMeshSection(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<FVector>& VertexPositions,
 		TArray<VertexType>& Vertices, TArray<int32>& Triangles, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<FVector> VertexPositions;
-			TArray<VertexType> Vertices;
-			TArray<int32> Triangles;
-			ESectionUpdateFlags UpdateFlags;
-		};
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(&VertexPositions, Vertices, &Triangles, nullptr, UpdateFlags);
 
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->VertexPositions = MoveTemp(VertexPositions);
-			CallData->Vertices = MoveTemp(Vertices);
-			CallData->Triangles = MoveTemp(Triangles);
-		}
-		else
-		{
-			CallData->VertexPositions = VertexPositions;
-			CallData->Vertices = Vertices;
-			CallData->Triangles = Triangles;
-		}
-
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
-
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(UpdateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->UpdateMeshSection(Data->SectionIndex, Data->VertexPositions, Data->Vertices, Data->Triangles, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), true, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::PositionsUpdate | ERuntimeMeshSectionBatchUpdateType::VerticesUpdate | ERuntimeMeshSectionBatchUpdateType::IndicesUpdate);
 	}
 
 	/**
@@ -568,39 +617,9 @@ public:
 	static void UpdateMeshSection(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex, TArray<FVector>& VertexPositions,
 		TArray<VertexType>& Vertices, TArray<int32>& Triangles, const FBox& BoundingBox, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<FVector> VertexPositions;
-			TArray<VertexType> Vertices;
-			TArray<int32> Triangles;
-			FBox BoundingBox;
-			ESectionUpdateFlags UpdateFlags;
-		};
+		RuntimeMeshSectionPtr Section = MakeDetachedSection<VertexType>(&VertexPositions, Vertices, &Triangles, &BoundingBox, UpdateFlags);
 
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->VertexPositions = MoveTemp(VertexPositions);
-			CallData->Vertices = MoveTemp(Vertices);
-			CallData->Triangles = MoveTemp(Triangles);
-		}
-		else
-		{
-			CallData->VertexPositions = VertexPositions;
-			CallData->Vertices = Vertices;
-			CallData->Triangles = Triangles;
-		}
-
-		CallData->BoundingBox = BoundingBox;
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
-
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(UpdateMeshSection, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->UpdateMeshSection(Data->SectionIndex, Data->VertexPositions, Data->Vertices, Data->Triangles, Data->BoundingBox, Data->UpdateFlags);
-		});
+		DispatchSectionPreparation(InRuntimeMeshComponent, SectionIndex, MoveTemp(Section), false, UpdateFlags, ERuntimeMeshSectionBatchUpdateType::PositionsUpdate | ERuntimeMeshSectionBatchUpdateType::VerticesUpdate | ERuntimeMeshSectionBatchUpdateType::IndicesUpdate);
 	}
 
 
@@ -613,31 +632,7 @@ public:
 	static void UpdateMeshSectionPositionsImmediate(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex,
 		TArray<FVector>& VertexPositions, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<FVector> VertexPositions;
-			ESectionUpdateFlags UpdateFlags;
-		};
-
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->VertexPositions = MoveTemp(VertexPositions);
-		}
-		else
-		{
-			CallData->VertexPositions = VertexPositions;
-		}
-
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
-
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(UpdateMeshSectionPositionsImmediate, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->UpdateMeshSectionPositionsImmediate(Data->SectionIndex, Data->VertexPositions, Data->UpdateFlags);
-		});
+		DispatchPositionUpdate(InRuntimeMeshComponent, SectionIndex, VertexPositions, nullptr, UpdateFlags);
 	}
 
 	/**
@@ -650,33 +645,7 @@ public:
 	static void UpdateMeshSectionPositionsImmediate(TWeakObjectPtr<URuntimeMeshComponent> InRuntimeMeshComponent, int32 SectionIndex,
 		TArray<FVector>& VertexPositions, const FBox& BoundingBox, ESectionUpdateFlags UpdateFlags = ESectionUpdateFlags::None)
 	{
-		struct FRMCAsyncData
-		{
-			int32 SectionIndex;
-			TArray<FVector> VertexPositions;
-			FBox BoundingBox;
-			ESectionUpdateFlags UpdateFlags;
-		};
-
-		FRMCAsyncData* CallData = new FRMCAsyncData;
-		CallData->SectionIndex = SectionIndex;
-
-		if (!!(UpdateFlags & ESectionUpdateFlags::MoveArrays))
-		{
-			CallData->VertexPositions = MoveTemp(VertexPositions);
-		}
-		else
-		{
-			CallData->VertexPositions = VertexPositions;
-		}
-		
-		CallData->BoundingBox = BoundingBox;
-		CallData->UpdateFlags = UpdateFlags | ESectionUpdateFlags::MoveArrays; // We can always use move arrays here since we either just copied it, or moved it from the original
-
-		RUNTIMEMESHCOMPONENTASYNC_ENQUEUETASK(UpdateMeshSectionPositionsImmediate, FRMCAsyncData, CallData, InRuntimeMeshComponent,
-		{
-			Mesh->UpdateMeshSectionPositionsImmediate(Data->SectionIndex, Data->VertexPositions, Data->BoundingBox, Data->UpdateFlags);
-		});
+		DispatchPositionUpdate(InRuntimeMeshComponent, SectionIndex, VertexPositions, &BoundingBox, UpdateFlags);
 	}
 
 
@@ -0,0 +1,113 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#pragma once
+
+#include "Engine.h"
+
+/**
+*	Bounding volume hierarchy over a triangle soup, built with a binned surface area heuristic.
+*	Rays can be traced one at a time or as packets of four sharing an origin, in which case the
+*	box and triangle tests run on all four rays at once in vector registers.
+*	Besides occlusion the tree answers closest hit rays, sphere sweeps and box overlaps, and can be
+*	refit in place when the triangles move without changing topology.
+*	Queries only read the tree and can run side by side on any thread, but Refit writes the tree they read,
+*	so nothing may query it while it runs.
+*/
+class RUNTIMEMESHCOMPONENT_API FRuntimeMeshBVH
+{
+public:
+	/** Triangles per leaf the build stops splitting at */
+	static const int32 MaxLeafTriangles = 4;
+
+	/** Closest hit of a ray or sweep */
+	struct FHit
+	{
+		FHit() : TriangleIndex(INDEX_NONE), Distance(0.0f), U(0.0f), V(0.0f) { }
+
+		/** Index into the triangles passed to AddTriangles */
+		int32 TriangleIndex;
+		/** Distance along the ray, for sweeps the distance the sphere center traveled */
+		float Distance;
+		/** Barycentric weights of the second and third vertex at the hit, for sweeps at the contact point */
+		float U;
+		float V;
+	};
+
+	FRuntimeMeshBVH() : NumInputTriangles(0) { }
+
+	/** Adds triangles, the indices are relative to the positions passed in the same call */
+	void AddTriangles(const TArray<FVector>& Positions, const TArray<int32>& Indices);
+
+	/** Builds the tree over every triangle added so far */
+	void Build();
+
+	/**
+	*	Moves the triangles without rebuilding, the node bounds are recomputed bottom up.
+	*	The tree keeps its structure so queries get slower the further the triangles move from where they were built.
+	*	@param GetTriangle		Returns the new corners of a triangle by its index into the triangles passed to AddTriangles
+	*/
+	void Refit(TFunctionRef<void(int32 TriangleIndex, FVector& OutV0, FVector& OutV1, FVector& OutV2)> GetTriangle);
+
+	void Reset();
+
+	bool IsEmpty() const { return Nodes.Num() == 0; }
+	int32 GetNumTriangles() const { return Triangles.Num(); }
+	int32 GetNumNodes() const { return Nodes.Num(); }
+	FBox GetBounds() const;
+	SIZE_T GetAllocatedSize() const { return Nodes.GetAllocatedSize() + Triangles.GetAllocatedSize() + TriangleIndices.GetAllocatedSize(); }
+
+	/** Whether anything is hit between MinDistance and MaxDistance along the ray, Direction has to be normalized */
+	bool IsOccluded(const FVector& Origin, const FVector& Direction, float MinDistance, float MaxDistance) const;
+
+	/**
+	*	Occlusion test for four rays from one origin.
+	*	@param Directions		Four normalized directions
+	*	@param ActiveMask		Rays to trace, bit i for Directions[i]
+	*	@return					Mask of the active rays that are blocked
+	*/
+	uint32 IsOccluded4(const FVector& Origin, const FVector Directions[4], uint32 ActiveMask, float MinDistance, float MaxDistance) const;
+
+	/** Closest triangle along the ray within MaxDistance, both sides count. Direction has to be normalized */
+	bool Raycast(const FVector& Origin, const FVector& Direction, float MaxDistance, FHit& OutHit) const;
+
+	/** First triangle a sphere moving along the ray touches within MaxDistance. Direction has to be normalized */
+	bool SweepSphere(const FVector& Origin, const FVector& Direction, float Radius, float MaxDistance, FHit& OutHit) const;
+
+	/** Appends the triangles that intersect the box, as indices into the triangles passed to AddTriangles */
+	void OverlapBox(const FBox& Box, TArray<int32>& OutTriangles) const;
+
+	/** Separating axis test of a triangle against an axis aligned box */
+	static bool TriangleIntersectsBox(const FVector& V0, const FVector& V1, const FVector& V2, const FVector& Center, const FVector& Extent);
+
+protected:
+	struct FNode
+	{
+		FVector Min;
+		/** First triangle of a leaf, or the first of the two adjacent children */
+		int32 Start;
+		FVector Max;
+		/** Triangles in a leaf, 0 for interior nodes */
+		int32 Count;
+	};
+
+	/** A vertex and the two edges leaving it, the form the ray test needs */
+	struct FTriangle
+	{
+		FVector V0;
+		FVector E1;
+		FVector E2;
+	};
+
+	void Subdivide(int32 NodeIndex, int32 Start, int32 Count, TArray<FBox>& TriangleBounds, TArray<FVector>& Centroids);
+
+	/** Closest hit traversal shared by rays and sweeps, the node boxes are grown by Padding */
+	template<typename TriangleTestType>
+	bool TraceClosest(const FVector& Origin, const FVector& Direction, float Padding, float MaxDistance, FHit& OutHit, TriangleTestType TriangleTest) const;
+
+	TArray<FNode> Nodes;
+	TArray<FTriangle> Triangles;
+	/** Index into the triangles passed to AddTriangles, in tree order */
+	TArray<int32> TriangleIndices;
+	/** Triangles passed to AddTriangles, including the invalid ones that were skipped */
+	int32 NumInputTriangles;
+};
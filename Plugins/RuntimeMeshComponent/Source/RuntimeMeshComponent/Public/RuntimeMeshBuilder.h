@@ -71,6 +71,111 @@ public:
 	virtual FColor GetColor(int32 VertexIndex) const = 0;
 	virtual FVector2D GetUV(int32 VertexIndex, int32 Index) const = 0;
 
+	/** 
+	*	Bulk accessors, copy Count vertices starting at StartIndex to or from contiguous arrays.
+	*	Getters fill in the same defaults as the single vertex getters for components the builder doesn't have.
+	*	Setters grow the builder to StartIndex + Count like MoveNextOrAdd does.
+	*	The defaults go through the single vertex accessors, the builders override them with loops over their own storage.
+	*/
+	virtual void GetPositionRange(int32 StartIndex, int32 Count, FVector* OutPositions) const
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			OutPositions[Index] = GetPosition(StartIndex + Index);
+		}
+	}
+	virtual void GetNormalRange(int32 StartIndex, int32 Count, FVector4* OutNormals) const
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			OutNormals[Index] = GetNormal(StartIndex + Index);
+		}
+	}
+	virtual void GetTangentRange(int32 StartIndex, int32 Count, FVector* OutTangents) const
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			OutTangents[Index] = GetTangent(StartIndex + Index);
+		}
+	}
+	virtual void GetColorRange(int32 StartIndex, int32 Count, FColor* OutColors) const
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			OutColors[Index] = GetColor(StartIndex + Index);
+		}
+	}
+	virtual void GetUVRange(int32 UVIndex, int32 StartIndex, int32 Count, FVector2D* OutUVs) const
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			OutUVs[Index] = GetUV(StartIndex + Index, UVIndex);
+		}
+	}
+
+	virtual void SetPositionRange(int32 StartIndex, int32 Count, const FVector* InPositions)
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			SetPosition(StartIndex + Index, InPositions[Index]);
+		}
+	}
+	virtual void SetNormalRange(int32 StartIndex, int32 Count, const FVector4* InNormals)
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			SetNormal(StartIndex + Index, InNormals[Index]);
+		}
+	}
+	virtual void SetTangentRange(int32 StartIndex, int32 Count, const FVector* InTangents)
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			SetTangent(StartIndex + Index, InTangents[Index]);
+		}
+	}
+	virtual void SetColorRange(int32 StartIndex, int32 Count, const FColor* InColors)
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			SetColor(StartIndex + Index, InColors[Index]);
+		}
+	}
+	virtual void SetUVRange(int32 UVIndex, int32 StartIndex, int32 Count, const FVector2D* InUVs)
+	{
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			SetUV(StartIndex + Index, UVIndex, InUVs[Index]);
+		}
+	}
+
+	/** Copies a whole component into an array sized to the builder */
+	void CopyPositions(TArray<FVector>& OutPositions) const
+	{
+		OutPositions.SetNumUninitialized(Length());
+		GetPositionRange(0, OutPositions.Num(), OutPositions.GetData());
+	}
+	void CopyNormals(TArray<FVector4>& OutNormals) const
+	{
+		OutNormals.SetNumUninitialized(Length());
+		GetNormalRange(0, OutNormals.Num(), OutNormals.GetData());
+	}
+	void CopyTangents(TArray<FVector>& OutTangents) const
+	{
+		OutTangents.SetNumUninitialized(Length());
+		GetTangentRange(0, OutTangents.Num(), OutTangents.GetData());
+	}
+	void CopyColors(TArray<FColor>& OutColors) const
+	{
+		OutColors.SetNumUninitialized(Length());
+		GetColorRange(0, OutColors.Num(), OutColors.GetData());
+	}
+	void CopyUVs(int32 UVIndex, TArray<FVector2D>& OutUVs) const
+	{
+		OutUVs.SetNumUninitialized(Length());
+		GetUVRange(UVIndex, 0, OutUVs.Num(), OutUVs.GetData());
+	}
+
 	virtual int32 Length() const = 0;
 	virtual void Seek(int32 Position) const = 0;
 	void SeekEnd() const
@@ -342,6 +447,125 @@ public:
 		return FVector2D::ZeroVector;
 	}
 
+	virtual void GetPositionRange(int32 StartIndex, int32 Count, FVector* OutPositions) const override
+	{
+		check(StartIndex >= 0 && StartIndex + Count <= Vertices->Num());
+		if (Positions)
+		{
+			FMemory::Memcpy(OutPositions, Positions->GetData() + StartIndex, Count * sizeof(FVector));
+			return;
+		}
+
+		const VertexType* Source = Vertices->GetData() + StartIndex;
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			OutPositions[Index] = GetPositionInternal<VertexType>(Source[Index]);
+		}
+	}
+	virtual void GetNormalRange(int32 StartIndex, int32 Count, FVector4* OutNormals) const override
+	{
+		check(StartIndex >= 0 && StartIndex + Count <= Vertices->Num());
+		const VertexType* Source = Vertices->GetData() + StartIndex;
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			OutNormals[Index] = GetNormalInternal<VertexType>(Source[Index]);
+		}
+	}
+	virtual void GetTangentRange(int32 StartIndex, int32 Count, FVector* OutTangents) const override
+	{
+		check(StartIndex >= 0 && StartIndex + Count <= Vertices->Num());
+		const VertexType* Source = Vertices->GetData() + StartIndex;
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			OutTangents[Index] = GetTangentInternal<VertexType>(Source[Index]);
+		}
+	}
+	virtual void GetColorRange(int32 StartIndex, int32 Count, FColor* OutColors) const override
+	{
+		check(StartIndex >= 0 && StartIndex + Count <= Vertices->Num());
+		const VertexType* Source = Vertices->GetData() + StartIndex;
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			OutColors[Index] = GetColorInternal<VertexType>(Source[Index]);
+		}
+	}
+	virtual void GetUVRange(int32 UVIndex, int32 StartIndex, int32 Count, FVector2D* OutUVs) const override
+	{
+		check(StartIndex >= 0 && StartIndex + Count <= Vertices->Num());
+		const VertexType* Source = Vertices->GetData() + StartIndex;
+		switch (UVIndex)
+		{
+		case 0: for (int32 Index = 0; Index < Count; Index++) { OutUVs[Index] = GetUV0Internal<VertexType>(Source[Index]); } return;
+		case 1: for (int32 Index = 0; Index < Count; Index++) { OutUVs[Index] = GetUV1Internal<VertexType>(Source[Index]); } return;
+		case 2: for (int32 Index = 0; Index < Count; Index++) { OutUVs[Index] = GetUV2Internal<VertexType>(Source[Index]); } return;
+		case 3: for (int32 Index = 0; Index < Count; Index++) { OutUVs[Index] = GetUV3Internal<VertexType>(Source[Index]); } return;
+		case 4: for (int32 Index = 0; Index < Count; Index++) { OutUVs[Index] = GetUV4Internal<VertexType>(Source[Index]); } return;
+		case 5: for (int32 Index = 0; Index < Count; Index++) { OutUVs[Index] = GetUV5Internal<VertexType>(Source[Index]); } return;
+		case 6: for (int32 Index = 0; Index < Count; Index++) { OutUVs[Index] = GetUV6Internal<VertexType>(Source[Index]); } return;
+		case 7: for (int32 Index = 0; Index < Count; Index++) { OutUVs[Index] = GetUV7Internal<VertexType>(Source[Index]); } return;
+		}
+		FMemory::Memzero(OutUVs, Count * sizeof(FVector2D));
+	}
+
+	virtual void SetPositionRange(int32 StartIndex, int32 Count, const FVector* InPositions) override
+	{
+		GrowTo(StartIndex + Count);
+		if (Positions)
+		{
+			FMemory::Memcpy(Positions->GetData() + StartIndex, InPositions, Count * sizeof(FVector));
+			return;
+		}
+
+		VertexType* Target = Vertices->GetData() + StartIndex;
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			SetPositionInternal<VertexType>(Target[Index], InPositions[Index]);
+		}
+	}
+	virtual void SetNormalRange(int32 StartIndex, int32 Count, const FVector4* InNormals) override
+	{
+		GrowTo(StartIndex + Count);
+		VertexType* Target = Vertices->GetData() + StartIndex;
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			SetNormalInternal<VertexType>(Target[Index], InNormals[Index]);
+		}
+	}
+	virtual void SetTangentRange(int32 StartIndex, int32 Count, const FVector* InTangents) override
+	{
+		GrowTo(StartIndex + Count);
+		VertexType* Target = Vertices->GetData() + StartIndex;
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			SetTangentInternal<VertexType>(Target[Index], InTangents[Index]);
+		}
+	}
+	virtual void SetColorRange(int32 StartIndex, int32 Count, const FColor* InColors) override
+	{
+		GrowTo(StartIndex + Count);
+		VertexType* Target = Vertices->GetData() + StartIndex;
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			SetColorInternal<VertexType>(Target[Index], InColors[Index]);
+		}
+	}
+	virtual void SetUVRange(int32 UVIndex, int32 StartIndex, int32 Count, const FVector2D* InUVs) override
+	{
+		GrowTo(StartIndex + Count);
+		VertexType* Target = Vertices->GetData() + StartIndex;
+		switch (UVIndex)
+		{
+		case 0: for (int32 Index = 0; Index < Count; Index++) { SetUV0Internal<VertexType>(Target[Index], InUVs[Index]); } return;
+		case 1: for (int32 Index = 0; Index < Count; Index++) { SetUV1Internal<VertexType>(Target[Index], InUVs[Index]); } return;
+		case 2: for (int32 Index = 0; Index < Count; Index++) { SetUV2Internal<VertexType>(Target[Index], InUVs[Index]); } return;
+		case 3: for (int32 Index = 0; Index < Count; Index++) { SetUV3Internal<VertexType>(Target[Index], InUVs[Index]); } return;
+		case 4: for (int32 Index = 0; Index < Count; Index++) { SetUV4Internal<VertexType>(Target[Index], InUVs[Index]); } return;
+		case 5: for (int32 Index = 0; Index < Count; Index++) { SetUV5Internal<VertexType>(Target[Index], InUVs[Index]); } return;
+		case 6: for (int32 Index = 0; Index < Count; Index++) { SetUV6Internal<VertexType>(Target[Index], InUVs[Index]); } return;
+		case 7: for (int32 Index = 0; Index < Count; Index++) { SetUV7Internal<VertexType>(Target[Index], InUVs[Index]); } return;
+		}
+	}
+
 	virtual int32 Length() const override { return Vertices->Num(); }
 	virtual void Seek(int32 Position) const override 
 	{ 
@@ -406,6 +630,18 @@ public:
 	}
 
 private:
+	void GrowTo(int32 NewNum)
+	{
+		if (NewNum > Vertices->Num())
+		{
+			Vertices->SetNumZeroed(NewNum, false);
+			if (Positions)
+			{
+				Positions->SetNumZeroed(NewNum, false);
+			}
+		}
+	}
+
 	template<typename Type>
 	FORCEINLINE static typename TEnableIf<FRuntimeMeshVertexTraits<Type>::HasPosition>::Type SetPositionInternal(Type& Vertex, const FVector& Position)
 	{
@@ -835,6 +1071,107 @@ public:
 	}
 
 
+	virtual void GetPositionRange(int32 StartIndex, int32 Count, FVector* OutPositions) const override
+	{
+		check(Positions && StartIndex >= 0 && StartIndex + Count <= Positions->Num());
+		FMemory::Memcpy(OutPositions, Positions->GetData() + StartIndex, Count * sizeof(FVector));
+	}
+	virtual void GetNormalRange(int32 StartIndex, int32 Count, FVector4* OutNormals) const override
+	{
+		check(Normals && StartIndex >= 0 && StartIndex + Count <= Normals->Num());
+		const FVector* SourceNormals = Normals->GetData() + StartIndex;
+		const int32 NumSigns = Tangents ? FMath::Clamp(Tangents->Num() - StartIndex, 0, Count) : 0;
+		for (int32 Index = 0; Index < NumSigns; Index++)
+		{
+			OutNormals[Index] = FVector4(SourceNormals[Index], (*Tangents)[StartIndex + Index].bFlipTangentY ? -1.0f : 1.0f);
+		}
+		for (int32 Index = NumSigns; Index < Count; Index++)
+		{
+			OutNormals[Index] = FVector4(SourceNormals[Index], 1.0f);
+		}
+	}
+	virtual void GetTangentRange(int32 StartIndex, int32 Count, FVector* OutTangents) const override
+	{
+		check(Tangents && StartIndex >= 0 && StartIndex + Count <= Tangents->Num());
+		const FRuntimeMeshTangent* SourceTangents = Tangents->GetData() + StartIndex;
+		for (int32 Index = 0; Index < Count; Index++)
+		{
+			OutTangents[Index] = SourceTangents[Index].TangentX;
+		}
+	}
+	virtual void GetColorRange(int32 StartIndex, int32 Count, FColor* OutColors) const override
+	{
+		check(Colors && StartIndex >= 0 && StartIndex + Count <= Colors->Num());
+		FMemory::Memcpy(OutColors, Colors->GetData() + StartIndex, Count * sizeof(FColor));
+	}
+	virtual void GetUVRange(int32 UVIndex, int32 StartIndex, int32 Count, FVector2D* OutUVs) const override
+	{
+		const TArray<FVector2D>* UVs = GetUVArray(UVIndex);
+		if (UVs == nullptr)
+		{
+			FMemory::Memzero(OutUVs, Count * sizeof(FVector2D));
+			return;
+		}
+		check(StartIndex >= 0 && StartIndex + Count <= UVs->Num());
+		FMemory::Memcpy(OutUVs, UVs->GetData() + StartIndex, Count * sizeof(FVector2D));
+	}
+
+	virtual void SetPositionRange(int32 StartIndex, int32 Count, const FVector* InPositions) override
+	{
+		GrowTo(*Positions, StartIndex + Count);
+		FMemory::Memcpy(Positions->GetData() + StartIndex, InPositions, Count * sizeof(FVector));
+	}
+	virtual void SetNormalRange(int32 StartIndex, int32 Count, const FVector4* InNormals) override
+	{
+		if (Normals)
+		{
+			GrowTo(*Normals, StartIndex + Count);
+			FVector* TargetNormals = Normals->GetData() + StartIndex;
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				TargetNormals[Index] = InNormals[Index];
+			}
+
+			if (Tangents)
+			{
+				GrowTo(*Tangents, StartIndex + Count);
+				FRuntimeMeshTangent* TargetTangents = Tangents->GetData() + StartIndex;
+				for (int32 Index = 0; Index < Count; Index++)
+				{
+					TargetTangents[Index].bFlipTangentY = InNormals[Index].W < 0.0f;
+				}
+			}
+		}
+	}
+	virtual void SetTangentRange(int32 StartIndex, int32 Count, const FVector* InTangents) override
+	{
+		if (Tangents)
+		{
+			GrowTo(*Tangents, StartIndex + Count);
+			FRuntimeMeshTangent* TargetTangents = Tangents->GetData() + StartIndex;
+			for (int32 Index = 0; Index < Count; Index++)
+			{
+				TargetTangents[Index].TangentX = InTangents[Index];
+			}
+		}
+	}
+	virtual void SetColorRange(int32 StartIndex, int32 Count, const FColor* InColors) override
+	{
+		if (Colors)
+		{
+			GrowTo(*Colors, StartIndex + Count);
+			FMemory::Memcpy(Colors->GetData() + StartIndex, InColors, Count * sizeof(FColor));
+		}
+	}
+	virtual void SetUVRange(int32 UVIndex, int32 StartIndex, int32 Count, const FVector2D* InUVs) override
+	{
+		if (TArray<FVector2D>* UVs = GetUVArray(UVIndex))
+		{
+			GrowTo(*UVs, StartIndex + Count);
+			FMemory::Memcpy(UVs->GetData() + StartIndex, InUVs, Count * sizeof(FVector2D));
+		}
+	}
+
 	virtual int32 Length() const override { return Positions->Num(); }
 	virtual void Seek(int32 Position) const override
 	{
@@ -885,6 +1222,29 @@ public:
 
 		return NewBuilder;
 	}
+
+private:
+	TArray<FVector2D>* GetUVArray(int32 UVIndex) const
+	{
+		switch (UVIndex)
+		{
+		case 0:
+			return UV0s;
+		case 1:
+			return UV1s;
+		default:
+			return nullptr;
+		}
+	}
+
+	template<typename Type>
+	static void GrowTo(TArray<Type>& Array, int32 NewNum)
+	{
+		if (NewNum > Array.Num())
+		{
+			Array.SetNumZeroed(NewNum, false);
+		}
+	}
 };
 
 
@@ -8,8 +8,12 @@
 #include "RuntimeMeshGenericVertex.h"
 #include "RuntimeMeshBuilder.h"
 #include "PhysicsEngine/ConvexElem.h"
+#include "Async/Future.h"
 #include "RuntimeMeshComponent.generated.h"
 
+class FRuntimeMeshComponentBVH;
+class FRuntimeMeshOcclusionScene;
+
 // This set of macros is only meant for argument validation as it will return out of whatever scope.
 #if WITH_EDITOR
 #define RMC_CHECKINGAME_LOGINEDITOR(Condition, Message, RetVal) \
@@ -27,7 +31,8 @@
 #define RMC_VALIDATE_CREATIONPARAMETERS(SectionIndex, Vertices, Triangles, RetVal) \
 		RMC_CHECKINGAME_LOGINEDITOR((SectionIndex >= 0), "SectionIndex cannot be negative.", RetVal); \
 		RMC_CHECKINGAME_LOGINEDITOR((Vertices.Num() > 0), "Vertices length must not be 0.", RetVal); \
-		RMC_CHECKINGAME_LOGINEDITOR((Triangles.Num() > 0), "Triangles length must not be 0", RetVal);
+		RMC_CHECKINGAME_LOGINEDITOR((Triangles.Num() > 0), "Triangles length must not be 0", RetVal); \
+		RMC_CHECKINGAME_LOGINEDITOR((Triangles.Num() % 3 == 0), "Triangles length must be a multiple of 3.", RetVal);
 
 #define RMC_VALIDATE_CREATIONPARAMETERS_DUALBUFFER(SectionIndex, Vertices, Triangles, Positions, RetVal) \
 		RMC_VALIDATE_CREATIONPARAMETERS(SectionIndex, Vertices, Triangles, RetVal) \
@@ -117,6 +122,8 @@ private:
 	/* Creates a mesh section of an internal type meant for the generic vertex and the old PMC style API */
 	TSharedPtr<FRuntimeMeshSectionInterface> CreateOrResetSectionLegacyType(int32 SectionIndex, int32 NumUVChannels);
 
+	void RestoreEvictedSection(int32 SectionIndex);
+
 	/* Gets the material for a section or the default material if one's not provided. */
 	UMaterialInterface* GetSectionMaterial(int32 Index)
 	{
@@ -126,16 +133,30 @@ private:
 
 
 	/* Finishes creating a section, including entering it for batch updating, or updating the RT directly */
-	void CreateSectionInternal(int32 SectionIndex, ESectionUpdateFlags UpdateFlags);
+	void CreateSectionInternal(int32 SectionIndex, ESectionUpdateFlags UpdateFlags, bool bHasPreparedData = false);
 
 	/* Finishes updating a section, including entering it for batch updating, or updating the RT directly */
-	void UpdateSectionInternal(int32 SectionIndex, bool bHadVertexPositionsUpdate, bool bHadVertexUpdates, bool bHadIndexUpdates, bool bNeedsBoundsUpdate, ESectionUpdateFlags UpdateFlags);
+	void UpdateSectionInternal(int32 SectionIndex, bool bHadVertexPositionsUpdate, bool bHadVertexUpdates, bool bHadIndexUpdates, bool bNeedsBoundsUpdate, ESectionUpdateFlags UpdateFlags, bool bHasPreparedData = false);
 
 	/* Finishes updating a sections positions (Only used if section is dual vertex buffer), including entering it for batch updating, or updating the RT directly */
-	void UpdateSectionVertexPositionsInternal(int32 SectionIndex, bool bNeedsBoundsUpdate);
+	void UpdateSectionVertexPositionsInternal(int32 SectionIndex, bool bNeedsBoundsUpdate, bool bHasPreparedData = false);
 
 	/* Finishes updating a sections properties, like visible/casts shadow, a*/
 	void UpdateSectionPropertiesInternal(int32 SectionIndex, bool bUpdateRequiresProxyRecreateIfStatic);
+
+	/* Installs a section whose derived data was already built on a worker. Does no per vertex work on the game thread. */
+	void CommitPreparedSection(int32 SectionIndex, const RuntimeMeshSectionPtr& PreparedSection, ESectionUpdateFlags UpdateFlags);
+
+	/* 
+	*	Hands an async update the section it will replace, before it goes to a worker which fills in the buffers the update
+	*	doesn't bring. Does no copying. Returns false when the update can't apply to the section.
+	*	Synchronous calls must not change the section until the update is committed.
+	*/
+	bool MatchPreparedSectionLayout(int32 SectionIndex, const RuntimeMeshSectionPtr& PreparedSection, ERuntimeMeshSectionBatchUpdateType UpdateType, RuntimeMeshSectionPtr& OutLayoutSource);
+
+	/* Swaps in a section an async update built on a worker from LayoutSource, keeping the existing section properties. */
+	void CommitPreparedSectionUpdate(int32 SectionIndex, const RuntimeMeshSectionPtr& PreparedSection, const RuntimeMeshSectionPtr& LayoutSource,
+		ERuntimeMeshSectionBatchUpdateType UpdateType, ESectionUpdateFlags UpdateFlags);
 	
 	/* Internal log helper for the templates to be able to use the internal logger */
 	static void Log(FString Text, bool bIsError = false)
@@ -319,6 +340,7 @@ public:
 
 		// Validate all update parameters
 		RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 		
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -370,6 +392,7 @@ public:
 		// Validate all update parameters
 		RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
 		RMC_VALIDATE_BOUNDINGBOX(BoundingBox, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -420,6 +443,7 @@ public:
 
 		// Validate all update parameters
 		RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -484,6 +508,7 @@ public:
 		// Validate all update parameters
 		RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
 		RMC_VALIDATE_BOUNDINGBOX(BoundingBox, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -547,6 +572,7 @@ public:
 
 		// Validate all update parameters
 		RMC_VALIDATE_UPDATEPARAMETERS_DUALBUFFER(SectionIndex, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -613,6 +639,7 @@ public:
 		// Validate all update parameters
 		RMC_VALIDATE_UPDATEPARAMETERS_DUALBUFFER(SectionIndex, /*VoidReturn*/);
 		RMC_VALIDATE_BOUNDINGBOX(BoundingBox, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -678,6 +705,7 @@ public:
 
 		// Validate all update parameters
 		RMC_VALIDATE_UPDATEPARAMETERS_DUALBUFFER(SectionIndex, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -757,6 +785,7 @@ public:
 		// Validate all update parameters
 		RMC_VALIDATE_UPDATEPARAMETERS_DUALBUFFER(SectionIndex, /*VoidReturn*/);
 		RMC_VALIDATE_BOUNDINGBOX(BoundingBox, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -864,6 +893,7 @@ public:
 	void BeginMeshSectionUpdate(int32 SectionIndex, TArray<VertexType>*& Vertices)
 	{
 		RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -878,6 +908,7 @@ public:
 	void BeginMeshSectionUpdate(int32 SectionIndex, TArray<VertexType>*& Vertices, TArray<int32>*& Triangles)
 	{
 		RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -893,6 +924,7 @@ public:
 	void BeginMeshSectionUpdate(int32 SectionIndex, TArray<FVector>*& Positions, TArray<VertexType>*& Vertices)
 	{
 		RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -908,6 +940,7 @@ public:
 	void BeginMeshSectionUpdate(int32 SectionIndex, TArray<FVector>*& Positions, TArray<VertexType>*& Vertices, TArray<int32>*& Triangles)
 	{
 		RMC_VALIDATE_UPDATEPARAMETERS(SectionIndex, /*VoidReturn*/);
+		MakeSectionResident(SectionIndex);
 
 		// Validate section type
 		MeshSections[SectionIndex]->GetVertexType()->EnsureEquals<VertexType>();
@@ -929,7 +962,26 @@ public:
 	
 
 	/*
-	*	Gets a readonly pointer to the sections mesh data.
+	*	Brings back the data of a section evicted by the memory budget, RMC.MemoryBudgetMB.
+	*	Anything that reads the section buffers from outside the component, GetSectionMesh() included, calls this first.
+	*	The updates that change the buffers do it themselves.
+	*/
+	void MakeSectionResident(int32 SectionIndex)
+	{
+		if (MeshSections[SectionIndex]->IsEvicted())
+		{
+			RestoreEvictedSection(SectionIndex);
+		}
+	}
+
+	/* Is the data of a section evicted? Readers that can do without it skip the section instead of calling MakeSectionResident() */
+	bool IsSectionEvicted(int32 SectionIndex) const
+	{
+		return MeshSections[SectionIndex]->IsEvicted();
+	}
+
+	/*
+	*	Gets a readonly pointer to the sections mesh data, the section has to be resident. See MakeSectionResident()
 	*	To be able to edit the section data use BegineMeshSectionUpdate()
 	*/
 	void GetSectionMesh(int32 SectionIndex, const IRuntimeMeshVerticesBuilder*& Vertices, const FRuntimeMeshIndicesBuilder*& Indices);
@@ -1198,6 +1250,50 @@ public:
 	void CookCollisionNow();
 
 
+	/**
+	*	Brings the CPU BVH the geometry queries run against up to date with the sections.
+	*	Position only updates refit the existing tree, anything else rebuilds it, on the thread pool when bAsync is set.
+	*	Queries do this on demand, calling it ahead of time keeps the build off the first query.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Components|RuntimeMesh")
+	void UpdateQueryBVH(bool bAsync = true);
+
+	/** Closest triangle between Start and End, in world space. Works on the mesh sections directly and doesn't need collision */
+	UFUNCTION(BlueprintCallable, Category = "Components|RuntimeMesh")
+	bool LineTraceMesh(const FVector& Start, const FVector& End, FRuntimeMeshQueryHit& OutHit);
+
+	/** First triangle a sphere moving from Start to End touches. Under non uniform scale the sphere is grown to cover the scaled one */
+	UFUNCTION(BlueprintCallable, Category = "Components|RuntimeMesh")
+	bool SweepSphereMesh(const FVector& Start, const FVector& End, float Radius, FRuntimeMeshQueryHit& OutHit);
+
+	/** Every triangle that intersects a box, the hits are at the triangle centers */
+	UFUNCTION(BlueprintCallable, Category = "Components|RuntimeMesh")
+	void OverlapBoxMesh(const FVector& Center, const FVector& Extent, const FRotator& Rotation, TArray<FRuntimeMeshQueryHit>& OutHits);
+
+	/** The up to date query BVH in component space, waits for a build running on the thread pool. Game thread only, the next update may refit it in place */
+	const FRuntimeMeshComponentBVH* GetQueryBVH();
+
+
+	/** Memory used by this component, optionally per section. The GPU sizes of the sections are estimated from their data */
+	void GetMemoryUsage(FRuntimeMeshComponentMemory& OutMemory, TArray<FRuntimeMeshSectionMemory>* OutSections = nullptr) const;
+
+	/** Drops the data that is rebuilt on demand, the collision positions kept from the worker preparation and the query BVH. Returns the bytes freed */
+	int64 TrimDerivedData();
+
+	/**
+	*	Compresses the CPU copy of the sections the GPU already has, a section comes back through MakeSectionResident().
+	*	Frequently updated sections and sections restored in the last 30 seconds are left alone. Returns the bytes freed.
+	*/
+	int64 EvictSectionData();
+
+
+	/** Puts the component in a software occlusion scene, use FRuntimeMeshOcclusionScene::AddComponent */
+	void SetOcclusionScene(const TSharedPtr<FRuntimeMeshOcclusionScene, ESPMode::ThreadSafe>& InOcclusionScene, int32 InOcclusionSlot);
+
+	FRuntimeMeshOcclusionScene* GetOcclusionScene() const { return OcclusionScene.Get(); }
+	int32 GetOcclusionSlot() const { return OcclusionSlot; }
+
+
 	/**
 	*	Delegate for when the collision was updated.
 	*/
@@ -1228,6 +1324,13 @@ public:
 	*/
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "RuntimeMesh")
 	bool bShouldSerializeMeshData;
+
+	/**
+	*	Controls whether RMC.MemoryBudgetMB may compress the CPU copy of the mesh sections when over budget.
+	*	Turn it off for components whose sections are read every frame.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "RuntimeMesh")
+	bool bAllowMemoryEviction;
 	
 	/* 
 	*	The current mode of the collision cooker 
@@ -1262,6 +1365,7 @@ private:
 	{
 		return true;
 	}
+	virtual void OnUpdateTransform(EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport = ETeleportType::None) override;
 	//~ Begin USceneComponent Interface.
 
 	//~ Begin UPrimitiveComponent Interface.
@@ -1269,6 +1373,7 @@ private:
 	virtual class UBodySetup* GetBodySetup() override;
 	virtual UMaterialInterface* GetMaterialFromCollisionFaceIndex(int32 FaceIndex, int32& SectionIndex) const override;
 	virtual bool ShouldCreatePhysicsState() const override { return false; };
+	virtual void SendRenderTransform_Concurrent() override;
 	//~ End UPrimitiveComponent Interface.
 
 	//~ Begin UMeshComponent Interface.
@@ -1297,6 +1402,12 @@ private:
 
 	void UpdateNavigation();
 
+	/* Flags the query BVH for a refit or, when more than the positions changed, a rebuild */
+	void MarkQueryBVHDirty(bool bPositionsOnly);
+
+	/* Trace against the query BVH, Radius 0 is a line trace */
+	bool TraceQueryBVH(const FVector& Start, const FVector& End, float Radius, FRuntimeMeshQueryHit& OutHit);
+
 
 	/* Serializes this component */
 	virtual void Serialize(FArchive& Ar) override;
@@ -1339,7 +1450,34 @@ private:
 	UPROPERTY(Transient)
 	TArray<UBodySetup*> AsyncBodySetupQueue;
 
+	/* CPU BVH the geometry queries run against */
+	TSharedPtr<FRuntimeMeshComponentBVH, ESPMode::ThreadSafe> QueryBVH;
+
+	/* Build of the query BVH running on the thread pool */
+	TFuture<TSharedPtr<FRuntimeMeshComponentBVH, ESPMode::ThreadSafe>> PendingQueryBVH;
+
+	/* Do the sections differ from the query BVH in more than their positions? */
+	bool bQueryBVHDirty;
+
+	/* Have section positions moved since the query BVH was built? */
+	bool bQueryBVHNeedsRefit;
+
+	/* Software occlusion scene of an import and the slot of this component in it */
+	TSharedPtr<FRuntimeMeshOcclusionScene, ESPMode::ThreadSafe> OcclusionScene;
+	int32 OcclusionSlot;
+
+	/* RMC.QuantizeStaticSections as it was when the current proxy was created. The proxy's uniform buffer setup and
+	*  every section created for it have to agree, so neither reads the console variable on its own. */
+	bool bQuantizeStaticSections;
+
+	/* Frame the sections of the current proxy are quantized in, covers all sections there were when it was created.
+	*  Sections created later that reach past it are uploaded unquantized until the proxy is recreated. */
+	FRuntimeMeshQuantizationFrame QuantizationFrame;
+
+	const FRuntimeMeshQuantizationFrame* GetQuantizationFrame() const { return bQuantizeStaticSections ? &QuantizationFrame : nullptr; }
+
 
 	friend class FRuntimeMeshSceneProxy;
 	friend struct FRuntimeMeshComponentPrePhysicsTickFunction;
+	friend class FRuntimeMeshAsync;
 };
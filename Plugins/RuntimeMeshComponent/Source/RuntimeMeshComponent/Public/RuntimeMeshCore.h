@@ -199,6 +199,14 @@ enum class ESectionUpdateFlags
 	*	To do this manually see RuntimeMeshLibrary::GenerateTessellationIndexBuffer()
 	*/
 	CalculateTessellationIndices = 0x4,
+
+	/**
+	*	Should the triangles and vertices be reordered for the post transform cache, overdraw and vertex fetch?
+	*	To do this manually see FRuntimeMeshOptimizer
+	*
+	*	CAUTION: This renumbers the vertices, later updates that don't replace the whole section have to supply them in the new order!
+	*/
+	OptimizeMesh = 0x8,
 	
 };
 ENUM_CLASS_FLAGS(ESectionUpdateFlags)
@@ -326,6 +334,59 @@ struct FRuntimeConvexCollisionSection
 	}
 };
 
+/**
+*	Result of a geometry query against the CPU BVH of a RuntimeMeshComponent.
+*	Overlaps don't have a single point of contact, they report the center of each triangle.
+*/
+USTRUCT(BlueprintType)
+struct FRuntimeMeshQueryHit
+{
+	GENERATED_USTRUCT_BODY()
+
+	/** Component that was hit */
+	UPROPERTY(BlueprintReadOnly, Category = "RuntimeMesh")
+	class URuntimeMeshComponent* Component;
+
+	/** Section of the component the triangle belongs to */
+	UPROPERTY(BlueprintReadOnly, Category = "RuntimeMesh")
+	int32 SectionIndex;
+
+	/** Triangle within the section */
+	UPROPERTY(BlueprintReadOnly, Category = "RuntimeMesh")
+	int32 TriangleIndex;
+
+	/** World space distance from the start of the trace */
+	UPROPERTY(BlueprintReadOnly, Category = "RuntimeMesh")
+	float Distance;
+
+	/** World space point of contact */
+	UPROPERTY(BlueprintReadOnly, Category = "RuntimeMesh")
+	FVector Location;
+
+	/** World space normal of the triangle */
+	UPROPERTY(BlueprintReadOnly, Category = "RuntimeMesh")
+	FVector Normal;
+
+	/** Weights of the three triangle corners at the point of contact */
+	UPROPERTY(BlueprintReadOnly, Category = "RuntimeMesh")
+	FVector Barycentrics;
+
+	/** First UV channel interpolated at the point of contact */
+	UPROPERTY(BlueprintReadOnly, Category = "RuntimeMesh")
+	FVector2D UV;
+
+	FRuntimeMeshQueryHit()
+		: Component(nullptr)
+		, SectionIndex(INDEX_NONE)
+		, TriangleIndex(INDEX_NONE)
+		, Distance(0.0f)
+		, Location(ForceInitToZero)
+		, Normal(ForceInitToZero)
+		, Barycentrics(ForceInitToZero)
+		, UV(ForceInitToZero)
+	{}
+};
+
 
 
 
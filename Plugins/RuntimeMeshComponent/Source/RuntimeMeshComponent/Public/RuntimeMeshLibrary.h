@@ -8,6 +8,7 @@
 
 class RuntimeMeshComponent;
 class FEssImporter;
+class FRuntimeMeshOcclusionScene;
 
 UCLASS()
 class RUNTIMEMESHCOMPONENT_API URuntimeMeshLibrary : public UBlueprintFunctionLibrary
@@ -36,6 +37,38 @@ class RUNTIMEMESHCOMPONENT_API URuntimeMeshLibrary : public UBlueprintFunctionLi
 	UFUNCTION(BlueprintCallable, Category = "Components|Elara")
 	static void ImportEss(const FString& filename, bool inEditor = false);
 
+	/**
+	*	Re-imports an ess scene over the one imported before. Nodes are matched to components by their name scoped by their group, only the
+	*	transforms, sections and materials that changed are touched, components of deleted nodes are destroyed.
+	*	Falls back to a full import when no imported scene is in the world.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Components|Elara")
+	static void ReimportEss(const FString& filename, bool inEditor = false);
+
+	/** ReimportEss for files nobody else needs, the file is deleted and OnFinished runs once the import is done with it, whether it succeeded or not */
+	static void ReimportTemporaryEss(const FString& filename, bool inEditor, const FSimpleDelegate& OnFinished = FSimpleDelegate());
+
+	/** Name of the ess mesh an imported component was created from, empty for components that weren't imported from an ess file */
+	static FString GetEssMeshName(const UActorComponent* Component);
+
+	/** Component of a nested ess instance group, the nodes and groups inside it are attached below it */
+	UFUNCTION(BlueprintCallable, Category = "Components|Elara")
+	static USceneComponent* FindEssGroup(AActor* SceneActor, const FString& GroupName);
+
+	/**
+	*	Moves an ess instance group and everything nested in it, only the group and the components below it update.
+	*	In game worlds the group is made movable first.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Components|Elara")
+	static bool SetEssGroupTransform(AActor* SceneActor, const FString& GroupName, const FTransform& WorldTransform);
+
+	/**
+	*	Clusters the components of an imported scene for software occlusion culling and picks the large ones as occluders.
+	*	Imports do this when they finish, moving nodes afterwards turns the culling off until this is called again.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Components|Elara")
+	static void BuildEssOcclusion(AActor* SceneActor);
+
 	/**
 	*	Automatically generate normals and tangent vectors for a mesh
 	*	UVs are required for correct tangent generation.
@@ -128,6 +161,29 @@ class RUNTIMEMESHCOMPONENT_API URuntimeMeshLibrary : public UBlueprintFunctionLi
 	UFUNCTION(BlueprintCallable, Category = "Components|RuntimeMesh")
 	static void CopyRuntimeMeshFromStaticMeshComponent(UStaticMeshComponent* StaticMeshComp, int32 LODIndex, URuntimeMeshComponent* RuntimeMeshComp, bool bShouldCreateCollision);
 
+	/**
+	*	Bakes per vertex ambient occlusion into the vertex colors of the components, they all occlude each other.
+	*	@param	bSkyVisibility	Also store the fraction of the hemisphere open to the sky in the alpha channel
+	*	@return					Rays traced per second
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Components|RuntimeMesh")
+	static float BakeAmbientOcclusion(const TArray<URuntimeMeshComponent*>& Components, int32 NumRays = 64, float MaxDistance = 200.0f, bool bSkyVisibility = false);
+
+	/**
+	*	Closest triangle of any of the components between Start and End, without collision.
+	*	Builds a scene BVH over the components for the call, C++ code tracing repeatedly should keep an FRuntimeMeshSceneBVH instead.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Components|RuntimeMesh")
+	static bool LineTraceRuntimeMeshes(const TArray<URuntimeMeshComponent*>& Components, const FVector& Start, const FVector& End, FRuntimeMeshQueryHit& OutHit);
+
+	/** First triangle of any of the components a sphere moving from Start to End touches */
+	UFUNCTION(BlueprintCallable, Category = "Components|RuntimeMesh")
+	static bool SweepSphereRuntimeMeshes(const TArray<URuntimeMeshComponent*>& Components, const FVector& Start, const FVector& End, float Radius, FRuntimeMeshQueryHit& OutHit);
+
+	/** Every triangle of the components that intersects a box */
+	UFUNCTION(BlueprintCallable, Category = "Components|RuntimeMesh")
+	static void OverlapBoxRuntimeMeshes(const TArray<URuntimeMeshComponent*>& Components, const FVector& Center, const FVector& Extent, const FRotator& Rotation, TArray<FRuntimeMeshQueryHit>& OutHits);
+
 private:
 	FEssImporter* mpEssImporter;
 	FTimerDelegate OnComplete;
@@ -135,8 +191,40 @@ private:
 	int32 mLastNodeIndex;
 	AActor* mCurrentActor;
 	FTimerHandle mTimerHandle;
+	/** Scene components of the instance groups, in the order of the importer's groups */
+	TArray<USceneComponent*> mGroupComponents;
+	/** Progressive imports: the component of every node, whether it has its real geometry yet and the nodes waiting for either */
+	TArray<URuntimeMeshComponent*> mNodeComponents;
+	TBitArray<> mNodeBuilt;
+	TMultiMap<FString, int32> mMeshNodes;
+	TArray<int32> mPlaceholderQueue;
+	TArray<int32> mGeometryQueue;
+	int32 mPlaceholderCursor;
+	int32 mGeometryCursor;
+	double mFirstPixelSeconds;
+	double mFirstGeometrySeconds;
+	/** Occlusion scene of the import, components join it as they are created so their proxies skip the hardware queries */
+	TSharedPtr<FRuntimeMeshOcclusionScene, ESPMode::ThreadSafe> mOcclusionScene;
+	bool mbParseDone;
 	bool mbInEditor;
+	bool mbReimport;
+	/** File of a temporary import, deleted once parsed */
+	FString mTemporaryFile;
+	FSimpleDelegate mOnTemporaryImportFinished;
 	void DoImportEss(const FString& filename, bool inEditor);
 	void OnEssParseFinished();
 	void DoImportMesh();
+	void DoReimport();
+	void DoProgressiveImport();
+	void BeginProgressiveImport();
+	void FinishImport();
+	void DeleteTemporaryFile();
+	void SpawnRootActor();
+	UWorld* GetImportWorld() const;
+	bool GetImportViewLocation(FVector& outLocation) const;
+	URuntimeMeshComponent* CreateNodeComponent(int nodeIndex, USceneComponent* RootComponent, bool bPlaceholder = false);
+	void BuildPlaceholderSection(URuntimeMeshComponent* runtimeMesh, int nodeIndex);
+	USceneComponent* CreateGroupComponent(int groupIndex, USceneComponent* RootComponent);
+	USceneComponent* GetGroupParent(int groupIndex, USceneComponent* RootComponent) const;
+	void BuildNodeSections(URuntimeMeshComponent* runtimeMesh, int nodeIndex, bool bGeometry, bool bMaterials);
 };
\ No newline at end of file
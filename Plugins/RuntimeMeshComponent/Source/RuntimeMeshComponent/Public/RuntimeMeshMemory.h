@@ -0,0 +1,112 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#pragma once
+
+#include "Engine.h"
+
+class URuntimeMeshComponent;
+
+/** Memory of one mesh section. GPU sizes are those of the buffers the section uploads in its current state. */
+struct FRuntimeMeshSectionMemory
+{
+	FRuntimeMeshSectionMemory() : SectionIndex(INDEX_NONE), CPUBytes(0), EvictedBytes(0), VertexBufferBytes(0), IndexBufferBytes(0) { }
+
+	int32 SectionIndex;
+	/** Vertex, position and index arrays and the collision positions extracted for the cooker */
+	int64 CPUBytes;
+	/** Compressed copy kept while the section is evicted, CPUBytes is 0 then */
+	int64 EvictedBytes;
+	int64 VertexBufferBytes;
+	int64 IndexBufferBytes;
+
+	bool IsEvicted() const { return EvictedBytes > 0; }
+};
+
+/** Memory of a RuntimeMeshComponent, or the sum over several */
+struct FRuntimeMeshComponentMemory
+{
+	FRuntimeMeshComponentMemory() : NumSections(0), NumEvictedSections(0), SectionCPUBytes(0), EvictedBytes(0), VertexBufferBytes(0), IndexBufferBytes(0), CollisionBytes(0), QueryBytes(0) { }
+
+	int32 NumSections;
+	int32 NumEvictedSections;
+	int64 SectionCPUBytes;
+	int64 EvictedBytes;
+	int64 VertexBufferBytes;
+	int64 IndexBufferBytes;
+	/** Body setup with its cooked meshes and the collision only sections */
+	int64 CollisionBytes;
+	/** CPU BVH of the geometry queries */
+	int64 QueryBytes;
+
+	int64 GetCPUBytes() const { return SectionCPUBytes + EvictedBytes + CollisionBytes + QueryBytes; }
+	int64 GetGPUBytes() const { return VertexBufferBytes + IndexBufferBytes; }
+
+	void AddSection(const FRuntimeMeshSectionMemory& Section)
+	{
+		NumSections++;
+		NumEvictedSections += Section.IsEvicted() ? 1 : 0;
+		SectionCPUBytes += Section.CPUBytes;
+		EvictedBytes += Section.EvictedBytes;
+		VertexBufferBytes += Section.VertexBufferBytes;
+		IndexBufferBytes += Section.IndexBufferBytes;
+	}
+
+	FRuntimeMeshComponentMemory& operator+=(const FRuntimeMeshComponentMemory& Other)
+	{
+		NumSections += Other.NumSections;
+		NumEvictedSections += Other.NumEvictedSections;
+		SectionCPUBytes += Other.SectionCPUBytes;
+		EvictedBytes += Other.EvictedBytes;
+		VertexBufferBytes += Other.VertexBufferBytes;
+		IndexBufferBytes += Other.IndexBufferBytes;
+		CollisionBytes += Other.CollisionBytes;
+		QueryBytes += Other.QueryBytes;
+		return *this;
+	}
+};
+
+/** Compressed CPU copy of an evicted section along with the GPU sizes it had, the section object itself keeps its bounds and properties */
+struct FRuntimeMeshEvictedSection
+{
+	FRuntimeMeshEvictedSection() : UncompressedSize(0), NumIndices(0), VertexBufferBytes(0), IndexBufferBytes(0) { }
+
+	TArray<uint8> CompressedData;
+	int32 UncompressedSize;
+	/** Length of the index buffer, the collision face indices are counted from it */
+	int32 NumIndices;
+	int64 VertexBufferBytes;
+	int64 IndexBufferBytes;
+};
+
+/**
+*	Global accounting of the memory used by RuntimeMeshComponents, reported by RMC.MemoryReport and in stat RuntimeMesh.
+*	With RMC.MemoryBudgetMB set, the CPU side is kept under the budget once a second by dropping data that is rebuilt
+*	on demand and then evicting the section data of the components farthest from the view.
+*/
+class RUNTIMEMESHCOMPONENT_API FRuntimeMeshMemoryTracker
+{
+public:
+	/** Tracks the RHI buffers of section proxies as they are created and released, called on the render thread */
+	static void TrackVertexBuffer(int64 DeltaBytes);
+	static void TrackIndexBuffer(int64 DeltaBytes);
+
+	/** Counts a texture created by the ess importer for as long as it is alive */
+	static void AddTexture(UTexture2D* Texture);
+
+	/** Bytes of the RHI buffers alive right now, exact unlike the per section sizes */
+	static int64 GetVertexBufferBytes();
+	static int64 GetIndexBufferBytes();
+	static int64 GetTextureBytes();
+
+	/** Sums the memory of every live component and refreshes the memory stats, optionally listing the components */
+	static FRuntimeMeshComponentMemory GatherMemory(TArray<TPair<URuntimeMeshComponent*, FRuntimeMeshComponentMemory>>* OutComponents = nullptr);
+
+	/** Brings the CPU memory of the components in game worlds under BudgetBytes as far as possible, returns the bytes freed */
+	static int64 EnforceBudget(int64 BudgetBytes);
+
+	static void LogReport(bool bIncludeSections);
+
+	/** Creates and destroys the ticker enforcing RMC.MemoryBudgetMB, called by the module */
+	static void Startup();
+	static void Shutdown();
+};
@@ -0,0 +1,241 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#pragma once
+
+#include "Engine.h"
+
+class URuntimeMeshComponent;
+class FSceneView;
+class FSceneViewStateInterface;
+
+/** What a visibility pass did, the culling rate is the culled clusters over NumClusters */
+struct FRuntimeMeshOcclusionStats
+{
+	FRuntimeMeshOcclusionStats() : NumOccluders(0), NumOccluderTriangles(0), NumNodesTested(0), NumClusters(0), NumClustersOccluded(0), NumClustersOutsideView(0) { }
+
+	/** Occluders large enough on screen to be rasterized and the triangles they drew */
+	int32 NumOccluders;
+	int32 NumOccluderTriangles;
+	/** Boxes of the hierarchy tested against the depth buffer, clusters included */
+	int32 NumNodesTested;
+	int32 NumClusters;
+	int32 NumClustersOccluded;
+	int32 NumClustersOutsideView;
+
+	int32 GetNumClustersCulled() const { return NumClustersOccluded + NumClustersOutsideView; }
+};
+
+/**
+*	Low resolution depth buffer rasterized on the CPU, four pixels at a time.
+*	Depths are z/w of a reversed Z projection like the engine's, so larger is closer and a cleared buffer is at the far plane.
+*	Triangles only write the pixels they cover entirely, at the farthest depth they have in them, so the buffer never hides
+*	more than the occluders. They are clipped against the near plane and drawn from both sides.
+*/
+class RUNTIMEMESHCOMPONENT_API FRuntimeMeshDepthBuffer
+{
+public:
+	enum class EBoxVisibility : uint8
+	{
+		Visible,
+		Occluded,
+		OutsideView,
+	};
+
+	FRuntimeMeshDepthBuffer() : Width(0), Height(0) { }
+
+	/** Width is rounded up to a multiple of four, the buffer is cleared */
+	void Init(int32 InWidth, int32 InHeight);
+	void Clear();
+
+	/** Rasterizes a world space mesh, indices are into Positions. Returns the triangles that reached the buffer */
+	int32 RasterizeMesh(const FMatrix& WorldToClip, const FVector* Positions, int32 NumPositions, const int32* Indices, int32 NumIndices);
+
+	/** Tests a world space box against the buffer, boxes crossing the near plane are always visible */
+	EBoxVisibility TestBox(const FMatrix& WorldToClip, const FBox& Box) const;
+	bool IsBoxVisible(const FMatrix& WorldToClip, const FBox& Box) const { return TestBox(WorldToClip, Box) == EBoxVisibility::Visible; }
+
+	/**
+	*	Screen rectangle in pixels and the closest depth of a world space box.
+	*	False when the box crosses the near plane, the rectangle isn't clamped to the buffer.
+	*/
+	bool ProjectBox(const FMatrix& WorldToClip, const FBox& Box, FVector2D& OutMin, FVector2D& OutMax, float& OutMaxDepth) const;
+
+	int32 GetWidth() const { return Width; }
+	int32 GetHeight() const { return Height; }
+	float GetDepth(int32 X, int32 Y) const { return Depth[Y * Width + X]; }
+	SIZE_T GetAllocatedSize() const { return Depth.GetAllocatedSize() + ClipPositions.GetAllocatedSize(); }
+
+private:
+	/** Screen space triangle, X and Y in pixels and Z the depth */
+	void RasterizeTriangle(const FVector& V0, const FVector& V1, const FVector& V2);
+
+	/** Clips a clip space triangle against the near plane and rasterizes what is left */
+	int32 ClipAndRasterizeTriangle(const FVector4& C0, const FVector4& C1, const FVector4& C2);
+
+	FVector ToScreen(const FVector4& Clip) const;
+
+	TArray<float> Depth;
+	/** Scratch for the transformed vertices of the mesh being rasterized */
+	TArray<FVector4> ClipPositions;
+	int32 Width;
+	int32 Height;
+};
+
+/**
+*	Clusters of nearby items under a bounds hierarchy and the meshes of the occluders among them, all in world space.
+*	Plain CPU data, building it and computing visibility need neither UObjects nor a GPU.
+*/
+class RUNTIMEMESHCOMPONENT_API FRuntimeMeshOcclusionData
+{
+public:
+	FRuntimeMeshOcclusionData() : NumClusters(0) { }
+
+	/** Adds the triangles of an occluder, indices are into its own positions */
+	void AddOccluder(const TArray<FVector>& Positions, const TArray<int32>& Indices);
+
+	/**
+	*	Groups the items into clusters of up to MaxItemsPerCluster by a median split of their centers.
+	*	Items with invalid bounds get no cluster and are never culled.
+	*/
+	void BuildClusters(const TArray<FBox>& ItemBounds, int32 MaxItemsPerCluster);
+
+	/** Items that move have no cluster, each is tested on its own with the bounds it has when it is drawn */
+	void SetMovableItems(const TBitArray<>& InMovableItems) { MovableItems = InMovableItems; }
+	bool IsItemMovable(int32 ItemIndex) const { return ItemIndex >= 0 && ItemIndex < MovableItems.Num() && MovableItems[ItemIndex]; }
+
+	/**
+	*	Rasterizes the occluders covering at least MinOccluderPixels and tests the hierarchy against them.
+	*	A bit of OutVisibleClusters is set for every cluster that may be visible.
+	*/
+	void ComputeVisibility(const FMatrix& WorldToClip, float MinOccluderPixels, FRuntimeMeshDepthBuffer& DepthBuffer, TBitArray<>& OutVisibleClusters, FRuntimeMeshOcclusionStats& OutStats) const;
+
+	int32 GetItemCluster(int32 ItemIndex) const { return ItemClusters.IsValidIndex(ItemIndex) ? ItemClusters[ItemIndex] : INDEX_NONE; }
+	int32 GetNumClusters() const { return NumClusters; }
+	int32 GetNumOccluders() const { return Occluders.Num(); }
+	int32 GetNumOccluderTriangles() const { return OccluderIndices.Num() / 3; }
+	SIZE_T GetAllocatedSize() const
+	{
+		return Nodes.GetAllocatedSize() + ItemClusters.GetAllocatedSize() + MovableItems.GetAllocatedSize() + Occluders.GetAllocatedSize() +
+			OccluderPositions.GetAllocatedSize() + OccluderIndices.GetAllocatedSize();
+	}
+
+private:
+	struct FNode
+	{
+		FBox Bounds;
+		/** First of the two adjacent children, INDEX_NONE for a leaf */
+		int32 FirstChild;
+		/** Clusters below the node are consecutive, a leaf is one cluster */
+		int32 FirstCluster;
+		int32 NumClusters;
+	};
+
+	struct FItemEntry
+	{
+		int32 ItemIndex;
+		FBox Bounds;
+	};
+
+	struct FOccluder
+	{
+		FBox Bounds;
+		int32 FirstVertex;
+		int32 NumVertices;
+		int32 FirstIndex;
+		int32 NumIndices;
+	};
+
+	void Subdivide(TArray<FItemEntry>& Entries, int32 NodeIndex, int32 Start, int32 Count, int32 MaxItemsPerCluster);
+
+	TArray<FNode> Nodes;
+	TArray<int32> ItemClusters;
+	TBitArray<> MovableItems;
+	int32 NumClusters;
+	TArray<FOccluder> Occluders;
+	TArray<FVector> OccluderPositions;
+	TArray<int32> OccluderIndices;
+};
+
+typedef TSharedPtr<const FRuntimeMeshOcclusionData, ESPMode::ThreadSafe> FRuntimeMeshOcclusionDataPtr;
+
+class FRuntimeMeshOcclusionScene;
+typedef TSharedPtr<FRuntimeMeshOcclusionScene, ESPMode::ThreadSafe> FRuntimeMeshOcclusionScenePtr;
+
+/**
+*	Software occlusion culling for the components of an imported scene, in place of the engine's per primitive occlusion queries.
+*
+*	Components join before they are registered so their proxies skip the hardware queries (RMC.Occlusion.HardwareQueries),
+*	Build then clusters them and copies the large ones as occluders. Proxies ask for the visibility of their cluster from
+*	GetViewRelevance, the first of them in a frame rasterizes the occluders for that view, so the result is never a frame late.
+*	Movable members are only occludees, they test their own bounds against the depth buffer and change nothing when they move.
+*	Moving another member or changing its mesh turns the culling off, the scene then rebuilds itself on the game thread a moment later.
+*/
+class RUNTIMEMESHCOMPONENT_API FRuntimeMeshOcclusionScene : public TSharedFromThis<FRuntimeMeshOcclusionScene, ESPMode::ThreadSafe>
+{
+public:
+	FRuntimeMeshOcclusionScene() : bHasRenderData(false), bRebuildPending(false) { }
+
+	/** Makes the component a member, a registered one passes the scene on to its proxy. Schedules a Build like Invalidate. Game thread */
+	void AddComponent(URuntimeMeshComponent* Component);
+
+	/** Clusters the members and picks the occluders from them, the render thread switches to the result. Game thread */
+	void Build();
+
+	/** Stops the culling and schedules a Build on the core ticker. Game thread */
+	void Invalidate();
+
+	/** Invalidate for a member that moved or changed, unless the last Build took it as movable. Game thread */
+	void InvalidateMember(int32 Slot);
+
+	/**
+	*	Is a member visible in a view? Movable members test Bounds, the others their cluster. Views without a view state are never culled.
+	*	Called by the proxies on the rendering threads.
+	*/
+	bool IsVisible(int32 Slot, const FSceneView& View, const FBox& Bounds);
+
+	void SetRenderData_RenderThread(const FRuntimeMeshOcclusionDataPtr& InRenderData);
+
+	int32 GetNumComponents() const { return Components.Num(); }
+
+	/** Do members keep the engine's occlusion queries? Read when their proxy is created */
+	static bool UseHardwareQueries();
+
+	/** Logs the culling rate of every scene since the last call and resets it, for RMC.OcclusionStats */
+	static void LogStats();
+
+private:
+	struct FViewOcclusion
+	{
+		FViewOcclusion() : FrameNumber(0), WorldToClip(FMatrix::Identity) { }
+
+		uint32 FrameNumber;
+		FMatrix WorldToClip;
+		FRuntimeMeshDepthBuffer DepthBuffer;
+		TBitArray<> VisibleClusters;
+	};
+
+	void ComputeViewVisibility(FViewOcclusion& ViewOcclusion, const FSceneView& View, const FRuntimeMeshOcclusionData& Data);
+
+	/** Builds once on a later game thread tick, however often it is asked for until then */
+	void ScheduleRebuild();
+	bool TickRebuild(float DeltaTime);
+
+	/** Members by slot, game thread */
+	TArray<TWeakObjectPtr<URuntimeMeshComponent>> Components;
+
+	/** Slots the last Build took as movable, game thread */
+	TBitArray<> MovableSlots;
+
+	/** Was data sent to the render thread since the last Invalidate? Game thread */
+	bool bHasRenderData;
+
+	/** Is a Build waiting on the ticker? Game thread */
+	bool bRebuildPending;
+
+	/** Clusters and occluders the proxies test against, render thread */
+	FRuntimeMeshOcclusionDataPtr RenderData;
+
+	/** Proxies of several views ask in parallel, the lock guards the per view results */
+	FCriticalSection ViewLock;
+	TMap<const FSceneViewStateInterface*, FViewOcclusion> ViewOcclusions;
+};
@@ -0,0 +1,91 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#pragma once
+
+#include "Engine.h"
+
+/** How well an index buffer uses the post transform vertex cache, measured with a FIFO cache */
+struct FRuntimeMeshCacheStats
+{
+	FRuntimeMeshCacheStats()
+		: NumTriangles(0)
+		, NumVertices(0)
+		, NumTransforms(0)
+	{ }
+
+	int32 NumTriangles;
+	/** Vertices referenced by the indices */
+	int32 NumVertices;
+	/** Cache misses, each one runs the vertex shader */
+	int32 NumTransforms;
+
+	/** Average cache miss ratio, transforms per triangle. 3 is the worst case, around 0.5 the best a closed mesh gets */
+	float GetACMR() const { return NumTriangles > 0 ? (float)NumTransforms / NumTriangles : 0.0f; }
+	/** Average transform to vertex ratio, 1 means every vertex is transformed exactly once */
+	float GetATVR() const { return NumVertices > 0 ? (float)NumTransforms / NumVertices : 0.0f; }
+
+	FRuntimeMeshCacheStats& operator+=(const FRuntimeMeshCacheStats& Other)
+	{
+		NumTriangles += Other.NumTriangles;
+		NumVertices += Other.NumVertices;
+		NumTransforms += Other.NumTransforms;
+		return *this;
+	}
+};
+
+/**
+*	Reorders triangle lists for the GPU.
+*	The triangles are ordered for the post transform cache with Tipsify (Sander et al. 2007), the clusters Tipsify
+*	produces are split where the cache efficiency allows it and sorted so triangles facing away from the mesh center
+*	are drawn first, which cuts overdraw. Finally the vertices are renumbered in the order the indices first use them
+*	so vertex fetch walks the vertex buffer front to back.
+*	Everything only touches the arrays passed in, so it is safe to run on any thread.
+*/
+class RUNTIMEMESHCOMPONENT_API FRuntimeMeshOptimizer
+{
+public:
+	/** Cache size the optimization targets, small enough to be a win on every GPU */
+	static const int32 DefaultCacheSize = 16;
+	/** How much worse than the Tipsify order a cluster may get in ACMR when it is split up for overdraw */
+	static const float DefaultOverdrawThreshold;
+
+	/** Simulates a FIFO cache of CacheSize entries over the indices */
+	static FRuntimeMeshCacheStats AnalyzeVertexCache(const TArray<int32>& Indices, int32 NumVertices, int32 CacheSize = DefaultCacheSize);
+
+	/**
+	*	Reorders the triangles for the vertex cache.
+	*	@param	OutClusters		Optional, receives the first triangle of every run Tipsify had to restart at a non adjacent vertex
+	*/
+	static void OptimizeVertexCache(TArray<int32>& Indices, int32 NumVertices, int32 CacheSize = DefaultCacheSize, TArray<int32>* OutClusters = nullptr);
+
+	/** Sorts the clusters of a cache optimized index buffer front to back, Clusters as returned by OptimizeVertexCache() */
+	static void OptimizeOverdraw(TArray<int32>& Indices, const TArray<FVector>& Positions, const TArray<int32>& Clusters, int32 CacheSize = DefaultCacheSize, float Threshold = DefaultOverdrawThreshold);
+
+	/**
+	*	Renumbers the vertices in the order the indices first reference them, vertices no triangle uses go last.
+	*	@param	OutNewToOld		For every new vertex the index it had before, pass it to RemapVertices() for each vertex array
+	*/
+	static void OptimizeVertexFetch(TArray<int32>& Indices, int32 NumVertices, TArray<int32>& OutNewToOld);
+
+	/** Runs all three passes, the stats before and after are optional */
+	static void Optimize(TArray<int32>& Indices, const TArray<FVector>& Positions, TArray<int32>& OutNewToOld,
+		FRuntimeMeshCacheStats* OutBefore = nullptr, FRuntimeMeshCacheStats* OutAfter = nullptr);
+
+	/** Moves the vertices into the order of a remap table from OptimizeVertexFetch(), arrays that don't have one entry per vertex are left alone */
+	template<typename Type>
+	static void RemapVertices(TArray<Type>& Vertices, const TArray<int32>& NewToOld)
+	{
+		if (Vertices.Num() != NewToOld.Num())
+		{
+			return;
+		}
+
+		TArray<Type> Remapped;
+		Remapped.Reserve(Vertices.Num());
+		for (int32 Index = 0; Index < NewToOld.Num(); Index++)
+		{
+			Remapped.Add(Vertices[NewToOld[Index]]);
+		}
+		Vertices = MoveTemp(Remapped);
+	}
+};
@@ -53,6 +53,9 @@ DECLARE_CYCLE_STAT(TEXT("UpdateMeshSection (GT)"), STAT_RuntimeMesh_UpdateMeshSe
 DECLARE_CYCLE_STAT(TEXT("UpdateMeshSectionPositionsImmediate (GT)"), STAT_RuntimeMesh_UpdateMeshSectionPositionsImmediate, STATGROUP_RuntimeMesh);
 DECLARE_CYCLE_STAT(TEXT("UpdateMeshSectionPositionsImmediate (With Bounding Box) (GT)"), STAT_RuntimeMesh_UpdateMeshSectionPositionsImmediate_WithBoundinBox, STATGROUP_RuntimeMesh);
 
+DECLARE_CYCLE_STAT(TEXT("Prepare Section (Worker)"), STAT_RuntimeMesh_PrepareSection, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Commit Prepared Section (GT)"), STAT_RuntimeMesh_CommitPreparedSection, STATGROUP_RuntimeMesh);
+
 DECLARE_CYCLE_STAT(TEXT("Finish Create Section (GT)"), STAT_RuntimeMesh_FinishCreateSectionInternal, STATGROUP_RuntimeMesh);
 DECLARE_CYCLE_STAT(TEXT("Finish Update Section (GT)"), STAT_RuntimeMesh_FinishUpdateSectionInternal, STATGROUP_RuntimeMesh);
 DECLARE_CYCLE_STAT(TEXT("Clear Mesh Section (GT)"), STAT_RuntimeMesh_ClearMeshSection, STATGROUP_RuntimeMesh);
@@ -68,7 +71,59 @@ DECLARE_CYCLE_STAT(TEXT("Create Scene Proxy (GT)"), STAT_RuntimeMesh_CreateScene
 DECLARE_CYCLE_STAT(TEXT("Get Physics TriMesh Data (GT)"), STAT_RuntimeMesh_GetPhysicsTriMeshData, STATGROUP_RuntimeMesh);
 DECLARE_CYCLE_STAT(TEXT("Update Collision (GT)"), STAT_RuntimeMesh_UpdateCollision, STATGROUP_RuntimeMesh);
 DECLARE_CYCLE_STAT(TEXT("Update Local Bounds (GT)"), STAT_RuntimeMesh_UpdateLocalBounds, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Update Transform (GT)"), STAT_RuntimeMesh_UpdateTransform, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Send Render Transform (GT)"), STAT_RuntimeMesh_SendRenderTransform, STATGROUP_RuntimeMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Transform Updates"), STAT_RuntimeMesh_TransformUpdates, STATGROUP_RuntimeMesh);
 DECLARE_CYCLE_STAT(TEXT("Serialize"), STAT_RuntimeMesh_Serialize, STATGROUP_RuntimeMesh);
 
-
-
+// ESS Import Profiling
+DECLARE_CYCLE_STAT(TEXT("Ess Import - Parse"), STAT_RuntimeMesh_EssImport_Parse, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Ess Import - Gather Nodes"), STAT_RuntimeMesh_EssImport_GatherNodes, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Ess Import - Build Meshes"), STAT_RuntimeMesh_EssImport_BuildMeshes, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Ess Import - Decode Textures"), STAT_RuntimeMesh_EssImport_DecodeTextures, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Ess Import - Build Materials"), STAT_RuntimeMesh_EssImport_BuildMaterials, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Ess Import - Create Components"), STAT_RuntimeMesh_EssImport_CreateComponents, STATGROUP_RuntimeMesh);
+
+// Ambient Occlusion Baking
+DECLARE_CYCLE_STAT(TEXT("AO Bake - Build BVH"), STAT_RuntimeMesh_AOBake_BuildBVH, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("AO Bake - Trace"), STAT_RuntimeMesh_AOBake_Trace, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("AO Bake - Write Colors"), STAT_RuntimeMesh_AOBake_WriteColors, STATGROUP_RuntimeMesh);
+
+// Geometry Queries
+DECLARE_CYCLE_STAT(TEXT("Query - Gather BVH (GT)"), STAT_RuntimeMesh_Query_GatherBVH, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Query - Build BVH"), STAT_RuntimeMesh_Query_BuildBVH, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Query - Refit BVH (GT)"), STAT_RuntimeMesh_Query_RefitBVH, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Query - Build Scene BVH (GT)"), STAT_RuntimeMesh_Query_BuildSceneBVH, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Query - Trace (GT)"), STAT_RuntimeMesh_Query_Trace, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Query - Overlap (GT)"), STAT_RuntimeMesh_Query_Overlap, STATGROUP_RuntimeMesh);
+
+// Mesh Optimization
+DECLARE_CYCLE_STAT(TEXT("Optimize - Vertex Cache"), STAT_RuntimeMesh_Optimize_VertexCache, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Optimize - Overdraw"), STAT_RuntimeMesh_Optimize_Overdraw, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Optimize - Vertex Fetch"), STAT_RuntimeMesh_Optimize_VertexFetch, STATGROUP_RuntimeMesh);
+
+// Memory
+DECLARE_MEMORY_STAT(TEXT("Memory - Vertex Buffers"), STAT_RuntimeMesh_Memory_VertexBuffers, STATGROUP_RuntimeMesh);
+DECLARE_MEMORY_STAT(TEXT("Memory - Index Buffers"), STAT_RuntimeMesh_Memory_IndexBuffers, STATGROUP_RuntimeMesh);
+DECLARE_MEMORY_STAT(TEXT("Memory - Section Data"), STAT_RuntimeMesh_Memory_SectionData, STATGROUP_RuntimeMesh);
+DECLARE_MEMORY_STAT(TEXT("Memory - Evicted Section Data"), STAT_RuntimeMesh_Memory_EvictedData, STATGROUP_RuntimeMesh);
+DECLARE_MEMORY_STAT(TEXT("Memory - Collision"), STAT_RuntimeMesh_Memory_Collision, STATGROUP_RuntimeMesh);
+DECLARE_MEMORY_STAT(TEXT("Memory - Query BVH"), STAT_RuntimeMesh_Memory_QueryBVH, STATGROUP_RuntimeMesh);
+DECLARE_MEMORY_STAT(TEXT("Memory - Imported Textures"), STAT_RuntimeMesh_Memory_Textures, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Memory - Gather (GT)"), STAT_RuntimeMesh_Memory_Gather, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Memory - Enforce Budget (GT)"), STAT_RuntimeMesh_Memory_EnforceBudget, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Memory - Evict Section (GT)"), STAT_RuntimeMesh_Memory_EvictSection, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Memory - Restore Section (GT)"), STAT_RuntimeMesh_Memory_RestoreSection, STATGROUP_RuntimeMesh);
+
+
+
+
+// Software Occlusion
+DECLARE_CYCLE_STAT(TEXT("Occlusion - Build (GT)"), STAT_RuntimeMesh_Occlusion_Build, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Occlusion - Rasterize Occluders"), STAT_RuntimeMesh_Occlusion_Rasterize, STATGROUP_RuntimeMesh);
+DECLARE_CYCLE_STAT(TEXT("Occlusion - Test Clusters"), STAT_RuntimeMesh_Occlusion_TestClusters, STATGROUP_RuntimeMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Occlusion - Occluder Triangles"), STAT_RuntimeMesh_Occlusion_OccluderTriangles, STATGROUP_RuntimeMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Occlusion - Clusters Tested"), STAT_RuntimeMesh_Occlusion_ClustersTested, STATGROUP_RuntimeMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Occlusion - Clusters Culled"), STAT_RuntimeMesh_Occlusion_ClustersCulled, STATGROUP_RuntimeMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Occlusion - Primitives Tested"), STAT_RuntimeMesh_Occlusion_PrimitivesTested, STATGROUP_RuntimeMesh);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Occlusion - Primitives Culled"), STAT_RuntimeMesh_Occlusion_PrimitivesCulled, STATGROUP_RuntimeMesh);
@@ -0,0 +1,147 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#pragma once
+
+#include "Engine.h"
+#include "RuntimeMeshCore.h"
+#include "RuntimeMeshRendering.h"
+#include "RuntimeMeshSectionProxy.h"
+
+class IRuntimeMeshVerticesBuilder;
+
+/** Position as signed normalized 16 bit values within the bounds of its component, W is always 1 */
+struct FRuntimeMeshQuantizedPosition
+{
+	int16 X;
+	int16 Y;
+	int16 Z;
+	int16 W;
+};
+
+/**
+*	Compact vertex static sections are uploaded to the GPU with, 28 bytes against the 40 of FRuntimeMeshVertexDualUV.
+*	The input assembler expands every component to floats, the position is mapped back into section space by a
+*	transform the section renders with (see FRuntimeMeshQuantizationFrame), so the stock local vertex factory shader
+*	does the dequantization as part of its local to world transform.
+*/
+struct RUNTIMEMESHCOMPONENT_API FRuntimeMeshVertexQuantized
+{
+	FRuntimeMeshQuantizedPosition Position;
+	FPackedNormal TangentX;
+	FPackedNormal TangentZ;
+	FColor Color;
+	FVector2DHalf UV0;
+	FVector2DHalf UV1;
+
+	static RuntimeMeshVertexStructure GetVertexStructure(const FVertexBuffer& VertexBuffer);
+};
+
+/**
+*	Maps quantized positions back to component space, Position = Center + Quantized * Extent. All sections of a proxy share
+*	one frame, so a vertex on the border of two sections lands on the same grid point in both and no cracks open between them.
+*/
+struct RUNTIMEMESHCOMPONENT_API FRuntimeMeshQuantizationFrame
+{
+	FRuntimeMeshQuantizationFrame() : Center(FVector::ZeroVector), Extent(FVector(1.0f)) { }
+
+	FVector Center;
+	FVector Extent;
+
+	/** Frame covering the box, flat axes keep a small extent so the transform stays invertible */
+	static FRuntimeMeshQuantizationFrame FromBounds(const FBox& Bounds);
+
+	FMatrix GetDequantizeMatrix() const { return FScaleMatrix(Extent) * FTranslationMatrix(Center); }
+};
+
+/** GPU memory of the quantized sections currently alive against what their source vertex types would have taken */
+struct FRuntimeMeshQuantizationStats
+{
+	FRuntimeMeshQuantizationStats() : NumSections(0), NumVertices(0), SourceBytes(0), QuantizedBytes(0) { }
+
+	int64 NumSections;
+	int64 NumVertices;
+	int64 SourceBytes;
+	int64 QuantizedBytes;
+
+	float GetSourceBytesPerVertex() const { return NumVertices > 0 ? (float)SourceBytes / NumVertices : 0.0f; }
+	float GetQuantizedBytesPerVertex() const { return NumVertices > 0 ? (float)QuantizedBytes / NumVertices : 0.0f; }
+};
+
+class RUNTIMEMESHCOMPONENT_API FRuntimeMeshQuantizer
+{
+public:
+	/** UVs further from the origin than this lose too much in half precision, sections using them aren't quantized */
+	static const float MaxHalfPrecisionUV;
+
+	/** Whether RMC.QuantizeStaticSections is on */
+	static bool IsEnabled();
+
+	/**
+	*	Packs the vertices into the quantized format, positions are quantized within the frame of their component.
+	*	Fails for vertices without position, normal or tangent, with more than two UV channels, with UVs out of half
+	*	precision range or with positions outside the frame.
+	*/
+	static bool Quantize(const IRuntimeMeshVerticesBuilder& Vertices, const FRuntimeMeshQuantizationFrame& Frame, TArray<FRuntimeMeshVertexQuantized>& OutVertices);
+
+	/** Tracks the vertex buffers of quantized section proxies, called on the render thread */
+	static void AddSection(int32 NumVertices, int32 SourceStride);
+	static void RemoveSection(int32 NumVertices, int32 SourceStride);
+
+	static FRuntimeMeshQuantizationStats GetStats();
+	static void LogStats();
+};
+
+/**
+*	RT proxy of a quantized section, renders with its own primitive uniform buffer so the dequantization is part of its transform.
+*	The velocity pass takes the previous transform of the whole primitive from the scene and can't be given the dequantization,
+*	so only proxies that never draw velocities, those of components that aren't movable, get quantized sections.
+*/
+class FRuntimeMeshQuantizedSectionProxy : public FRuntimeMeshSectionProxy<FRuntimeMeshVertexQuantized, false>
+{
+public:
+	FRuntimeMeshQuantizedSectionProxy(FSceneInterface* InScene, bool bInIsVisible, bool bInCastsShadow, UMaterialInterface* InMaterial, FMaterialRelevance InMaterialRelevance,
+		const FRuntimeMeshQuantizationFrame& InFrame, int32 InSourceStride)
+		: FRuntimeMeshSectionProxy<FRuntimeMeshVertexQuantized, false>(InScene, EUpdateFrequency::Infrequent, bInIsVisible, bInCastsShadow, InMaterial, InMaterialRelevance)
+		, DequantizeMatrix(InFrame.GetDequantizeMatrix())
+		, SourceStride(InSourceStride)
+		, NumTrackedVertices(0)
+	{ }
+
+	virtual ~FRuntimeMeshQuantizedSectionProxy() override
+	{
+		UniformBuffer.ReleaseResource();
+		FRuntimeMeshQuantizer::RemoveSection(NumTrackedVertices, SourceStride);
+	}
+
+	virtual bool HasSectionTransform() const override { return true; }
+	virtual FMatrix GetSectionTransform() const override { return DequantizeMatrix; }
+
+	virtual void SetPrimitiveUniformShaderParameters(const FPrimitiveUniformShaderParameters& Parameters) override
+	{
+		UniformBuffer.SetContents(Parameters);
+		if (!UniformBuffer.IsInitialized())
+		{
+			UniformBuffer.InitResource();
+		}
+	}
+
+	virtual const TUniformBuffer<FPrimitiveUniformShaderParameters>* GetPrimitiveUniformBuffer() const override
+	{
+		return UniformBuffer.IsInitialized() ? &UniformBuffer : nullptr;
+	}
+
+	virtual void FinishCreate_RenderThread(FRuntimeMeshSectionCreateDataInterface* UpdateData) override
+	{
+		FRuntimeMeshSectionProxy<FRuntimeMeshVertexQuantized, false>::FinishCreate_RenderThread(UpdateData);
+
+		NumTrackedVertices = VertexBuffer.Num();
+		FRuntimeMeshQuantizer::AddSection(NumTrackedVertices, SourceStride);
+	}
+
+private:
+	TUniformBuffer<FPrimitiveUniformShaderParameters> UniformBuffer;
+	FMatrix DequantizeMatrix;
+	/** Size of a vertex of the section this was quantized from */
+	int32 SourceStride;
+	int32 NumTrackedVertices;
+};
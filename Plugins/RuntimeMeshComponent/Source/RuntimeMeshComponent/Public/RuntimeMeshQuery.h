@@ -0,0 +1,119 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#pragma once
+
+#include "Engine.h"
+#include "RuntimeMeshCore.h"
+#include "RuntimeMeshBuilder.h"
+#include "RuntimeMeshBVH.h"
+
+class URuntimeMeshComponent;
+
+/**
+*	Copy of the mesh of every section of a RuntimeMeshComponent with a BVH over it, in component space.
+*	Queries don't need cooked physics, they report the section and triangle they hit along with barycentrics and the first UV channel.
+*	Gathering reads the component and has to run on the game thread, building can run on any thread.
+*	The component refits its tree in place on the game thread, so queries on the tree of a component are game thread only.
+*/
+class RUNTIMEMESHCOMPONENT_API FRuntimeMeshComponentBVH
+{
+public:
+	/** Copies the mesh of every section, the previous tree is dropped */
+	void Gather(URuntimeMeshComponent* Component);
+
+	/** Copies new positions and UVs for a refit, false when a section changed its vertex or triangle count and the tree has to be rebuilt */
+	bool GatherVertices(URuntimeMeshComponent* Component);
+
+	/** Builds the tree over the gathered mesh */
+	void Build();
+
+	/** Moves the tree to the positions copied by GatherVertices */
+	void Refit();
+
+	/** Closest hit along a normalized direction, the hit is in component space */
+	bool Raycast(const FVector& Origin, const FVector& Direction, float MaxDistance, FRuntimeMeshQueryHit& OutHit) const;
+
+	/** First triangle a sphere moving along a normalized direction touches, the hit is in component space */
+	bool SweepSphere(const FVector& Origin, const FVector& Direction, float Radius, float MaxDistance, FRuntimeMeshQueryHit& OutHit) const;
+
+	/**
+	*	Appends a hit for every triangle that intersects an oriented box, the hits are in component space.
+	*	@param BoxToComponent	Transform of the box, from a space where it spans -Extent to Extent
+	*/
+	void OverlapBox(const FMatrix& BoxToComponent, const FVector& Extent, TArray<FRuntimeMeshQueryHit>& OutHits) const;
+
+	bool IsEmpty() const { return BVH.IsEmpty(); }
+	int32 GetNumTriangles() const { return Indices.Num() / 3; }
+	FBox GetBounds() const { return BVH.GetBounds(); }
+	SIZE_T GetAllocatedSize() const
+	{
+		return Sections.GetAllocatedSize() + Positions.GetAllocatedSize() + UVs.GetAllocatedSize() + Indices.GetAllocatedSize() + BVH.GetAllocatedSize();
+	}
+
+private:
+	struct FSection
+	{
+		int32 SectionIndex;
+		int32 FirstVertex;
+		int32 NumVertices;
+		int32 FirstTriangle;
+		int32 NumTriangles;
+	};
+
+	void CopySectionVertices(const FSection& Section, const IRuntimeMeshVerticesBuilder& Vertices);
+	void GetTriangle(int32 Triangle, FVector& OutV0, FVector& OutV1, FVector& OutV2) const;
+
+	/** Fills everything but the component, the distance and the world space conversion */
+	void FillHit(int32 Triangle, float U, float V, FRuntimeMeshQueryHit& OutHit) const;
+
+	TArray<FSection> Sections;
+	TArray<FVector> Positions;
+	TArray<FVector2D> UVs;
+	/** Three per triangle, into Positions */
+	TArray<int32> Indices;
+	FRuntimeMeshBVH BVH;
+};
+
+/**
+*	Top level tree over the world bounds of a set of RuntimeMeshComponents, queries descend into the BVH of each component.
+*	The tree is built from the component transforms at the time of Build, rebuild it after components move.
+*	Everything runs on the game thread, only the component BVHs are built on the thread pool.
+*/
+class RUNTIMEMESHCOMPONENT_API FRuntimeMeshSceneBVH
+{
+public:
+	/** Brings the BVHs of the components up to date, building the stale ones side by side, and builds the tree over them */
+	void Build(const TArray<URuntimeMeshComponent*>& InComponents);
+
+	void Reset();
+
+	bool LineTrace(const FVector& Start, const FVector& End, FRuntimeMeshQueryHit& OutHit) const;
+	bool SweepSphere(const FVector& Start, const FVector& End, float Radius, FRuntimeMeshQueryHit& OutHit) const;
+	void OverlapBox(const FVector& Center, const FVector& Extent, const FRotator& Rotation, TArray<FRuntimeMeshQueryHit>& OutHits) const;
+
+	int32 GetNumComponents() const { return Components.Num(); }
+
+private:
+	struct FNode
+	{
+		FBox Bounds;
+		/** First component of a leaf, or the first of the two adjacent children */
+		int32 Start;
+		/** Components in a leaf, 0 for interior nodes */
+		int32 Count;
+	};
+
+	struct FComponentEntry
+	{
+		TWeakObjectPtr<URuntimeMeshComponent> Component;
+		FBox Bounds;
+	};
+
+	void Subdivide(int32 NodeIndex, int32 Start, int32 Count);
+
+	/** Closest hit of a sweep, Radius 0 is a line trace */
+	bool Trace(const FVector& Start, const FVector& End, float Radius, FRuntimeMeshQueryHit& OutHit) const;
+
+	TArray<FComponentEntry> Components;
+	TArray<FNode> Nodes;
+};
@@ -4,6 +4,7 @@
 
 #include "Engine.h"
 #include "RuntimeMeshCore.h"
+#include "RuntimeMeshMemory.h"
 
 
 #if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 12
@@ -35,7 +36,7 @@ class FRuntimeMeshVertexBuffer : public FVertexBuffer
 {
 public:
 
-	FRuntimeMeshVertexBuffer(EUpdateFrequency SectionUpdateFrequency) : VertexCount(0)
+	FRuntimeMeshVertexBuffer(EUpdateFrequency SectionUpdateFrequency) : VertexCount(0), AllocatedBytes(0)
 	{
 		UsageFlags = SectionUpdateFrequency == EUpdateFrequency::Frequent ? BUF_Dynamic : BUF_Static;
 	}
@@ -45,10 +46,24 @@ public:
 		// Create the vertex buffer
 		FRHIResourceCreateInfo CreateInfo;
 		VertexBufferRHI = RHICreateVertexBuffer(sizeof(VertexType) * VertexCount, UsageFlags, CreateInfo);
+
+		AllocatedBytes = sizeof(VertexType) * VertexCount;
+		FRuntimeMeshMemoryTracker::TrackVertexBuffer(AllocatedBytes);
+	}
+
+	virtual void ReleaseRHI() override
+	{
+		FRuntimeMeshMemoryTracker::TrackVertexBuffer(-AllocatedBytes);
+		AllocatedBytes = 0;
+
+		FVertexBuffer::ReleaseRHI();
 	}
 
 	/* Get the size of the vertex buffer */
-	int32 Num() { return VertexCount; }
+	int32 Num() const { return VertexCount; }
+
+	/* Get the size in bytes of the RHI buffer, 0 while it isn't created */
+	int64 GetAllocatedBytes() const { return AllocatedBytes; }
 	
 	/* Set the size of the vertex buffer */
 	void SetNum(int32 NewVertexCount)
@@ -85,6 +100,8 @@ private:
 
 	/* The number of vertices this buffer is currently allocated to hold */
 	int32 VertexCount;
+	/* The size of the RHI buffer as reported to the memory tracker */
+	int64 AllocatedBytes;
 	/* The buffer configuration to use */
 	EBufferUsageFlags UsageFlags;
 };
@@ -94,7 +111,7 @@ class FRuntimeMeshIndexBuffer : public FIndexBuffer
 {
 public:
 
-	FRuntimeMeshIndexBuffer(EUpdateFrequency SectionUpdateFrequency) : IndexCount(0)
+	FRuntimeMeshIndexBuffer(EUpdateFrequency SectionUpdateFrequency) : IndexCount(0), IndexStride(sizeof(int32)), AllocatedBytes(0)
 	{
 		UsageFlags = SectionUpdateFrequency == EUpdateFrequency::Frequent ? BUF_Dynamic : BUF_Static;
 	}
@@ -103,21 +120,41 @@ public:
 	{
 		// Create the index buffer
 		FRHIResourceCreateInfo CreateInfo;
-		IndexBufferRHI = RHICreateIndexBuffer(sizeof(int32), IndexCount * sizeof(int32), BUF_Dynamic, CreateInfo);
+		IndexBufferRHI = RHICreateIndexBuffer(IndexStride, IndexCount * IndexStride, BUF_Dynamic, CreateInfo);
+
+		AllocatedBytes = IndexCount * IndexStride;
+		FRuntimeMeshMemoryTracker::TrackIndexBuffer(AllocatedBytes);
+	}
+
+	virtual void ReleaseRHI() override
+	{
+		FRuntimeMeshMemoryTracker::TrackIndexBuffer(-AllocatedBytes);
+		AllocatedBytes = 0;
+
+		FIndexBuffer::ReleaseRHI();
 	}
 
 	/* Get the size of the index buffer */
-	int32 Num() { return IndexCount; }
+	int32 Num() const { return IndexCount; }
+
+	/* Get the size in bytes of the RHI buffer, 0 while it isn't created */
+	int64 GetAllocatedBytes() const { return AllocatedBytes; }
+
+	/* Get the size in bytes of a single index */
+	int32 GetStride() const { return IndexStride; }
 
 	/* Set the size of the index buffer */
-	void SetNum(int32 NewIndexCount)
+	void SetNum(int32 NewIndexCount, bool bUse16BitIndices = false)
 	{
 		check(NewIndexCount != 0);
 
+		const int32 NewIndexStride = bUse16BitIndices ? sizeof(uint16) : sizeof(int32);
+
 		// Make sure we're not already the right size
-		if (NewIndexCount != IndexCount)
+		if (NewIndexCount != IndexCount || NewIndexStride != IndexStride)
 		{
 			IndexCount = NewIndexCount;
+			IndexStride = NewIndexStride;
 
 			// Rebuild resource
 			ReleaseResource();
@@ -131,10 +168,21 @@ public:
 		check(Data.Num() == IndexCount);
 
 		// Lock the index buffer
-		void* Buffer = RHILockIndexBuffer(IndexBufferRHI, 0, IndexCount * sizeof(int32), RLM_WriteOnly);
+		void* Buffer = RHILockIndexBuffer(IndexBufferRHI, 0, IndexCount * IndexStride, RLM_WriteOnly);
 
-		// Write the indices to the vertex buffer	
-		FMemory::Memcpy(Buffer, Data.GetData(), Data.Num() * sizeof(int32));
+		// Write the indices to the vertex buffer, narrowing them if this is a 16 bit buffer
+		if (IndexStride == sizeof(uint16))
+		{
+			uint16* PackedIndices = static_cast<uint16*>(Buffer);
+			for (int32 Index = 0; Index < Data.Num(); Index++)
+			{
+				PackedIndices[Index] = static_cast<uint16>(Data[Index]);
+			}
+		}
+		else
+		{
+			FMemory::Memcpy(Buffer, Data.GetData(), Data.Num() * sizeof(int32));
+		}
 
 		// Unlock the index buffer
 		RHIUnlockIndexBuffer(IndexBufferRHI);
@@ -144,6 +192,10 @@ private:
 
 	/* The number of indices this buffer is currently allocated to hold */
 	int32 IndexCount;
+	/* The size of a single index in bytes */
+	int32 IndexStride;
+	/* The size of the RHI buffer as reported to the memory tracker */
+	int64 AllocatedBytes;
 	/* The buffer configuration to use */
 	EBufferUsageFlags UsageFlags;
 };
@@ -9,6 +9,9 @@
 #include "RuntimeMeshSectionProxy.h"
 #include "RuntimeMeshBuilder.h"
 #include "RuntimeMeshLibrary.h"
+#include "RuntimeMeshOptimizer.h"
+#include "RuntimeMeshQuantizedVertex.h"
+#include "RuntimeMeshMemory.h"
 
 /** Interface class for a single mesh section */
 class FRuntimeMeshSectionInterface
@@ -44,17 +47,62 @@ public:
 	/** Update frequency of this section */
 	EUpdateFrequency UpdateFrequency;
 
+	/** Can the index buffers be packed to 16 bit on the render thread. Set by UpdateIndexFormat() whenever the indices change. */
+	bool bCanUse16BitIndices;
+
+	/** Did the last creation data sent to the render thread use the quantized format */
+	bool bIsQuantizedOnGPU;
+
+	/** Collision positions extracted during worker preparation. Empty when the section has to be gathered on demand. */
+	TArray<FVector> CollisionPositionCache;
+
 	FRuntimeMeshSectionInterface(bool bInNeedsPositionOnlyBuffer) : 
 		bNeedsPositionOnlyBuffer(bInNeedsPositionOnlyBuffer),
 		LocalBoundingBox(EForceInit::ForceInitToZero),
 		CollisionEnabled(false),
 		bIsVisible(true),
 		bCastsShadow(true),
-		bIsLegacySectionType(false)
+		bCanUse16BitIndices(false),
+		bIsQuantizedOnGPU(false),
+		bIsLegacySectionType(false),
+		LastRestoreTime(0.0)
 	{}
 
 	virtual ~FRuntimeMeshSectionInterface() { }
 
+	/** Has the mesh data been moved out to a compressed copy by Evict() */
+	bool IsEvicted() const { return EvictedData.IsValid(); }
+
+	/** Length of the index buffer, also while the section is evicted */
+	int32 GetNumIndices() const { return EvictedData.IsValid() ? EvictedData->NumIndices : IndexBuffer.Num(); }
+
+	/** Seconds since the section was last brought back from eviction */
+	double GetTimeSinceRestore() const { return FPlatformTime::Seconds() - LastRestoreTime; }
+
+	/** CPU memory of this section and the size of the GPU buffers it uploads, in the format of its last upload */
+	void GetMemoryUsage(FRuntimeMeshSectionMemory& OutMemory) const
+	{
+		if (EvictedData.IsValid())
+		{
+			OutMemory.CPUBytes = 0;
+			OutMemory.EvictedBytes = EvictedData->CompressedData.GetAllocatedSize();
+			OutMemory.VertexBufferBytes = EvictedData->VertexBufferBytes;
+			OutMemory.IndexBufferBytes = EvictedData->IndexBufferBytes;
+			return;
+		}
+
+		int64 VertexCPUBytes, VertexGPUBytes;
+		GetVertexBufferMemory(VertexCPUBytes, VertexGPUBytes);
+
+		OutMemory.CPUBytes = VertexCPUBytes + PositionVertexBuffer.GetAllocatedSize() + IndexBuffer.GetAllocatedSize() +
+			TessellationIndexBuffer.GetAllocatedSize() + CollisionPositionCache.GetAllocatedSize();
+		OutMemory.EvictedBytes = 0;
+		OutMemory.VertexBufferBytes = VertexGPUBytes + (IsDualBufferSection() ? (int64)PositionVertexBuffer.Num() * sizeof(FVector) : 0);
+
+		const int32 NumIndices = bShouldUseAdjacencyIndexBuffer && TessellationIndexBuffer.Num() > 0 ? TessellationIndexBuffer.Num() : IndexBuffer.Num();
+		OutMemory.IndexBufferBytes = (int64)NumIndices * (bCanUse16BitIndices ? sizeof(uint16) : sizeof(int32));
+	}
+
 protected:
 
 	/** Is this an internal section type. */
@@ -159,7 +207,187 @@ protected:
 		}
 	}
 
-	virtual FRuntimeMeshSectionCreateDataInterface* GetSectionCreationData(FSceneInterface* InScene, UMaterialInterface* InMaterial) const = 0;
+	/* 
+	*	Computes all derived data for this section (normals/tangents, tessellation indices, bounds, index format and collision positions).
+	*	This touches nothing but the section itself so it is safe to call on a worker for a section that isn't owned by a component yet.
+	*/
+	void PrepareDerivedData(ESectionUpdateFlags UpdateFlags, bool bRecalculateBounds)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_RuntimeMesh_PrepareSection);
+
+		if (!!(UpdateFlags & ESectionUpdateFlags::OptimizeMesh))
+		{
+			OptimizeMesh();
+		}
+
+		if (!!(UpdateFlags & ESectionUpdateFlags::CalculateNormalTangent))
+		{
+			GenerateNormalTangent();
+		}
+
+		if (!!(UpdateFlags & ESectionUpdateFlags::CalculateTessellationIndices))
+		{
+			GenerateTessellationIndices();
+		}
+
+		if (bRecalculateBounds)
+		{
+			RecalculateBoundingBox();
+		}
+
+		UpdateIndexFormat();
+
+		CollisionPositionCache.Reset();
+		if (CollisionEnabled)
+		{
+#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 13
+			TArray<TArray<FVector2D>> UnusedUVs;
+			GetCollisionInformation(CollisionPositionCache, UnusedUVs, false);
+#else
+			GetCollisionInformation(CollisionPositionCache);
+#endif
+		}
+	}
+
+	/* Finds the largest index so the RT can pick the smallest index format */
+	void UpdateIndexFormat()
+	{
+		int32 MaxIndex = 0;
+		for (int32 Index = 0; Index < IndexBuffer.Num(); Index++)
+		{
+			MaxIndex = FMath::Max(MaxIndex, IndexBuffer[Index]);
+		}
+		for (int32 Index = 0; Index < TessellationIndexBuffer.Num(); Index++)
+		{
+			MaxIndex = FMath::Max(MaxIndex, TessellationIndexBuffer[Index]);
+		}
+		bCanUse16BitIndices = MaxIndex <= MAX_uint16;
+	}
+
+	/*
+	*	Replaces the vertex and index buffers with a compressed copy once the GPU has them, the bounds and properties stay.
+	*	Returns the bytes freed, 0 when the mesh doesn't compress and is kept as is.
+	*/
+	int64 Evict()
+	{
+		check(!IsEvicted());
+
+		FRuntimeMeshSectionMemory Memory;
+		GetMemoryUsage(Memory);
+
+		TArray<uint8> MeshData;
+		FMemoryWriter Writer(MeshData);
+		SerializeMeshData(Writer);
+
+		TUniquePtr<FRuntimeMeshEvictedSection> NewEvictedData = MakeUnique<FRuntimeMeshEvictedSection>();
+		int32 CompressedSize = FCompression::CompressMemoryBound(COMPRESS_ZLIB, MeshData.Num());
+		NewEvictedData->CompressedData.SetNumUninitialized(CompressedSize);
+		if (!FCompression::CompressMemory(COMPRESS_ZLIB, NewEvictedData->CompressedData.GetData(), CompressedSize, MeshData.GetData(), MeshData.Num()) ||
+			CompressedSize >= MeshData.Num())
+		{
+			return 0;
+		}
+		NewEvictedData->CompressedData.SetNum(CompressedSize);
+		NewEvictedData->CompressedData.Shrink();
+		NewEvictedData->UncompressedSize = MeshData.Num();
+		NewEvictedData->NumIndices = IndexBuffer.Num();
+		NewEvictedData->VertexBufferBytes = Memory.VertexBufferBytes;
+		NewEvictedData->IndexBufferBytes = Memory.IndexBufferBytes;
+		EvictedData = MoveTemp(NewEvictedData);
+
+		EmptyMeshData();
+
+		return Memory.CPUBytes - EvictedData->CompressedData.GetAllocatedSize();
+	}
+
+	/* Brings back the buffers of an evicted section */
+	void Restore()
+	{
+		check(IsEvicted());
+
+		UncompressMeshData(*EvictedData);
+		EvictedData.Reset();
+		LastRestoreTime = FPlatformTime::Seconds();
+	}
+
+	/*
+	*	Creation data of an evicted section for a new proxy. The buffers are uncompressed only for as long as the creation
+	*	data takes to copy them, the section stays evicted.
+	*/
+	FRuntimeMeshSectionCreateDataInterface* GetEvictedSectionCreationData(FSceneInterface* InScene, UMaterialInterface* InMaterial, const FRuntimeMeshQuantizationFrame* QuantizationFrame)
+	{
+		check(IsEvicted());
+
+		TUniquePtr<FRuntimeMeshEvictedSection> Evicted = MoveTemp(EvictedData);
+		UncompressMeshData(*Evicted);
+
+		FRuntimeMeshSectionCreateDataInterface* SectionData = GetSectionCreationData(InScene, InMaterial, QuantizationFrame);
+
+		// The upload format can have changed with the new proxy
+		FRuntimeMeshSectionMemory Memory;
+		GetMemoryUsage(Memory);
+		Evicted->VertexBufferBytes = Memory.VertexBufferBytes;
+		Evicted->IndexBufferBytes = Memory.IndexBufferBytes;
+
+		EmptyMeshData();
+		EvictedData = MoveTemp(Evicted);
+		return SectionData;
+	}
+
+	void UncompressMeshData(const FRuntimeMeshEvictedSection& Evicted)
+	{
+		TArray<uint8> MeshData;
+		MeshData.SetNumUninitialized(Evicted.UncompressedSize);
+		verify(FCompression::UncompressMemory(COMPRESS_ZLIB, MeshData.GetData(), MeshData.Num(), Evicted.CompressedData.GetData(), Evicted.CompressedData.Num()));
+
+		FMemoryReader Reader(MeshData);
+		SerializeMeshData(Reader);
+		check(!Reader.IsError());
+	}
+
+	void EmptyMeshData()
+	{
+		PositionVertexBuffer.Empty();
+		IndexBuffer.Empty();
+		TessellationIndexBuffer.Empty();
+		CollisionPositionCache.Empty();
+		EmptyVertexBuffer();
+	}
+
+	/* Serializes only the buffers, for the in memory copy of an evicted section */
+	virtual void SerializeMeshData(FArchive& Ar)
+	{
+		Ar << PositionVertexBuffer;
+		Ar << IndexBuffer;
+		Ar << TessellationIndexBuffer;
+	}
+
+	virtual void EmptyVertexBuffer() = 0;
+
+	virtual int32 GetNumVertices() const = 0;
+
+	/* 
+	*	Builds the section a partial async update commits, in the buffer layout of this section. Moves in what the update
+	*	brought and copies the rest from this section. Update is null when only Positions came, Positions is null when
+	*	they didn't. Runs on a worker, this section is only read and the caller keeps it alive and unchanged until the commit.
+	*/
+	virtual TSharedPtr<FRuntimeMeshSectionInterface> MergeUpdate(FRuntimeMeshSectionInterface* Update, TArray<FVector>* Positions, bool bHasVertices, bool bHasIndices) const = 0;
+
+	/* Bytes held by the vertex array and the size of the vertex buffer the GPU gets from it */
+	virtual void GetVertexBufferMemory(int64& OutCPUBytes, int64& OutGPUBytes) const = 0;
+
+	/* Drops the derived data computed by PrepareDerivedData() after the section was changed on the game thread, the index format is found again. */
+	void InvalidatePreparedData(bool bIndicesChanged)
+	{
+		CollisionPositionCache.Empty();
+		if (bIndicesChanged)
+		{
+			UpdateIndexFormat();
+		}
+	}
+
+	/* QuantizationFrame has to be the component's, its proxy is only set up for quantized sections when it has one */
+	virtual FRuntimeMeshSectionCreateDataInterface* GetSectionCreationData(FSceneInterface* InScene, UMaterialInterface* InMaterial, const FRuntimeMeshQuantizationFrame* QuantizationFrame) const = 0;
 
 	virtual FRuntimeMeshRenderThreadCommandInterface* GetSectionUpdateData(bool bIncludePositionVertices, bool bIncludeVertices, bool bIncludeIndices) const = 0;
 
@@ -186,6 +414,9 @@ protected:
 
 	virtual void GenerateTessellationIndices() = 0;
 
+	/* Reorders the indices and vertices with FRuntimeMeshOptimizer, tessellation indices are regenerated if the section has them */
+	virtual void OptimizeMesh() = 0;
+
 
 	virtual void Serialize(FArchive& Ar)
 	{
@@ -227,9 +458,16 @@ protected:
 	}
 
 	
+private:
+	/** Compressed buffers while the section is evicted */
+	TUniquePtr<FRuntimeMeshEvictedSection> EvictedData;
+
+	/** When Restore() last ran, keeps a section that is still in use from being evicted again right away */
+	double LastRestoreTime;
 
 	friend class FRuntimeMeshSceneProxy;
 	friend class URuntimeMeshComponent;
+	friend class FRuntimeMeshAsync;
 };
 
 namespace RuntimeMeshSectionInternal
@@ -345,6 +583,23 @@ namespace RuntimeMeshSectionInternal
 	{
 	}
 
+
+	template<typename Type>
+	static typename TEnableIf<FRuntimeMeshVertexTraits<Type>::HasPosition>::Type GetPositions(const TArray<Type>& VertexBuffer, TArray<FVector>& Positions)
+	{
+		Positions.SetNumUninitialized(VertexBuffer.Num());
+		for (int32 Index = 0; Index < VertexBuffer.Num(); Index++)
+		{
+			Positions[Index] = VertexBuffer[Index].Position;
+		}
+	}
+
+	template<typename Type>
+	static typename TEnableIf<!FRuntimeMeshVertexTraits<Type>::HasPosition>::Type GetPositions(const TArray<Type>& VertexBuffer, TArray<FVector>& Positions)
+	{
+		Positions.Reset();
+	}
+
 }
 
 /** Templated class for a single mesh section */
@@ -419,14 +674,25 @@ protected:
 		}	
 	}
 
-	virtual FRuntimeMeshSectionCreateDataInterface* GetSectionCreationData(FSceneInterface* InScene, UMaterialInterface* InMaterial) const override
+	virtual FRuntimeMeshSectionCreateDataInterface* GetSectionCreationData(FSceneInterface* InScene, UMaterialInterface* InMaterial, const FRuntimeMeshQuantizationFrame* QuantizationFrame) const override
 	{
-		auto UpdateData = new FRuntimeMeshSectionCreateData<VertexType>();
-
 		FMaterialRelevance MaterialRelevance = (InMaterial != nullptr) 
 			? InMaterial->GetRelevance(InScene->GetFeatureLevel()) 
 			: UMaterial::GetDefaultMaterial(MD_Surface)->GetRelevance(InScene->GetFeatureLevel());
 
+		// Static sections are only ever recreated, so they can go to the GPU in the compact format
+		if (UpdateFrequency == EUpdateFrequency::Infrequent && !IsDualBufferSection() && QuantizationFrame != nullptr)
+		{
+			if (auto QuantizedData = GetQuantizedSectionCreationData(InScene, InMaterial, MaterialRelevance, *QuantizationFrame))
+			{
+				const_cast<FRuntimeMeshSection*>(this)->bIsQuantizedOnGPU = true;
+				return QuantizedData;
+			}
+		}
+		const_cast<FRuntimeMeshSection*>(this)->bIsQuantizedOnGPU = false;
+
+		auto UpdateData = new FRuntimeMeshSectionCreateData<VertexType>();
+
 		// Create new section proxy based on whether we need separate position buffer
 		if (IsDualBufferSection())
 		{
@@ -453,6 +719,38 @@ protected:
 			UpdateData->IndexBuffer = IndexBuffer;
 			UpdateData->bIsAdjacencyIndexBuffer = false;
 		}
+		UpdateData->bUse16BitIndices = bCanUse16BitIndices;
+
+		return UpdateData;
+	}
+
+	FRuntimeMeshSectionCreateDataInterface* GetQuantizedSectionCreationData(FSceneInterface* InScene, UMaterialInterface* InMaterial, const FMaterialRelevance& MaterialRelevance,
+		const FRuntimeMeshQuantizationFrame& Frame) const
+	{
+		TArray<FRuntimeMeshVertexQuantized> QuantizedVertices;
+		FRuntimeMeshPackedVerticesBuilder<VertexType> Vertices(const_cast<TArray<VertexType>*>(&VertexBuffer));
+		if (!FRuntimeMeshQuantizer::Quantize(Vertices, Frame, QuantizedVertices))
+		{
+			return nullptr;
+		}
+
+		auto UpdateData = new FRuntimeMeshSectionCreateData<FRuntimeMeshVertexQuantized>();
+		UpdateData->NewProxy = new FRuntimeMeshQuantizedSectionProxy(InScene, bIsVisible, bCastsShadow, InMaterial, MaterialRelevance, Frame, sizeof(VertexType));
+		const_cast<FRuntimeMeshSection*>(this)->bShouldUseAdjacencyIndexBuffer = UpdateData->NewProxy->ShouldUseAdjacencyIndexBuffer();
+
+		UpdateData->VertexBuffer = MoveTemp(QuantizedVertices);
+
+		if (bShouldUseAdjacencyIndexBuffer && TessellationIndexBuffer.Num() > 0)
+		{
+			UpdateData->IndexBuffer = TessellationIndexBuffer;
+			UpdateData->bIsAdjacencyIndexBuffer = true;
+		}
+		else
+		{
+			UpdateData->IndexBuffer = IndexBuffer;
+			UpdateData->bIsAdjacencyIndexBuffer = false;
+		}
+		UpdateData->bUse16BitIndices = bCanUse16BitIndices;
 
 		return UpdateData;
 	}
@@ -486,6 +784,7 @@ protected:
 				UpdateData->IndexBuffer = IndexBuffer;
 				UpdateData->bIsAdjacencyIndexBuffer = false;
 			}
+			UpdateData->bUse16BitIndices = bCanUse16BitIndices;
 		}
 
 		return UpdateData;
@@ -518,17 +817,14 @@ protected:
 		}
 #endif
 
-		for (int VertexIdx = 0; VertexIdx < VerticesBuilder.Length(); VertexIdx++)
-		{
-			Positions[PositionStart + VertexIdx] = VerticesBuilder.GetPosition(VertexIdx);
+		VerticesBuilder.GetPositionRange(0, VerticesBuilder.Length(), Positions.GetData() + PositionStart);
 
 #if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 13
-			if (bIncludeUVs && VerticesBuilder.HasUVComponent(0))
-			{
-				UVs[0][PositionStart + VertexIdx] = VerticesBuilder.GetUV(0);
-			}
-#endif
+		if (bIncludeUVs && VerticesBuilder.HasUVComponent(0))
+		{
+			VerticesBuilder.GetUVRange(0, 0, VerticesBuilder.Length(), UVs[0].GetData() + PositionStart);
 		}
+#endif
 
 		return VerticesBuilder.Length();
 	}
@@ -541,6 +837,60 @@ protected:
 
 	virtual const FRuntimeMeshVertexTypeInfo* GetVertexType() const { return &VertexType::TypeInfo; }
 
+	virtual void SerializeMeshData(FArchive& Ar) override
+	{
+		Ar << VertexBuffer;
+		FRuntimeMeshSectionInterface::SerializeMeshData(Ar);
+	}
+
+	virtual void EmptyVertexBuffer() override
+	{
+		VertexBuffer.Empty();
+	}
+
+	virtual int32 GetNumVertices() const override
+	{
+		return VertexBuffer.Num();
+	}
+
+	virtual TSharedPtr<FRuntimeMeshSectionInterface> MergeUpdate(FRuntimeMeshSectionInterface* Update, TArray<FVector>* Positions, bool bHasVertices, bool bHasIndices) const override
+	{
+		FRuntimeMeshSection<VertexType>* TypedUpdate = static_cast<FRuntimeMeshSection<VertexType>*>(Update);
+		check(TypedUpdate || (!bHasVertices && !bHasIndices));
+
+		TSharedPtr<FRuntimeMeshSection<VertexType>> Section = MakeShareable(new FRuntimeMeshSection<VertexType>(bNeedsPositionOnlyBuffer));
+		if (bNeedsPositionOnlyBuffer)
+		{
+			Section->PositionVertexBuffer = Positions ? MoveTemp(*Positions) : PositionVertexBuffer;
+		}
+
+		Section->VertexBuffer = bHasVertices ? MoveTemp(TypedUpdate->VertexBuffer) : VertexBuffer;
+
+		if (bHasIndices)
+		{
+			Section->IndexBuffer = MoveTemp(TypedUpdate->IndexBuffer);
+			Section->TessellationIndexBuffer = MoveTemp(TypedUpdate->TessellationIndexBuffer);
+		}
+		else
+		{
+			Section->IndexBuffer = IndexBuffer;
+			Section->TessellationIndexBuffer = TessellationIndexBuffer;
+		}
+
+		// The caller replaces these when the update changes them
+		Section->LocalBoundingBox = LocalBoundingBox;
+		Section->CollisionEnabled = CollisionEnabled;
+		Section->UpdateFrequency = UpdateFrequency;
+		return Section;
+	}
+
+	virtual void GetVertexBufferMemory(int64& OutCPUBytes, int64& OutGPUBytes) const override
+	{
+		OutCPUBytes = VertexBuffer.GetAllocatedSize();
+
+		OutGPUBytes = (int64)VertexBuffer.Num() * (bIsQuantizedOnGPU ? sizeof(FRuntimeMeshVertexQuantized) : sizeof(VertexType));
+	}
+
 	virtual void GenerateNormalTangent()
 	{
 		if (IsDualBufferSection())
@@ -567,6 +917,38 @@ protected:
 		UpdateTessellationIndexBuffer(TessellationIndices, true);
 	}
 
+	virtual void OptimizeMesh() override
+	{
+		TArray<FVector> VertexPositions;
+		if (!IsDualBufferSection())
+		{
+			RuntimeMeshSectionInternal::GetPositions<VertexType>(VertexBuffer, VertexPositions);
+		}
+		const TArray<FVector>& Positions = IsDualBufferSection() ? PositionVertexBuffer : VertexPositions;
+		if (Positions.Num() != VertexBuffer.Num())
+		{
+			return;
+		}
+
+		TArray<int32> NewToOld;
+		FRuntimeMeshCacheStats Before, After;
+		FRuntimeMeshOptimizer::Optimize(IndexBuffer, Positions, NewToOld, &Before, &After);
+		if (NewToOld.Num() == 0)
+		{
+			return;
+		}
+
+		FRuntimeMeshOptimizer::RemapVertices(VertexBuffer, NewToOld);
+		FRuntimeMeshOptimizer::RemapVertices(PositionVertexBuffer, NewToOld);
+		if (TessellationIndexBuffer.Num() > 0)
+		{
+			GenerateTessellationIndices();
+		}
+
+		UE_LOG(RuntimeMeshLog, Verbose, TEXT("Optimized %d triangles: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f"),
+			After.NumTriangles, Before.GetACMR(), After.GetACMR(), Before.GetATVR(), After.GetATVR());
+	}
+
 	virtual void RecalculateBoundingBox() override
 	{
 		LocalBoundingBox.Init();
@@ -805,6 +1187,7 @@ public:
 	}
 
 	friend class URuntimeMeshComponent;
+	friend class FRuntimeMeshAsync;
 };
 
 
@@ -34,6 +34,17 @@ public:
 	virtual void FinishPositionUpdate_RenderThread(FRuntimeMeshRenderThreadCommandInterface* UpdateData) = 0;
 	virtual void FinishPropertyUpdate_RenderThread(FRuntimeMeshRenderThreadCommandInterface* UpdateData) = 0;
 
+	/** Whether the vertices of this section are in a space of their own that GetSectionTransform maps to component space */
+	virtual bool HasSectionTransform() const { return false; }
+	virtual FMatrix GetSectionTransform() const { return FMatrix::Identity; }
+
+	/** Sections with a transform render with their own primitive uniform buffer, kept up to date by the scene proxy */
+	virtual void SetPrimitiveUniformShaderParameters(const FPrimitiveUniformShaderParameters& Parameters) { }
+	virtual const TUniformBuffer<FPrimitiveUniformShaderParameters>* GetPrimitiveUniformBuffer() const { return nullptr; }
+
+	/** Size of the proxy with its vertex and index buffers, for the memory footprint of the scene proxy */
+	virtual SIZE_T GetAllocatedSize() const = 0;
+
 };
 
 /** Templated class for the RT proxy of a single mesh section */
@@ -101,6 +112,16 @@ public:
 	virtual bool ShouldUseAdjacencyIndexBuffer() const override { return bShouldUseAdjacency; }
 
 	virtual FMaterialRelevance GetMaterialRelevance() const { return MaterialRelevance; }
+
+	virtual SIZE_T GetAllocatedSize() const override
+	{
+		SIZE_T Size = sizeof(*this) + VertexBuffer.GetAllocatedBytes() + IndexBuffer.GetAllocatedBytes();
+		if (PositionVertexBuffer)
+		{
+			Size += sizeof(*PositionVertexBuffer) + PositionVertexBuffer->GetAllocatedBytes();
+		}
+		return Size;
+	}
 	
 	virtual void CreateMeshBatch(FMeshBatch& MeshBatch, FMaterialRenderProxy* WireframeMaterial, bool bIsSelected) override
 	{
@@ -168,7 +189,7 @@ public:
 		}
 		
 		auto& Indices = SectionUpdateData->IndexBuffer;
-		IndexBuffer.SetNum(Indices.Num());
+		IndexBuffer.SetNum(Indices.Num(), SectionUpdateData->bUse16BitIndices);
 		IndexBuffer.SetData(Indices);
 		bIsUsingAdjacency = SectionUpdateData->bIsAdjacencyIndexBuffer;
 	}
@@ -197,7 +218,7 @@ public:
 		if (SectionUpdateData->bIncludeIndices)
 		{
 			auto& IndexBufferData = SectionUpdateData->IndexBuffer;
-			IndexBuffer.SetNum(IndexBufferData.Num());
+			IndexBuffer.SetNum(IndexBufferData.Num(), SectionUpdateData->bUse16BitIndices);
 			IndexBuffer.SetData(IndexBufferData);
 			bIsUsingAdjacency = SectionUpdateData->bIsAdjacencyIndexBuffer;
 		}
@@ -63,8 +63,11 @@ public:
 	/* Updated index buffer for the section */
 	TArray<int32> IndexBuffer;
 
+	/* Whether every index fits in 16 bits so the RHI buffer can be packed */
+	bool bUse16BitIndices;
 
-	FRuntimeMeshSectionCreateData() {}
+
+	FRuntimeMeshSectionCreateData() : bUse16BitIndices(false) {}
 	virtual ~FRuntimeMeshSectionCreateData() override { }
 
 };
@@ -95,7 +98,10 @@ public:
 	/* Whether the supplied index buffer contains adjacency info */
 	bool bIsAdjacencyIndexBuffer;
 
-	FRuntimeMeshSectionUpdateData() {}
+	/* Whether every index fits in 16 bits so the RHI buffer can be packed */
+	bool bUse16BitIndices;
+
+	FRuntimeMeshSectionUpdateData() : bUse16BitIndices(false) {}
 	virtual ~FRuntimeMeshSectionUpdateData() override { }
 };
 
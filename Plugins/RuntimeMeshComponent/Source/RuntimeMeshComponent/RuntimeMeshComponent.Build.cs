@@ -34,6 +34,13 @@ public class RuntimeMeshComponent : ModuleRules
                         "RHI"
                 }
             );
+        PrivateDependencyModuleNames.AddRange(
+                new string[]
+                {
+                        "Sockets",
+                        "Networking"
+                }
+            );
         if (UEBuildConfiguration.bBuildEditor)
         {
             PublicDependencyModuleNames.AddRange(
@@ -55,6 +62,12 @@ public class RuntimeMeshComponent : ModuleRules
             PublicLibraryPaths.Add(LibraryPath);
             PublicAdditionalLibraries.Add(Path.Combine(LibraryPath, "liber.lib"));
             PublicIncludePaths.Add(Path.Combine(ThirdPartyPath, "ERSDK", "include"));
+            Definitions.Add("WITH_ERSDK=1");
+        }
+        else
+        {
+            // Ess files are read by the plugin's own reader where the SDK isn't available
+            Definitions.Add("WITH_ERSDK=0");
         }
     }
     
@@ -4,12 +4,16 @@
 #include "RuntimeMeshComponentDetails.h"
 #include "RuntimeMeshComponent.h"
 
+#include "RuntimeMeshStaticMeshConverter.h"
+#include "RuntimeMeshEssSceneConverter.h"
+#include "RuntimeMeshAmbientOcclusion.h"
+
 #include "DlgPickAssetPath.h"
 #include "IAssetTools.h"
 #include "AssetToolsModule.h"
-#include "AssetRegistryModule.h"
-#include "PhysicsEngine/PhysicsSettings.h"
-#include "PhysicsEngine/BodySetup.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Widgets/Notifications/SNotificationList.h"
 
 #define LOCTEXT_NAMESPACE "RuntimeMeshComponentDetails"
 
@@ -38,7 +42,7 @@ void FRuntimeMeshComponentDetails::CustomizeDetails( IDetailLayoutBuilder& Detai
 	[
 		SNew(SButton)
 		.VAlign(VAlign_Center)
-		.ToolTipText(LOCTEXT("ConvertToStaticMeshTooltip", "Create a new StaticMesh asset using current geometry from this RuntimeMeshComponent. Does not modify instance."))
+		.ToolTipText(LOCTEXT("ConvertToStaticMeshTooltip", "Create new StaticMesh assets using current geometry from the selected RuntimeMeshComponents. Does not modify instances."))
 		.OnClicked(this, &FRuntimeMeshComponentDetails::ClickedOnConvertToStaticMesh)
 		.IsEnabled(this, &FRuntimeMeshComponentDetails::ConvertToStaticMeshEnabled)
 		.Content()
@@ -47,6 +51,52 @@ void FRuntimeMeshComponentDetails::CustomizeDetails( IDetailLayoutBuilder& Detai
 			.Text(ConvertToStaticMeshText)
 		]
 	];
+
+	const FText BakeAmbientOcclusionText = LOCTEXT("BakeAmbientOcclusion", "Bake Ambient Occlusion");
+
+	RuntimeMeshCategory.AddCustomRow(BakeAmbientOcclusionText, false)
+	.NameContent()
+	[
+		SNullWidget::NullWidget
+	]
+	.ValueContent()
+	.VAlign(VAlign_Center)
+	.MaxDesiredWidth(250)
+	[
+		SNew(SButton)
+		.VAlign(VAlign_Center)
+		.ToolTipText(LOCTEXT("BakeAmbientOcclusionTooltip", "Ray trace ambient occlusion for every vertex of the selected RuntimeMeshComponents and store it in their vertex colors. The selected components occlude each other."))
+		.OnClicked(this, &FRuntimeMeshComponentDetails::ClickedOnBakeAmbientOcclusion)
+		.IsEnabled(this, &FRuntimeMeshComponentDetails::ConvertToStaticMeshEnabled)
+		.Content()
+		[
+			SNew(STextBlock)
+			.Text(BakeAmbientOcclusionText)
+		]
+	];
+
+	const FText ConvertEssSceneText = LOCTEXT("ConvertEssScene", "Convert Ess Scene");
+
+	RuntimeMeshCategory.AddCustomRow(ConvertEssSceneText, false)
+	.NameContent()
+	[
+		SNullWidget::NullWidget
+	]
+	.ValueContent()
+	.VAlign(VAlign_Center)
+	.MaxDesiredWidth(250)
+	[
+		SNew(SButton)
+		.VAlign(VAlign_Center)
+		.ToolTipText(LOCTEXT("ConvertEssSceneTooltip", "Create one StaticMesh asset per unique ess mesh of the imported scene this component belongs to, and place them as instanced static meshes in a new actor. The imported actor is hidden."))
+		.OnClicked(this, &FRuntimeMeshComponentDetails::ClickedOnConvertEssScene)
+		.IsEnabled(this, &FRuntimeMeshComponentDetails::ConvertEssSceneEnabled)
+		.Content()
+		[
+			SNew(STextBlock)
+			.Text(ConvertEssSceneText)
+		]
+	];
 }
 
 URuntimeMeshComponent* FRuntimeMeshComponentDetails::GetFirstSelectedRuntimeMeshComp() const
@@ -67,6 +117,21 @@ URuntimeMeshComponent* FRuntimeMeshComponentDetails::GetFirstSelectedRuntimeMesh
 	return RuntimeMeshComp;
 }
 
+TArray<URuntimeMeshComponent*> FRuntimeMeshComponentDetails::GetSelectedRuntimeMeshComps() const
+{
+	TArray<URuntimeMeshComponent*> RuntimeMeshComps;
+	for (const TWeakObjectPtr<UObject>& Object : SelectedObjectsList)
+	{
+		URuntimeMeshComponent* TestRuntimeComp = Cast<URuntimeMeshComponent>(Object.Get());
+		if (TestRuntimeComp != nullptr && !TestRuntimeComp->IsTemplate())
+		{
+			RuntimeMeshComps.AddUnique(TestRuntimeComp);
+		}
+	}
+
+	return RuntimeMeshComps;
+}
+
 
 bool FRuntimeMeshComponentDetails::ConvertToStaticMeshEnabled() const
 {
@@ -76,187 +141,98 @@ bool FRuntimeMeshComponentDetails::ConvertToStaticMeshEnabled() const
 
 FReply FRuntimeMeshComponentDetails::ClickedOnConvertToStaticMesh()
 {
- 	// Find first selected RuntimeMeshComp
- 	URuntimeMeshComponent* RuntimeMeshComp = GetFirstSelectedRuntimeMeshComp();
- 	if (RuntimeMeshComp != nullptr)
- 	{
- 		FString NewNameSuggestion = FString(TEXT("RuntimeMeshComp"));
- 		FString PackageName = FString(TEXT("/Game/Meshes/")) + NewNameSuggestion;
- 		FString Name;
- 		FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
- 		AssetToolsModule.Get().CreateUniqueAssetName(PackageName, TEXT(""), PackageName, Name);
- 
- 		TSharedPtr<SDlgPickAssetPath> PickAssetPathWidget =
- 			SNew(SDlgPickAssetPath)
- 			.Title(LOCTEXT("ConvertToStaticMeshPickName", "Choose New StaticMesh Location"))
- 			.DefaultAssetPath(FText::FromString(PackageName));
- 
- 		if (PickAssetPathWidget->ShowModal() == EAppReturnType::Ok)
- 		{
- 			// Get the full name of where we want to create the physics asset.
- 			FString UserPackageName = PickAssetPathWidget->GetFullAssetPath().ToString();
- 			FName MeshName(*FPackageName::GetLongPackageAssetName(UserPackageName));
- 
- 			// Check if the user inputed a valid asset name, if they did not, give it the generated default name
- 			if (MeshName == NAME_None)
- 			{
- 				// Use the defaults that were already generated.
- 				UserPackageName = PackageName;
- 				MeshName = *Name;
- 			}
- 
- 			// Raw mesh data we are filling in
- 			FRawMesh RawMesh;
- 					
-			// Unique Materials to apply to new mesh
-#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 14
-			TArray<FStaticMaterial> Materials;
-#else
-			TArray<UMaterialInterface*> Materials;
-#endif
- 
-			bool bUseHighPrecisionTangents = false;
-			bool bUseFullPrecisionUVs = false;
-
- 			const int32 NumSections = RuntimeMeshComp->GetNumSections();
- 			int32 VertexBase = 0;
- 			for (int32 SectionIdx = 0; SectionIdx < NumSections; SectionIdx++)
- 			{
-				const IRuntimeMeshVerticesBuilder* Vertices;
-				const FRuntimeMeshIndicesBuilder* Indices;
-				RuntimeMeshComp->GetSectionMesh(SectionIdx, Vertices, Indices);
-
-				if (Vertices->HasHighPrecisionNormals())
-				{
-					bUseHighPrecisionTangents = true;
-				}
-				if (Vertices->HasHighPrecisionUVs())
-				{
-					bUseFullPrecisionUVs = true;
-				}
- 
- 				// Copy verts
-				Vertices->Seek(-1);
-				while (Vertices->MoveNext() < Vertices->Length())
-				{
-					RawMesh.VertexPositions.Add(Vertices->GetPosition());
-				}
- 
- 				// Copy 'wedge' info
-				Indices->Seek(0);
-				while (Indices->HasRemaining())
- 				{
-					int32 Index = Indices->ReadOne();
- 
- 					RawMesh.WedgeIndices.Add(Index + VertexBase);
- 
-
-					Vertices->Seek(Index);
- 
-					FVector TangentX = Vertices->GetTangent();
-					FVector TangentZ = Vertices->GetNormal();
- 					FVector TangentY = (TangentX ^ TangentZ).GetSafeNormal() * Vertices->GetNormal().W;
- 
- 					RawMesh.WedgeTangentX.Add(TangentX);
- 					RawMesh.WedgeTangentY.Add(TangentY);
- 					RawMesh.WedgeTangentZ.Add(TangentZ);
- 
-					for (int UVIndex = 0; UVIndex < 8; UVIndex++)
-					{
-						if (!Vertices->HasUVComponent(UVIndex))
-						{
-							break;
-						}
-						RawMesh.WedgeTexCoords[UVIndex].Add(Vertices->GetUV(UVIndex));
-					}
-
- 					RawMesh.WedgeColors.Add(Vertices->GetColor());
- 				}
- 
-				// Find a material index for this section.
-				UMaterialInterface* Material = RuntimeMeshComp->GetMaterial(SectionIdx);
-
-#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 14
-				int32 MaterialIndex = Materials.AddUnique(FStaticMaterial(Material));
-#else
-				int32 MaterialIndex = Materials.AddUnique(Material);
-#endif
-				
-
- 				// copy face info
- 				int32 NumTris = Indices->Length() / 3;
- 				for (int32 TriIdx=0; TriIdx < NumTris; TriIdx++)
- 				{
-					// Set the face material
-					RawMesh.FaceMaterialIndices.Add(MaterialIndex);
-
- 					RawMesh.FaceSmoothingMasks.Add(0); // Assume this is ignored as bRecomputeNormals is false
- 				}
- 
- 				// Update offset for creating one big index/vertex buffer
-				VertexBase += Vertices->Length();
- 			}
- 
- 			// If we got some valid data.
- 			if (RawMesh.VertexPositions.Num() >= 3 && RawMesh.WedgeIndices.Num() >= 3)
- 			{
- 				// Then find/create it.
- 				UPackage* Package = CreatePackage(NULL, *UserPackageName);
- 				check(Package);
- 
- 				// Create StaticMesh object
- 				UStaticMesh* StaticMesh = NewObject<UStaticMesh>(Package, MeshName, RF_Public | RF_Standalone);
- 				StaticMesh->InitResources();
- 
- 				StaticMesh->LightingGuid = FGuid::NewGuid();
- 
- 				// Add source to new StaticMesh
- 				FStaticMeshSourceModel* SrcModel = new (StaticMesh->SourceModels) FStaticMeshSourceModel();
- 				SrcModel->BuildSettings.bRecomputeNormals = false;
- 				SrcModel->BuildSettings.bRecomputeTangents = false;
- 				SrcModel->BuildSettings.bRemoveDegenerates = false;
- 				SrcModel->BuildSettings.bUseHighPrecisionTangentBasis = bUseHighPrecisionTangents;
-				SrcModel->BuildSettings.bUseFullPrecisionUVs = bUseFullPrecisionUVs;
- 				SrcModel->BuildSettings.bGenerateLightmapUVs = true;
- 				SrcModel->BuildSettings.SrcLightmapIndex = 0;
- 				SrcModel->BuildSettings.DstLightmapIndex = 1;
- 				SrcModel->RawMeshBulkData->SaveRawMesh(RawMesh);
- 
-				// Set the materials used for this static mesh
-#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 14
-				StaticMesh->StaticMaterials = Materials;
-				int32 NumMaterials = StaticMesh->StaticMaterials.Num();
-#else
-				StaticMesh->Materials = Materials;
-				int32 NumMaterials = StaticMesh->Materials.Num();
-#endif
-
-				// Set up the SectionInfoMap to enable collision
-				for (int32 SectionIdx = 0; SectionIdx < NumMaterials; SectionIdx++)
-				{
-					FMeshSectionInfo Info = StaticMesh->SectionInfoMap.Get(0, SectionIdx);
-					Info.MaterialIndex = SectionIdx;
-					Info.bEnableCollision = true;
-					StaticMesh->SectionInfoMap.Set(0, SectionIdx, Info);
-				}
-
-				// Configure body setup for working collision.
-				StaticMesh->CreateBodySetup();
-				StaticMesh->BodySetup->CollisionTraceFlag = CTF_UseComplexAsSimple;
-
- 				// Build mesh from source
- 				StaticMesh->Build(false);
-
-				// Make package dirty.
-				StaticMesh->MarkPackageDirty();
-
- 				StaticMesh->PostEditChange();
- 
- 				// Notify asset registry of new asset
- 				FAssetRegistryModule::AssetCreated(StaticMesh);
- 			}
- 		}
- 	}
+	TArray<URuntimeMeshComponent*> RuntimeMeshComps = GetSelectedRuntimeMeshComps();
+	if (RuntimeMeshComps.Num() == 0)
+	{
+		return FReply::Handled();
+	}
+
+	// Several components can either become one asset or one asset each
+	bool bMerge = false;
+	if (RuntimeMeshComps.Num() > 1)
+	{
+		EAppReturnType::Type MergeResult = FMessageDialog::Open(EAppMsgType::YesNoCancel,
+			FText::Format(LOCTEXT("ConvertToStaticMeshMerge", "{0} RuntimeMeshComponents are selected. Merge them into a single StaticMesh?\n\nNo creates one StaticMesh per component."), FText::AsNumber(RuntimeMeshComps.Num())));
+		if (MergeResult == EAppReturnType::Cancel)
+		{
+			return FReply::Handled();
+		}
+		bMerge = MergeResult == EAppReturnType::Yes;
+	}
+
+	FString NewNameSuggestion = FString(TEXT("RuntimeMeshComp"));
+	FString PackageName = FString(TEXT("/Game/Meshes/")) + NewNameSuggestion;
+	FString Name;
+	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+	AssetToolsModule.Get().CreateUniqueAssetName(PackageName, TEXT(""), PackageName, Name);
+
+	TSharedPtr<SDlgPickAssetPath> PickAssetPathWidget =
+		SNew(SDlgPickAssetPath)
+		.Title(LOCTEXT("ConvertToStaticMeshPickName", "Choose New StaticMesh Location"))
+		.DefaultAssetPath(FText::FromString(PackageName));
+
+	if (PickAssetPathWidget->ShowModal() == EAppReturnType::Ok)
+	{
+		// Get the full name of where we want to create the physics asset.
+		FString UserPackageName = PickAssetPathWidget->GetFullAssetPath().ToString();
+		FName MeshName(*FPackageName::GetLongPackageAssetName(UserPackageName));
+
+		// Check if the user inputed a valid asset name, if they did not, give it the generated default name
+		if (MeshName == NAME_None)
+		{
+			// Use the defaults that were already generated.
+			UserPackageName = PackageName;
+		}
+
+		FRuntimeMeshStaticMeshConverter::Convert(RuntimeMeshComps, UserPackageName, bMerge);
+	}
+
+	return FReply::Handled();
+}
+
+
+FReply FRuntimeMeshComponentDetails::ClickedOnBakeAmbientOcclusion()
+{
+	TArray<URuntimeMeshComponent*> RuntimeMeshComps = GetSelectedRuntimeMeshComps();
+	if (RuntimeMeshComps.Num() == 0)
+	{
+		return FReply::Handled();
+	}
+
+	FRuntimeMeshAOBakeStats Stats;
+	{
+		FScopedSlowTask SlowTask(1.0f, LOCTEXT("BakingAmbientOcclusion", "Baking ambient occlusion..."));
+		SlowTask.MakeDialog();
+		SlowTask.EnterProgressFrame();
+		Stats = FRuntimeMeshAOBaker::Bake(RuntimeMeshComps, FRuntimeMeshAOBakeSettings());
+	}
+
+	FFormatNamedArguments Args;
+	Args.Add(TEXT("Vertices"), FText::AsNumber(Stats.NumVertices));
+	Args.Add(TEXT("Seconds"), FText::AsNumber(Stats.BuildSeconds + Stats.TraceSeconds));
+	Args.Add(TEXT("MRays"), FText::AsNumber(Stats.GetRaysPerSecond() / 1000000.0));
+	FNotificationInfo Info(FText::Format(LOCTEXT("BakedAmbientOcclusion", "Baked ambient occlusion for {Vertices} vertices in {Seconds}s ({MRays} Mrays/s)"), Args));
+	Info.ExpireDuration = 5.0f;
+	FSlateNotificationManager::Get().AddNotification(Info);
+
+	return FReply::Handled();
+}
+
+
+bool FRuntimeMeshComponentDetails::ConvertEssSceneEnabled() const
+{
+	URuntimeMeshComponent* RuntimeMeshComp = GetFirstSelectedRuntimeMeshComp();
+	return RuntimeMeshComp != nullptr && FRuntimeMeshEssSceneConverter::IsEssSceneActor(RuntimeMeshComp->GetOwner());
+}
+
+
+FReply FRuntimeMeshComponentDetails::ClickedOnConvertEssScene()
+{
+	URuntimeMeshComponent* RuntimeMeshComp = GetFirstSelectedRuntimeMeshComp();
+	if (RuntimeMeshComp != nullptr)
+	{
+		FRuntimeMeshEssSceneConverter::Convert(RuntimeMeshComp->GetOwner());
+	}
 
 	return FReply::Handled();
 }
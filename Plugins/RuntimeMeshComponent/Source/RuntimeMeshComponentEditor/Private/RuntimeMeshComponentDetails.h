@@ -19,9 +19,21 @@ public:
 	/** Is the convert button enabled */
 	bool ConvertToStaticMeshEnabled() const;
 
+	/** Handle clicking the bake ambient occlusion button */
+	FReply ClickedOnBakeAmbientOcclusion();
+
+	/** Handle clicking the convert ess scene button */
+	FReply ClickedOnConvertEssScene();
+
+	/** Is the convert ess scene button enabled */
+	bool ConvertEssSceneEnabled() const;
+
 	/** Util to get the RuntimeMeshComponent we want to convert */
 	class URuntimeMeshComponent* GetFirstSelectedRuntimeMeshComp() const;
 
+	/** Util to get every selected RuntimeMeshComponent */
+	TArray<class URuntimeMeshComponent*> GetSelectedRuntimeMeshComps() const;
+
 	/** Cached array of selected objects */
 	TArray< TWeakObjectPtr<UObject> > SelectedObjectsList;
 };
\ No newline at end of file
@@ -0,0 +1,309 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentEditorPrivatePCH.h"
+#include "RuntimeMeshEssSceneConverter.h"
+#include "RuntimeMeshStaticMeshConverter.h"
+#include "RuntimeMeshComponent.h"
+#include "RuntimeMeshLibrary.h"
+
+#include "IAssetTools.h"
+#include "AssetToolsModule.h"
+#include "ObjectTools.h"
+#include "ScopedTransaction.h"
+#include "EngineUtils.h"
+#include "Engine/Selection.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Async/ParallelFor.h"
+
+#define LOCTEXT_NAMESPACE "RuntimeMeshEssSceneConverter"
+
+DEFINE_LOG_CATEGORY_STATIC(LogEssSceneConverter, Log, All);
+
+namespace
+{
+	/** One StaticMesh asset, shared by every node using the same ess mesh */
+	struct FEssMeshGroup
+	{
+		FEssMeshGroup() : Source(nullptr), NumSlots(0), StaticMesh(nullptr) { }
+
+		FString MeshName;
+		URuntimeMeshComponent* Source;
+		/** Material slot of every section of the source, in the order ExtractRawMesh adds them */
+		TArray<int32> SectionSlots;
+		int32 NumSlots;
+		FRuntimeMeshRawMeshSource SourceSections;
+		FRuntimeMeshRawMeshData Data;
+		UStaticMesh* StaticMesh;
+	};
+
+	/** One instanced component, the nodes of a group that also share their materials and handedness */
+	struct FEssInstanceBatch
+	{
+		int32 GroupIndex;
+		bool bMirrored;
+		TArray<UMaterialInterface*> SlotMaterials;
+		TArray<FTransform> Transforms;
+	};
+
+	/**
+	 * Instanced meshes only reverse culling for the determinant of the component, not per instance.
+	 * Mirrored batches put the mirror on the component and take it back out of every instance so they share the asset of the others.
+	 */
+	const FVector MirrorScale(-1.0f, 1.0f, 1.0f);
+
+	FTransform UnmirrorInstanceTransform(const FTransform& Transform)
+	{
+		return FTransform(Transform.ToMatrixWithScale() * FScaleMatrix(MirrorScale));
+	}
+
+	void GetSectionMaterials(URuntimeMeshComponent* Component, TArray<UMaterialInterface*>& OutMaterials)
+	{
+		const int32 LastSectionIdx = Component->GetLastSectionIndex();
+		for (int32 SectionIdx = 0; SectionIdx <= LastSectionIdx; SectionIdx++)
+		{
+			if (Component->DoesSectionExist(SectionIdx))
+			{
+				OutMaterials.Add(Component->GetMaterial(SectionIdx));
+			}
+		}
+	}
+}
+
+bool FRuntimeMeshEssSceneConverter::IsEssSceneActor(const AActor* Actor)
+{
+	if (Actor == nullptr)
+	{
+		return false;
+	}
+
+	TInlineComponentArray<URuntimeMeshComponent*> Components;
+	Actor->GetComponents(Components);
+	for (URuntimeMeshComponent* Component : Components)
+	{
+		if (!URuntimeMeshLibrary::GetEssMeshName(Component).IsEmpty())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+AActor* FRuntimeMeshEssSceneConverter::FindEssSceneActor()
+{
+	for (FSelectionIterator It(GEditor->GetSelectedActorIterator()); It; ++It)
+	{
+		AActor* Actor = Cast<AActor>(*It);
+		if (IsEssSceneActor(Actor))
+		{
+			return Actor;
+		}
+	}
+
+	UWorld* World = GEditor->GetEditorWorldContext().World();
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		if (IsEssSceneActor(*It))
+		{
+			return *It;
+		}
+	}
+	return nullptr;
+}
+
+AActor* FRuntimeMeshEssSceneConverter::Convert(AActor* SceneActor, const FString& PackagePath)
+{
+	if (!IsEssSceneActor(SceneActor))
+	{
+		return nullptr;
+	}
+
+	const FString AssetPath = PackagePath.IsEmpty() ? FString(TEXT("/Game/Meshes/")) + ObjectTools::SanitizeObjectName(SceneActor->GetActorLabel()) : PackagePath;
+	const FTransform SceneTransform = SceneActor->GetActorTransform();
+
+	// Group the nodes by the mesh they were created from, mirrored nodes share the triangles of the others
+	TArray<FEssMeshGroup> Groups;
+	TMap<FString, int32> GroupMap;
+	TMap<URuntimeMeshComponent*, int32> ComponentGroups;
+	TInlineComponentArray<URuntimeMeshComponent*> Components;
+	SceneActor->GetComponents(Components);
+	for (URuntimeMeshComponent* Component : Components)
+	{
+		FString MeshName = URuntimeMeshLibrary::GetEssMeshName(Component);
+		if (MeshName.IsEmpty())
+		{
+			// Not imported, nothing to share it with
+			MeshName = Component->GetName();
+		}
+
+		int32* GroupIndex = GroupMap.Find(MeshName);
+		if (GroupIndex == nullptr)
+		{
+			GroupIndex = &GroupMap.Add(MeshName, Groups.AddDefaulted());
+			FEssMeshGroup& Group = Groups[*GroupIndex];
+			Group.MeshName = MeshName;
+			Group.Source = Component;
+
+			TArray<UMaterialInterface*> SectionMaterials;
+			TArray<UMaterialInterface*> UniqueMaterials;
+			GetSectionMaterials(Component, SectionMaterials);
+			for (UMaterialInterface* Material : SectionMaterials)
+			{
+				Group.SectionSlots.Add(UniqueMaterials.AddUnique(Material));
+			}
+			Group.NumSlots = UniqueMaterials.Num();
+		}
+		ComponentGroups.Add(Component, *GroupIndex);
+	}
+
+	FScopedSlowTask SlowTask((float)(2 + Groups.Num() * 4), FText::Format(LOCTEXT("ConvertingEssScene", "Converting {0} to StaticMeshes..."), FText::FromString(SceneActor->GetActorLabel())));
+	SlowTask.MakeDialog(true);
+
+	// The components are only read on the game thread, converting their sections is independent per group
+	SlowTask.EnterProgressFrame(1.0f, FText::Format(LOCTEXT("ReadingEssMeshes", "Reading {0} meshes"), FText::AsNumber(Groups.Num())));
+	for (FEssMeshGroup& Group : Groups)
+	{
+		FRuntimeMeshStaticMeshConverter::GatherSections(TArray<URuntimeMeshComponent*>({ Group.Source }), TArray<FTransform>(), Group.SourceSections);
+	}
+	ParallelFor(Groups.Num(), [&](int32 GroupIdx)
+	{
+		FEssMeshGroup& Group = Groups[GroupIdx];
+		FRuntimeMeshStaticMeshConverter::ConvertSections(Group.SourceSections, Group.Data);
+	});
+	for (FEssMeshGroup& Group : Groups)
+	{
+		Group.SourceSections.Sections.Empty();
+	}
+
+	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+	int32 NumBuilt = 0;
+	for (FEssMeshGroup& Group : Groups)
+	{
+		if (SlowTask.ShouldCancel())
+		{
+			break;
+		}
+
+		FString AssetPackageName;
+		FString AssetName;
+		FString BaseName = ObjectTools::SanitizeObjectName(Group.MeshName);
+		AssetToolsModule.Get().CreateUniqueAssetName(AssetPath / BaseName, TEXT(""), AssetPackageName, AssetName);
+
+		SlowTask.EnterProgressFrame(4.0f, FText::Format(LOCTEXT("BuildingEssMesh", "Building {0}"), FText::FromString(AssetName)));
+		Group.StaticMesh = FRuntimeMeshStaticMeshConverter::CreateStaticMesh(AssetPackageName, *AssetName, Group.Data);
+		Group.Data = FRuntimeMeshRawMeshData();
+		NumBuilt += Group.StaticMesh != nullptr ? 1 : 0;
+	}
+
+	if (SlowTask.ShouldCancel() || NumBuilt == 0)
+	{
+		UE_LOG(LogEssSceneConverter, Warning, TEXT("Ess scene conversion of %s stopped, %d StaticMeshes were created in %s"), *SceneActor->GetActorLabel(), NumBuilt, *AssetPath);
+		return nullptr;
+	}
+
+	// Split the groups further by material, instances of one component all share its override materials
+	SlowTask.EnterProgressFrame(1.0f, LOCTEXT("PlacingEssInstances", "Placing instances"));
+	TArray<FEssInstanceBatch> Batches;
+	for (URuntimeMeshComponent* Component : Components)
+	{
+		const int32 GroupIndex = ComponentGroups.FindChecked(Component);
+		const FEssMeshGroup& Group = Groups[GroupIndex];
+		if (Group.StaticMesh == nullptr)
+		{
+			continue;
+		}
+
+		TArray<UMaterialInterface*> SectionMaterials;
+		GetSectionMaterials(Component, SectionMaterials);
+		TArray<UMaterialInterface*> SlotMaterials;
+		SlotMaterials.SetNumZeroed(Group.NumSlots);
+		for (int32 SectionIdx = SectionMaterials.Num() - 1; SectionIdx >= 0; SectionIdx--)
+		{
+			// Sections sharing a slot in the source keep the material of their first section
+			if (Group.SectionSlots.IsValidIndex(SectionIdx))
+			{
+				SlotMaterials[Group.SectionSlots[SectionIdx]] = SectionMaterials[SectionIdx];
+			}
+		}
+
+		const FTransform Transform = Component->GetComponentTransform().GetRelativeTransform(SceneTransform);
+		const bool bMirrored = Transform.GetDeterminant() < 0.0f;
+		FEssInstanceBatch* Batch = Batches.FindByPredicate([&](const FEssInstanceBatch& Other) { return Other.GroupIndex == GroupIndex && Other.bMirrored == bMirrored && Other.SlotMaterials == SlotMaterials; });
+		if (Batch == nullptr)
+		{
+			Batch = &Batches[Batches.AddDefaulted()];
+			Batch->GroupIndex = GroupIndex;
+			Batch->bMirrored = bMirrored;
+			Batch->SlotMaterials = SlotMaterials;
+		}
+		Batch->Transforms.Add(bMirrored ? UnmirrorInstanceTransform(Transform) : Transform);
+	}
+
+	const FScopedTransaction Transaction(LOCTEXT("ConvertEssSceneTransaction", "Convert Ess Scene to StaticMeshes"));
+	UWorld* World = SceneActor->GetWorld();
+	FActorSpawnParameters Parameters;
+	Parameters.Name = MakeUniqueObjectName(World->GetCurrentLevel(), AActor::StaticClass(), *(SceneActor->GetName() + TEXT("_Static")));
+	AActor* StaticActor = World->SpawnActor(AActor::StaticClass(), &SceneTransform, Parameters);
+	StaticActor->SetActorLabel(SceneActor->GetActorLabel() + TEXT("_Static"));
+
+	USceneComponent* RootComponent = NewObject<USceneComponent>(StaticActor, USceneComponent::GetDefaultSceneRootVariableName(), RF_Transactional);
+	RootComponent->Mobility = EComponentMobility::Static;
+	RootComponent->SetWorldTransform(SceneTransform);
+	StaticActor->SetRootComponent(RootComponent);
+	StaticActor->AddInstanceComponent(RootComponent);
+	RootComponent->RegisterComponent();
+
+	int32 NumInstances = 0;
+	for (const FEssInstanceBatch& Batch : Batches)
+	{
+		UStaticMesh* StaticMesh = Groups[Batch.GroupIndex].StaticMesh;
+		FName ComponentName = MakeUniqueObjectName(StaticActor, UInstancedStaticMeshComponent::StaticClass(), *StaticMesh->GetName());
+		UInstancedStaticMeshComponent* InstancedMesh = NewObject<UInstancedStaticMeshComponent>(StaticActor, ComponentName, RF_Transactional);
+		InstancedMesh->Mobility = EComponentMobility::Static;
+		InstancedMesh->SetStaticMesh(StaticMesh);
+		for (int32 SlotIdx = 0; SlotIdx < Batch.SlotMaterials.Num(); SlotIdx++)
+		{
+			if (Batch.SlotMaterials[SlotIdx] != StaticMesh->GetMaterial(SlotIdx))
+			{
+				InstancedMesh->SetMaterial(SlotIdx, Batch.SlotMaterials[SlotIdx]);
+			}
+		}
+		if (Batch.bMirrored)
+		{
+			InstancedMesh->SetRelativeScale3D(MirrorScale);
+		}
+		for (const FTransform& Transform : Batch.Transforms)
+		{
+			InstancedMesh->AddInstance(Transform);
+		}
+		NumInstances += Batch.Transforms.Num();
+
+		StaticActor->AddInstanceComponent(InstancedMesh);
+		InstancedMesh->RegisterComponent();
+		InstancedMesh->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepRelativeTransform);
+	}
+
+	// Keep the runtime meshes around until the result has been checked, they are only hidden
+	SceneActor->SetIsTemporarilyHiddenInEditor(true);
+
+	UE_LOG(LogEssSceneConverter, Log, TEXT("Converted %s: %d nodes to %d StaticMeshes in %s, %d instanced components"),
+		*SceneActor->GetActorLabel(), NumInstances, NumBuilt, *AssetPath, Batches.Num());
+	return StaticActor;
+}
+
+static FAutoConsoleCommand ConvertEssSceneCommand(
+	TEXT("RMC.ConvertEssScene"),
+	TEXT("Converts the selected ess scene actor, or the first one in the level, to StaticMesh assets and instanced static mesh components.\n")
+	TEXT("Optional argument: content folder for the assets, defaults to /Game/Meshes/<ActorLabel>"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		AActor* SceneActor = FRuntimeMeshEssSceneConverter::FindEssSceneActor();
+		if (SceneActor == nullptr)
+		{
+			UE_LOG(LogEssSceneConverter, Warning, TEXT("RMC.ConvertEssScene: no actor imported from an ess file found"));
+			return;
+		}
+		FRuntimeMeshEssSceneConverter::Convert(SceneActor, Args.Num() > 0 ? Args[0] : FString());
+	}));
+
+#undef LOCTEXT_NAMESPACE
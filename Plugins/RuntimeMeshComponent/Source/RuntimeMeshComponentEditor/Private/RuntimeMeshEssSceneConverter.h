@@ -0,0 +1,27 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#pragma once
+
+class AActor;
+
+/**
+ *	Converts the actor created by ImportEss into StaticMesh assets and instanced static mesh components.
+ *	One asset is built per unique ess mesh rather than per node, every node using it becomes an instance
+ *	that keeps its transform and materials. The source actor is only hidden, so the conversion can be undone.
+ */
+class FRuntimeMeshEssSceneConverter
+{
+public:
+	/** Whether the actor holds RuntimeMeshComponents created by ImportEss */
+	static bool IsEssSceneActor(const AActor* Actor);
+
+	/** Finds the actor to convert, the first selected ess scene actor or else the first one in the editor world */
+	static AActor* FindEssSceneActor();
+
+	/**
+	 *	Converts the scene with a cancellable progress dialog.
+	 *	@param PackagePath		Content folder the assets are created in, defaults to /Game/Meshes/<ActorLabel>
+	 *	@return					The spawned actor holding the instanced components, nullptr when nothing was converted
+	 */
+	static AActor* Convert(AActor* SceneActor, const FString& PackagePath = FString());
+};
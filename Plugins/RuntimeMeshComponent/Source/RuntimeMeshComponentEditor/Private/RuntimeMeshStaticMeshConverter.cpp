@@ -0,0 +1,406 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#include "RuntimeMeshComponentEditorPrivatePCH.h"
+#include "RuntimeMeshStaticMeshConverter.h"
+#include "RuntimeMeshComponent.h"
+
+#include "IAssetTools.h"
+#include "AssetToolsModule.h"
+#include "AssetRegistryModule.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Misc/ScopedSlowTask.h"
+#include "Async/ParallelFor.h"
+
+#define LOCTEXT_NAMESPACE "RuntimeMeshStaticMeshConverter"
+
+namespace
+{
+	/** Per vertex copy of one section, wedges index into it */
+	struct FSectionExtract
+	{
+		FSectionExtract() : NumUVs(0), Material(nullptr), VertexBase(0), WedgeBase(0), FaceBase(0) { }
+
+		TArray<FVector> Positions;
+		TArray<FVector> TangentX;
+		TArray<FVector> TangentY;
+		TArray<FVector> TangentZ;
+		TArray<FColor> Colors;
+		TArray<FVector2D> UVs[MAX_MESH_TEXTURE_COORDS];
+		TArray<int32> Indices;
+		int32 NumUVs;
+		UMaterialInterface* Material;
+		FTransform ToMeshSpace;
+
+		int32 VertexBase;
+		int32 WedgeBase;
+		int32 FaceBase;
+		int32 MaterialIndex;
+	};
+
+	/** Builders only return the components their vertex type has, missing entries take the default */
+	template<typename Type>
+	void FitToVertexCount(TArray<Type>& Array, int32 NumVertices, const Type& Default)
+	{
+		const int32 PreviousNum = Array.Num();
+		Array.SetNum(NumVertices, false);
+		for (int32 VertexIdx = PreviousNum; VertexIdx < NumVertices; VertexIdx++)
+		{
+			Array[VertexIdx] = Default;
+		}
+	}
+
+	void ReadSection(const IRuntimeMeshVerticesBuilder* Vertices, const FRuntimeMeshIndicesBuilder* Indices, FSectionExtract& Extract)
+	{
+		const int32 NumVertices = Vertices->Length();
+		while (Extract.NumUVs < MAX_MESH_TEXTURE_COORDS && Vertices->HasUVComponent(Extract.NumUVs))
+		{
+			Extract.NumUVs++;
+		}
+
+		TArray<FVector4> Normals;
+		Vertices->CopyPositions(Extract.Positions);
+		Vertices->CopyNormals(Normals);
+		Vertices->CopyTangents(Extract.TangentX);
+		Extract.TangentY.SetNumUninitialized(NumVertices);
+		Extract.TangentZ.SetNumUninitialized(NumVertices);
+		if (Vertices->HasColorComponent())
+		{
+			Vertices->CopyColors(Extract.Colors);
+		}
+		else
+		{
+			Extract.Colors.Init(FColor::Transparent, NumVertices);
+		}
+		for (int32 UVIndex = 0; UVIndex < Extract.NumUVs; UVIndex++)
+		{
+			Vertices->CopyUVs(UVIndex, Extract.UVs[UVIndex]);
+			FitToVertexCount(Extract.UVs[UVIndex], NumVertices, FVector2D::ZeroVector);
+		}
+		FitToVertexCount(Extract.Positions, NumVertices, FVector::ZeroVector);
+		FitToVertexCount(Normals, NumVertices, FVector4(0.0f, 0.0f, 1.0f, 1.0f));
+		FitToVertexCount(Extract.TangentX, NumVertices, FVector(1.0f, 0.0f, 0.0f));
+		FitToVertexCount(Extract.Colors, NumVertices, FColor::Transparent);
+
+		// Normals and tangents are transformed like the engine does for components, the inverse transpose keeps them perpendicular under non uniform scale
+		const FMatrix PositionMatrix = Extract.ToMeshSpace.ToMatrixWithScale();
+		const FMatrix NormalMatrix = PositionMatrix.InverseFast().GetTransposed();
+		const bool bIdentity = Extract.ToMeshSpace.Equals(FTransform::Identity);
+
+		for (int32 VertexIdx = 0; VertexIdx < NumVertices; VertexIdx++)
+		{
+			const FVector4& Normal = Normals[VertexIdx];
+			FVector& TangentX = Extract.TangentX[VertexIdx];
+			FVector TangentZ = Normal;
+			if (!bIdentity)
+			{
+				Extract.Positions[VertexIdx] = PositionMatrix.TransformPosition(Extract.Positions[VertexIdx]);
+				TangentX = PositionMatrix.TransformVector(TangentX).GetSafeNormal();
+				TangentZ = NormalMatrix.TransformVector(TangentZ).GetSafeNormal();
+			}
+
+			Extract.TangentY[VertexIdx] = (TangentX ^ TangentZ).GetSafeNormal() * Normal.W;
+			Extract.TangentZ[VertexIdx] = TangentZ;
+		}
+
+		const int32 NumIndices = Indices->Length() - Indices->Length() % 3;
+		Extract.Indices.SetNumUninitialized(NumIndices);
+		Indices->Seek(0);
+		for (int32 Index = 0; Index < NumIndices; Index++)
+		{
+			Extract.Indices[Index] = Indices->ReadOne();
+		}
+
+		// Triangles referencing vertices the section doesn't have would read past every per vertex array
+		int32 NumValidIndices = 0;
+		for (int32 Index = 0; Index < NumIndices; Index += 3)
+		{
+			const int32* Triangle = &Extract.Indices[Index];
+			if (Triangle[0] >= 0 && Triangle[0] < NumVertices && Triangle[1] >= 0 && Triangle[1] < NumVertices && Triangle[2] >= 0 && Triangle[2] < NumVertices)
+			{
+				Extract.Indices[NumValidIndices++] = Triangle[0];
+				Extract.Indices[NumValidIndices++] = Triangle[1];
+				Extract.Indices[NumValidIndices++] = Triangle[2];
+			}
+		}
+		Extract.Indices.SetNum(NumValidIndices, false);
+
+		// Mirroring transforms flip the winding
+		if (!bIdentity && Extract.ToMeshSpace.GetDeterminant() < 0.0f)
+		{
+			for (int32 Index = 0; Index < NumValidIndices; Index += 3)
+			{
+				Swap(Extract.Indices[Index + 1], Extract.Indices[Index + 2]);
+			}
+		}
+	}
+}
+
+void FRuntimeMeshStaticMeshConverter::ExtractRawMesh(const TArray<URuntimeMeshComponent*>& Components, const TArray<FTransform>& ToMeshSpace, FRuntimeMeshRawMeshData& OutData)
+{
+	FRuntimeMeshRawMeshSource Source;
+	GatherSections(Components, ToMeshSpace, Source);
+	ConvertSections(Source, OutData);
+}
+
+void FRuntimeMeshStaticMeshConverter::GatherSections(const TArray<URuntimeMeshComponent*>& Components, const TArray<FTransform>& ToMeshSpace, FRuntimeMeshRawMeshSource& OutSource)
+{
+	check(IsInGameThread());
+
+	for (int32 ComponentIdx = 0; ComponentIdx < Components.Num(); ComponentIdx++)
+	{
+		URuntimeMeshComponent* Component = Components[ComponentIdx];
+		const int32 LastSectionIdx = Component->GetLastSectionIndex();
+		for (int32 SectionIdx = 0; SectionIdx <= LastSectionIdx; SectionIdx++)
+		{
+			if (!Component->DoesSectionExist(SectionIdx))
+			{
+				continue;
+			}
+
+			const IRuntimeMeshVerticesBuilder* Vertices = nullptr;
+			const FRuntimeMeshIndicesBuilder* Indices = nullptr;
+			Component->MakeSectionResident(SectionIdx);
+			Component->GetSectionMesh(SectionIdx, Vertices, Indices);
+			if (Vertices == nullptr || Indices == nullptr)
+			{
+				delete Vertices;
+				delete Indices;
+				continue;
+			}
+
+			FRuntimeMeshRawMeshSource::FSection& Section = OutSource.Sections[OutSource.Sections.AddDefaulted()];
+			Section.Vertices = TUniquePtr<const IRuntimeMeshVerticesBuilder>(Vertices);
+			Section.Indices = TUniquePtr<const FRuntimeMeshIndicesBuilder>(Indices);
+			Section.Material = Component->GetMaterial(SectionIdx);
+			Section.ToMeshSpace = ToMeshSpace.IsValidIndex(ComponentIdx) ? ToMeshSpace[ComponentIdx] : FTransform::Identity;
+		}
+	}
+}
+
+void FRuntimeMeshStaticMeshConverter::ConvertSections(const FRuntimeMeshRawMeshSource& Source, FRuntimeMeshRawMeshData& OutData)
+{
+	TArray<FSectionExtract> Extracts;
+	Extracts.SetNum(Source.Sections.Num());
+	for (int32 SectionIdx = 0; SectionIdx < Source.Sections.Num(); SectionIdx++)
+	{
+		const FRuntimeMeshRawMeshSource::FSection& Section = Source.Sections[SectionIdx];
+		OutData.bUseHighPrecisionTangents |= Section.Vertices->HasHighPrecisionNormals();
+		OutData.bUseFullPrecisionUVs |= Section.Vertices->HasHighPrecisionUVs();
+		Extracts[SectionIdx].Material = Section.Material;
+		Extracts[SectionIdx].ToMeshSpace = Section.ToMeshSpace;
+	}
+
+	// Sections are independent, each worker only touches its own builders and extract
+	ParallelFor(Extracts.Num(), [&](int32 ExtractIdx)
+	{
+		const FRuntimeMeshRawMeshSource::FSection& Section = Source.Sections[ExtractIdx];
+		ReadSection(Section.Vertices.Get(), Section.Indices.Get(), Extracts[ExtractIdx]);
+	});
+
+	FRawMesh& RawMesh = OutData.RawMesh;
+	int32 NumVertices = RawMesh.VertexPositions.Num();
+	int32 NumWedges = RawMesh.WedgeIndices.Num();
+	int32 NumUVs = 0;
+	for (int32 UVIndex = 0; UVIndex < MAX_MESH_TEXTURE_COORDS; UVIndex++)
+	{
+		NumUVs = RawMesh.WedgeTexCoords[UVIndex].Num() > 0 ? UVIndex + 1 : NumUVs;
+	}
+
+	for (FSectionExtract& Extract : Extracts)
+	{
+		Extract.VertexBase = NumVertices;
+		Extract.WedgeBase = NumWedges;
+		Extract.FaceBase = NumWedges / 3;
+#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 14
+		Extract.MaterialIndex = OutData.Materials.AddUnique(FStaticMaterial(Extract.Material));
+#else
+		Extract.MaterialIndex = OutData.Materials.AddUnique(Extract.Material);
+#endif
+		NumVertices += Extract.Positions.Num();
+		NumWedges += Extract.Indices.Num();
+		NumUVs = FMath::Max(NumUVs, Extract.NumUVs);
+	}
+
+	// Size everything once, sections then fill their own ranges in parallel
+	const int32 ExistingWedges = RawMesh.WedgeIndices.Num();
+	RawMesh.VertexPositions.SetNumUninitialized(NumVertices);
+	RawMesh.WedgeIndices.SetNumUninitialized(NumWedges);
+	RawMesh.WedgeTangentX.SetNumUninitialized(NumWedges);
+	RawMesh.WedgeTangentY.SetNumUninitialized(NumWedges);
+	RawMesh.WedgeTangentZ.SetNumUninitialized(NumWedges);
+	RawMesh.WedgeColors.SetNumUninitialized(NumWedges);
+	for (int32 UVIndex = 0; UVIndex < NumUVs; UVIndex++)
+	{
+		// Channels only some sections have are zero filled, a raw mesh channel has to cover every wedge
+		int32 PreviousNum = RawMesh.WedgeTexCoords[UVIndex].Num();
+		RawMesh.WedgeTexCoords[UVIndex].SetNumZeroed(PreviousNum > 0 ? PreviousNum : ExistingWedges);
+		RawMesh.WedgeTexCoords[UVIndex].SetNumUninitialized(NumWedges);
+	}
+	RawMesh.FaceMaterialIndices.SetNumUninitialized(NumWedges / 3);
+	RawMesh.FaceSmoothingMasks.SetNumUninitialized(NumWedges / 3);
+
+	ParallelFor(Extracts.Num(), [&](int32 ExtractIdx)
+	{
+		const FSectionExtract& Extract = Extracts[ExtractIdx];
+		FMemory::Memcpy(&RawMesh.VertexPositions[Extract.VertexBase], Extract.Positions.GetData(), Extract.Positions.Num() * sizeof(FVector));
+
+		for (int32 Index = 0; Index < Extract.Indices.Num(); Index++)
+		{
+			const int32 Wedge = Extract.WedgeBase + Index;
+			const int32 Vertex = Extract.Indices[Index];
+			RawMesh.WedgeIndices[Wedge] = Vertex + Extract.VertexBase;
+			RawMesh.WedgeTangentX[Wedge] = Extract.TangentX[Vertex];
+			RawMesh.WedgeTangentY[Wedge] = Extract.TangentY[Vertex];
+			RawMesh.WedgeTangentZ[Wedge] = Extract.TangentZ[Vertex];
+			RawMesh.WedgeColors[Wedge] = Extract.Colors[Vertex];
+			for (int32 UVIndex = 0; UVIndex < NumUVs; UVIndex++)
+			{
+				RawMesh.WedgeTexCoords[UVIndex][Wedge] = UVIndex < Extract.NumUVs ? Extract.UVs[UVIndex][Vertex] : FVector2D::ZeroVector;
+			}
+		}
+
+		const int32 NumFaces = Extract.Indices.Num() / 3;
+		for (int32 Face = 0; Face < NumFaces; Face++)
+		{
+			RawMesh.FaceMaterialIndices[Extract.FaceBase + Face] = Extract.MaterialIndex;
+			RawMesh.FaceSmoothingMasks[Extract.FaceBase + Face] = 0; // Assume this is ignored as bRecomputeNormals is false
+		}
+	});
+}
+
+UStaticMesh* FRuntimeMeshStaticMeshConverter::CreateStaticMesh(const FString& PackageName, FName MeshName, const FRuntimeMeshRawMeshData& Data)
+{
+	const FRawMesh& RawMesh = Data.RawMesh;
+	if (RawMesh.VertexPositions.Num() < 3 || RawMesh.WedgeIndices.Num() < 3)
+	{
+		return nullptr;
+	}
+
+	UPackage* Package = CreatePackage(NULL, *PackageName);
+	check(Package);
+
+	// Create StaticMesh object
+	UStaticMesh* StaticMesh = NewObject<UStaticMesh>(Package, MeshName, RF_Public | RF_Standalone);
+	StaticMesh->InitResources();
+
+	StaticMesh->LightingGuid = FGuid::NewGuid();
+
+	// Add source to new StaticMesh
+	FStaticMeshSourceModel* SrcModel = new (StaticMesh->SourceModels) FStaticMeshSourceModel();
+	SrcModel->BuildSettings.bRecomputeNormals = false;
+	SrcModel->BuildSettings.bRecomputeTangents = false;
+	SrcModel->BuildSettings.bRemoveDegenerates = false;
+	SrcModel->BuildSettings.bUseHighPrecisionTangentBasis = Data.bUseHighPrecisionTangents;
+	SrcModel->BuildSettings.bUseFullPrecisionUVs = Data.bUseFullPrecisionUVs;
+	SrcModel->BuildSettings.bGenerateLightmapUVs = true;
+	SrcModel->BuildSettings.SrcLightmapIndex = 0;
+	SrcModel->BuildSettings.DstLightmapIndex = 1;
+	SrcModel->RawMeshBulkData->SaveRawMesh(const_cast<FRawMesh&>(RawMesh));
+
+	// Set the materials used for this static mesh
+#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 14
+	StaticMesh->StaticMaterials = Data.Materials;
+	int32 NumMaterials = StaticMesh->StaticMaterials.Num();
+#else
+	StaticMesh->Materials = Data.Materials;
+	int32 NumMaterials = StaticMesh->Materials.Num();
+#endif
+
+	// Set up the SectionInfoMap to enable collision
+	for (int32 SectionIdx = 0; SectionIdx < NumMaterials; SectionIdx++)
+	{
+		FMeshSectionInfo Info = StaticMesh->SectionInfoMap.Get(0, SectionIdx);
+		Info.MaterialIndex = SectionIdx;
+		Info.bEnableCollision = true;
+		StaticMesh->SectionInfoMap.Set(0, SectionIdx, Info);
+	}
+
+	// Configure body setup for working collision.
+	StaticMesh->CreateBodySetup();
+	StaticMesh->BodySetup->CollisionTraceFlag = CTF_UseComplexAsSimple;
+
+	// Build mesh from source
+	StaticMesh->Build(true);
+
+	// Make package dirty.
+	StaticMesh->MarkPackageDirty();
+
+	StaticMesh->PostEditChange();
+
+	// Notify asset registry of new asset
+	FAssetRegistryModule::AssetCreated(StaticMesh);
+	return StaticMesh;
+}
+
+TArray<UStaticMesh*> FRuntimeMeshStaticMeshConverter::Convert(const TArray<URuntimeMeshComponent*>& Components, const FString& PackageName, bool bMerge)
+{
+	TArray<UStaticMesh*> Result;
+	if (Components.Num() == 0)
+	{
+		return Result;
+	}
+
+	// Extraction is the cheap part, the frames are weighted towards the builds
+	const int32 NumBuilds = bMerge ? 1 : Components.Num();
+	FScopedSlowTask SlowTask((float)(Components.Num() + NumBuilds * 4), LOCTEXT("ConvertingToStaticMesh", "Creating StaticMesh assets..."));
+	SlowTask.MakeDialog(true);
+
+	FAssetToolsModule& AssetToolsModule = FModuleManager::LoadModuleChecked<FAssetToolsModule>("AssetTools");
+
+	if (bMerge)
+	{
+		// Everything ends up in the space of the first component
+		const FTransform InverseFirst = Components[0]->GetComponentTransform().Inverse();
+		TArray<FTransform> ToMeshSpace;
+		for (URuntimeMeshComponent* Component : Components)
+		{
+			ToMeshSpace.Add(Component == Components[0] ? FTransform::Identity : Component->GetComponentTransform() * InverseFirst);
+		}
+
+		SlowTask.EnterProgressFrame((float)Components.Num(), LOCTEXT("ReadingSections", "Reading sections"));
+		FRuntimeMeshRawMeshData Data;
+		ExtractRawMesh(Components, ToMeshSpace, Data);
+
+		SlowTask.EnterProgressFrame(4.0f, FText::Format(LOCTEXT("BuildingStaticMesh", "Building {0}"), FText::FromString(PackageName)));
+		UStaticMesh* StaticMesh = CreateStaticMesh(PackageName, *FPackageName::GetLongPackageAssetName(PackageName), Data);
+		if (StaticMesh)
+		{
+			Result.Add(StaticMesh);
+		}
+		return Result;
+	}
+
+	for (URuntimeMeshComponent* Component : Components)
+	{
+		if (SlowTask.ShouldCancel())
+		{
+			break;
+		}
+
+		FString AssetPackageName;
+		FString AssetName;
+		const FString BasePackageName = Components.Num() > 1 ? PackageName + TEXT("_") + Component->GetName() : PackageName;
+		AssetToolsModule.Get().CreateUniqueAssetName(BasePackageName, TEXT(""), AssetPackageName, AssetName);
+		if (Components.Num() == 1)
+		{
+			// The single asset keeps exactly the name that was picked
+			AssetPackageName = PackageName;
+			AssetName = FPackageName::GetLongPackageAssetName(PackageName);
+		}
+
+		SlowTask.EnterProgressFrame(1.0f, FText::Format(LOCTEXT("ReadingComponent", "Reading {0}"), FText::FromString(Component->GetName())));
+		FRuntimeMeshRawMeshData Data;
+		ExtractRawMesh(TArray<URuntimeMeshComponent*>({ Component }), TArray<FTransform>(), Data);
+
+		SlowTask.EnterProgressFrame(4.0f, FText::Format(LOCTEXT("BuildingStaticMesh", "Building {0}"), FText::FromString(AssetName)));
+		UStaticMesh* StaticMesh = CreateStaticMesh(AssetPackageName, *AssetName, Data);
+		if (StaticMesh)
+		{
+			Result.Add(StaticMesh);
+		}
+	}
+
+	return Result;
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,69 @@
+// Copyright 2016 Chris Conway (Koderz). All Rights Reserved.
+
+#pragma once
+
+#include "RawMesh.h"
+#include "RuntimeMeshBuilder.h"
+
+class URuntimeMeshComponent;
+class UStaticMesh;
+
+#if ENGINE_MAJOR_VERSION == 4 && ENGINE_MINOR_VERSION >= 14
+typedef FStaticMaterial FRuntimeMeshStaticMaterial;
+#else
+typedef UMaterialInterface* FRuntimeMeshStaticMaterial;
+#endif
+
+/** Geometry of one or more RuntimeMeshComponents ready to be saved as a StaticMesh source model */
+struct FRuntimeMeshRawMeshData
+{
+	FRuntimeMeshRawMeshData() : bUseHighPrecisionTangents(false), bUseFullPrecisionUVs(false) { }
+
+	FRawMesh RawMesh;
+	TArray<FRuntimeMeshStaticMaterial> Materials;
+	bool bUseHighPrecisionTangents;
+	bool bUseFullPrecisionUVs;
+};
+
+/** Sections of one or more RuntimeMeshComponents, read on the game thread and turned into a raw mesh on any thread */
+struct FRuntimeMeshRawMeshSource
+{
+	struct FSection
+	{
+		FSection() : Material(nullptr) { }
+
+		TUniquePtr<const IRuntimeMeshVerticesBuilder> Vertices;
+		TUniquePtr<const FRuntimeMeshIndicesBuilder> Indices;
+		UMaterialInterface* Material;
+		FTransform ToMeshSpace;
+	};
+
+	TArray<FSection> Sections;
+};
+
+/**
+ *	Converts RuntimeMeshComponents to StaticMesh assets.
+ *	Every section is read once per vertex into plain arrays on the task graph, the wedges are then expanded into
+ *	presized raw mesh arrays, so the cost no longer comes from a virtual seek and several virtual reads per wedge.
+ */
+class FRuntimeMeshStaticMeshConverter
+{
+public:
+	/** Appends every section of the components to OutData, transformed into the space of ToMeshSpace[i] */
+	static void ExtractRawMesh(const TArray<URuntimeMeshComponent*>& Components, const TArray<FTransform>& ToMeshSpace, FRuntimeMeshRawMeshData& OutData);
+
+	/** The part of ExtractRawMesh that touches the components: section builders, materials and evicted sections. Game thread only. */
+	static void GatherSections(const TArray<URuntimeMeshComponent*>& Components, const TArray<FTransform>& ToMeshSpace, FRuntimeMeshRawMeshSource& OutSource);
+
+	/** The rest of ExtractRawMesh, only reads the gathered sections so it can run on any thread */
+	static void ConvertSections(const FRuntimeMeshRawMeshSource& Source, FRuntimeMeshRawMeshData& OutData);
+
+	/** Creates and builds a StaticMesh asset, returns nullptr when the data has no triangles */
+	static UStaticMesh* CreateStaticMesh(const FString& PackageName, FName MeshName, const FRuntimeMeshRawMeshData& Data);
+
+	/**
+	 *	Converts the components with a cancellable progress dialog.
+	 *	@param bMerge		One asset for all components in the space of the first one, otherwise one asset per component named PackageName_ComponentName
+	 */
+	static TArray<UStaticMesh*> Convert(const TArray<URuntimeMeshComponent*>& Components, const FString& PackageName, bool bMerge);
+};
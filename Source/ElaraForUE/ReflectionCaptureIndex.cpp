@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ReflectionCaptureIndex.h"
+#include "Engine.h"
+#include "Components/SphereReflectionCaptureComponent.h"
+
+static const int32 MAX_CELLS_PER_CAPTURE = 512;
+
+FReflectionCaptureIndex::FReflectionCaptureIndex() : mCellSize(2000.f)
+{ }
+
+bool FReflectionCaptureIndex::GetInfluence(ASphereReflectionCapture* pCapture, FSphere& OutInfluence)
+{
+	if (NULL == pCapture)
+	{
+		return false;
+	}
+
+	USphereReflectionCaptureComponent* pCaptureComponent = Cast<USphereReflectionCaptureComponent>(pCapture->GetCaptureComponent());
+	if (NULL == pCaptureComponent)
+	{
+		return false;
+	}
+
+	OutInfluence = FSphere(pCaptureComponent->GetComponentLocation(), pCaptureComponent->InfluenceRadius);
+	return true;
+}
+
+FIntVector FReflectionCaptureIndex::ToCell(const FVector& Position) const
+{
+	return FIntVector(FMath::FloorToInt(Position.X / mCellSize), FMath::FloorToInt(Position.Y / mCellSize), FMath::FloorToInt(Position.Z / mCellSize));
+}
+
+void FReflectionCaptureIndex::Build(const TSet<TWeakObjectPtr<ASphereReflectionCapture>>& Captures, float InCellSize)
+{
+	mCellSize = FMath::Max(InCellSize, 1.f);
+	mCaptures.Reset();
+	mCells.Reset();
+	mLargeCaptures.Reset();
+
+	for (auto& capture : Captures)
+	{
+		FSphere influence;
+		if (!capture.IsValid() || !GetInfluence(capture.Get(), influence))
+		{
+			continue;
+		}
+
+		int32 captureIndex = mCaptures.Num();
+		FIndexedCapture& indexed = mCaptures[mCaptures.AddDefaulted()];
+		indexed.Capture = capture;
+		indexed.Influence = influence;
+
+		FIntVector minCell = ToCell(influence.Center - FVector(influence.W));
+		FIntVector maxCell = ToCell(influence.Center + FVector(influence.W));
+		FIntVector span = maxCell - minCell + FIntVector(1, 1, 1);
+		if ((int64)span.X * span.Y * span.Z > MAX_CELLS_PER_CAPTURE)
+		{
+			mLargeCaptures.Add(captureIndex);
+			continue;
+		}
+
+		for (int32 x = minCell.X; x <= maxCell.X; ++x)
+		{
+			for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+			{
+				for (int32 z = minCell.Z; z <= maxCell.Z; ++z)
+				{
+					mCells.Add(FIntVector(x, y, z), captureIndex);
+				}
+			}
+		}
+	}
+}
+
+bool FReflectionCaptureIndex::VisitIntersecting(const FBox& Region, TFunctionRef<bool(const FIndexedCapture&)> Visitor) const
+{
+	if (!Region.IsValid)
+	{
+		return false;
+	}
+
+	auto testCapture = [&](int32 captureIndex)
+	{
+		const FIndexedCapture& indexed = mCaptures[captureIndex];
+		return indexed.Capture.IsValid() && FMath::SphereAABBIntersection(indexed.Influence, Region) && Visitor(indexed);
+	};
+
+	for (int32 captureIndex : mLargeCaptures)
+	{
+		if (testCapture(captureIndex))
+		{
+			return true;
+		}
+	}
+
+	FIntVector minCell = ToCell(Region.Min);
+	FIntVector maxCell = ToCell(Region.Max);
+	FIntVector span = maxCell - minCell + FIntVector(1, 1, 1);
+	if ((int64)span.X * span.Y * span.Z > mCells.Num())
+	{
+		// The region covers more cells than are occupied, testing every capture is cheaper
+		for (int32 captureIndex = 0; captureIndex < mCaptures.Num(); ++captureIndex)
+		{
+			if (testCapture(captureIndex))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	TArray<int32> candidates;
+	for (int32 x = minCell.X; x <= maxCell.X; ++x)
+	{
+		for (int32 y = minCell.Y; y <= maxCell.Y; ++y)
+		{
+			for (int32 z = minCell.Z; z <= maxCell.Z; ++z)
+			{
+				mCells.MultiFind(FIntVector(x, y, z), candidates);
+			}
+		}
+	}
+
+	for (int32 captureIndex : candidates)
+	{
+		if (testCapture(captureIndex))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FReflectionCaptureIndex::Query(const FBox& Region, TSet<TWeakObjectPtr<ASphereReflectionCapture>>& OutCaptures) const
+{
+	VisitIntersecting(Region, [&](const FIndexedCapture& indexed)
+	{
+		OutCaptures.Add(indexed.Capture);
+		return false;
+	});
+}
+
+bool FReflectionCaptureIndex::IntersectsAny(const FBox& Box, const TSet<TWeakObjectPtr<ASphereReflectionCapture>>& Among) const
+{
+	if (0 == Among.Num())
+	{
+		return false;
+	}
+
+	return VisitIntersecting(Box, [&](const FIndexedCapture& indexed)
+	{
+		return Among.Contains(indexed.Capture);
+	});
+}
@@ -0,0 +1,44 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Classes/Engine/SphereReflectionCapture.h"
+
+/**
+ * Uniform grid over the influence spheres of sphere reflection captures, so a changed region only tests the captures around it.
+ * Captures are expected to stay put while the index is alive; rebuild it when the capture set changes.
+ */
+class FReflectionCaptureIndex
+{
+public:
+	FReflectionCaptureIndex();
+
+	void Build(const TSet<TWeakObjectPtr<ASphereReflectionCapture>>& Captures, float InCellSize = 2000.f);
+
+	// Adds every capture whose influence sphere intersects the box
+	void Query(const FBox& Region, TSet<TWeakObjectPtr<ASphereReflectionCapture>>& OutCaptures) const;
+
+	// Whether the box intersects the influence sphere of any indexed capture that is also in Among
+	bool IntersectsAny(const FBox& Box, const TSet<TWeakObjectPtr<ASphereReflectionCapture>>& Among) const;
+
+	int32 Num() const { return mCaptures.Num(); }
+
+private:
+	struct FIndexedCapture
+	{
+		TWeakObjectPtr<ASphereReflectionCapture> Capture;
+		FSphere Influence;
+	};
+
+	static bool GetInfluence(ASphereReflectionCapture* pCapture, FSphere& OutInfluence);
+	FIntVector ToCell(const FVector& Position) const;
+	// Calls the visitor for every live capture whose influence intersects the region, stops as soon as it returns true
+	bool VisitIntersecting(const FBox& Region, TFunctionRef<bool(const FIndexedCapture&)> Visitor) const;
+
+	float mCellSize;
+	TArray<FIndexedCapture> mCaptures;
+	TMultiMap<FIntVector, int32> mCells;
+	// Captures spanning too many cells to be worth inserting, always tested
+	TArray<int32> mLargeCaptures;
+};
@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ReflectionCaptureScheduler.h"
+#include "Engine.h"
+#include "Components/SphereReflectionCaptureComponent.h"
+
+DEFINE_STAT(STAT_ReflectionMonitor_CapturesPending);
+DEFINE_STAT(STAT_ReflectionMonitor_CapturesPerSecond);
+DEFINE_STAT(STAT_ReflectionMonitor_WorstFrameCost);
+DEFINE_STAT(STAT_ReflectionMonitor_EstimatedCaptureCost);
+
+// Weight of a new sample in the running averages
+static const float FRAME_SMOOTHING = 0.1f;
+// Starting guess for one sphere capture before anything was measured
+static const float INITIAL_CAPTURE_COST_MS = 8.f;
+
+FReflectionCaptureScheduler::FReflectionCaptureScheduler() :
+	BudgetMs(4.f),
+	StalenessWeight(0.5f),
+	mLastTickTime(0),
+	mRefreshedLastTick(0),
+	mBaselineFrameMs(0),
+	mEstimatedCaptureMs(INITIAL_CAPTURE_COST_MS),
+	mWorstFrameCostMs(0),
+	mRateWindowStart(0),
+	mRefreshedInWindow(0),
+	mRefreshRate(0)
+{ }
+
+void FReflectionCaptureScheduler::Invalidate(const TWeakObjectPtr<ASphereReflectionCapture>& Capture)
+{
+	if (!Capture.IsValid())
+	{
+		return;
+	}
+
+	bool bAlreadyPending = false;
+	mPending.Add(Capture, &bAlreadyPending);
+	if (!bAlreadyPending)
+	{
+		mInvalidatedTime.Add(Capture, FPlatformTime::Seconds());
+	}
+}
+
+void FReflectionCaptureScheduler::Reset()
+{
+	mPending.Reset();
+	mInvalidatedTime.Reset();
+}
+
+void FReflectionCaptureScheduler::MeasureFrame()
+{
+	double now = FPlatformTime::Seconds();
+	if (mLastTickTime > 0)
+	{
+		float frameMs = (float)((now - mLastTickTime) * 1000.0);
+		if (mRefreshedLastTick > 0)
+		{
+			// What the captures added on top of a normal frame, spread over the captures refreshed
+			float costMs = FMath::Max(frameMs - mBaselineFrameMs, 0.f);
+			mWorstFrameCostMs = FMath::Max(mWorstFrameCostMs, costMs);
+			mEstimatedCaptureMs = FMath::Lerp(mEstimatedCaptureMs, costMs / mRefreshedLastTick, FRAME_SMOOTHING);
+		}
+		else
+		{
+			mBaselineFrameMs = mBaselineFrameMs > 0 ? FMath::Lerp(mBaselineFrameMs, frameMs, FRAME_SMOOTHING) : frameMs;
+		}
+	}
+	mLastTickTime = now;
+
+	if (now - mRateWindowStart >= 1.0)
+	{
+		mRefreshRate = mRateWindowStart > 0 ? (float)(mRefreshedInWindow / (now - mRateWindowStart)) : 0.f;
+		mRateWindowStart = now;
+		mRefreshedInWindow = 0;
+	}
+
+	SET_DWORD_STAT(STAT_ReflectionMonitor_CapturesPending, mPending.Num());
+	SET_FLOAT_STAT(STAT_ReflectionMonitor_CapturesPerSecond, mRefreshRate);
+	SET_FLOAT_STAT(STAT_ReflectionMonitor_WorstFrameCost, mWorstFrameCostMs);
+	SET_FLOAT_STAT(STAT_ReflectionMonitor_EstimatedCaptureCost, mEstimatedCaptureMs);
+}
+
+void FReflectionCaptureScheduler::TickIdle()
+{
+	MeasureFrame();
+	mRefreshedLastTick = 0;
+}
+
+float FReflectionCaptureScheduler::GetPriority(ASphereReflectionCapture* pCapture, double Age, bool bHasCamera, const FVector& CameraOrigin, const FVector& CameraDirection) const
+{
+	float priority = StalenessWeight * (float)Age;
+	if (!bHasCamera)
+	{
+		return priority;
+	}
+
+	USphereReflectionCaptureComponent* pCaptureComponent = Cast<USphereReflectionCaptureComponent>(pCapture->GetCaptureComponent());
+	float radius = NULL != pCaptureComponent ? pCaptureComponent->InfluenceRadius : 1.f;
+	FVector cameraToCapture = pCapture->GetActorLocation() - CameraOrigin;
+	float distance = cameraToCapture.Size();
+
+	// Approximate share of the screen the influence sphere covers, captures around or in front of the camera first
+	float importance = radius / FMath::Max(distance, radius);
+	if (distance > radius && FVector::DotProduct(cameraToCapture, CameraDirection) <= 0)
+	{
+		importance *= 0.25f;
+	}
+	return priority + importance;
+}
+
+void FReflectionCaptureScheduler::Tick(bool bHasCamera, const FVector& CameraOrigin, const FVector& CameraDirection)
+{
+	MeasureFrame();
+	mRefreshedLastTick = 0;
+
+	struct FCandidate
+	{
+		ASphereReflectionCapture* pCapture;
+		float Priority;
+	};
+
+	double now = FPlatformTime::Seconds();
+	TArray<FCandidate> candidates;
+	candidates.Reserve(mPending.Num());
+	for (auto it = mPending.CreateIterator(); it; ++it)
+	{
+		ASphereReflectionCapture* pCapture = it->Get();
+		if (NULL == pCapture || NULL == pCapture->GetCaptureComponent())
+		{
+			mInvalidatedTime.Remove(*it);
+			it.RemoveCurrent();
+			continue;
+		}
+
+		double* pInvalidatedTime = mInvalidatedTime.Find(*it);
+		double age = NULL != pInvalidatedTime ? now - *pInvalidatedTime : 0.0;
+		candidates.Add({ pCapture, GetPriority(pCapture, age, bHasCamera, CameraOrigin, CameraDirection) });
+	}
+
+	candidates.Sort([](const FCandidate& A, const FCandidate& B) { return A.Priority > B.Priority; });
+
+	float spentMs = 0;
+	for (const FCandidate& candidate : candidates)
+	{
+		if (mRefreshedLastTick > 0 && spentMs + mEstimatedCaptureMs > BudgetMs)
+		{
+			break;
+		}
+
+		candidate.pCapture->GetCaptureComponent()->SetCaptureIsDirty();
+		mPending.Remove(candidate.pCapture);
+		mInvalidatedTime.Remove(candidate.pCapture);
+		spentMs += mEstimatedCaptureMs;
+		mRefreshedLastTick++;
+	}
+	mRefreshedInWindow += mRefreshedLastTick;
+}
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Classes/Engine/SphereReflectionCapture.h"
+#include "ReflectionChangeTracker.h"
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Captures Pending"), STAT_ReflectionMonitor_CapturesPending, STATGROUP_ReflectionMonitor, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Captures Refreshed Per Second"), STAT_ReflectionMonitor_CapturesPerSecond, STATGROUP_ReflectionMonitor, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Worst Refresh Frame Cost (ms)"), STAT_ReflectionMonitor_WorstFrameCost, STATGROUP_ReflectionMonitor, );
+DECLARE_FLOAT_COUNTER_STAT_EXTERN(TEXT("Estimated Capture Cost (ms)"), STAT_ReflectionMonitor_EstimatedCaptureCost, STATGROUP_ReflectionMonitor, );
+
+/**
+ * Refreshes invalidated sphere captures under a per frame millisecond budget.
+ * A capture only renders at the end of the frame that dirtied it, so its cost is learned from how much longer
+ * those frames take than frames without refreshes, and that estimate decides how many captures fit in the budget.
+ */
+class FReflectionCaptureScheduler
+{
+public:
+	FReflectionCaptureScheduler();
+
+	// Queues a capture, invalidating one that is already queued only keeps its original age
+	void Invalidate(const TWeakObjectPtr<ASphereReflectionCapture>& Capture);
+
+	/**
+	 * Dirties the most important pending captures that fit in the budget. At least one capture is refreshed per call so the queue always drains.
+	 * @param bHasCamera		Whether CameraOrigin and CameraDirection are valid, otherwise only staleness orders the queue
+	 */
+	void Tick(bool bHasCamera, const FVector& CameraOrigin, const FVector& CameraDirection);
+
+	// Feeds the real frame time without refreshing, so the baseline keeps up while the queue is paused
+	void TickIdle();
+
+	int32 Num() const { return mPending.Num(); }
+	const TSet<TWeakObjectPtr<ASphereReflectionCapture>>& GetPendingCaptures() const { return mPending; }
+	void Reset();
+
+	float BudgetMs;
+	float StalenessWeight;
+
+private:
+	float GetPriority(ASphereReflectionCapture* pCapture, double Age, bool bHasCamera, const FVector& CameraOrigin, const FVector& CameraDirection) const;
+	void MeasureFrame();
+
+	TSet<TWeakObjectPtr<ASphereReflectionCapture>> mPending;
+	TMap<TWeakObjectPtr<ASphereReflectionCapture>, double> mInvalidatedTime;
+
+	double mLastTickTime;
+	int32 mRefreshedLastTick;
+	float mBaselineFrameMs;
+	float mEstimatedCaptureMs;
+	float mWorstFrameCostMs;
+
+	double mRateWindowStart;
+	int32 mRefreshedInWindow;
+	float mRefreshRate;
+};
@@ -0,0 +1,302 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "ReflectionChangeTracker.h"
+#include "UObjectIterator.h"
+#include "Engine.h"
+
+DEFINE_STAT(STAT_ReflectionMonitor_Tick);
+DEFINE_STAT(STAT_ReflectionMonitor_FlushRegistrations);
+DEFINE_STAT(STAT_ReflectionMonitor_TrackedComponents);
+DEFINE_STAT(STAT_ReflectionMonitor_DirtyComponents);
+
+bool IsMovableActor(AActor* pActor)
+{
+	if (NULL == pActor)
+	{
+		return false;
+	}
+
+	if (Cast<ACharacter>(pActor) != NULL)
+	{
+		return false;
+	}
+
+	USceneComponent* pRootComponent = pActor->GetRootComponent();
+	return NULL != pRootComponent && pRootComponent->Mobility == EComponentMobility::Movable;
+}
+
+FReflectionChangeTracker::FReflectionChangeTracker(UWorld* InWorld, bool bInTrackRuntimeMeshOnly) :
+	mWorld(InWorld),
+	mbTrackRuntimeMeshOnly(bInTrackRuntimeMeshOnly),
+	mbRegistrationChanged(false)
+{
+	// One scan for what already exists, everything after that arrives through the listeners
+	for (TObjectIterator<UPrimitiveComponent> It; It; ++It)
+	{
+		TryTrack((*It)->GetUniqueID());
+	}
+
+	GUObjectArray.AddUObjectCreateListener(this);
+	GUObjectArray.AddUObjectDeleteListener(this);
+	mCreatePhysicsHandle = UActorComponent::GlobalCreatePhysicsDelegate.AddRaw(this, &FReflectionChangeTracker::OnPhysicsStateChanged);
+	mDestroyPhysicsHandle = UActorComponent::GlobalDestroyPhysicsDelegate.AddRaw(this, &FReflectionChangeTracker::OnPhysicsStateChanged);
+	if (NULL != GEngine)
+	{
+		mActorDeletedHandle = GEngine->OnLevelActorDeleted().AddRaw(this, &FReflectionChangeTracker::OnLevelActorDeleted);
+	}
+	ResetChanges();
+}
+
+FReflectionChangeTracker::~FReflectionChangeTracker()
+{
+	GUObjectArray.RemoveUObjectCreateListener(this);
+	GUObjectArray.RemoveUObjectDeleteListener(this);
+	UActorComponent::GlobalCreatePhysicsDelegate.Remove(mCreatePhysicsHandle);
+	UActorComponent::GlobalDestroyPhysicsDelegate.Remove(mDestroyPhysicsHandle);
+	if (NULL != GEngine)
+	{
+		GEngine->OnLevelActorDeleted().Remove(mActorDeletedHandle);
+	}
+
+	for (auto& iter : mTrackedComponents)
+	{
+		if (iter.Value.Component.IsValid())
+		{
+			iter.Value.Component->TransformUpdated.Remove(iter.Value.TransformUpdatedHandle);
+		}
+	}
+}
+
+void FReflectionChangeTracker::NotifyUObjectCreated(const class UObjectBase* Object, int32 Index)
+{
+	// The object is still being constructed, only its class can be trusted here
+	if (Object->GetClass()->IsChildOf(UPrimitiveComponent::StaticClass()))
+	{
+		FScopeLock lock(&mPendingLock);
+		mPendingCreated.Add(Index);
+	}
+}
+
+void FReflectionChangeTracker::NotifyUObjectDeleted(const class UObjectBase* Object, int32 Index)
+{
+	if (Object->GetClass()->IsChildOf(UPrimitiveComponent::StaticClass()))
+	{
+		FScopeLock lock(&mPendingLock);
+		mPendingCreated.Remove(Index);
+		mPendingDeleted.Add(Index);
+	}
+}
+
+bool FReflectionChangeTracker::TryTrack(int32 Index)
+{
+	if (mTrackedComponents.Contains(Index))
+	{
+		return false;
+	}
+
+	FUObjectItem* pItem = GUObjectArray.IndexToObject(Index);
+	UPrimitiveComponent* pComponent = pItem ? Cast<UPrimitiveComponent>((UObject*)pItem->Object) : NULL;
+	if (NULL == pComponent || pComponent->IsPendingKill() || pComponent->HasAnyFlags(RF_ClassDefaultObject | RF_ArchetypeObject) ||
+		pComponent->GetWorld() != mWorld.Get())
+	{
+		return false;
+	}
+
+	FTrackedComponent& tracked = mTrackedComponents.Add(Index);
+	tracked.Component = pComponent;
+	tracked.TransformUpdatedHandle = pComponent->TransformUpdated.AddRaw(this, &FReflectionChangeTracker::OnTransformUpdated);
+	tracked.Bounds = FBox(ForceInit);
+	tracked.bWasRelevant = false;
+	Refresh(Index, tracked);
+	return true;
+}
+
+void FReflectionChangeTracker::Refresh(int32 Index, FTrackedComponent& Tracked)
+{
+	UPrimitiveComponent* pComponent = Tracked.Component.Get();
+	bool bWasRelevant = Tracked.bWasRelevant;
+	FBox oldBounds = Tracked.Bounds;
+
+	Tracked.bWasRelevant = IsRelevant(pComponent);
+	if (Tracked.bWasRelevant)
+	{
+		Tracked.Bounds = pComponent->Bounds.GetBox();
+		mRelevantComponents.Add(Index);
+	}
+	else
+	{
+		mRelevantComponents.Remove(Index);
+	}
+
+	if (NULL != pComponent && !pComponent->IsPendingKill() && !pComponent->IsRegistered())
+	{
+		mAwaitingRegistration.Add(Index);
+	}
+	else
+	{
+		mAwaitingRegistration.Remove(Index);
+	}
+
+	if (bWasRelevant != Tracked.bWasRelevant)
+	{
+		mbRegistrationChanged = true;
+		mChangedRegions.Add(oldBounds + Tracked.Bounds);
+	}
+}
+
+void FReflectionChangeTracker::QueueRefresh(UActorComponent* pComponent)
+{
+	if (NULL != pComponent && mTrackedComponents.Contains(pComponent->GetUniqueID()))
+	{
+		mPendingRefresh.Add(pComponent->GetUniqueID());
+	}
+}
+
+void FReflectionChangeTracker::QueueActorRefresh(AActor* pActor)
+{
+	if (NULL == pActor)
+	{
+		return;
+	}
+
+	TInlineComponentArray<UPrimitiveComponent*> components;
+	pActor->GetComponents(components);
+	for (UPrimitiveComponent* pComponent : components)
+	{
+		QueueRefresh(pComponent);
+	}
+}
+
+void FReflectionChangeTracker::OnPhysicsStateChanged(UActorComponent* pComponent)
+{
+	// Still registered while its physics state is destroyed, so only look at it once the unregistration is done
+	QueueRefresh(pComponent);
+}
+
+void FReflectionChangeTracker::OnLevelActorDeleted(AActor* pActor)
+{
+	QueueActorRefresh(pActor);
+}
+
+void FReflectionChangeTracker::Ignore(UActorComponent* pComponent)
+{
+	if (NULL != pComponent)
+	{
+		mIgnoredComponents.Add(pComponent->GetUniqueID());
+		mReleasedComponents.Remove(pComponent->GetUniqueID());
+	}
+}
+
+void FReflectionChangeTracker::Release(UActorComponent* pComponent)
+{
+	if (NULL != pComponent && mIgnoredComponents.Contains(pComponent->GetUniqueID()))
+	{
+		mReleasedComponents.Add(pComponent->GetUniqueID());
+	}
+}
+
+void FReflectionChangeTracker::Flush()
+{
+	SCOPE_CYCLE_COUNTER(STAT_ReflectionMonitor_FlushRegistrations);
+
+	TArray<int32> created;
+	TArray<int32> deleted;
+	{
+		FScopeLock lock(&mPendingLock);
+		Swap(created, mPendingCreated);
+		Swap(deleted, mPendingDeleted);
+	}
+
+	// Deletions first so a recycled index is tracked as the new object
+	for (int32 index : deleted)
+	{
+		FTrackedComponent tracked;
+		mPendingRefresh.Remove(index);
+		mAwaitingRegistration.Remove(index);
+		mRelevantComponents.Remove(index);
+		mIgnoredComponents.Remove(index);
+		mReleasedComponents.Remove(index);
+		if (mTrackedComponents.RemoveAndCopyValue(index, tracked) && tracked.bWasRelevant)
+		{
+			mbRegistrationChanged = true;
+			mChangedRegions.Add(tracked.Bounds);
+		}
+	}
+
+	for (int32 index : created)
+	{
+		TryTrack(index);
+	}
+
+	// Registering without collision raises no event, unregistered components are checked until they register
+	mPendingRefresh.Append(mAwaitingRegistration);
+	for (int32 index : mPendingRefresh)
+	{
+		FTrackedComponent* pTracked = mTrackedComponents.Find(index);
+		if (NULL != pTracked && !mIgnoredComponents.Contains(index))
+		{
+			Refresh(index, *pTracked);
+		}
+	}
+	mPendingRefresh.Reset();
+
+	// The events of the mobility change were dropped above, the components are tracked again from here
+	mIgnoredComponents = mIgnoredComponents.Difference(mReleasedComponents);
+	mReleasedComponents.Reset();
+
+	SET_DWORD_STAT(STAT_ReflectionMonitor_TrackedComponents, mTrackedComponents.Num());
+	SET_DWORD_STAT(STAT_ReflectionMonitor_DirtyComponents, mDirtyComponents.Num());
+}
+
+bool FReflectionChangeTracker::IsRelevant(const UPrimitiveComponent* pComponent) const
+{
+	if (NULL == pComponent || pComponent->IsPendingKill() || !pComponent->IsRegistered())
+	{
+		return false;
+	}
+
+	if (mbTrackRuntimeMeshOnly)
+	{
+		return pComponent->GetClass()->GetName() == TEXT("RuntimeMeshComponent");
+	}
+
+	return IsMovableActor(pComponent->GetOwner());
+}
+
+void FReflectionChangeTracker::OnTransformUpdated(USceneComponent* pUpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	int32 index = pUpdatedComponent->GetUniqueID();
+	FTrackedComponent* pTracked = mTrackedComponents.Find(index);
+	if (NULL == pTracked || pTracked->Component.Get() != pUpdatedComponent || mIgnoredComponents.Contains(index))
+	{
+		return;
+	}
+
+	FBox oldBounds = pTracked->Bounds;
+	bool bWasRelevant = pTracked->bWasRelevant;
+	Refresh(index, *pTracked);
+	if (bWasRelevant && pTracked->bWasRelevant)
+	{
+		mDirtyComponents.Add(pTracked->Component);
+		mChangedRegions.Add(oldBounds + pTracked->Bounds);
+	}
+}
+
+void FReflectionChangeTracker::ResetChanges()
+{
+	mDirtyComponents.Reset();
+	mChangedRegions.Reset();
+	mbRegistrationChanged = false;
+}
+
+void FReflectionChangeTracker::ForEachRelevantComponent(TFunctionRef<void(UPrimitiveComponent*)> Visitor) const
+{
+	for (int32 index : mRelevantComponents)
+	{
+		UPrimitiveComponent* pComponent = mTrackedComponents.FindChecked(index).Component.Get();
+		if (IsRelevant(pComponent))
+		{
+			Visitor(pComponent);
+		}
+	}
+}
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/UObjectArray.h"
+#include "Components/PrimitiveComponent.h"
+
+DECLARE_STATS_GROUP(TEXT("ReflectionMonitor"), STATGROUP_ReflectionMonitor, STATCAT_Advanced);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Monitor Tick"), STAT_ReflectionMonitor_Tick, STATGROUP_ReflectionMonitor, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Flush Registrations"), STAT_ReflectionMonitor_FlushRegistrations, STATGROUP_ReflectionMonitor, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Tracked Components"), STAT_ReflectionMonitor_TrackedComponents, STATGROUP_ReflectionMonitor, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Dirty Components"), STAT_ReflectionMonitor_DirtyComponents, STATGROUP_ReflectionMonitor, );
+
+/**
+ * Tracks primitive components of one world through transform, registration and object lifetime events instead of scanning every object.
+ * Creation and deletion can be reported from any thread, so they are queued and only resolved in Flush() on the game thread.
+ * Registration and actor deletion queue the affected components, Flush() re-evaluates only those.
+ */
+class FReflectionChangeTracker : public FUObjectArray::FUObjectCreateListener, public FUObjectArray::FUObjectDeleteListener
+{
+public:
+	FReflectionChangeTracker(UWorld* InWorld, bool bInTrackRuntimeMeshOnly);
+	virtual ~FReflectionChangeTracker();
+
+	// Binds newly created components and forgets deleted ones. Call once per tick before reading the dirty state.
+	void Flush();
+
+	// Whether a component should invalidate reflections when it changes
+	bool IsRelevant(const UPrimitiveComponent* pComponent) const;
+
+	bool HasChanges() const { return mDirtyComponents.Num() > 0 || mbRegistrationChanged; }
+	void ResetChanges();
+
+	const TSet<TWeakObjectPtr<UPrimitiveComponent>>& GetDirtyComponents() const { return mDirtyComponents; }
+	// Union of the old and new world bounds of every change since the last reset, one box per change
+	const TArray<FBox>& GetChangedRegions() const { return mChangedRegions; }
+	int32 GetTrackedComponentCount() const { return mTrackedComponents.Num(); }
+
+	// Calls the visitor for every tracked component that is still alive and relevant
+	void ForEachRelevantComponent(TFunctionRef<void(UPrimitiveComponent*)> Visitor) const;
+
+	// Leaves a component out of the tracking while its owner changes its mobility, the re-registration that follows isn't
+	// a change of the scene. It stays out until Release() and the Flush() after that, which drops the events it caused.
+	void Ignore(UActorComponent* pComponent);
+	void Release(UActorComponent* pComponent);
+
+	// FUObjectCreateListener / FUObjectDeleteListener
+	virtual void NotifyUObjectCreated(const class UObjectBase* Object, int32 Index) override;
+	virtual void NotifyUObjectDeleted(const class UObjectBase* Object, int32 Index) override;
+
+private:
+	struct FTrackedComponent
+	{
+		TWeakObjectPtr<UPrimitiveComponent> Component;
+		FDelegateHandle TransformUpdatedHandle;
+		FBox Bounds;
+		bool bWasRelevant;
+	};
+
+	bool TryTrack(int32 Index);
+	// Re-evaluates the relevance and bounds of a tracked component, recording a change when it became relevant or stopped being it
+	void Refresh(int32 Index, FTrackedComponent& Tracked);
+	void QueueRefresh(UActorComponent* pComponent);
+	void QueueActorRefresh(AActor* pActor);
+
+	void OnTransformUpdated(USceneComponent* pUpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+	// Physics state is created on registration and destroyed on unregistration, the closest the engine has to registration events
+	void OnPhysicsStateChanged(UActorComponent* pComponent);
+	void OnLevelActorDeleted(AActor* pActor);
+
+	TWeakObjectPtr<UWorld> mWorld;
+	bool mbTrackRuntimeMeshOnly;
+	bool mbRegistrationChanged;
+	TMap<int32, FTrackedComponent> mTrackedComponents;
+	// Indices of the tracked components that were relevant when last evaluated
+	TSet<int32> mRelevantComponents;
+	// Components to re-evaluate in the next Flush()
+	TSet<int32> mPendingRefresh;
+	// Tracked components that aren't registered yet, registering without collision creates no physics state to announce it
+	TSet<int32> mAwaitingRegistration;
+	// Components left out by Ignore(), and the released ones that come back after the next Flush()
+	TSet<int32> mIgnoredComponents;
+	TSet<int32> mReleasedComponents;
+	FDelegateHandle mCreatePhysicsHandle;
+	FDelegateHandle mDestroyPhysicsHandle;
+	FDelegateHandle mActorDeletedHandle;
+	TSet<TWeakObjectPtr<UPrimitiveComponent>> mDirtyComponents;
+	TArray<FBox> mChangedRegions;
+
+	FCriticalSection mPendingLock;
+	TArray<int32> mPendingCreated;
+	TArray<int32> mPendingDeleted;
+};
@@ -8,51 +8,16 @@
 // Sets default values
 AReflectionMonitorActor::AReflectionMonitorActor() : 
 	mbMouseDown(false),
-	mMovableActorCount(0),
-	ObjectTrackMode(MODE_DRAGANDDROP)
+	mTicksSinceCheck(0),
+	ObjectTrackMode(MODE_DRAGANDDROP),
+	bSpatialInvalidation(false),
+	RefreshBudgetMs(4.f),
+	StalenessWeight(0.5f)
 {
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 }
 
-bool IsMovableActor(AActor* pActor)
-{
-	if (NULL == pActor)
-	{
-		return false;
-	}
-
-	if (Cast<ACharacter>(pActor) != NULL)
-	{
-		return false;
-	}
-
-	TArray<UPrimitiveComponent*> primitiveComponents;
-	pActor->GetComponents(primitiveComponents);
-	if (primitiveComponents.Num() == 0)
-	{
-		return false;
-	}
-
-	USceneComponent* pRootComponent = pActor->GetRootComponent();
-	return NULL != pRootComponent && pRootComponent->Mobility == EComponentMobility::Movable;
-}
-
-int GetMovableActorCount()
-{
-	int count = 0;
-	for (TObjectIterator<AActor> It; It; ++It)
-	{
-		AActor* pActor = *It;
-		if (IsMovableActor(pActor))
-		{
-			count++;
-		}
-	}
-
-	return count;
-}
-
 // Called when the game starts or when spawned
 void AReflectionMonitorActor::BeginPlay()
 {
@@ -67,13 +32,45 @@ void AReflectionMonitorActor::BeginPlay()
 #endif
 			mSphereReflectionCaptures.Add(pCaptureObj);
 		}
-		mMovableActorCount = GetMovableActorCount();
 	}
+	mCaptureIndex.Build(mSphereReflectionCaptures);
+
+	if (!mpChangeTracker.IsValid())
+	{
+		mpChangeTracker = MakeUnique<FReflectionChangeTracker>(GEngine->GameViewport->GetWorld(), MODE_AGRESSIVE_ESS == ObjectTrackMode);
+	}
+}
+
+void AReflectionMonitorActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	mpChangeTracker.Reset();
+	Super::EndPlay(EndPlayReason);
 }
 
-void AReflectionMonitorActor::ChangeMobility(USceneComponent* pComponent, EComponentMobility::Type mobility)
+void AReflectionMonitorActor::SetMonitorMobility(USceneComponent* pComponent, EComponentMobility::Type mobility, bool bTemporary)
 {
+	// Relevance follows the mobility of the owner's root, so every component of the owner is left out
+	TInlineComponentArray<UActorComponent*> components;
+	if (NULL != pComponent->GetOwner())
+	{
+		pComponent->GetOwner()->GetComponents(components);
+	}
+	components.AddUnique(pComponent);
+
+	for (UActorComponent* pOwnerComponent : components)
+	{
+		mpChangeTracker->Ignore(pOwnerComponent);
+	}
+
 	pComponent->SetMobility(mobility);
+
+	if (!bTemporary)
+	{
+		for (UActorComponent* pOwnerComponent : components)
+		{
+			mpChangeTracker->Release(pOwnerComponent);
+		}
+	}
 }
 
 bool GetActiveCameraSetting(UWorld* world, FVector& cameraOrigin, FVector& cameraDirection)
@@ -120,271 +117,141 @@ bool GetActiveCameraSetting(UWorld* world, FVector& cameraOrigin, FVector& camer
 void AReflectionMonitorActor::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
+	SCOPE_CYCLE_COUNTER(STAT_ReflectionMonitor_Tick);
+
+	if (!mpChangeTracker.IsValid())
+	{
+		return;
+	}
+
 	bool movableActorChanged = false;
 	UWorld* world = GEngine->GameViewport->GetWorld();
 	bool bMouseDown = (GetAsyncKeyState(VK_LBUTTON) & 0x8000) != 0;
+	mpChangeTracker->Flush();
+
 	switch (ObjectTrackMode)
 	{
 	case MODE_DRAGANDDROP:
-		if (!mbMouseDown)
+		// Changes made while dragging are collected and only acted on once the drop happens
+		if (!bMouseDown && mTempStaticActors.Num() == 0)
 		{
-			if (bMouseDown)
-			{
-				mMovableActorTransforms.Reset();
-				for (TObjectIterator<AActor> It; It; ++It)
-				{
-					AActor* pActor = *It;
-					if (IsMovableActor(pActor))
-					{
-						USceneComponent* pRootComponent = pActor->GetRootComponent();
-						mMovableActorTransforms.Add(pActor->GetUniqueID(), pRootComponent->GetComponentTransform());
-					}
-				}
-			}
-			else if (mTempStaticActors.Num() == 0)
-			{
-				int curentMovableActorCount = GetMovableActorCount();
-				movableActorChanged = curentMovableActorCount != mMovableActorCount;
-				mMovableActorCount = curentMovableActorCount;
-			}
+			movableActorChanged = mpChangeTracker->HasChanges();
 		}
-		else if (!bMouseDown)
-		{
-			int movableActorCount = 0;
-			for (TObjectIterator<AActor> It; It; ++It)
-			{
-				AActor* pActor = *It;
-				movableActorCount++;
-				if (movableActorCount > mMovableActorCount)
-				{
-					movableActorChanged = true;
-					break;
-				}
-
-				if (IsMovableActor(pActor))
-				{
-					USceneComponent* pRootComponent = pActor->GetRootComponent();
-					FTransform* pTransform = mMovableActorTransforms.Find(pActor->GetUniqueID());
-					if (NULL == pTransform || !pTransform->Equals(pRootComponent->GetComponentTransform()))
-					{
-						movableActorChanged = true;
-						break;
-					}
-				}
-			}
-		}
-		mbMouseDown = bMouseDown;
 		break;
 	case MODE_AGRESSIVE:
-		if (!bMouseDown)
-		{
-			static int sCheckTime = 0;
-			const int CHECK_FREQUENCY = 5;
-			TMap<uint32, FTransform> currentMovableActorTransforms;
-			if (sCheckTime++ == CHECK_FREQUENCY)
-			{
-				sCheckTime = sCheckTime % CHECK_FREQUENCY;
-				for (TObjectIterator<AActor> It; It; ++It)
-				{
-					AActor* pActor = *It;
-					if (IsMovableActor(pActor))
-					{
-						USceneComponent* pRootComponent = pActor->GetRootComponent();
-						FTransform* pTransform = mMovableActorTransforms.Find(pActor->GetUniqueID());
-						if (NULL == pTransform || !pTransform->Equals(pRootComponent->GetComponentTransform()))
-						{
-							movableActorChanged = true;
-						}
-						currentMovableActorTransforms.Add(pActor->GetUniqueID(), pRootComponent->GetComponentTransform());
-					}
-				}
-				movableActorChanged |= currentMovableActorTransforms.Num() != mMovableActorTransforms.Num();
-				if (movableActorChanged)
-				{
-					mMovableActorTransforms = currentMovableActorTransforms;
-				}
-			}
-		}
-		break;
 	case MODE_AGRESSIVE_ESS:
 		if (!bMouseDown)
 		{
-			static int sCheckTime2 = 0;
 			const int CHECK_FREQUENCY = 5;
-			TMap<uint32, FTransform> currentMovableActorTransforms;
-			if (sCheckTime2++ == CHECK_FREQUENCY)
+			if (++mTicksSinceCheck >= CHECK_FREQUENCY)
 			{
-				sCheckTime2 = sCheckTime2 % CHECK_FREQUENCY;
-				for (TObjectIterator<UMeshComponent> It; It; ++It)
-				{
-					UMeshComponent* pPrimitive = *It;
-					if (NULL == pPrimitive || pPrimitive->GetClass()->GetName() != TEXT("RuntimeMeshComponent"))
-					{
-						continue;
-					}
-
-					FTransform* pTransform = mMovableActorTransforms.Find(pPrimitive->GetUniqueID());
-					if (NULL == pTransform || !pTransform->Equals(pPrimitive->GetComponentTransform()))
-					{
-						movableActorChanged = true;
-					}
-					currentMovableActorTransforms.Add(pPrimitive->GetUniqueID(), pPrimitive->GetComponentTransform());
-				}
-				
-				movableActorChanged |= currentMovableActorTransforms.Num() != mMovableActorTransforms.Num();
-				if (movableActorChanged)
-				{
-					mMovableActorTransforms = currentMovableActorTransforms;
-				}
+				mTicksSinceCheck = 0;
+				movableActorChanged = mpChangeTracker->HasChanges();
 			}
 		}
-		else
+		else if (MODE_AGRESSIVE_ESS == ObjectTrackMode && !mbMouseDown)
 		{
-			for (TObjectIterator<UMeshComponent> It; It; ++It)
+			// Selected ess meshes have to be movable to be dragged
+			mpChangeTracker->ForEachRelevantComponent([this](UPrimitiveComponent* pComponent)
 			{
-				UMeshComponent* pMeshComponent = *It;
-				if (NULL != pMeshComponent && pMeshComponent->GetClass()->GetName() == TEXT("RuntimeMeshComponent") && pMeshComponent->IsSelected())
+				if (pComponent->IsSelected())
 				{
-					pMeshComponent->SetMobility(EComponentMobility::Movable);
+					SetMonitorMobility(pComponent, EComponentMobility::Movable, false);
 				}
-			}
+			});
 		}
 		break;
 	default:
 		break;
 	}
+	mbMouseDown = bMouseDown;
 
 	if (movableActorChanged)
 	{
 		bool anyInvalid = false;
-		for (auto& capture : mSphereReflectionCaptures)
+		TSet<TWeakObjectPtr<ASphereReflectionCapture>> invalidatedCaptures;
+		if (bSpatialInvalidation)
 		{
-			if (capture.IsValid())
+			for (const FBox& region : mpChangeTracker->GetChangedRegions())
 			{
-				mPendingUpdatingCaptures.Add(capture);
+				mCaptureIndex.Query(region, invalidatedCaptures);
 			}
-			else
+		}
+		for (auto& capture : mSphereReflectionCaptures)
+		{
+			if (!capture.IsValid())
 			{
 				anyInvalid = true;
 			}
+			else if (!bSpatialInvalidation || invalidatedCaptures.Contains(capture))
+			{
+				mCaptureScheduler.Invalidate(capture);
+			}
 		}
-		if (MODE_AGRESSIVE_ESS != ObjectTrackMode)
+
+		// Movable objects are only baked into captures while static, only the ones seen by a pending capture need it
+		mpChangeTracker->ForEachRelevantComponent([&](UPrimitiveComponent* pComponent)
 		{
-			for (TObjectIterator<AActor> It; It; ++It)
+			if (bSpatialInvalidation && !mCaptureIndex.IntersectsAny(pComponent->Bounds.GetBox(), mCaptureScheduler.GetPendingCaptures()))
 			{
-				AActor* pActor = *It;
-				if (IsMovableActor(pActor))
-				{
-					mTempStaticActors.Add(pActor);
-					pActor->GetRootComponent()->SetMobility(EComponentMobility::Static);
-				}
+				return;
 			}
-		}
-		else
+
+			if (MODE_AGRESSIVE_ESS != ObjectTrackMode)
+			{
+				mTempStaticActors.Add(pComponent->GetOwner());
+			}
+			else
+			{
+				SetMonitorMobility(pComponent, EComponentMobility::Static, false);
+			}
+		});
+		for (auto& staticActor : mTempStaticActors)
 		{
-			for (TObjectIterator<UMeshComponent> It; It; ++It)
+			if (staticActor.IsValid())
 			{
-				UMeshComponent* pMeshComponent = *It;
-				if (NULL != pMeshComponent && pMeshComponent->GetClass()->GetName() == TEXT("RuntimeMeshComponent"))
-				{
-					pMeshComponent->SetMobility(EComponentMobility::Static);
-				}
+				SetMonitorMobility(staticActor->GetRootComponent(), EComponentMobility::Static, true);
 			}
 		}
-		
+		mpChangeTracker->ResetChanges();
+
 		if (anyInvalid)
 		{
-			mSphereReflectionCaptures = mPendingUpdatingCaptures;
+			for (auto it = mSphereReflectionCaptures.CreateIterator(); it; ++it)
+			{
+				if (!it->IsValid())
+				{
+					it.RemoveCurrent();
+				}
+			}
+			mCaptureIndex.Build(mSphereReflectionCaptures);
 		}
 	}
 
-	if (mPendingUpdatingCaptures.Num() > 0)
+	if (mCaptureScheduler.Num() > 0)
 	{
+		// Dragging keeps invalidating, refreshing now would only be thrown away
 		if (bMouseDown)
 		{
+			mCaptureScheduler.TickIdle();
 			return;
 		}
 
 		FVector cameraOrigin;
 		FVector cameraDirection;
-		ASphereReflectionCapture* pCandidateCaptureActor = NULL;
-		if (GetActiveCameraSetting(world, cameraOrigin, cameraDirection))
-		{
-			float candidateDepth = FLT_MAX;
-			for (auto& capture : mPendingUpdatingCaptures)
-			{
-				if (!capture.IsValid())
-				{
-					continue;
-				}
-
-				UReflectionCaptureComponent* pReflectionCapture = capture->GetCaptureComponent();
-				if (pReflectionCapture)
-				{
-					const FTransform& captureTransform = capture->GetRootComponent()->GetComponentTransform();
-					FVector cameraToCapture = captureTransform.GetLocation() - cameraOrigin;
-					float depth = FVector::DotProduct(cameraToCapture, cameraDirection);
-					auto compareDepth = [&]()
-					{
-						if (depth > 0)
-						{
-							if (candidateDepth <= 0)
-							{
-								return true;
-							}
-							else if (depth < candidateDepth)
-							{
-								return true;
-							}
-						}
-						else // depth <= 0
-						{
-							if (candidateDepth == FLT_MAX)
-							{
-								return true;
-							}
-							else if (depth > candidateDepth)
-							{
-								return true;
-							}
-						}
-						return false;
-					};
-					if (compareDepth())
-					{
-						candidateDepth = depth;
-						pCandidateCaptureActor = capture.Get();
-					}
-				}
-			}
-			if (FLT_MAX == candidateDepth)
-			{
-				mPendingUpdatingCaptures.Reset();
-			}
-		}
-		else
-		{
-			pCandidateCaptureActor = (*mPendingUpdatingCaptures.CreateIterator()).Get();
-		}
-
-		if (NULL != pCandidateCaptureActor)
-		{
-			UReflectionCaptureComponent* pReflectionCapture = pCandidateCaptureActor->GetCaptureComponent();
-			if (NULL != pReflectionCapture)
-			{
-				pReflectionCapture->SetCaptureIsDirty();
-			}
-			mPendingUpdatingCaptures.Remove(pCandidateCaptureActor);
-		}
+		bool bHasCamera = GetActiveCameraSetting(world, cameraOrigin, cameraDirection);
+		mCaptureScheduler.BudgetMs = RefreshBudgetMs;
+		mCaptureScheduler.StalenessWeight = StalenessWeight;
+		mCaptureScheduler.Tick(bHasCamera, cameraOrigin, cameraDirection);
 	}
 	else
 	{
+		mCaptureScheduler.TickIdle();
 		for (auto& staticActor : mTempStaticActors)
 		{
 			if (staticActor.IsValid())
 			{
-				USceneComponent* pRootComponent = staticActor->GetRootComponent();
-				pRootComponent->SetMobility(EComponentMobility::Movable);
+				SetMonitorMobility(staticActor->GetRootComponent(), EComponentMobility::Movable, false);
 			}
 		}
 		mTempStaticActors.Reset();
@@ -5,6 +5,9 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Classes/Engine/SphereReflectionCapture.h"
+#include "ReflectionChangeTracker.h"
+#include "ReflectionCaptureIndex.h"
+#include "ReflectionCaptureScheduler.h"
 #include "ReflectionMonitorActor.generated.h"
 
 UENUM()
@@ -24,23 +27,38 @@ public:
 	// Sets default values for this actor's properties
 	AReflectionMonitorActor();
 
-	UFUNCTION(BlueprintCallable, Category = "Components")
-	static void ChangeMobility(USceneComponent* pComponent, EComponentMobility::Type mobility);
-
 	UPROPERTY(EditAnywhere, Category = ObjectTracking)
 	TEnumAsByte<enum EObjectTrackMode> ObjectTrackMode;
 
+	// Only recapture the sphere captures whose influence overlaps the old or new bounds of what changed
+	UPROPERTY(EditAnywhere, Category = ObjectTracking)
+	bool bSpatialInvalidation;
+
+	// Milliseconds per frame spent on refreshing captures, at least one capture is refreshed per frame while any are pending
+	UPROPERTY(EditAnywhere, Category = CaptureRefresh, meta = (ClampMin = "0.0"))
+	float RefreshBudgetMs;
+
+	// Priority a pending capture gains per second, so far away captures are refreshed eventually
+	UPROPERTY(EditAnywhere, Category = CaptureRefresh, meta = (ClampMin = "0.0"))
+	float StalenessWeight;
+
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Every mobility change the monitor makes goes through here so the tracker doesn't take it for a change of the scene.
+	// A temporary change keeps the owner's components out of the tracking until the mobility is set again with bTemporary false.
+	void SetMonitorMobility(USceneComponent* pComponent, EComponentMobility::Type mobility, bool bTemporary);
 
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 	bool mbMouseDown;
 	TSet<TWeakObjectPtr<ASphereReflectionCapture>> mSphereReflectionCaptures;
-	TSet<TWeakObjectPtr<ASphereReflectionCapture>> mPendingUpdatingCaptures;
 	TSet<TWeakObjectPtr<AActor>> mTempStaticActors;
-	TMap<uint32, FTransform> mMovableActorTransforms;
-	int32 mMovableActorCount;
+	TUniquePtr<FReflectionChangeTracker> mpChangeTracker;
+	FReflectionCaptureIndex mCaptureIndex;
+	FReflectionCaptureScheduler mCaptureScheduler;
+	int32 mTicksSinceCheck;
 };